@@ -0,0 +1,142 @@
+#include <cassert>
+#include <chrono>
+#include <algorithm>
+#include "AudioStream.h"
+
+//Tempo is allowed to vary enough to cover emulation running between 85% and 115% of its speed
+#define MIN_TEMPO			(0.85f)
+#define MAX_TEMPO			(1.15f)
+#define TEMPO_SMOOTHING		(0.05f)
+
+//Audio thread resynchronizes with the clock if it's late by more than that
+#define MAX_LAG_MS			(100)
+
+CAudioStream::CAudioStream()
+: m_fifo(FIFO_SIZE)
+, m_stretcher(SAMPLE_RATE)
+, m_stopping(false)
+, m_latency(0)
+, m_underrunCount(0)
+{
+	m_outputBuffers.resize(CHUNK_FRAMES * 2 * OUTPUT_BUFFER_COUNT);
+}
+
+CAudioStream::~CAudioStream()
+{
+	Stop();
+}
+
+void CAudioStream::Start(CSoundHandler* handler)
+{
+	assert(handler != nullptr);
+	assert(!IsStarted());
+	m_handler = handler;
+	m_stretcher.Clear();
+	m_stretcher.SetTempo(1.0f);
+	m_buffering = true;
+	m_stopping = false;
+	m_thread = std::thread([this] () { ThreadProc(); });
+}
+
+void CAudioStream::Stop()
+{
+	if(!IsStarted()) return;
+	m_stopping = true;
+	m_thread.join();
+	m_handler = nullptr;
+}
+
+bool CAudioStream::IsStarted() const
+{
+	return m_thread.joinable();
+}
+
+void CAudioStream::Write(const int16* samples, unsigned int sampleCount)
+{
+	//FIFO always holds complete frames, samples that don't fit are dropped
+	assert((sampleCount & 1) == 0);
+	m_fifo.Write(samples, sampleCount);
+}
+
+CAudioStream::STATS CAudioStream::GetStats() const
+{
+	STATS stats;
+	stats.latency = m_latency;
+	stats.underrunCount = m_underrunCount;
+	return stats;
+}
+
+void CAudioStream::ThreadProc()
+{
+	auto chunkDuration = std::chrono::microseconds((CHUNK_FRAMES * 1000000ULL) / SAMPLE_RATE);
+	auto maxLag = std::chrono::milliseconds(MAX_LAG_MS);
+	auto nextChunkTime = std::chrono::steady_clock::now();
+	while(!m_stopping)
+	{
+		ProcessChunk();
+		nextChunkTime += chunkDuration;
+		auto currentTime = std::chrono::steady_clock::now();
+		if(currentTime > (nextChunkTime + maxLag))
+		{
+			nextChunkTime = currentTime;
+		}
+		std::this_thread::sleep_until(nextChunkTime);
+	}
+}
+
+void CAudioStream::ProcessChunk()
+{
+	unsigned int pendingFrames = (m_fifo.GetAvailableSamples() / 2) + m_stretcher.GetInputFrameCount() + m_stretcher.GetOutputFrameCount();
+	if(pendingFrames > MAX_LATENCY_FRAMES)
+	{
+		//Emulation ran way faster than real time, drop samples that would only add latency
+		unsigned int discardFrames = std::min<unsigned int>(pendingFrames - TARGET_LATENCY_FRAMES, m_fifo.GetAvailableSamples() / 2);
+		m_fifo.Discard(discardFrames * 2);
+		pendingFrames -= discardFrames;
+	}
+	m_latency = (pendingFrames * 1000) / SAMPLE_RATE;
+
+	if(m_buffering)
+	{
+		if(pendingFrames < TARGET_LATENCY_FRAMES) return;
+		m_buffering = false;
+	}
+
+	UpdateTempo(pendingFrames);
+
+	int16 inputSamples[CHUNK_FRAMES * 2];
+	while(m_stretcher.GetOutputFrameCount() < CHUNK_FRAMES)
+	{
+		unsigned int readSamples = m_fifo.Read(inputSamples, CHUNK_FRAMES * 2);
+		if(readSamples == 0) break;
+		m_stretcher.PutSamples(inputSamples, readSamples / 2);
+	}
+
+	if(m_stretcher.GetOutputFrameCount() < CHUNK_FRAMES)
+	{
+		//Wait for the FIFO to be filled up again before resuming output
+		m_underrunCount++;
+		m_buffering = true;
+		return;
+	}
+
+	int16* outputBuffer = m_outputBuffers.data() + (m_currentOutputBuffer * CHUNK_FRAMES * 2);
+	m_currentOutputBuffer = (m_currentOutputBuffer + 1) % OUTPUT_BUFFER_COUNT;
+	m_stretcher.ReceiveSamples(outputBuffer, CHUNK_FRAMES);
+
+	m_handler->RecycleBuffers();
+	if(m_handler->HasFreeBuffers())
+	{
+		m_handler->Write(outputBuffer, CHUNK_FRAMES * 2, SAMPLE_RATE);
+	}
+}
+
+void CAudioStream::UpdateTempo(unsigned int pendingFrames)
+{
+	//Play faster when more samples than needed are pending and slower when running low
+	float targetTempo = static_cast<float>(pendingFrames) / static_cast<float>(TARGET_LATENCY_FRAMES);
+	targetTempo = std::max<float>(targetTempo, MIN_TEMPO);
+	targetTempo = std::min<float>(targetTempo, MAX_TEMPO);
+	float tempo = m_stretcher.GetTempo();
+	m_stretcher.SetTempo(tempo + ((targetTempo - tempo) * TEMPO_SMOOTHING));
+}
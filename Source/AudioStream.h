@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Types.h"
+#include "SampleFifo.h"
+#include "TimeStretcher.h"
+#include "../tools/PsfPlayer/Source/SoundHandler.h"
+
+//Moves SPU output to a dedicated thread that feeds the sound handler at the output rate.
+//The emulation thread pushes samples in a lock-free FIFO and the audio thread stretches
+//them to keep the FIFO around a target fill level, hiding emulation speed variations.
+class CAudioStream
+{
+public:
+	struct STATS
+	{
+		uint32		latency = 0;		//In milliseconds, samples waiting to be sent to the handler
+		uint32		underrunCount = 0;	//Times the audio thread ran out of samples since start
+	};
+
+							CAudioStream();
+	virtual					~CAudioStream();
+
+	//Handler is owned by the caller and must outlive the stream until Stop is called
+	void					Start(CSoundHandler*);
+	void					Stop();
+	bool					IsStarted() const;
+
+	//Called from the emulation thread, 'sampleCount' counts both channels
+	void					Write(const int16*, unsigned int sampleCount);
+
+	STATS					GetStats() const;
+
+private:
+	enum
+	{
+		SAMPLE_RATE = 44100,
+		CHUNK_FRAMES = 441,
+		OUTPUT_BUFFER_COUNT = 16,
+		FIFO_SIZE = 0x10000,
+		TARGET_LATENCY_FRAMES = 4410,
+		MAX_LATENCY_FRAMES = TARGET_LATENCY_FRAMES * 4,
+	};
+
+	void					ThreadProc();
+	void					ProcessChunk();
+	void					UpdateTempo(unsigned int);
+
+	CSampleFifo				m_fifo;
+	CTimeStretcher			m_stretcher;
+	CSoundHandler*			m_handler = nullptr;
+
+	std::thread				m_thread;
+	std::atomic<bool>		m_stopping;
+
+	//Output buffers are rotated, some handlers keep pointers to them until played
+	std::vector<int16>		m_outputBuffers;
+	unsigned int			m_currentOutputBuffer = 0;
+	bool					m_buffering = true;
+
+	std::atomic<uint32>		m_latency;
+	std::atomic<uint32>		m_underrunCount;
+};
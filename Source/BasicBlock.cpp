@@ -1,8 +1,13 @@
+#include <mutex>
+#include <algorithm>
+#include <memory>
 #include "BasicBlock.h"
 #include "MemStream.h"
 #include "offsetof_def.h"
 #include "MipsJitter.h"
 #include "Jitter_CodeGenFactory.h"
+#include "BlockCache.h"
+#include <zlib.h>
 
 #if defined(AOT_BUILD_CACHE) || defined(AOT_USE_CACHE)
 #define AOT_ENABLED
@@ -10,7 +15,6 @@
 
 #ifdef AOT_ENABLED
 
-#include <zlib.h>
 #include "StdStream.h"
 #include "StdStreamUtils.h"
 
@@ -42,17 +46,21 @@ CBasicBlock::CBasicBlock(CMIPS& context, uint32 begin, uint32 end)
 : m_begin(begin)
 , m_end(end)
 , m_context(context)
+, m_compileState(COMPILE_STATE_NONE)
 , m_selfLoopCount(0)
-#ifdef AOT_USE_CACHE
-, m_function(nullptr)
-#endif
 {
 	assert(m_end >= m_begin);
 }
 
 CBasicBlock::~CBasicBlock()
 {
-
+	UnlinkBlocks();
+#ifndef AOT_USE_CACHE
+	if(m_codeArena != nullptr)
+	{
+		m_codeArena->Free(m_codeAllocation);
+	}
+#endif
 }
 
 #ifdef AOT_BUILD_CACHE
@@ -69,20 +77,51 @@ void CBasicBlock::SetAotBlockOutputStream(Framework::CStdStream* outputStream)
 #endif
 
 void CBasicBlock::Compile()
+{
+	CompileFunction();
+	//Code needs to be visible to other threads before they see the block as compiled
+	m_compileState.store(COMPILE_STATE_DONE, std::memory_order_release);
+}
+
+bool CBasicBlock::TryCompile()
+{
+	uint32 expectedState = COMPILE_STATE_NONE;
+	if(!m_compileState.compare_exchange_strong(expectedState, COMPILE_STATE_COMPILING)) return false;
+	Compile();
+	return true;
+}
+
+void CBasicBlock::CompileFunction()
 {
 #ifndef AOT_USE_CACHE
 
+#ifndef AOT_BUILD_CACHE
+	AOT_BLOCK_KEY cacheKey = {};
+	CBlockCache::SymbolReferenceArray symbolReferences;
+	bool trackReferences = (m_blockCache != nullptr);
+	if(m_blockCache != nullptr)
+	{
+		cacheKey = GetCacheKey();
+		std::vector<uint8> cachedCode;
+		if(m_blockCache->LoadBlock(cacheKey, cachedCode))
+		{
+			SetFunctionCode(cachedCode.data(), cachedCode.size());
+			return;
+		}
+	}
+#endif
+
 	Framework::CMemStream stream;
 	{
-		static
-#ifdef AOT_BUILD_CACHE
-		__declspec(thread)
+#ifndef AOT_BUILD_CACHE
+		std::lock_guard<std::mutex> compileLock(m_context.m_compileMutex);
 #endif
-		CMipsJitter* jitter = nullptr;
-		if(jitter == nullptr)
+		//Every thread compiling blocks (ie.: VU1 worker thread, background compiler) has its own jitter
+		static thread_local std::unique_ptr<CMipsJitter> jitter;
+		if(!jitter)
 		{
 			Jitter::CCodeGen* codeGen = Jitter::CreateCodeGen();
-			jitter = new CMipsJitter(codeGen);
+			jitter = std::make_unique<CMipsJitter>(codeGen);
 
 			for(unsigned int i = 0; i < 4; i++)
 			{
@@ -94,14 +133,53 @@ void CBasicBlock::Compile()
 		}
 
 		jitter->SetStream(&stream);
+#ifndef AOT_BUILD_CACHE
+		if(trackReferences)
+		{
+			//Host functions called by the block need to be known to relocate it when it's loaded back
+			jitter->GetCodeGen()->SetExternalSymbolReferencedHandler(
+				[&symbolReferences] (uintptr_t symbol, uint32 offset)
+				{
+					CBlockCache::SYMBOL_REFERENCE reference = { offset, symbol };
+					symbolReferences.push_back(reference);
+				}
+			);
+		}
+#endif
 		jitter->Begin();
-		CompileRange(jitter);
+		CompileRange(jitter.get());
 //		codeGen.DumpVariables(0);
 //		codeGen.EndQuota();
 		jitter->End();
+#ifndef AOT_BUILD_CACHE
+		if(trackReferences)
+		{
+			jitter->GetCodeGen()->SetExternalSymbolReferencedHandler(nullptr);
+		}
+#endif
 	}
 
-	m_function = CMemoryFunction(stream.GetBuffer(), stream.GetSize());
+#ifndef AOT_BUILD_CACHE
+	if(trackReferences)
+	{
+		if(!CBlockCache::AreReferencesResolved(stream.GetBuffer(), stream.GetSize(), symbolReferences))
+		{
+			//Code generator didn't emit references as plain pointers, code can't be used as is
+			m_blockCache = nullptr;
+			CompileFunction();
+			return;
+		}
+		//Code might have been written over while it was compiled on another thread,
+		//what was generated wouldn't match the key it was looked up with
+		auto compiledKey = GetCacheKey();
+		if(compiledKey.crc == cacheKey.crc)
+		{
+			m_blockCache->AddBlock(cacheKey, stream.GetBuffer(), stream.GetSize(), symbolReferences);
+		}
+	}
+#endif
+
+	SetFunctionCode(stream.GetBuffer(), stream.GetSize());
 	
 #ifdef VTUNE_ENABLED
 	if(iJIT_IsProfilingActive() == iJIT_SAMPLING_ON)
@@ -111,8 +189,8 @@ void CBasicBlock::Compile()
 		jmethod.class_file_name = "";
 		jmethod.source_file_name = __FILE__;
 
-		jmethod.method_load_address = m_function.GetCode();
-		jmethod.method_size = m_function.GetSize();
+		jmethod.method_load_address = m_codeAllocation.code;
+		jmethod.method_size = m_codeAllocation.size;
 		jmethod.line_number_size = 0;
 
 		auto functionName = string_format("BasicBlock_0x%0.8X_0x%0.8X", m_begin, m_end);
@@ -178,8 +256,62 @@ void CBasicBlock::Compile()
 #endif
 }
 
+#ifndef AOT_USE_CACHE
+
+void CBasicBlock::SetFunctionCode(const void* code, size_t size)
+{
+	assert(m_codeArena != nullptr);
+	assert(m_codeAllocation.code == nullptr);
+	m_codeAllocation = m_codeArena->Allocate(m_begin, code, size);
+	m_function = reinterpret_cast<void (*)(void*)>(m_codeAllocation.code);
+}
+
+#endif
+
+void CBasicBlock::GetCompiledRange(uint32& begin, uint32& end) const
+{
+	begin = m_begin;
+	end = m_end;
+}
+
+void CBasicBlock::GetCompileParameters(std::vector<uint32>&) const
+{
+
+}
+
+AOT_BLOCK_KEY CBasicBlock::GetCacheKey() const
+{
+	uint32 rangeBegin = 0;
+	uint32 rangeEnd = 0;
+	GetCompiledRange(rangeBegin, rangeEnd);
+
+	std::vector<uint32> blockData;
+	blockData.reserve(((rangeEnd - rangeBegin) / 4) + 1);
+	for(uint32 address = rangeBegin; address <= rangeEnd; address += 4)
+	{
+		blockData.push_back(m_context.m_pMemoryMap->GetInstruction(address));
+	}
+	if(m_isLoop)
+	{
+		//Code of a loop block isn't the same as the code of a plain block covering the same range
+		blockData.push_back(LOOP_CACHE_KEY_MARKER);
+	}
+	GetCompileParameters(blockData);
+
+	AOT_BLOCK_KEY key = {};
+	key.crc		= crc32(0, reinterpret_cast<const Bytef*>(blockData.data()), static_cast<uInt>(blockData.size() * 4));
+	key.begin	= m_begin;
+	key.end		= m_end;
+	return key;
+}
+
 void CBasicBlock::CompileRange(CMipsJitter* jitter)
 {
+	if(m_isLoop)
+	{
+		CompileLoopRange(jitter);
+		return;
+	}
 	for(uint32 address = m_begin; address <= m_end; address += 4)
 	{
 		m_context.m_pArch->CompileInstruction(
@@ -191,8 +323,124 @@ void CBasicBlock::CompileRange(CMipsJitter* jitter)
 	}
 }
 
+void CBasicBlock::CompileLoopRange(CMipsJitter* jitter)
+{
+	//Every instruction a branch of the loop can go to gets a label
+	LabelMap labels;
+	for(uint32 address = m_begin; address <= m_end; address += 4)
+	{
+		uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
+		if(m_context.m_pArch->IsInstructionBranch(&m_context, address, opcode) != MIPS_BRANCH_NORMAL) continue;
+		uint32 target = m_context.m_pArch->GetInstructionEffectiveAddress(&m_context, address, opcode);
+		if((target < m_begin) || (target > m_end)) continue;
+		if(labels.find(target) == std::end(labels))
+		{
+			labels.insert(std::make_pair(target, jitter->CreateLabel()));
+		}
+	}
+
+	uint32 branchAddress = MIPS_INVALID_PC;
+	for(uint32 address = m_begin; address <= m_end; address += 4)
+	{
+		auto labelIterator = labels.find(address);
+		if(labelIterator != std::end(labels))
+		{
+			jitter->MarkLabel(labelIterator->second);
+		}
+		m_context.m_pArch->CompileInstruction(
+			address,
+			jitter,
+			&m_context);
+		//Sanity check
+		assert(jitter->IsStackEmpty());
+		if(branchAddress != MIPS_INVALID_PC)
+		{
+			//Delay slot is done, branch can be taken
+			CompileLoopBranch(jitter, branchAddress, labels);
+			branchAddress = MIPS_INVALID_PC;
+		}
+		else
+		{
+			uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
+			if(m_context.m_pArch->IsInstructionBranch(&m_context, address, opcode) == MIPS_BRANCH_NORMAL)
+			{
+				branchAddress = address;
+			}
+		}
+	}
+	//Loop ends without taking the last branch
+	CompileLoopInstructionCount(jitter, ((m_end - m_begin) / 4) + 1);
+}
+
+void CBasicBlock::CompileLoopBranch(CMipsJitter* jitter, uint32 branchAddress, const LabelMap& labels)
+{
+	uint32 opcode = m_context.m_pMemoryMap->GetInstruction(branchAddress);
+	uint32 target = m_context.m_pArch->GetInstructionEffectiveAddress(&m_context, branchAddress, opcode);
+	auto labelIterator = labels.find(target);
+	uint32 delaySlotAddress = branchAddress + 4;
+	//Going forward skips instructions, the count is then negative and taken back from the total
+	int32 takenInstructionCount = (static_cast<int32>(delaySlotAddress - target) / 4) + 1;
+
+	jitter->PushRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+	jitter->PushCst(MIPS_INVALID_PC);
+	jitter->BeginIf(Jitter::CONDITION_NE);
+	{
+		if(labelIterator != std::end(labels))
+		{
+			if(target > branchAddress)
+			{
+				CompileLoopInstructionCount(jitter, takenInstructionCount);
+
+				jitter->PushCst(MIPS_INVALID_PC);
+				jitter->PullRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+				jitter->Goto(labelIterator->second);
+			}
+			else
+			{
+				//Going back is only allowed while the executor gives more time and nothing needs to be handled
+				jitter->PushRel(offsetof(CMIPS, m_loopIterationCount));
+				jitter->PushRel(offsetof(CMIPS, m_loopIterationLimit));
+				jitter->BeginIf(Jitter::CONDITION_BL);
+				{
+					jitter->PushRel(offsetof(CMIPS, m_State.nHasException));
+					jitter->PushCst(0);
+					jitter->BeginIf(Jitter::CONDITION_EQ);
+					{
+						jitter->PushRel(offsetof(CMIPS, m_loopIterationCount));
+						jitter->PushCst(1);
+						jitter->Add();
+						jitter->PullRel(offsetof(CMIPS, m_loopIterationCount));
+
+						CompileLoopInstructionCount(jitter, takenInstructionCount);
+
+						jitter->PushCst(MIPS_INVALID_PC);
+						jitter->PullRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+						jitter->Goto(labelIterator->second);
+					}
+					jitter->EndIf();
+				}
+				jitter->EndIf();
+			}
+		}
+		//Leaving the loop, the executor takes the branch
+		CompileLoopInstructionCount(jitter, ((delaySlotAddress - m_begin) / 4) + 1);
+		jitter->Goto(jitter->GetFinalBlockLabel());
+	}
+	jitter->EndIf();
+}
+
+void CBasicBlock::CompileLoopInstructionCount(CMipsJitter* jitter, int32 instructionCount)
+{
+	jitter->PushRel(offsetof(CMIPS, m_loopInstructionCount));
+	jitter->PushCst(static_cast<uint32>(instructionCount));
+	jitter->Add();
+	jitter->PullRel(offsetof(CMIPS, m_loopInstructionCount));
+}
+
 unsigned int CBasicBlock::Execute()
 {
+	m_context.m_loopIterationCount = 0;
+	m_context.m_loopInstructionCount = 0;
 	m_function(&m_context);
 
 	if(m_context.m_State.nDelayedJumpAddr != MIPS_INVALID_PC)
@@ -217,6 +465,10 @@ unsigned int CBasicBlock::Execute()
 	assert(m_context.m_State.nCOP2[0].nV3 == 0x3F800000);
 	assert(m_context.m_State.nCOP2VI[0] == 0);
 
+	if(m_isLoop)
+	{
+		return m_context.m_loopInstructionCount;
+	}
 	return ((m_end - m_begin) / 4) + 1;
 }
 
@@ -232,11 +484,7 @@ uint32 CBasicBlock::GetEndAddress() const
 
 bool CBasicBlock::IsCompiled() const
 {
-#ifndef AOT_USE_CACHE
-	return !m_function.IsEmpty();
-#else
-	return (m_function != nullptr);
-#endif
+	return m_compileState.load(std::memory_order_acquire) == COMPILE_STATE_DONE;
 }
 
 unsigned int CBasicBlock::GetSelfLoopCount() const
@@ -248,3 +496,110 @@ void CBasicBlock::SetSelfLoopCount(unsigned int selfLoopCount)
 {
 	m_selfLoopCount = selfLoopCount;
 }
+
+void CBasicBlock::SetIsLoop(bool isLoop)
+{
+	assert(!IsCompiled());
+	m_isLoop = isLoop;
+}
+
+bool CBasicBlock::IsLoop() const
+{
+	return m_isLoop;
+}
+
+CBasicBlock::BUSYWAIT_LOOP_INFO& CBasicBlock::GetBusyWaitLoopInfo()
+{
+	return m_busyWaitLoopInfo;
+}
+
+void CBasicBlock::SetBlockCache(CBlockCache* blockCache)
+{
+	m_blockCache = blockCache;
+}
+
+void CBasicBlock::SetCodeArena(CCodeArena* codeArena)
+{
+#ifndef AOT_USE_CACHE
+	assert((m_codeAllocation.code == nullptr) || (m_codeArena == codeArena));
+	m_codeArena = codeArena;
+#endif
+}
+
+CBasicBlock* CBasicBlock::GetLinkedBlock(uint32 address) const
+{
+	if(m_links[LINK_SLOT_NEXT].address == address) return m_links[LINK_SLOT_NEXT].block;
+	if(m_links[LINK_SLOT_BRANCH].address == address) return m_links[LINK_SLOT_BRANCH].block;
+	return nullptr;
+}
+
+void CBasicBlock::LinkBlock(uint32 address, uint32 physicalAddress, CBasicBlock* block)
+{
+	assert(block->GetBeginAddress() == physicalAddress);
+
+	if(!m_branchTargetValid)
+	{
+		//Find where the branch in this block leads, indirect jumps have no effective address
+		for(uint32 instructionAddress = m_begin; instructionAddress <= m_end; instructionAddress += 4)
+		{
+			uint32 opcode = m_context.m_pMemoryMap->GetInstruction(instructionAddress);
+			if(m_context.m_pArch->IsInstructionBranch(&m_context, instructionAddress, opcode) != MIPS_BRANCH_NORMAL) continue;
+			uint32 target = m_context.m_pArch->GetInstructionEffectiveAddress(&m_context, instructionAddress, opcode);
+			m_branchTarget = (target != 0) ? target : MIPS_INVALID_PC;
+		}
+		m_branchTargetValid = true;
+	}
+
+	unsigned int slot = LINK_SLOT_MAX;
+	if(physicalAddress == (m_end + 4))
+	{
+		slot = LINK_SLOT_NEXT;
+	}
+	else if(physicalAddress == m_branchTarget)
+	{
+		slot = LINK_SLOT_BRANCH;
+	}
+	else
+	{
+		return;
+	}
+
+	auto& link = m_links[slot];
+	if((link.address == address) && (link.block == block)) return;
+	UnlinkSlot(slot);
+	link.address = address;
+	link.block = block;
+	block->m_incomingLinks.push_back(this);
+}
+
+void CBasicBlock::UnlinkBlocks()
+{
+	for(unsigned int slot = 0; slot < LINK_SLOT_MAX; slot++)
+	{
+		UnlinkSlot(slot);
+	}
+	while(!m_incomingLinks.empty())
+	{
+		auto source = m_incomingLinks.back();
+		for(unsigned int slot = 0; slot < LINK_SLOT_MAX; slot++)
+		{
+			if(source->m_links[slot].block == this)
+			{
+				source->UnlinkSlot(slot);
+				break;
+			}
+		}
+	}
+}
+
+void CBasicBlock::UnlinkSlot(unsigned int slot)
+{
+	auto& link = m_links[slot];
+	if(link.block == nullptr) return;
+	auto& targetIncomingLinks = link.block->m_incomingLinks;
+	auto incomingLinkIterator = std::find(std::begin(targetIncomingLinks), std::end(targetIncomingLinks), this);
+	assert(incomingLinkIterator != std::end(targetIncomingLinks));
+	targetIncomingLinks.erase(incomingLinkIterator);
+	link.address = MIPS_INVALID_PC;
+	link.block = nullptr;
+}
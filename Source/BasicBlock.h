@@ -1,7 +1,10 @@
 #pragma once
 
+#include <map>
+#include <vector>
+#include <atomic>
 #include "MIPS.h"
-#include "MemoryFunction.h"
+#include "CodeArena.h"
 #ifdef AOT_BUILD_CACHE
 #include "StdStream.h"
 #include <mutex>
@@ -40,6 +43,8 @@ namespace Jitter
 	class CJitter;
 };
 
+class CBlockCache;
+
 class CBasicBlock
 {
 public:
@@ -48,12 +53,41 @@ public:
 	unsigned int					Execute();
 	void							Compile();
 
+	//Can be called from any thread, compiles the block unless another thread already did or is doing it
+	bool							TryCompile();
+
 	uint32							GetBeginAddress() const;
 	uint32							GetEndAddress() const;
 	bool							IsCompiled() const;
 	unsigned int					GetSelfLoopCount() const;
 	void							SetSelfLoopCount(unsigned int);
 
+	//A loop block is compiled with the branches inside it, and goes back to its beginning without returning
+	//to the executor while CMIPS::m_loopIterationLimit allows it. Must be set before the block is compiled.
+	void							SetIsLoop(bool);
+	bool							IsLoop() const;
+
+	//Result of the busy-wait analysis of the loop formed by this block branching back to an earlier address.
+	//Kept by the executor, 'generation' lets it know if blocks were removed since the analysis was done.
+	struct BUSYWAIT_LOOP_INFO
+	{
+		uint32		loopBegin = MIPS_INVALID_PC;
+		uint32		generation = 0;
+		bool		isBusyWaitLoop = false;
+	};
+	BUSYWAIT_LOOP_INFO&				GetBusyWaitLoopInfo();
+
+	void							SetBlockCache(CBlockCache*);
+
+	//Compiled code is placed in the arena, it must outlive the block
+	void							SetCodeArena(CCodeArena*);
+
+	//Links let the executor go directly to a block following this one without looking it up.
+	//A link is only made if the block starts at a static successor (fall-through or branch target).
+	CBasicBlock*					GetLinkedBlock(uint32) const;
+	void							LinkBlock(uint32, uint32, CBasicBlock*);
+	void							UnlinkBlocks();
+
 #ifdef AOT_BUILD_CACHE
 	static void						SetAotBlockOutputStream(Framework::CStdStream*);
 #endif
@@ -65,7 +99,49 @@ protected:
 
 	virtual void					CompileRange(CMipsJitter*);
 
+	//Range of instructions read when compiling this block
+	virtual void					GetCompiledRange(uint32&, uint32&) const;
+
+	//Decisions taken while compiling that change the generated code, they are part of the cache key
+	virtual void					GetCompileParameters(std::vector<uint32>&) const;
+
 private:
+	enum COMPILE_STATE
+	{
+		COMPILE_STATE_NONE,
+		COMPILE_STATE_COMPILING,
+		COMPILE_STATE_DONE,
+	};
+
+	enum
+	{
+		LOOP_CACHE_KEY_MARKER = 0x504F4F4C,	//'LOOP'
+	};
+
+	enum LINK_SLOT
+	{
+		LINK_SLOT_NEXT,
+		LINK_SLOT_BRANCH,
+		LINK_SLOT_MAX,
+	};
+
+	struct BLOCK_LINK
+	{
+		uint32			address = MIPS_INVALID_PC;
+		CBasicBlock*	block = nullptr;
+	};
+
+	typedef std::map<uint32, Jitter::CJitter::LABEL> LabelMap;
+
+	void							CompileFunction();
+	void							CompileLoopRange(CMipsJitter*);
+	void							CompileLoopBranch(CMipsJitter*, uint32, const LabelMap&);
+	void							CompileLoopInstructionCount(CMipsJitter*, int32);
+#ifndef AOT_USE_CACHE
+	void							SetFunctionCode(const void*, size_t);
+#endif
+	AOT_BLOCK_KEY					GetCacheKey() const;
+	void							UnlinkSlot(unsigned int);
 
 #ifdef AOT_BUILD_CACHE
 	static Framework::CStdStream*	m_aotBlockOutputStream;
@@ -73,10 +149,19 @@ private:
 #endif
 
 #ifndef AOT_USE_CACHE
-	CMemoryFunction					m_function;
-#else
-	void							(*m_function)(void*);
+	CCodeArena*						m_codeArena = nullptr;
+	CCodeArena::ALLOCATION			m_codeAllocation;
 #endif
+	void							(*m_function)(void*) = nullptr;
 
+	std::atomic<uint32>				m_compileState;
 	unsigned int					m_selfLoopCount;
+	bool							m_isLoop = false;
+	BUSYWAIT_LOOP_INFO				m_busyWaitLoopInfo;
+	CBlockCache*					m_blockCache = nullptr;
+
+	uint32							m_branchTarget = MIPS_INVALID_PC;
+	bool							m_branchTargetValid = false;
+	BLOCK_LINK						m_links[LINK_SLOT_MAX];
+	std::vector<CBasicBlock*>		m_incomingLinks;
 };
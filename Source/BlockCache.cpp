@@ -0,0 +1,373 @@
+#include <cstring>
+#include <cassert>
+#include <zlib.h>
+#include <boost/filesystem/fstream.hpp>
+#include "BlockCache.h"
+#include "StdStream.h"
+#include "make_unique.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <sys/mman.h>
+#endif
+
+CBlockCache::CBlockCache(const boost::filesystem::path& path)
+{
+	boost::system::error_code errorCode;
+	size_t fileSize = static_cast<size_t>(boost::filesystem::file_size(path, errorCode));
+	if(errorCode)
+	{
+		fileSize = 0;
+	}
+
+	size_t validSize = 0;
+	if(fileSize != 0)
+	{
+		MapFile(path, fileSize);
+		validSize = IndexRecords(m_mapping, m_mappingSize);
+		if(validSize != fileSize)
+		{
+			//Cache was built by another version or last block wasn't completely written, drop what's invalid
+			printf("BlockCache: Discarding %d bytes from '%s'.\r\n", static_cast<int>(fileSize - validSize), path.string().c_str());
+			m_blocks.clear();
+			UnmapFile();
+			boost::filesystem::resize_file(path, validSize);
+			if(validSize != 0)
+			{
+				MapFile(path, validSize);
+				IndexRecords(m_mapping, m_mappingSize);
+			}
+		}
+	}
+
+	m_outputStream = std::make_unique<Framework::CStdStream>(path.string().c_str(), "ab");
+	if(validSize == 0)
+	{
+		FILE_HEADER header = {};
+		header.magic			= FILE_MAGIC;
+		header.version			= FILE_VERSION;
+		header.pointerSize		= sizeof(void*);
+		header.buildSignature	= GetBuildSignature().value;
+		m_outputStream->Write(&header, sizeof(FILE_HEADER));
+	}
+}
+
+CBlockCache::~CBlockCache()
+{
+	m_outputStream.reset();
+	UnmapFile();
+}
+
+bool CBlockCache::IsSupported()
+{
+	//Relocations are only known to be plain 64-bit pointers on x86-64
+	//Caches can't be told apart from the ones of another build if the binary can't be read
+#if defined(_M_X64) || defined(__x86_64__)
+	return GetBuildSignature().valid;
+#else
+	return false;
+#endif
+}
+
+bool CBlockCache::AreReferencesResolved(const void* code, size_t size, const SymbolReferenceArray& references)
+{
+	for(const auto& reference : references)
+	{
+		if((reference.offset + sizeof(uintptr_t)) > size) return false;
+		uintptr_t value = 0;
+		memcpy(&value, reinterpret_cast<const uint8*>(code) + reference.offset, sizeof(uintptr_t));
+		if(value != reference.value) return false;
+	}
+	return true;
+}
+
+bool CBlockCache::LoadBlock(const AOT_BLOCK_KEY& key, std::vector<uint8>& code)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto blockIterator = m_blocks.find(key);
+	if(blockIterator == std::end(m_blocks)) return false;
+
+	auto record = blockIterator->second;
+	BLOCK_HEADER header;
+	memcpy(&header, record, sizeof(BLOCK_HEADER));
+	auto references = record + sizeof(BLOCK_HEADER);
+	auto blockCode = references + (header.referenceCount * sizeof(BLOCK_REFERENCE));
+	code.assign(blockCode, blockCode + header.codeSize);
+
+	uintptr_t anchor = GetImageAnchor();
+	for(uint32 i = 0; i < header.referenceCount; i++)
+	{
+		BLOCK_REFERENCE reference;
+		memcpy(&reference, references + (i * sizeof(BLOCK_REFERENCE)), sizeof(BLOCK_REFERENCE));
+		uintptr_t value = anchor + static_cast<intptr_t>(reference.symbolOffset);
+		memcpy(code.data() + reference.offset, &value, sizeof(uintptr_t));
+	}
+
+	return true;
+}
+
+void CBlockCache::AddBlock(const AOT_BLOCK_KEY& key, const void* code, size_t size, const SymbolReferenceArray& references)
+{
+	auto codeBytes = reinterpret_cast<const uint8*>(code);
+
+	//Make sure the block doesn't contain pointers we don't know how to relocate
+	for(const auto& reference : references)
+	{
+		if(!IsImageAddress(reference.value)) return;
+	}
+	if(HasUnrelocatedAbsolutes(codeBytes, size, references)) return;
+
+	BLOCK_HEADER header = {};
+	header.key				= key;
+	header.codeSize			= static_cast<uint32>(size);
+	header.referenceCount	= static_cast<uint32>(references.size());
+
+	size_t recordSize = sizeof(BLOCK_HEADER) + (references.size() * sizeof(BLOCK_REFERENCE)) + size;
+	std::vector<uint8> record(recordSize);
+	uint8* recordPtr = record.data();
+	memcpy(recordPtr, &header, sizeof(BLOCK_HEADER));
+	recordPtr += sizeof(BLOCK_HEADER);
+
+	uintptr_t anchor = GetImageAnchor();
+	for(const auto& reference : references)
+	{
+		BLOCK_REFERENCE blockReference = {};
+		blockReference.offset		= reference.offset;
+		blockReference.symbolOffset	= static_cast<int64>(static_cast<intptr_t>(reference.value - anchor));
+		memcpy(recordPtr, &blockReference, sizeof(BLOCK_REFERENCE));
+		recordPtr += sizeof(BLOCK_REFERENCE);
+	}
+	memcpy(recordPtr, code, size);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_blocks.find(key) != std::end(m_blocks)) return;
+	try
+	{
+		m_outputStream->Write(record.data(), record.size());
+	}
+	catch(const std::exception& exception)
+	{
+		printf("BlockCache: Failed to write block: %s\r\n", exception.what());
+		return;
+	}
+	m_addedRecords.push_back(std::move(record));
+	m_blocks.insert(std::make_pair(key, m_addedRecords.back().data()));
+}
+
+unsigned int CBlockCache::GetBlockCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return static_cast<unsigned int>(m_blocks.size());
+}
+
+uintptr_t CBlockCache::GetImageAnchor()
+{
+	return reinterpret_cast<uintptr_t>(&CBlockCache::GetImageAnchor);
+}
+
+bool CBlockCache::IsImageAddress(uintptr_t value)
+{
+	//Symbols are relocated relative to the anchor, they need to be in the same module
+#ifdef _WIN32
+	static const DWORD moduleFlags = GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT;
+	HMODULE anchorModule = NULL;
+	HMODULE valueModule = NULL;
+	if(!GetModuleHandleExW(moduleFlags, reinterpret_cast<LPCWSTR>(GetImageAnchor()), &anchorModule)) return false;
+	if(!GetModuleHandleExW(moduleFlags, reinterpret_cast<LPCWSTR>(value), &valueModule)) return false;
+	return (anchorModule == valueModule);
+#else
+	Dl_info anchorInfo = {};
+	Dl_info valueInfo = {};
+	if(dladdr(reinterpret_cast<void*>(GetImageAnchor()), &anchorInfo) == 0) return false;
+	if(dladdr(reinterpret_cast<void*>(value), &valueInfo) == 0) return false;
+	return (anchorInfo.dli_fbase == valueInfo.dli_fbase);
+#endif
+}
+
+bool CBlockCache::HasUnrelocatedAbsolutes(const uint8* code, size_t size, const SymbolReferenceArray& references)
+{
+	//x86-64 code can only hold 64-bit absolute values in MOV r64, imm64 (REX.W B8+r) and
+	//MOV with a 64-bit address (REX.W A0-A3). Any of these that isn't a reported reference
+	//could be a pointer that won't be valid in another session. We don't decode instructions,
+	//so other bytes that look like these opcodes also get the block rejected.
+	std::vector<bool> relocated(size, false);
+	std::vector<bool> referenceStart(size, false);
+	for(const auto& reference : references)
+	{
+		assert((reference.offset + sizeof(uintptr_t)) <= size);
+		std::fill(relocated.begin() + reference.offset, relocated.begin() + reference.offset + sizeof(uintptr_t), true);
+		referenceStart[reference.offset] = true;
+	}
+	for(size_t offset = 0; (offset + 2 + sizeof(uint64)) <= size; offset++)
+	{
+		if(relocated[offset] || relocated[offset + 1]) continue;
+		uint8 rex = code[offset + 0];
+		uint8 opcode = code[offset + 1];
+		if((rex & 0xF8) != 0x48) continue;
+		bool isMovImm64 = ((opcode & 0xF8) == 0xB8);
+		bool isMovOffset64 = (opcode >= 0xA0) && (opcode <= 0xA3);
+		if(!isMovImm64 && !isMovOffset64) continue;
+		if(!referenceStart[offset + 2]) return true;
+	}
+	return false;
+}
+
+const CBlockCache::BUILD_SIGNATURE& CBlockCache::GetBuildSignature()
+{
+	static const BUILD_SIGNATURE signature = ComputeBuildSignature();
+	return signature;
+}
+
+CBlockCache::BUILD_SIGNATURE CBlockCache::ComputeBuildSignature()
+{
+	//Caches are only valid for the exact binary that produced them: code generation,
+	//instruction compilers and symbol layout can change with any rebuild.
+	//Hash the file of the module holding the compiled code's references.
+	BUILD_SIGNATURE signature;
+
+	boost::filesystem::path modulePath;
+#ifdef _WIN32
+	HMODULE module = NULL;
+	if(!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+		reinterpret_cast<LPCWSTR>(GetImageAnchor()), &module))
+	{
+		return signature;
+	}
+	wchar_t modulePathString[MAX_PATH];
+	DWORD modulePathLength = GetModuleFileNameW(module, modulePathString, MAX_PATH);
+	if((modulePathLength == 0) || (modulePathLength == MAX_PATH)) return signature;
+	modulePath = modulePathString;
+#else
+	Dl_info anchorInfo = {};
+	if((dladdr(reinterpret_cast<void*>(GetImageAnchor()), &anchorInfo) == 0) || (anchorInfo.dli_fname == nullptr)) return signature;
+	modulePath = anchorInfo.dli_fname;
+#if defined(__linux__) && !defined(__ANDROID__)
+	//Main executable's name might be relative to a directory we're not in anymore
+	boost::system::error_code errorCode;
+	if(!boost::filesystem::is_regular_file(modulePath, errorCode))
+	{
+		modulePath = "/proc/self/exe";
+	}
+#endif
+#endif
+
+	boost::filesystem::ifstream moduleStream(modulePath, std::ios::binary);
+	if(!moduleStream) return signature;
+
+	uLong crc = crc32(0, Z_NULL, 0);
+	uint64 moduleSize = 0;
+	std::vector<char> buffer(0x10000);
+	while(moduleStream)
+	{
+		moduleStream.read(buffer.data(), buffer.size());
+		auto readSize = moduleStream.gcount();
+		if(readSize <= 0) break;
+		crc = crc32(crc, reinterpret_cast<const Bytef*>(buffer.data()), static_cast<uInt>(readSize));
+		moduleSize += readSize;
+	}
+	if(moduleStream.bad() || (moduleSize == 0)) return signature;
+
+	crc = crc32(crc, reinterpret_cast<const Bytef*>(&moduleSize), sizeof(uint64));
+
+	signature.valid = true;
+	signature.value = static_cast<uint32>(crc);
+	return signature;
+}
+
+size_t CBlockCache::IndexRecords(const uint8* data, size_t size)
+{
+	if(size < sizeof(FILE_HEADER)) return 0;
+
+	FILE_HEADER header;
+	memcpy(&header, data, sizeof(FILE_HEADER));
+	if(
+		(header.magic != FILE_MAGIC) ||
+		(header.version != FILE_VERSION) ||
+		(header.pointerSize != sizeof(void*)) ||
+		(header.buildSignature != GetBuildSignature().value)
+		)
+	{
+		return 0;
+	}
+
+	size_t offset = sizeof(FILE_HEADER);
+	while((offset + sizeof(BLOCK_HEADER)) <= size)
+	{
+		BLOCK_HEADER blockHeader;
+		memcpy(&blockHeader, data + offset, sizeof(BLOCK_HEADER));
+		size_t recordSize = sizeof(BLOCK_HEADER) + (static_cast<size_t>(blockHeader.referenceCount) * sizeof(BLOCK_REFERENCE)) + blockHeader.codeSize;
+		if((offset + recordSize) > size) break;
+
+		bool valid = true;
+		auto references = data + offset + sizeof(BLOCK_HEADER);
+		for(uint32 i = 0; i < blockHeader.referenceCount; i++)
+		{
+			BLOCK_REFERENCE reference;
+			memcpy(&reference, references + (i * sizeof(BLOCK_REFERENCE)), sizeof(BLOCK_REFERENCE));
+			if((static_cast<size_t>(reference.offset) + sizeof(uintptr_t)) > blockHeader.codeSize)
+			{
+				valid = false;
+				break;
+			}
+		}
+		if(!valid) break;
+
+		m_blocks.insert(std::make_pair(blockHeader.key, data + offset));
+		offset += recordSize;
+	}
+
+	return offset;
+}
+
+void CBlockCache::MapFile(const boost::filesystem::path& path, size_t size)
+{
+	assert(m_mapping == nullptr);
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileW(path.native().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(fileHandle == INVALID_HANDLE_VALUE) return;
+	HANDLE mappingHandle = CreateFileMappingW(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(mappingHandle == NULL)
+	{
+		CloseHandle(fileHandle);
+		return;
+	}
+	void* mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, size);
+	if(mapping == NULL)
+	{
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return;
+	}
+	m_fileHandle = fileHandle;
+	m_mappingHandle = mappingHandle;
+#else
+	int fd = open(path.native().c_str(), O_RDONLY);
+	if(fd < 0) return;
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapping == MAP_FAILED) return;
+#endif
+	m_mapping = reinterpret_cast<const uint8*>(mapping);
+	m_mappingSize = size;
+}
+
+void CBlockCache::UnmapFile()
+{
+	if(m_mapping == nullptr) return;
+#ifdef _WIN32
+	UnmapViewOfFile(m_mapping);
+	CloseHandle(m_mappingHandle);
+	CloseHandle(m_fileHandle);
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+#else
+	munmap(const_cast<uint8*>(m_mapping), m_mappingSize);
+#endif
+	m_mapping = nullptr;
+	m_mappingSize = 0;
+}
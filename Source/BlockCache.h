@@ -0,0 +1,108 @@
+#pragma once
+
+#include <map>
+#include <list>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <boost/filesystem.hpp>
+#include "Types.h"
+#include "BasicBlock.h"
+
+namespace Framework
+{
+	class CStdStream;
+};
+
+//Persistent cache of compiled blocks, one file per processor and per game.
+//Blocks are stored with the list of host functions they reference, allowing
+//them to be relocated if the executable is loaded at a different address.
+//The file is memory mapped and blocks are only copied out when they are needed.
+class CBlockCache
+{
+public:
+	struct SYMBOL_REFERENCE
+	{
+		uint32		offset;
+		uintptr_t	value;
+	};
+	typedef std::vector<SYMBOL_REFERENCE> SymbolReferenceArray;
+
+								CBlockCache(const boost::filesystem::path&);
+	virtual						~CBlockCache();
+
+	//Returns true if compiled code can be persisted on this host
+	static bool					IsSupported();
+
+	//Checks that every reference reported by the code generator is a plain pointer at its offset
+	static bool					AreReferencesResolved(const void*, size_t, const SymbolReferenceArray&);
+
+	bool						LoadBlock(const AOT_BLOCK_KEY&, std::vector<uint8>&);
+	void						AddBlock(const AOT_BLOCK_KEY&, const void*, size_t, const SymbolReferenceArray&);
+
+	unsigned int				GetBlockCount();
+
+private:
+	enum
+	{
+		FILE_MAGIC		= 0x4B4C424A,	//'JBLK'
+		FILE_VERSION	= 2,
+	};
+
+	struct FILE_HEADER
+	{
+		uint32	magic;
+		uint32	version;
+		uint32	pointerSize;
+		uint32	buildSignature;
+	};
+	static_assert(sizeof(FILE_HEADER) == 0x10, "FILE_HEADER must be 16 bytes long.");
+
+	struct BLOCK_HEADER
+	{
+		AOT_BLOCK_KEY	key;
+		uint32			codeSize;
+		uint32			referenceCount;
+	};
+	static_assert(sizeof(BLOCK_HEADER) == 0x14, "BLOCK_HEADER must be 20 bytes long.");
+
+	struct BLOCK_REFERENCE
+	{
+		uint32	offset;
+		uint32	reserved;
+		int64	symbolOffset;		//Relative to the image anchor
+	};
+	static_assert(sizeof(BLOCK_REFERENCE) == 0x10, "BLOCK_REFERENCE must be 16 bytes long.");
+
+	typedef std::map<AOT_BLOCK_KEY, const uint8*> BlockMap;
+	typedef std::unique_ptr<Framework::CStdStream> StreamPtr;
+	typedef std::list<std::vector<uint8>> RecordList;
+
+	struct BUILD_SIGNATURE
+	{
+		bool	valid = false;
+		uint32	value = 0;
+	};
+
+	static uintptr_t			GetImageAnchor();
+	static bool					IsImageAddress(uintptr_t);
+	static bool					HasUnrelocatedAbsolutes(const uint8*, size_t, const SymbolReferenceArray&);
+	static const BUILD_SIGNATURE&	GetBuildSignature();
+	static BUILD_SIGNATURE		ComputeBuildSignature();
+
+	size_t						IndexRecords(const uint8*, size_t);
+	void						MapFile(const boost::filesystem::path&, size_t);
+	void						UnmapFile();
+
+	std::mutex					m_mutex;
+	BlockMap					m_blocks;
+	RecordList					m_addedRecords;
+	StreamPtr					m_outputStream;
+
+	const uint8*				m_mapping = nullptr;
+	size_t						m_mappingSize = 0;
+#ifdef _WIN32
+	void*						m_fileHandle = nullptr;
+	void*						m_mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,84 @@
+#include "BlockCompileQueue.h"
+
+CBlockCompileQueue::CBlockCompileQueue()
+{
+	m_worker = std::thread([this] () { WorkerThreadProc(); });
+}
+
+CBlockCompileQueue::~CBlockCompileQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+		m_jobs.clear();
+	}
+	m_jobCondition.notify_all();
+	m_worker.join();
+}
+
+void CBlockCompileQueue::QueueBlock(const BlockPtr& block)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(block);
+	}
+	m_jobCondition.notify_one();
+}
+
+void CBlockCompileQueue::EnsureCompiled(CBasicBlock* block)
+{
+	if(block->TryCompile()) return;
+
+	//Worker is compiling it
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [block] () { return block->IsCompiled(); });
+}
+
+void CBlockCompileQueue::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobs.clear();
+	m_doneCondition.wait(lock, [this] () { return !m_compiling; });
+}
+
+void CBlockCompileQueue::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [this] () { return !m_compiling; });
+}
+
+uint32 CBlockCompileQueue::GetCompiledCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_compiledCount;
+}
+
+void CBlockCompileQueue::WorkerThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(1)
+	{
+		m_jobCondition.wait(lock, [this] () { return m_stopping || !m_jobs.empty(); });
+		if(m_stopping) break;
+
+		auto block = std::move(m_jobs.front());
+		m_jobs.pop_front();
+
+		//Executor already removed the block, no need to compile it
+		if(block.use_count() == 1) continue;
+
+		m_compiling = true;
+		lock.unlock();
+
+		bool compiled = block->TryCompile();
+		block.reset();
+
+		lock.lock();
+		m_compiling = false;
+		if(compiled)
+		{
+			m_compiledCount++;
+		}
+		m_doneCondition.notify_all();
+	}
+}
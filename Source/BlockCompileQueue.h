@@ -0,0 +1,49 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "BasicBlock.h"
+
+//Compiles blocks on a worker thread before the CPU reaches them, taking compilation
+//latency off the emulation thread. The worker has its own jitter, but blocks of
+//a same context are still compiled one at a time (see CMIPS::m_compileMutex).
+class CBlockCompileQueue
+{
+public:
+	typedef std::shared_ptr<CBasicBlock> BlockPtr;
+
+						CBlockCompileQueue();
+	virtual				~CBlockCompileQueue();
+
+						CBlockCompileQueue(const CBlockCompileQueue&) = delete;
+	CBlockCompileQueue&	operator =(const CBlockCompileQueue&) = delete;
+
+	void				QueueBlock(const BlockPtr&);
+
+	//Returns once the block is compiled, compiles it on the calling thread if the worker didn't start on it
+	void				EnsureCompiled(CBasicBlock*);
+
+	//Drops queued blocks and waits for the worker to be done with the block it's compiling
+	void				Flush();
+
+	//Waits for the worker to be done with the block it's compiling, queued blocks are kept
+	void				WaitIdle();
+
+	//Amount of blocks compiled by the worker
+	uint32				GetCompiledCount() const;
+
+private:
+	void				WorkerThreadProc();
+
+	mutable std::mutex		m_mutex;
+	std::condition_variable	m_jobCondition;
+	std::condition_variable	m_doneCondition;
+	std::deque<BlockPtr>	m_jobs;
+	bool					m_compiling = false;
+	bool					m_stopping = false;
+	uint32					m_compiledCount = 0;
+	std::thread				m_worker;
+};
@@ -0,0 +1,307 @@
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include "CodeArena.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <libkern/OSCacheControl.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+CCodeArena::CCodeArena()
+{
+
+}
+
+CCodeArena::~CCodeArena()
+{
+	//Blocks hold pointers to the code, they must be gone before the arena
+	assert(m_usedSize == 0);
+	for(const auto& largeAllocationPair : m_largeAllocations)
+	{
+		UnmapMemory(largeAllocationPair.second);
+	}
+	for(const auto& chunk : m_chunks)
+	{
+		UnmapMemory(chunk);
+	}
+}
+
+CCodeArena::ALLOCATION CCodeArena::Allocate(uint32 guestAddress, const void* code, size_t size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	size_t alignedSize = (size + CODE_ALIGNMENT - 1) & ~static_cast<size_t>(CODE_ALIGNMENT - 1);
+	ALLOCATION allocation;
+	allocation.size = size;
+
+	if(alignedSize > SPAN_SIZE)
+	{
+		//Too big to fit in a span, gets a mapping of its own
+		auto mapping = MapMemory((alignedSize + SPAN_SIZE - 1) & ~static_cast<size_t>(SPAN_SIZE - 1));
+		WriteCode(mapping.writeView, mapping.executeView, code, size);
+		m_largeAllocations.insert(std::make_pair(mapping.executeView, mapping));
+		m_mappedSize += mapping.size;
+		m_usedSize += size;
+		allocation.code = mapping.executeView;
+		allocation.spanIndex = LARGE_ALLOCATION;
+		return allocation;
+	}
+
+	uint32 guestPage = guestAddress >> GUEST_PAGE_SHIFT;
+	uint32 spanIndex = INVALID_SPAN;
+	auto pageIterator = m_pageSpans.find(guestPage);
+	if(pageIterator != std::end(m_pageSpans))
+	{
+		spanIndex = pageIterator->second;
+		if((m_spans[spanIndex].used + alignedSize) > SPAN_SIZE)
+		{
+			//Span is full, it stays alive until the blocks in it are freed
+			m_pageSpans.erase(pageIterator);
+			spanIndex = INVALID_SPAN;
+		}
+	}
+	if(spanIndex == INVALID_SPAN)
+	{
+		spanIndex = AcquireSpan(guestPage);
+		m_pageSpans[guestPage] = spanIndex;
+	}
+
+	auto& span = m_spans[spanIndex];
+	size_t offset = span.used;
+	WriteCode(span.writeBase + offset, span.executeBase + offset, code, size);
+	span.used += alignedSize;
+	span.liveCount++;
+	m_usedSize += size;
+
+	allocation.code = span.executeBase + offset;
+	allocation.spanIndex = spanIndex;
+	return allocation;
+}
+
+void CCodeArena::Free(ALLOCATION& allocation)
+{
+	if(allocation.code == nullptr) return;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_usedSize -= allocation.size;
+	if(allocation.spanIndex == LARGE_ALLOCATION)
+	{
+		auto largeAllocationIterator = m_largeAllocations.find(allocation.code);
+		assert(largeAllocationIterator != std::end(m_largeAllocations));
+		m_mappedSize -= largeAllocationIterator->second.size;
+		UnmapMemory(largeAllocationIterator->second);
+		m_largeAllocations.erase(largeAllocationIterator);
+	}
+	else
+	{
+		assert(allocation.spanIndex < m_spans.size());
+		auto& span = m_spans[allocation.spanIndex];
+		assert(span.liveCount != 0);
+		span.liveCount--;
+		if(span.liveCount == 0)
+		{
+			ReleaseSpan(allocation.spanIndex);
+		}
+	}
+	allocation = ALLOCATION();
+}
+
+size_t CCodeArena::GetMappedSize() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_mappedSize;
+}
+
+size_t CCodeArena::GetUsedSize() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_usedSize;
+}
+
+uint32 CCodeArena::AcquireSpan(uint32 guestPage)
+{
+	if(m_freeSpans.empty())
+	{
+		auto chunk = MapMemory(CHUNK_SIZE);
+		m_chunks.push_back(chunk);
+		m_mappedSize += chunk.size;
+		//Free spans are taken from the back, push them in reverse to hand them out in address order
+		uint32 firstSpanIndex = static_cast<uint32>(m_spans.size());
+		for(size_t offset = 0; offset < chunk.size; offset += SPAN_SIZE)
+		{
+			SPAN span;
+			span.writeBase = chunk.writeView + offset;
+			span.executeBase = chunk.executeView + offset;
+			m_spans.push_back(span);
+		}
+		for(uint32 spanIndex = static_cast<uint32>(m_spans.size()); spanIndex > firstSpanIndex; spanIndex--)
+		{
+			m_freeSpans.push_back(spanIndex - 1);
+		}
+	}
+
+	uint32 spanIndex = m_freeSpans.back();
+	m_freeSpans.pop_back();
+	auto& span = m_spans[spanIndex];
+	assert(span.used == 0);
+	assert(span.liveCount == 0);
+	span.guestPage = guestPage;
+	return spanIndex;
+}
+
+void CCodeArena::ReleaseSpan(uint32 spanIndex)
+{
+	auto& span = m_spans[spanIndex];
+	auto pageIterator = m_pageSpans.find(span.guestPage);
+	if((pageIterator != std::end(m_pageSpans)) && (pageIterator->second == spanIndex))
+	{
+		m_pageSpans.erase(pageIterator);
+	}
+	span.used = 0;
+	m_freeSpans.push_back(spanIndex);
+}
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+
+int CCodeArena::CreateSharedMemory(size_t size)
+{
+	//Returns a descriptor to anonymous memory that can be mapped more than once, -1 if not supported
+#if defined(__linux__) && defined(SYS_memfd_create)
+	static const unsigned int memfdCloseOnExec = 1;
+	int fd = static_cast<int>(syscall(SYS_memfd_create, "CodeArena", memfdCloseOnExec));
+	if(fd == -1)
+	{
+		return -1;
+	}
+	if(ftruncate(fd, static_cast<off_t>(size)) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+#else
+	return -1;
+#endif
+}
+
+#endif
+
+CCodeArena::MAPPING CCodeArena::MapMemory(size_t size)
+{
+	MAPPING mapping;
+	mapping.size = size;
+#if defined(_WIN32)
+	//Writable and executable views of the same section, no page is ever both at once
+	uint64 sectionSize = size;
+	HANDLE section = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_EXECUTE_READWRITE,
+		static_cast<DWORD>(sectionSize >> 32), static_cast<DWORD>(sectionSize), nullptr);
+	if(section == nullptr)
+	{
+		throw std::runtime_error("Can't map executable memory: CreateFileMapping failed.");
+	}
+	void* writeView = MapViewOfFile(section, FILE_MAP_WRITE, 0, 0, size);
+	void* executeView = (writeView != nullptr) ? MapViewOfFile(section, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, size) : nullptr;
+	//Views keep the section alive
+	CloseHandle(section);
+	if(executeView == nullptr)
+	{
+		if(writeView != nullptr) UnmapViewOfFile(writeView);
+		throw std::runtime_error("Can't map executable memory: MapViewOfFile failed.");
+	}
+	mapping.writeView = reinterpret_cast<uint8*>(writeView);
+	mapping.executeView = reinterpret_cast<uint8*>(executeView);
+#elif defined(__APPLE__)
+	//Memory can't be writable and executable at once, map the same pages a second time to execute them
+	vm_address_t writeAddress = 0;
+	if(vm_allocate(mach_task_self(), &writeAddress, size, VM_FLAGS_ANYWHERE) != KERN_SUCCESS)
+	{
+		throw std::runtime_error("Can't map executable memory: vm_allocate failed.");
+	}
+	vm_address_t executeAddress = 0;
+	vm_prot_t currentProtection = VM_PROT_NONE;
+	vm_prot_t maxProtection = VM_PROT_NONE;
+	kern_return_t result = vm_remap(mach_task_self(), &executeAddress, size, 0, VM_FLAGS_ANYWHERE,
+		mach_task_self(), writeAddress, FALSE, &currentProtection, &maxProtection, VM_INHERIT_NONE);
+	if(result != KERN_SUCCESS)
+	{
+		vm_deallocate(mach_task_self(), writeAddress, size);
+		throw std::runtime_error("Can't map executable memory: vm_remap failed.");
+	}
+	result = vm_protect(mach_task_self(), executeAddress, size, FALSE, VM_PROT_READ | VM_PROT_EXECUTE);
+	if(result != KERN_SUCCESS)
+	{
+		vm_deallocate(mach_task_self(), executeAddress, size);
+		vm_deallocate(mach_task_self(), writeAddress, size);
+		throw std::runtime_error("Can't map executable memory: vm_protect failed.");
+	}
+	mapping.writeView = reinterpret_cast<uint8*>(writeAddress);
+	mapping.executeView = reinterpret_cast<uint8*>(executeAddress);
+#else
+	int fd = CreateSharedMemory(size);
+	if(fd != -1)
+	{
+		//Writable and executable mappings of the same memory, no page is ever both at once
+		void* writeView = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		void* executeView = (writeView != MAP_FAILED) ? mmap(nullptr, size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0) : MAP_FAILED;
+		//Mappings keep the memory alive
+		close(fd);
+		if(executeView == MAP_FAILED)
+		{
+			if(writeView != MAP_FAILED) munmap(writeView, size);
+			throw std::runtime_error("Can't map executable memory: mmap failed.");
+		}
+		mapping.writeView = reinterpret_cast<uint8*>(writeView);
+		mapping.executeView = reinterpret_cast<uint8*>(executeView);
+	}
+	else
+	{
+		//No anonymous shared memory available (ie.: kernel older than 3.17), memory has to be writable and executable
+		void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(memory == MAP_FAILED)
+		{
+			throw std::runtime_error("Can't map executable memory: mmap failed.");
+		}
+		mapping.writeView = reinterpret_cast<uint8*>(memory);
+		mapping.executeView = mapping.writeView;
+	}
+#endif
+	return mapping;
+}
+
+void CCodeArena::UnmapMemory(const MAPPING& mapping)
+{
+#if defined(_WIN32)
+	UnmapViewOfFile(mapping.executeView);
+	UnmapViewOfFile(mapping.writeView);
+#elif defined(__APPLE__)
+	vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(mapping.executeView), mapping.size);
+	vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(mapping.writeView), mapping.size);
+#else
+	if(mapping.executeView != mapping.writeView)
+	{
+		munmap(mapping.executeView, mapping.size);
+	}
+	munmap(mapping.writeView, mapping.size);
+#endif
+}
+
+void CCodeArena::WriteCode(uint8* writeView, uint8* executeView, const void* code, size_t size)
+{
+	memcpy(writeView, code, size);
+#if defined(_WIN32)
+	FlushInstructionCache(GetCurrentProcess(), executeView, size);
+#elif defined(__APPLE__)
+	sys_icache_invalidate(executeView, size);
+#else
+	__builtin___clear_cache(reinterpret_cast<char*>(executeView), reinterpret_cast<char*>(executeView + size));
+#endif
+}
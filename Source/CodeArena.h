@@ -0,0 +1,90 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include "Types.h"
+
+//Executable memory shared by the blocks of an executor. Code is bump allocated in spans
+//owned by a guest memory page, laying out blocks of a same page next to each other in host
+//memory. A span goes back to the free list as soon as the last block in it is freed, which
+//happens in bulk when a range of guest memory is invalidated.
+//Memory is mapped twice, once to write and once to execute, so that no page is ever writable and
+//executable at once. Only platforms without anonymous shared memory fall back to a single mapping.
+class CCodeArena
+{
+public:
+	struct ALLOCATION
+	{
+		void*		code = nullptr;
+		size_t		size = 0;
+		uint32		spanIndex = ~0U;
+	};
+
+							CCodeArena();
+	virtual					~CCodeArena();
+
+							CCodeArena(const CCodeArena&) = delete;
+	CCodeArena&				operator =(const CCodeArena&) = delete;
+
+	//Copies the code of a block starting at the guest address, throws if memory can't be mapped
+	ALLOCATION				Allocate(uint32, const void*, size_t);
+	void					Free(ALLOCATION&);
+
+	//Amount of executable memory mapped and how much of it holds code of live blocks
+	size_t					GetMappedSize() const;
+	size_t					GetUsedSize() const;
+
+private:
+	enum
+	{
+		GUEST_PAGE_SHIFT	= 12,
+		CHUNK_SIZE			= 0x100000,
+		SPAN_SIZE			= 0x4000,
+		CODE_ALIGNMENT		= 0x10,
+	};
+
+	enum : uint32
+	{
+		INVALID_SPAN		= ~0U,
+		LARGE_ALLOCATION	= ~1U,
+	};
+
+	struct MAPPING
+	{
+		uint8*		writeView = nullptr;
+		uint8*		executeView = nullptr;
+		size_t		size = 0;
+	};
+
+	struct SPAN
+	{
+		uint8*		writeBase = nullptr;
+		uint8*		executeBase = nullptr;
+		size_t		used = 0;
+		uint32		liveCount = 0;
+		uint32		guestPage = 0;
+	};
+
+	typedef std::unordered_map<uint32, uint32> PageSpanMap;
+	typedef std::unordered_map<void*, MAPPING> LargeAllocationMap;
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+	static int				CreateSharedMemory(size_t);
+#endif
+	static MAPPING			MapMemory(size_t);
+	static void				UnmapMemory(const MAPPING&);
+	static void				WriteCode(uint8*, uint8*, const void*, size_t);
+
+	uint32					AcquireSpan(uint32);
+	void					ReleaseSpan(uint32);
+
+	mutable std::mutex		m_mutex;
+	std::vector<MAPPING>	m_chunks;
+	std::vector<SPAN>		m_spans;
+	std::vector<uint32>		m_freeSpans;
+	PageSpanMap				m_pageSpans;
+	LargeAllocationMap		m_largeAllocations;
+	size_t					m_mappedSize = 0;
+	size_t					m_usedSize = 0;
+};
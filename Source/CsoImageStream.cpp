@@ -8,8 +8,6 @@
 typedef uint32 uint32_le;
 typedef uint64 uint64_le;
 
-static const uint32 CSO_READ_BUFFER_SIZE = 256 * 1024;
-
 struct CsoHeader
 {
 	uint8 magic[4];
@@ -22,7 +20,7 @@ struct CsoHeader
 };
 
 CCsoImageStream::CCsoImageStream(CStream* baseStream)
-	: m_baseStream(baseStream), m_readBuffer(nullptr), m_zlibBuffer(nullptr), m_index(nullptr), m_position(0)
+	: m_baseStream(baseStream), m_index(nullptr), m_position(0)
 {
 	if(baseStream == nullptr)
 	{
@@ -31,12 +29,16 @@ CCsoImageStream::CCsoImageStream(CStream* baseStream)
 
 	ReadFileHeader();
 	InitializeBuffers();
+
+	// Decompressed frames are kept in the shared cache, which might also decompress them ahead of time.
+	m_cacheSourceId = CImageBlockCache::GetInstance().RegisterSource(
+		[this] (uint32 frame, CImageBlockCache::Block& output) { DecompressFrame(frame, output); },
+		m_numFrames, m_frameSize);
 }
 
 CCsoImageStream::~CCsoImageStream()
 {
-	delete [] m_readBuffer;
-	delete [] m_zlibBuffer;
+	CImageBlockCache::GetInstance().UnregisterSource(m_cacheSourceId);
 	delete [] m_index;
 }
 
@@ -82,21 +84,9 @@ void CCsoImageStream::ReadFileHeader()
 
 void CCsoImageStream::InitializeBuffers()
 {
-	uint32 numFrames = static_cast<uint32>((m_totalSize + m_frameSize - 1) / m_frameSize);
+	m_numFrames = static_cast<uint32>((m_totalSize + m_frameSize - 1) / m_frameSize);
 
-	// We might read a bit of alignment too, so be prepared.
-	if(m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
-	{
-		m_readBuffer = new uint8[CSO_READ_BUFFER_SIZE];
-	}
-	else
-	{
-		m_readBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
-	}
-	m_zlibBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
-	m_zlibBufferFrame = numFrames;
-
-	const uint32 indexSize = numFrames + 1;
+	const uint32 indexSize = m_numFrames + 1;
 	m_index = new uint32[indexSize];
 	if(m_baseStream->Read(m_index, sizeof(uint32) * indexSize) != sizeof(uint32) * indexSize)
 	{
@@ -169,11 +159,9 @@ uint32 CCsoImageStream::ReadFromNextFrame(uint8* dest, uint64 maxBytes)
 	// Grab the index data for the frame we're about to read.
 	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
 	const uint32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
-	const uint32 index1 = m_index[frame + 1] & 0x7FFFFFFF;
 
-	// Calculate where the compressed payload is (if compressed.)
+	// Calculate where the payload is (if not compressed.)
 	const uint64 frameRawPos = static_cast<uint64>(index0) << m_indexShift;
-	const uint64 frameRawSize = (index1 - index0) << m_indexShift;
 
 	if(!compressed)
 	{
@@ -185,24 +173,35 @@ uint32 CCsoImageStream::ReadFromNextFrame(uint8* dest, uint64 maxBytes)
 	}
 	else
 	{
-		// We don't need to decompress if we already did this same frame last time.
-		if(m_zlibBufferFrame != frame)
-		{
-			// This might be less bytes than frameRawSize in case of padding on the last frame.
-			// This is because the index positions must be aligned.
-			const uint64 readRawBytes = ReadBaseAt(frameRawPos, m_readBuffer, frameRawSize);
-			DecompressFrame(frame, readRawBytes);
-		}
-
-		// Now we just copy the offset data from the cache.
-		memcpy(dest, m_zlibBuffer + offset, bytes);
+		// Frames are only decompressed if they're not in the cache already.
+		auto frameData = CImageBlockCache::GetInstance().GetBlock(m_cacheSourceId, frame);
+		memcpy(dest, frameData->data() + offset, bytes);
 	}
 
 	return bytes;
 }
 
-void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
+void CCsoImageStream::DecompressFrame(uint32 frame, CImageBlockCache::Block& output)
 {
+	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
+	const uint32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
+	const uint32 index1 = m_index[frame + 1] & 0x7FFFFFFF;
+	const uint64 frameRawPos = static_cast<uint64>(index0) << m_indexShift;
+	const uint64 frameRawSize = (index1 - index0) << m_indexShift;
+
+	// Might be called from a worker thread, so we need our own buffer.
+	std::vector<uint8> readBuffer(static_cast<size_t>(frameRawSize));
+	// This might be less bytes than frameRawSize in case of padding on the last frame.
+	// This is because the index positions must be aligned.
+	const uint64 readBufferSize = ReadBaseAt(frameRawPos, readBuffer.data(), frameRawSize);
+
+	output.resize(m_frameSize);
+	if(!compressed)
+	{
+		memcpy(output.data(), readBuffer.data(), static_cast<size_t>(std::min<uint64>(readBufferSize, m_frameSize)));
+		return;
+	}
+
 	z_stream z;
 	z.zalloc = Z_NULL;
 	z.zfree = Z_NULL;
@@ -212,9 +211,9 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to initialize zlib for CSO decompression.");
 	}
 
-	z.next_in = m_readBuffer;
+	z.next_in = readBuffer.data();
 	z.avail_in = static_cast<uint32>(readBufferSize);
-	z.next_out = m_zlibBuffer;
+	z.next_out = output.data();
 	z.avail_out = m_frameSize;
 
 	int status = inflate(&z, Z_FINISH);
@@ -224,13 +223,12 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to decompress CSO frame using zlib.");
 	}
 	inflateEnd(&z);
-
-	// Our buffer now contains this frame.
-	m_zlibBufferFrame = frame;
 }
 
 uint64 CCsoImageStream::ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes)
 {
+	// Base stream is shared with the cache's worker threads.
+	std::lock_guard<std::mutex> baseStreamLock(m_baseStreamMutex);
 	m_baseStream->Seek(pos, Framework::STREAM_SEEK_SET);
 	return m_baseStream->Read(dest, bytes);
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <mutex>
 #include "Types.h"
 #include "Stream.h"
+#include "ImageBlockCache.h"
 
 class CCsoImageStream : public Framework::CStream
 {
@@ -21,16 +23,16 @@ private:
 	uint64				GetTotalSize() const;
 	uint32				ReadFromNextFrame(uint8* dest, uint64 maxBytes);
 	uint64				ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes);
-	void				DecompressFrame(uint32 frame, uint64 readBufferSize);
+	void				DecompressFrame(uint32 frame, CImageBlockCache::Block& output);
 
 	Framework::CStream*	m_baseStream;
+	std::mutex			m_baseStreamMutex;
 	uint32				m_frameSize;
 	uint8				m_frameShift;
 	uint8				m_indexShift;
-	uint8*				m_readBuffer;
-	uint8*				m_zlibBuffer;
-	uint32				m_zlibBufferFrame;
 	uint32*				m_index;
+	uint32				m_numFrames;
+	CImageBlockCache::SourceId	m_cacheSourceId;
 	uint64				m_totalSize;
 	uint64				m_position;
 };
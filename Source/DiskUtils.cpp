@@ -5,6 +5,7 @@
 #include "DiskUtils.h"
 #include "IszImageStream.h"
 #include "CsoImageStream.h"
+#include "MappedFile.h"
 #include "StdStream.h"
 #ifdef WIN32
 #include "VolumeStream.h"
@@ -24,12 +25,51 @@ static Framework::CStream* CreateImageStream(const boost::filesystem::path& imag
 #endif
 }
 
+static DiskUtils::Iso9660Ptr CreateMappedDiskImage(const boost::filesystem::path& imagePath)
+{
+	DiskUtils::Iso9660Ptr result;
+	std::shared_ptr<CMappedFile> file;
+	try
+	{
+		file = std::make_shared<CMappedFile>(imagePath);
+	}
+	catch(...)
+	{
+		//Not mappable, will be read through a stream instead
+		return result;
+	}
+
+	try
+	{
+		auto blockProvider = std::make_shared<ISO9660::CBlockProviderMapped2048>(file);
+		result = std::make_unique<CISO9660>(blockProvider);
+	}
+	catch(...)
+	{
+		//Failed with block size 2048, try with CD-ROM XA
+		auto blockProvider = std::make_shared<ISO9660::CBlockProviderMappedCDROMXA>(file);
+		result = std::make_unique<CISO9660>(blockProvider);
+	}
+	return result;
+}
+
 DiskUtils::Iso9660Ptr DiskUtils::CreateDiskImageFromPath(const boost::filesystem::path& imagePath)
 {
 	assert(!imagePath.empty());
 
 	std::shared_ptr<Framework::CStream> stream;
 	auto extension = imagePath.extension().string();
+	bool compressed = !stricmp(extension.c_str(), ".isz") || !stricmp(extension.c_str(), ".cso");
+
+	//Uncompressed images are mapped in memory, sectors can then be copied without going through system calls
+	boost::system::error_code errorCode;
+	if(!compressed && boost::filesystem::is_regular_file(imagePath, errorCode))
+	{
+		if(auto result = CreateMappedDiskImage(imagePath))
+		{
+			return result;
+		}
+	}
 
 	//Gotta think of something better than that...
 	if(!stricmp(extension.c_str(), ".isz"))
@@ -0,0 +1,94 @@
+#include <cassert>
+#include <algorithm>
+#include "EventScheduler.h"
+
+CEventScheduler::CEventScheduler()
+{
+
+}
+
+CEventScheduler::~CEventScheduler()
+{
+
+}
+
+CEventScheduler::EventHandle CEventScheduler::RegisterEvent(const char* name, const EventHandler& handler)
+{
+	EVENT event;
+	event.name = name;
+	event.handler = handler;
+	m_events.push_back(event);
+	return static_cast<EventHandle>(m_events.size() - 1);
+}
+
+void CEventScheduler::ScheduleEvent(EventHandle handle, uint64 delay)
+{
+	assert(handle < m_events.size());
+	CancelEvent(handle);
+
+	//Pending events are kept sorted by time, events scheduled at the same time run in scheduling order.
+	//There are only a handful of events, a sorted array is cheaper than a heap here.
+	PENDING_EVENT pendingEvent;
+	pendingEvent.time = m_currentTime + delay;
+	pendingEvent.handle = handle;
+	auto insertIterator = std::upper_bound(m_pendingEvents.begin(), m_pendingEvents.end(), pendingEvent,
+		[] (const PENDING_EVENT& lhs, const PENDING_EVENT& rhs) { return lhs.time < rhs.time; });
+	m_pendingEvents.insert(insertIterator, pendingEvent);
+	m_events[handle].scheduled = true;
+}
+
+void CEventScheduler::CancelEvent(EventHandle handle)
+{
+	assert(handle < m_events.size());
+	auto& event = m_events[handle];
+	if(!event.scheduled) return;
+	auto eventIterator = std::find_if(m_pendingEvents.begin(), m_pendingEvents.end(),
+		[handle] (const PENDING_EVENT& pendingEvent) { return pendingEvent.handle == handle; });
+	assert(eventIterator != m_pendingEvents.end());
+	m_pendingEvents.erase(eventIterator);
+	event.scheduled = false;
+}
+
+bool CEventScheduler::IsEventScheduled(EventHandle handle) const
+{
+	assert(handle < m_events.size());
+	return m_events[handle].scheduled;
+}
+
+uint64 CEventScheduler::GetCurrentTime() const
+{
+	return m_currentTime;
+}
+
+uint32 CEventScheduler::GetTicksUntilNextEvent(uint32 maxTicks) const
+{
+	assert(maxTicks != 0);
+	if(m_pendingEvents.empty()) return maxTicks;
+	uint64 nextTime = m_pendingEvents.front().time;
+	if(nextTime <= m_currentTime) return 1;
+	return static_cast<uint32>(std::min<uint64>(nextTime - m_currentTime, maxTicks));
+}
+
+void CEventScheduler::Advance(uint32 ticks)
+{
+	m_currentTime += ticks;
+	//Handlers can schedule other events, including ones that are already due
+	while(!m_pendingEvents.empty() && (m_pendingEvents.front().time <= m_currentTime))
+	{
+		auto handle = m_pendingEvents.front().handle;
+		m_pendingEvents.erase(m_pendingEvents.begin());
+		auto& event = m_events[handle];
+		event.scheduled = false;
+		event.handler();
+	}
+}
+
+void CEventScheduler::Reset()
+{
+	for(auto& event : m_events)
+	{
+		event.scheduled = false;
+	}
+	m_pendingEvents.clear();
+	m_currentTime = 0;
+}
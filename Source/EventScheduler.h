@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "Types.h"
+
+//Keeps a timestamp ordered queue of pending events, allowing the emulation loop
+//to run processors until something is actually due instead of polling devices.
+//Time is expressed in ticks of the fastest clock (EE cycles).
+class CEventScheduler
+{
+public:
+	typedef uint32 EventHandle;
+	typedef std::function<void ()> EventHandler;
+
+						CEventScheduler();
+	virtual				~CEventScheduler();
+
+	EventHandle			RegisterEvent(const char*, const EventHandler&);
+
+	//Schedules an event 'delay' ticks from now, replacing any previous occurrence of that event
+	void				ScheduleEvent(EventHandle, uint64 delay);
+	void				CancelEvent(EventHandle);
+	bool				IsEventScheduled(EventHandle) const;
+
+	uint64				GetCurrentTime() const;
+
+	//Returns the amount of ticks that can be executed before the next event, at least 1 and at most 'maxTicks'
+	uint32				GetTicksUntilNextEvent(uint32 maxTicks) const;
+
+	//Moves time forward and runs handlers of every event that became due, in timestamp order
+	void				Advance(uint32);
+
+	//Cancels all pending events and brings time back to 0, registered events are kept
+	void				Reset();
+
+private:
+	struct EVENT
+	{
+		std::string		name;
+		EventHandler	handler;
+		bool			scheduled = false;
+	};
+
+	struct PENDING_EVENT
+	{
+		uint64			time;
+		EventHandle		handle;
+	};
+
+	typedef std::vector<EVENT> EventArray;
+	typedef std::vector<PENDING_EVENT> PendingEventArray;
+
+	EventArray			m_events;
+	PendingEventArray	m_pendingEvents;
+	uint64				m_currentTime = 0;
+};
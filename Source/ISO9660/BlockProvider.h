@@ -1,8 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <cstring>
+#include <algorithm>
 #include "Types.h"
 #include "Stream.h"
+#include "../MappedFile.h"
 
 namespace ISO9660
 {
@@ -16,6 +19,21 @@ namespace ISO9660
 
 		virtual				~CBlockProvider() {};
 		virtual void		ReadBlock(uint32, void*) = 0;
+
+		virtual void ReadBlocks(uint32 address, uint32 count, void* blocks)
+		{
+			//The buffer is needed to make sure exception handlers
+			//are properly called as some system calls (ie.: ReadFile)
+			//won't generate an exception when trying to write to
+			//a write protected area
+			uint8 block[BLOCKSIZE];
+			auto output = reinterpret_cast<uint8*>(blocks);
+			for(uint32 i = 0; i < count; i++)
+			{
+				ReadBlock(address + i, block);
+				memcpy(output + (i * BLOCKSIZE), block, BLOCKSIZE);
+			}
+		}
 	};
 
 	class CBlockProvider2048 : public CBlockProvider
@@ -75,4 +93,66 @@ namespace ISO9660
 
 		StreamPtr m_stream;
 	};
+
+	//Reads sectors straight from a memory mapped image, avoiding a system call per sector
+	template <uint32 INTERNAL_BLOCKSIZE, uint32 BLOCKHEADER_SIZE>
+	class CBlockProviderMapped : public CBlockProvider
+	{
+	public:
+		typedef std::shared_ptr<CMappedFile> MappedFilePtr;
+
+		CBlockProviderMapped(const MappedFilePtr& file)
+			: m_file(file)
+			, m_blockCount(static_cast<uint32>(file->GetSize() / INTERNAL_BLOCKSIZE))
+		{
+
+		}
+
+		virtual ~CBlockProviderMapped()
+		{
+
+		}
+
+		//Returns nullptr if the block is outside of the image
+		const uint8* GetBlockPointer(uint32 address) const
+		{
+			if(address >= m_blockCount) return nullptr;
+			return m_file->GetData() + (static_cast<uint64>(address) * INTERNAL_BLOCKSIZE) + BLOCKHEADER_SIZE;
+		}
+
+		void ReadBlock(uint32 address, void* block) override
+		{
+			ReadBlocks(address, 1, block);
+		}
+
+		void ReadBlocks(uint32 address, uint32 count, void* blocks) override
+		{
+			auto output = reinterpret_cast<uint8*>(blocks);
+			uint32 availableCount = (address < m_blockCount) ? std::min<uint32>(count, m_blockCount - address) : 0;
+			const uint8* input = GetBlockPointer(address);
+			if(INTERNAL_BLOCKSIZE == BLOCKSIZE)
+			{
+				if(availableCount != 0)
+				{
+					memcpy(output, input, availableCount * BLOCKSIZE);
+				}
+			}
+			else
+			{
+				for(uint32 i = 0; i < availableCount; i++)
+				{
+					memcpy(output + (i * BLOCKSIZE), input + (i * INTERNAL_BLOCKSIZE), BLOCKSIZE);
+				}
+			}
+			//Blocks past the end of the image are cleared
+			memset(output + (availableCount * BLOCKSIZE), 0, (count - availableCount) * BLOCKSIZE);
+		}
+
+	private:
+		MappedFilePtr	m_file;
+		uint32			m_blockCount = 0;
+	};
+
+	typedef CBlockProviderMapped<0x800, 0> CBlockProviderMapped2048;
+	typedef CBlockProviderMapped<0x930, 0x18> CBlockProviderMappedCDROMXA;
 }
@@ -23,12 +23,12 @@ CISO9660::~CISO9660()
 
 void CISO9660::ReadBlock(uint32 address, void* data)
 {
-	//The buffer is needed to make sure exception handlers
-	//are properly called as some system calls (ie.: ReadFile)
-	//won't generate an exception when trying to write to
-	//a write protected area
-	m_blockProvider->ReadBlock(address, m_blockBuffer);
-	memcpy(data, m_blockBuffer, CBlockProvider::BLOCKSIZE);
+	m_blockProvider->ReadBlocks(address, 1, data);
+}
+
+void CISO9660::ReadBlocks(uint32 address, uint32 count, void* data)
+{
+	m_blockProvider->ReadBlocks(address, count, data);
 }
 
 bool CISO9660::GetFileRecord(CDirectoryRecord* record, const char* filename)
@@ -15,6 +15,7 @@ public:
 								~CISO9660();
 
 	void						ReadBlock(uint32, void*);
+	void						ReadBlocks(uint32, uint32, void*);
 
 	Framework::CStream*			Open(const char*);
 	bool						GetFileRecord(ISO9660::CDirectoryRecord*, const char*);
@@ -25,6 +26,4 @@ private:
 	BlockProviderPtr			m_blockProvider;
 	ISO9660::CVolumeDescriptor	m_volumeDescriptor;
 	ISO9660::CPathTable			m_pathTable;
-
-	uint8						m_blockBuffer[ISO9660::CBlockProvider::BLOCKSIZE];
 };
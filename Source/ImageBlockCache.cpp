@@ -0,0 +1,248 @@
+#include <cassert>
+#include <algorithm>
+#include "ImageBlockCache.h"
+
+CImageBlockCache::CImageBlockCache()
+{
+	for(unsigned int i = 0; i < WORKER_COUNT; i++)
+	{
+		m_workers.emplace_back([this] () { WorkerThreadProc(); });
+	}
+}
+
+CImageBlockCache::~CImageBlockCache()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_jobCondition.notify_all();
+	for(auto& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+CImageBlockCache::SourceId CImageBlockCache::RegisterSource(const DecodeFunction& decodeFunction, uint32 blockCount, uint32 blockSize)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	SourceId sourceId = m_nextSourceId++;
+	SOURCE source;
+	source.decodeFunction = decodeFunction;
+	source.blockCount = blockCount;
+	source.blockSize = blockSize;
+	m_sources.insert(std::make_pair(sourceId, source));
+	return sourceId;
+}
+
+void CImageBlockCache::UnregisterSource(SourceId sourceId)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto sourceIterator = m_sources.find(sourceId);
+	assert(sourceIterator != std::end(m_sources));
+	if(sourceIterator == std::end(m_sources)) return;
+	auto& source = sourceIterator->second;
+
+	//Jobs that haven't started yet can be dropped, wait for the others
+	auto jobIterator = std::remove_if(m_jobs.begin(), m_jobs.end(),
+		[sourceId] (BlockKey key) { return static_cast<SourceId>(key >> 32) == sourceId; });
+	source.pendingJobs -= static_cast<uint32>(std::distance(jobIterator, m_jobs.end()));
+	m_jobs.erase(jobIterator, m_jobs.end());
+	m_doneCondition.wait(lock, [&source] () { return source.pendingJobs == 0; });
+
+	for(auto lruIterator = m_lru.begin(); lruIterator != m_lru.end();)
+	{
+		BlockKey key = *lruIterator;
+		if(static_cast<SourceId>(key >> 32) != sourceId)
+		{
+			lruIterator++;
+			continue;
+		}
+		auto entryIterator = m_entries.find(key);
+		assert(entryIterator != std::end(m_entries));
+		m_memoryUsage -= entryIterator->second.block->size();
+		m_entries.erase(entryIterator);
+		lruIterator = m_lru.erase(lruIterator);
+	}
+
+	m_sources.erase(sourceIterator);
+}
+
+CImageBlockCache::BlockPtr CImageBlockCache::GetBlock(SourceId sourceId, uint32 blockNumber)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto sourceIterator = m_sources.find(sourceId);
+	assert(sourceIterator != std::end(m_sources));
+	auto& source = sourceIterator->second;
+	assert(blockNumber < source.blockCount);
+
+	//Reads usually span several sectors of the same block, only count block changes
+	if(blockNumber != source.lastBlock)
+	{
+		if(blockNumber == (source.lastBlock + 1))
+		{
+			source.sequentialCount++;
+		}
+		else
+		{
+			source.sequentialCount = 0;
+			source.readAheadBlock = blockNumber + 1;
+		}
+		source.lastBlock = blockNumber;
+		if(source.sequentialCount >= SEQUENTIAL_THRESHOLD)
+		{
+			ScheduleReadAhead(sourceId, source, blockNumber);
+		}
+	}
+
+	BlockKey key = MakeKey(sourceId, blockNumber);
+	while(1)
+	{
+		auto entryIterator = m_entries.find(key);
+		if(entryIterator != std::end(m_entries))
+		{
+			auto& entry = entryIterator->second;
+			m_lru.splice(m_lru.begin(), m_lru, entry.lruIterator);
+			return entry.block;
+		}
+		if(m_pendingBlocks.find(key) == std::end(m_pendingBlocks)) break;
+		//A worker is already decoding this block, wait for it instead of doing it twice
+		m_doneCondition.wait(lock);
+	}
+
+	m_pendingBlocks.insert(key);
+	source.pendingJobs++;
+	auto decodeFunction = source.decodeFunction;
+	lock.unlock();
+
+	auto block = std::make_shared<Block>();
+	try
+	{
+		decodeFunction(blockNumber, *block);
+	}
+	catch(...)
+	{
+		lock.lock();
+		m_pendingBlocks.erase(key);
+		source.pendingJobs--;
+		m_doneCondition.notify_all();
+		throw;
+	}
+
+	lock.lock();
+	m_pendingBlocks.erase(key);
+	source.pendingJobs--;
+	InsertBlock(key, block);
+	m_doneCondition.notify_all();
+	return block;
+}
+
+void CImageBlockCache::SetMemoryBudget(size_t memoryBudget)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_memoryBudget = memoryBudget;
+	EvictBlocks();
+}
+
+size_t CImageBlockCache::GetMemoryBudget() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_memoryBudget;
+}
+
+CImageBlockCache::BlockKey CImageBlockCache::MakeKey(SourceId sourceId, uint32 blockNumber)
+{
+	return (static_cast<BlockKey>(sourceId) << 32) | static_cast<BlockKey>(blockNumber);
+}
+
+void CImageBlockCache::InsertBlock(BlockKey key, const BlockPtr& block)
+{
+	assert(m_entries.find(key) == std::end(m_entries));
+	m_lru.push_front(key);
+	ENTRY entry;
+	entry.block = block;
+	entry.lruIterator = m_lru.begin();
+	m_entries.insert(std::make_pair(key, entry));
+	m_memoryUsage += block->size();
+	EvictBlocks();
+}
+
+void CImageBlockCache::EvictBlocks()
+{
+	//Most recently used block is always kept, even if it doesn't fit in the budget
+	while((m_memoryUsage > m_memoryBudget) && (m_lru.size() > 1))
+	{
+		auto entryIterator = m_entries.find(m_lru.back());
+		assert(entryIterator != std::end(m_entries));
+		m_memoryUsage -= entryIterator->second.block->size();
+		m_entries.erase(entryIterator);
+		m_lru.pop_back();
+	}
+}
+
+void CImageBlockCache::ScheduleReadAhead(SourceId sourceId, SOURCE& source, uint32 blockNumber)
+{
+	//Don't read ahead more than what the budget can hold, blocks would be evicted before being used
+	size_t readAheadSize = std::min<size_t>(READ_AHEAD_SIZE, m_memoryBudget / 4);
+	uint32 readAheadCount = std::max<uint32>(static_cast<uint32>(readAheadSize / source.blockSize), 1);
+	uint32 endBlock = std::min<uint32>(blockNumber + 1 + readAheadCount, source.blockCount);
+	source.readAheadBlock = std::max<uint32>(source.readAheadBlock, blockNumber + 1);
+	bool scheduled = false;
+	for(; source.readAheadBlock < endBlock; source.readAheadBlock++)
+	{
+		m_jobs.push_back(MakeKey(sourceId, source.readAheadBlock));
+		source.pendingJobs++;
+		scheduled = true;
+	}
+	if(scheduled)
+	{
+		m_jobCondition.notify_all();
+	}
+}
+
+void CImageBlockCache::WorkerThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(1)
+	{
+		m_jobCondition.wait(lock, [this] () { return m_stopping || !m_jobs.empty(); });
+		if(m_stopping) break;
+
+		BlockKey key = m_jobs.front();
+		m_jobs.pop_front();
+
+		auto sourceIterator = m_sources.find(static_cast<SourceId>(key >> 32));
+		assert(sourceIterator != std::end(m_sources));
+		auto& source = sourceIterator->second;
+
+		bool needed = (m_entries.find(key) == std::end(m_entries)) && (m_pendingBlocks.find(key) == std::end(m_pendingBlocks));
+		if(needed)
+		{
+			m_pendingBlocks.insert(key);
+			auto decodeFunction = source.decodeFunction;
+			lock.unlock();
+
+			auto block = std::make_shared<Block>();
+			bool succeeded = true;
+			try
+			{
+				decodeFunction(static_cast<uint32>(key), *block);
+			}
+			catch(...)
+			{
+				//Reader will get the error when it tries to decode the block by itself
+				succeeded = false;
+			}
+
+			lock.lock();
+			m_pendingBlocks.erase(key);
+			if(succeeded)
+			{
+				InsertBlock(key, block);
+			}
+		}
+
+		source.pendingJobs--;
+		m_doneCondition.notify_all();
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <list>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <condition_variable>
+#include "Types.h"
+#include "Singleton.h"
+
+//Cache of decompressed blocks shared by all compressed disk image streams.
+//Blocks are evicted in least recently used order when the memory budget is exceeded.
+//Sequential accesses on a source are detected and the following blocks are decompressed
+//ahead of time by worker threads.
+class CImageBlockCache : public CSingleton<CImageBlockCache>
+{
+public:
+	typedef uint32 SourceId;
+	typedef std::vector<uint8> Block;
+	typedef std::shared_ptr<const Block> BlockPtr;
+
+	//Must fill the block with its decompressed contents, can be called from any thread
+	typedef std::function<void (uint32, Block&)> DecodeFunction;
+
+	enum
+	{
+		DEFAULT_MEMORY_BUDGET_MB = 32,
+	};
+
+							CImageBlockCache();
+	virtual					~CImageBlockCache();
+
+	SourceId				RegisterSource(const DecodeFunction&, uint32 blockCount, uint32 blockSize);
+
+	//Waits for pending decoding jobs of the source to complete and drops its blocks
+	void					UnregisterSource(SourceId);
+
+	BlockPtr				GetBlock(SourceId, uint32);
+
+	void					SetMemoryBudget(size_t);
+	size_t					GetMemoryBudget() const;
+
+private:
+	enum
+	{
+		WORKER_COUNT = 2,
+		READ_AHEAD_SIZE = 0x80000,
+		SEQUENTIAL_THRESHOLD = 2,
+	};
+
+	struct SOURCE
+	{
+		DecodeFunction		decodeFunction;
+		uint32				blockCount = 0;
+		uint32				blockSize = 0;
+		uint32				lastBlock = ~0U;
+		uint32				sequentialCount = 0;
+		uint32				readAheadBlock = 0;
+		uint32				pendingJobs = 0;
+	};
+
+	typedef uint64 BlockKey;
+	typedef std::list<BlockKey> LruList;
+
+	struct ENTRY
+	{
+		BlockPtr			block;
+		LruList::iterator	lruIterator;
+	};
+
+	typedef std::unordered_map<SourceId, SOURCE> SourceMap;
+	typedef std::unordered_map<BlockKey, ENTRY> EntryMap;
+	typedef std::unordered_set<BlockKey> BlockKeySet;
+	typedef std::deque<BlockKey> JobQueue;
+
+	static BlockKey			MakeKey(SourceId, uint32);
+
+	void					InsertBlock(BlockKey, const BlockPtr&);
+	void					EvictBlocks();
+	void					ScheduleReadAhead(SourceId, SOURCE&, uint32);
+	void					WorkerThreadProc();
+
+	mutable std::mutex		m_mutex;
+	std::condition_variable	m_jobCondition;
+	std::condition_variable	m_doneCondition;
+
+	SourceMap				m_sources;
+	SourceId				m_nextSourceId = 1;
+
+	EntryMap				m_entries;
+	LruList					m_lru;
+	size_t					m_memoryUsage = 0;
+	size_t					m_memoryBudget = DEFAULT_MEMORY_BUDGET_MB << 20;
+
+	//Blocks being decoded, by a worker or a reader
+	BlockKeySet				m_pendingBlocks;
+	JobQueue				m_jobs;
+
+	std::vector<std::thread>	m_workers;
+	bool					m_stopping = false;
+};
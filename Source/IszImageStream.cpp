@@ -30,14 +30,17 @@ CIszImageStream::CIszImageStream(CStream* baseStream)
 	}
 
 	ReadBlockDescriptorTable();
-	m_cachedBlock = new uint8[m_header.blockSize];
-	m_readBuffer = new uint8[m_header.blockSize];
+
+	//Blocks are decompressed through the shared cache, which might also decompress them ahead of time
+	m_cacheSourceId = CImageBlockCache::GetInstance().RegisterSource(
+		[this] (uint32 blockNumber, CImageBlockCache::Block& block) { DecodeBlock(blockNumber, block); },
+		m_header.blockNumber, m_header.blockSize);
 }
 
 CIszImageStream::~CIszImageStream()
 {
-	delete [] m_cachedBlock;
-	delete [] m_readBuffer;
+	CImageBlockCache::GetInstance().UnregisterSource(m_cacheSourceId);
+	m_cachedBlock.reset();
 	delete [] m_blockDescriptorTable;
 	delete m_baseStream;
 }
@@ -77,7 +80,7 @@ uint64 CIszImageStream::Read(void* buffer, uint64 size)
 		uint64 blockPosition = (m_position % m_header.blockSize);
 		uint64 sizeLeft = m_header.blockSize - blockPosition;
 		uint64 sizeToRead = std::min<uint64>(size, sizeLeft);
-		memcpy(inputBuffer, m_cachedBlock + blockPosition, static_cast<size_t>(sizeToRead));
+		memcpy(inputBuffer, m_cachedBlock->data() + blockPosition, static_cast<size_t>(sizeToRead));
 		m_position += sizeToRead;
 		size -= sizeToRead;
 		inputBuffer += sizeToRead;
@@ -108,13 +111,21 @@ void CIszImageStream::ReadBlockDescriptorTable()
 		cryptedTable[i] ^= ~key[i & 3];
 	}
 
+	//Offsets of blocks in the file are also computed here to avoid going through the table on every block read
 	m_blockDescriptorTable = new BLOCKDESCRIPTOR[m_header.blockNumber];
+	m_blockOffsets.resize(m_header.blockNumber);
+	uint64 blockOffset = m_header.dataOffset;
 	for(unsigned int i = 0; i < m_header.blockNumber; i++)
 	{
 		uint32 value = *reinterpret_cast<uint32*>(&cryptedTable[i * m_header.blockPtrLength]);
 		value &= 0xFFFFFF;
 		m_blockDescriptorTable[i].size = value & 0x3FFFFF;
 		m_blockDescriptorTable[i].storageType = static_cast<uint8>(value >> 22);
+		m_blockOffsets[i] = blockOffset;
+		if(m_blockDescriptorTable[i].storageType != ADI_ZERO)
+		{
+			blockOffset += m_blockDescriptorTable[i].size;
+		}
 	}
 
 	delete [] cryptedTable;
@@ -125,22 +136,6 @@ uint64 CIszImageStream::GetTotalSize() const
 	return static_cast<uint64>(m_header.totalSectors) * static_cast<uint64>(m_header.sectorSize);
 }
 
-const CIszImageStream::BLOCKDESCRIPTOR& CIszImageStream::SeekToBlock(uint64 blockNumber)
-{
-	assert(blockNumber < m_header.blockNumber);
-	uint64 seekPosition = m_header.dataOffset;
-	for(unsigned int i = 0; i < blockNumber; i++)
-	{
-		const BLOCKDESCRIPTOR& blockDescriptor = m_blockDescriptorTable[i];
-		if(blockDescriptor.storageType != ADI_ZERO)
-		{
-			seekPosition += blockDescriptor.size;
-		}
-	}
-	m_baseStream->Seek(seekPosition, Framework::STREAM_SEEK_SET);
-	return m_blockDescriptorTable[blockNumber];
-}
-
 void CIszImageStream::SyncCache()
 {
 	uint64 currentSector = (m_position / m_header.sectorSize);
@@ -154,30 +149,44 @@ void CIszImageStream::SyncCache()
 		throw std::runtime_error("Trying to read past eof.");
 	}
 
-	const BLOCKDESCRIPTOR& blockDescriptor = SeekToBlock(neededBlock);
-	memset(m_cachedBlock, 0, m_header.blockSize);
+	m_cachedBlock = CImageBlockCache::GetInstance().GetBlock(m_cacheSourceId, static_cast<uint32>(neededBlock));
+	m_cachedBlockNumber = neededBlock;
+}
+
+void CIszImageStream::DecodeBlock(uint32 blockNumber, CImageBlockCache::Block& block)
+{
+	//Can be called from the cache's worker threads
+	assert(blockNumber < m_header.blockNumber);
+	const BLOCKDESCRIPTOR& blockDescriptor = m_blockDescriptorTable[blockNumber];
+	block.assign(m_header.blockSize, 0);
 	switch(blockDescriptor.storageType)
 	{
 	case ADI_ZERO:
-		ReadZeroBlock(blockDescriptor.size);
+		ReadZeroBlock(blockDescriptor.size, block);
 		break;
 	case ADI_DATA:
-		ReadDataBlock(blockDescriptor.size);
+		ReadDataBlock(blockNumber, blockDescriptor.size, block);
 		break;
 	case ADI_ZLIB:
-		ReadGzipBlock(blockDescriptor.size);
+		ReadGzipBlock(blockNumber, blockDescriptor.size, block);
 		break;
 	case ADI_BZ2:
-		ReadBz2Block(blockDescriptor.size);
+		ReadBz2Block(blockNumber, blockDescriptor.size, block);
 		break;
 	default:
 		throw std::runtime_error("Unsupported block storage mode.");
 		break;
 	}
-	m_cachedBlockNumber = neededBlock;
 }
 
-void CIszImageStream::ReadZeroBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadBaseBlock(uint32 blockNumber, uint8* buffer, uint32 size)
+{
+	std::lock_guard<std::mutex> baseStreamLock(m_baseStreamMutex);
+	m_baseStream->Seek(m_blockOffsets[blockNumber], Framework::STREAM_SEEK_SET);
+	m_baseStream->Read(buffer, size);
+}
+
+void CIszImageStream::ReadZeroBlock(uint32 compressedBlockSize, CImageBlockCache::Block& block)
 {
 	if(compressedBlockSize != m_header.blockSize)
 	{
@@ -185,38 +194,40 @@ void CIszImageStream::ReadZeroBlock(uint32 compressedBlockSize)
 	}
 }
 
-void CIszImageStream::ReadDataBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadDataBlock(uint32 blockNumber, uint32 compressedBlockSize, CImageBlockCache::Block& block)
 {
 	if(compressedBlockSize != m_header.blockSize)
 	{
 		throw std::runtime_error("Invalid data block.");
 	}
-	m_baseStream->Read(m_cachedBlock, compressedBlockSize);
+	ReadBaseBlock(blockNumber, block.data(), compressedBlockSize);
 }
 
-void CIszImageStream::ReadGzipBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadGzipBlock(uint32 blockNumber, uint32 compressedBlockSize, CImageBlockCache::Block& block)
 {
-	m_baseStream->Read(m_readBuffer, compressedBlockSize);
+	std::vector<uint8> readBuffer(compressedBlockSize);
+	ReadBaseBlock(blockNumber, readBuffer.data(), compressedBlockSize);
 	uLongf destLength = m_header.blockSize;
 	if(uncompress(
-				  reinterpret_cast<Bytef*>(m_cachedBlock), &destLength,
-				  reinterpret_cast<Bytef*>(m_readBuffer), compressedBlockSize) != Z_OK)
+				  reinterpret_cast<Bytef*>(block.data()), &destLength,
+				  reinterpret_cast<Bytef*>(readBuffer.data()), compressedBlockSize) != Z_OK)
 	{
 		throw std::runtime_error("Error decompressing zlib block.");
 	}
 }
 
-void CIszImageStream::ReadBz2Block(uint32 compressedBlockSize)
+void CIszImageStream::ReadBz2Block(uint32 blockNumber, uint32 compressedBlockSize, CImageBlockCache::Block& block)
 {
-	m_baseStream->Read(m_readBuffer, compressedBlockSize);
+	std::vector<uint8> readBuffer(std::max<uint32>(compressedBlockSize, 3));
+	ReadBaseBlock(blockNumber, readBuffer.data(), compressedBlockSize);
 	//Force BZ2 header
-	m_readBuffer[0] = 'B';
-	m_readBuffer[1] = 'Z';
-	m_readBuffer[2] = 'h';
+	readBuffer[0] = 'B';
+	readBuffer[1] = 'Z';
+	readBuffer[2] = 'h';
 	unsigned int destLength = m_header.blockSize;
 	if(BZ2_bzBuffToBuffDecompress(
-								  reinterpret_cast<char*>(m_cachedBlock), &destLength,
-								  reinterpret_cast<char*>(m_readBuffer), compressedBlockSize, 0, 0) != BZ_OK)
+								  reinterpret_cast<char*>(block.data()), &destLength,
+								  reinterpret_cast<char*>(readBuffer.data()), compressedBlockSize, 0, 0) != BZ_OK)
 	{
 		throw std::runtime_error("Error decompressing bz2 block.");
 	}
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <mutex>
+#include <vector>
 #include "Types.h"
 #include "Stream.h"
+#include "ImageBlockCache.h"
 
 class CIszImageStream : public Framework::CStream
 {
@@ -68,21 +71,26 @@ private:
 		ADI_BZ2 = 3
 	};
 
+	typedef std::vector<uint64> BlockOffsetArray;
+
 	void					ReadBlockDescriptorTable();
 	uint64					GetTotalSize() const;
-	const BLOCKDESCRIPTOR&	SeekToBlock(uint64);
 	void					SyncCache();
+	void					DecodeBlock(uint32, CImageBlockCache::Block&);
+	void					ReadBaseBlock(uint32, uint8*, uint32);
 
-	void					ReadZeroBlock(uint32);
-	void					ReadDataBlock(uint32);
-	void					ReadGzipBlock(uint32);
-	void					ReadBz2Block(uint32);
+	void					ReadZeroBlock(uint32, CImageBlockCache::Block&);
+	void					ReadDataBlock(uint32, uint32, CImageBlockCache::Block&);
+	void					ReadGzipBlock(uint32, uint32, CImageBlockCache::Block&);
+	void					ReadBz2Block(uint32, uint32, CImageBlockCache::Block&);
 
 	Framework::CStream*		m_baseStream = nullptr;
+	std::mutex				m_baseStreamMutex;
 	HEADER					m_header;
 	BLOCKDESCRIPTOR*		m_blockDescriptorTable = nullptr;
+	BlockOffsetArray		m_blockOffsets;
+	CImageBlockCache::SourceId	m_cacheSourceId = 0;
 	int64					m_cachedBlockNumber = -1;
-	uint8*					m_cachedBlock = nullptr;
-	uint8*					m_readBuffer = nullptr;
+	CImageBlockCache::BlockPtr	m_cachedBlock;
 	uint64					m_position = 0;
 };
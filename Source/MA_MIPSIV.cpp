@@ -564,7 +564,36 @@ void CMA_MIPSIV::LWL()
 //23
 void CMA_MIPSIV::LW()
 {
-	Template_LoadUnsigned32(reinterpret_cast<void*>(&MemoryUtils_GetWordProxy));
+	if(m_pCtx->m_fastMemory == nullptr)
+	{
+		Template_LoadUnsigned32(reinterpret_cast<void*>(&MemoryUtils_GetWordProxy));
+		return;
+	}
+
+	if(m_nRT == 0) return;
+
+	ComputeMemAccessAddr();
+
+	BeginFastMemAccess(4);
+	{
+		m_codeGen->LoadFromRef();
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+	}
+	m_codeGen->Else();
+	{
+		m_codeGen->PushCtx();
+		m_codeGen->PushRel(offsetof(CMIPS, m_memAccessAddress));
+		m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_GetWordProxy), 2, true);
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+	}
+	m_codeGen->EndIf();
+
+	if(m_regSize == MIPS_REGSIZE_64)
+	{
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+		m_codeGen->SignExt();
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[1]));
+	}
 }
 
 //24
@@ -656,6 +685,24 @@ void CMA_MIPSIV::SW()
 {
 	ComputeMemAccessAddr();
 
+	if(m_pCtx->m_fastMemory != nullptr)
+	{
+		BeginFastMemAccess(4);
+		{
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+			m_codeGen->StoreAtRef();
+		}
+		m_codeGen->Else();
+		{
+			m_codeGen->PushCtx();
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+			m_codeGen->PushRel(offsetof(CMIPS, m_memAccessAddress));
+			m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_SetWordProxy), 3, false);
+		}
+		m_codeGen->EndIf();
+		return;
+	}
+
 	m_codeGen->PushCtx();
 	m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
 	m_codeGen->PushIdx(2);
@@ -9,6 +9,7 @@
 #include "MIPSTags.h"
 #include "uint128.h"
 #include <set>
+#include <mutex>
 
 struct REGISTER_PIPELINE
 {
@@ -135,6 +136,21 @@ public:
 
 	void*						m_vuMem = nullptr;
 
+	//Host memory the JIT accesses directly for addresses below m_fastMemorySize (after masking),
+	//other addresses go through the memory map. Disabled when null.
+	uint8*						m_fastMemory = nullptr;
+	uint32						m_fastMemorySize = 0;
+	uint32						m_fastMemoryMask = ~0U;
+	uint32						m_memAccessAddress = 0;
+
+	//Loop blocks go back to their beginning by themselves while the iteration count is below the limit.
+	//The executor clears the limit when blocks are removed, making them return at their next iteration.
+	uint32						m_loopIterationLimit = 0;
+	uint32						m_loopIterationCount = 0;
+	//Instructions executed by a loop block. Branches taken inside the loop add the instructions up to their
+	//delay slot minus the ones before their target, leaving the loop adds the ones before the exit point.
+	uint32						m_loopInstructionCount = 0;
+
 	CMIPSArchitecture*			m_pArch;
 	CMIPSCoprocessor*			m_pCOP[4];
 	CMemoryMap*					m_pMemoryMap;
@@ -146,6 +162,9 @@ public:
 
 	AddressTranslator			m_pAddrTranslator;
 
+	//Instruction factories keep state while compiling, blocks of this context must be compiled one at a time
+	std::mutex					m_compileMutex;
+
 	enum REGISTER
 	{
 		R0 = 0,	AT,	V0,	V1,	A0,	A1,	A2,	A3,
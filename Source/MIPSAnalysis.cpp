@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <algorithm>
 #include "MIPSAnalysis.h"
 #include "MIPS.h"
 
@@ -460,3 +461,412 @@ CMIPSAnalysis::CallStackItemArray CMIPSAnalysis::GetCallStack(CMIPS* context, ui
 
 	return result;
 }
+
+//////////////////////////////////////////////////
+//Busy-wait loops
+//////////////////////////////////////////////////
+
+enum
+{
+	MAX_BUSYWAIT_LOOP_SIZE = 0x100,
+};
+
+struct LOOP_INSTRUCTION
+{
+	uint32		reads = 0;
+	uint32		writes = 0;
+	uint32		destination = 0;
+	bool		isLoad = false;
+	bool		isBranch = false;
+	bool		isLikely = false;
+	bool		isUnconditional = false;
+	uint32		target = 0;
+};
+
+static uint32 GetRegisterBit(uint32 reg)
+{
+	//R0 never carries anything from one iteration to the next
+	return (reg == 0) ? 0 : (1 << reg);
+}
+
+//Returns false if the instruction can have an effect other than writing to a general purpose register
+static bool DecodeLoopInstruction(uint32 address, uint32 opcode, LOOP_INSTRUCTION& instruction)
+{
+	uint32 rs = (opcode >> 21) & 0x1F;
+	uint32 rt = (opcode >> 16) & 0x1F;
+	uint32 rd = (opcode >> 11) & 0x1F;
+	uint32 branchTarget = address + 4 + (static_cast<int16>(opcode & 0xFFFF) * 4);
+
+	auto setBranch =
+		[&] (uint32 reads, bool isLikely, bool isUnconditional)
+		{
+			instruction.reads = reads;
+			instruction.isBranch = true;
+			instruction.isLikely = isLikely;
+			instruction.isUnconditional = isUnconditional;
+			instruction.target = branchTarget;
+		};
+	auto setOperation =
+		[&] (uint32 reads, uint32 destination)
+		{
+			instruction.reads = reads;
+			instruction.writes = GetRegisterBit(destination);
+			instruction.destination = destination;
+		};
+
+	switch(opcode >> 26)
+	{
+	case 0x00:
+		//SPECIAL
+		switch(opcode & 0x3F)
+		{
+		case 0x00: case 0x02: case 0x03:				//SLL, SRL, SRA
+		case 0x38: case 0x3A: case 0x3B:				//DSLL, DSRL, DSRA
+		case 0x3C: case 0x3E: case 0x3F:				//DSLL32, DSRL32, DSRA32
+			setOperation(GetRegisterBit(rt), rd);
+			return true;
+		case 0x04: case 0x06: case 0x07:				//SLLV, SRLV, SRAV
+		case 0x14: case 0x16: case 0x17:				//DSLLV, DSRLV, DSRAV
+		case 0x20: case 0x21: case 0x22: case 0x23:		//ADD, ADDU, SUB, SUBU
+		case 0x24: case 0x25: case 0x26: case 0x27:		//AND, OR, XOR, NOR
+		case 0x2A: case 0x2B:							//SLT, SLTU
+		case 0x2C: case 0x2D: case 0x2E: case 0x2F:		//DADD, DADDU, DSUB, DSUBU
+			setOperation(GetRegisterBit(rs) | GetRegisterBit(rt), rd);
+			return true;
+		case 0x0A: case 0x0B:							//MOVZ, MOVN
+			//Destination keeps its value when the condition isn't met
+			setOperation(GetRegisterBit(rs) | GetRegisterBit(rt) | GetRegisterBit(rd), rd);
+			return true;
+		case 0x10: case 0x12:							//MFHI, MFLO
+			//HI and LO can't be modified by any instruction allowed in a loop
+			setOperation(0, rd);
+			return true;
+		case 0x0F:										//SYNC
+			return true;
+		default:
+			return false;
+		}
+		break;
+	case 0x01:
+		//REGIMM
+		switch(rt)
+		{
+		case 0x00: case 0x01:							//BLTZ, BGEZ
+		case 0x02: case 0x03:							//BLTZL, BGEZL
+			setBranch(GetRegisterBit(rs), (rt & 0x02) != 0, ((rt & 0x01) != 0) && (rs == 0));
+			return true;
+		default:
+			return false;
+		}
+		break;
+	case 0x02:											//J
+		setBranch(0, false, true);
+		instruction.target = ((address + 4) & 0xF0000000) | ((opcode & 0x03FFFFFF) << 2);
+		return true;
+	case 0x04: case 0x05:								//BEQ, BNE
+	case 0x14: case 0x15:								//BEQL, BNEL
+		setBranch(GetRegisterBit(rs) | GetRegisterBit(rt), (opcode & 0x40000000) != 0, ((opcode & 0x04000000) == 0) && (rs == rt));
+		return true;
+	case 0x06: case 0x07:								//BLEZ, BGTZ
+	case 0x16: case 0x17:								//BLEZL, BGTZL
+		setBranch(GetRegisterBit(rs), (opcode & 0x40000000) != 0, ((opcode & 0x04000000) == 0) && (rs == 0));
+		return true;
+	case 0x08: case 0x09: case 0x0A: case 0x0B:			//ADDI, ADDIU, SLTI, SLTIU
+	case 0x0C: case 0x0D: case 0x0E:					//ANDI, ORI, XORI
+	case 0x18: case 0x19:								//DADDI, DADDIU
+		setOperation(GetRegisterBit(rs), rt);
+		return true;
+	case 0x0F:											//LUI
+		setOperation(0, rt);
+		return true;
+	case 0x20: case 0x21: case 0x23:					//LB, LH, LW
+	case 0x24: case 0x25: case 0x27:					//LBU, LHU, LWU
+	case 0x1E: case 0x37:								//LQ, LD
+		setOperation(GetRegisterBit(rs), rt);
+		instruction.isLoad = true;
+		return true;
+	case 0x1A: case 0x1B:								//LDL, LDR
+	case 0x22: case 0x26:								//LWL, LWR
+		//Only part of the destination is replaced
+		setOperation(GetRegisterBit(rs) | GetRegisterBit(rt), rt);
+		instruction.isLoad = true;
+		return true;
+	default:
+		return false;
+	}
+}
+
+//Visits the instructions executed by an iteration that doesn't leave the loop. Fails if an instruction
+//has side effects or if control flow inside the loop is more than exits and the final branch back.
+template <typename VisitorType>
+static bool VisitLoopInstructions(CMIPS* context, uint32 begin, uint32 end, const VisitorType& visitor)
+{
+	if((end <= begin) || ((end - begin) >= MAX_BUSYWAIT_LOOP_SIZE)) return false;
+
+	for(uint32 address = begin; address <= end; address += 4)
+	{
+		uint32 opcode = context->m_pMemoryMap->GetInstruction(address);
+		LOOP_INSTRUCTION instruction;
+		if(!DecodeLoopInstruction(address, opcode, instruction)) return false;
+		if(instruction.isBranch)
+		{
+			bool isBackBranch = (instruction.target == begin);
+			if(address == (end - 4))
+			{
+				if(!isBackBranch) return false;
+			}
+			else
+			{
+				//Branch in the last delay slot, a second way back or a jump within the loop
+				if(address == end) return false;
+				if(isBackBranch || instruction.isUnconditional) return false;
+				if((instruction.target > begin) && (instruction.target <= end)) return false;
+			}
+			visitor(opcode, instruction);
+			if(instruction.isLikely && !isBackBranch)
+			{
+				//Delay slot is only executed when leaving the loop
+				address += 4;
+			}
+			continue;
+		}
+		visitor(opcode, instruction);
+	}
+	return true;
+}
+
+bool CMIPSAnalysis::IsBusyWaitLoop(CMIPS* context, uint32 begin, uint32 end)
+{
+	uint32 loopWrites = 0;
+	bool succeeded = VisitLoopInstructions(context, begin, end,
+		[&] (uint32, const LOOP_INSTRUCTION& instruction)
+		{
+			loopWrites |= instruction.writes;
+		}
+	);
+	if(!succeeded) return false;
+
+	//A register read before being written comes from the previous iteration, it must not be modified by the loop
+	uint32 iterationWrites = 0;
+	bool carriesValues = false;
+	VisitLoopInstructions(context, begin, end,
+		[&] (uint32, const LOOP_INSTRUCTION& instruction)
+		{
+			if(instruction.reads & loopWrites & ~iterationWrites)
+			{
+				carriesValues = true;
+			}
+			iterationWrites |= instruction.writes;
+		}
+	);
+	return !carriesValues;
+}
+
+bool CMIPSAnalysis::GetBusyWaitLoopReads(CMIPS* context, uint32 begin, uint32 end, std::vector<uint32>& reads)
+{
+	//Registers start with their current values, those loaded from memory become unknown
+	uint32 values[32];
+	for(unsigned int i = 0; i < 32; i++)
+	{
+		values[i] = context->m_State.nGPR[i].nV[0];
+	}
+	uint32 knownRegisters = ~0U;
+	bool addressesKnown = true;
+
+	reads.clear();
+	bool succeeded = VisitLoopInstructions(context, begin, end,
+		[&] (uint32 opcode, const LOOP_INSTRUCTION& instruction)
+		{
+			uint32 rs = (opcode >> 21) & 0x1F;
+			uint32 rt = (opcode >> 16) & 0x1F;
+			uint16 immediate = static_cast<uint16>(opcode & 0xFFFF);
+			bool rsKnown = (knownRegisters & (1 << rs)) != 0;
+			bool rtKnown = (knownRegisters & (1 << rt)) != 0;
+
+			if(instruction.isLoad)
+			{
+				if(rsKnown)
+				{
+					uint32 address = values[rs] + static_cast<int16>(immediate);
+					reads.push_back(context->m_pAddrTranslator(context, address));
+				}
+				else
+				{
+					addressesKnown = false;
+				}
+			}
+
+			if(instruction.writes == 0) return;
+
+			//Only follow what is commonly used to build addresses
+			bool resultKnown = false;
+			uint32 result = 0;
+			switch(opcode >> 26)
+			{
+			case 0x00:
+				switch(opcode & 0x3F)
+				{
+				case 0x21:		//ADDU
+				case 0x2D:		//DADDU
+					resultKnown = rsKnown && rtKnown;
+					result = values[rs] + values[rt];
+					break;
+				case 0x25:		//OR
+					resultKnown = rsKnown && rtKnown;
+					result = values[rs] | values[rt];
+					break;
+				}
+				break;
+			case 0x09:			//ADDIU
+			case 0x19:			//DADDIU
+				resultKnown = rsKnown;
+				result = values[rs] + static_cast<int16>(immediate);
+				break;
+			case 0x0C:			//ANDI
+				resultKnown = rsKnown;
+				result = values[rs] & immediate;
+				break;
+			case 0x0D:			//ORI
+				resultKnown = rsKnown;
+				result = values[rs] | immediate;
+				break;
+			case 0x0F:			//LUI
+				resultKnown = true;
+				result = immediate << 16;
+				break;
+			}
+
+			if(resultKnown)
+			{
+				values[instruction.destination] = result;
+				knownRegisters |= instruction.writes;
+			}
+			else
+			{
+				knownRegisters &= ~instruction.writes;
+			}
+		}
+	);
+	return succeeded && addressesKnown;
+}
+
+//////////////////////////////////////////////////
+//Compilable loops
+//////////////////////////////////////////////////
+
+enum
+{
+	MAX_COMPILED_LOOP_SIZE = 0x400,
+};
+
+static bool IsLikelyBranch(uint32 opcode)
+{
+	uint32 rs = (opcode >> 21) & 0x1F;
+	uint32 rt = (opcode >> 16) & 0x1F;
+	switch(opcode >> 26)
+	{
+	case 0x01:											//REGIMM
+		return (rt & 0x02) != 0;
+	case 0x10: case 0x11: case 0x12:					//COP0, COP1, COP2
+		return (rs == 0x08) && ((rt & 0x02) != 0);
+	case 0x14: case 0x15: case 0x16: case 0x17:			//BEQL, BNEL, BLEZL, BGTZL
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool IsLinkingBranch(uint32 opcode)
+{
+	switch(opcode >> 26)
+	{
+	case 0x00:
+		return (opcode & 0x3F) == 0x09;					//JALR
+	case 0x01:
+		return (((opcode >> 16) & 0x1F) & 0x10) != 0;	//BLTZAL, BGEZAL, BLTZALL, BGEZALL
+	case 0x03:											//JAL
+		return true;
+	default:
+		return false;
+	}
+}
+
+void CMIPSAnalysis::FindCompilableLoops(CMIPS* context, uint32 begin, uint32 end, LoopRegionArray& loops)
+{
+	struct BRANCH
+	{
+		uint32		address;
+		uint32		target;
+	};
+
+	loops.clear();
+
+	//Indirect jumps have no effective address, they are left with a target of 0
+	std::vector<BRANCH> branches;
+	for(uint32 address = begin; address <= end; address += 4)
+	{
+		uint32 opcode = context->m_pMemoryMap->GetInstruction(address);
+		if(context->m_pArch->IsInstructionBranch(context, address, opcode) != MIPS_BRANCH_NORMAL) continue;
+		BRANCH branch = { address, context->m_pArch->GetInstructionEffectiveAddress(context, address, opcode) };
+		branches.push_back(branch);
+	}
+
+	LoopRegionArray candidates;
+	for(const auto& backBranch : branches)
+	{
+		if((backBranch.target < begin) || (backBranch.target > backBranch.address)) continue;
+		LOOP_REGION loop = { backBranch.target, backBranch.address + 4 };
+		if((loop.end > end) || ((loop.end - loop.begin) >= MAX_COMPILED_LOOP_SIZE)) continue;
+
+		bool compilable = true;
+		bool inDelaySlot = false;
+		for(uint32 address = loop.begin; compilable && (address <= loop.end); address += 4)
+		{
+			uint32 opcode = context->m_pMemoryMap->GetInstruction(address);
+			auto branchType = context->m_pArch->IsInstructionBranch(context, address, opcode);
+			if(branchType == MIPS_BRANCH_NODELAY)
+			{
+				//Needs to be handled by the executor (ie.: SYSCALL, ERET)
+				compilable = false;
+			}
+			else if(branchType == MIPS_BRANCH_NORMAL)
+			{
+				//Likely branches skip their delay slot and calls return in the middle of the loop
+				if(inDelaySlot || (address == loop.end) || IsLikelyBranch(opcode) || IsLinkingBranch(opcode))
+				{
+					compilable = false;
+				}
+				inDelaySlot = true;
+				continue;
+			}
+			inDelaySlot = false;
+		}
+		if(!compilable) continue;
+
+		for(const auto& branch : branches)
+		{
+			bool isInside = (branch.address >= loop.begin) && (branch.address <= loop.end);
+			if(!isInside && (branch.target > loop.begin) && (branch.target <= loop.end))
+			{
+				compilable = false;
+				break;
+			}
+		}
+		if(!compilable) continue;
+
+		candidates.push_back(loop);
+	}
+
+	//Outer loops contain the inner ones, keep the biggest
+	std::sort(candidates.begin(), candidates.end(),
+		[] (const LOOP_REGION& loop1, const LOOP_REGION& loop2) { return (loop1.end - loop1.begin) > (loop2.end - loop2.begin); });
+	for(const auto& candidate : candidates)
+	{
+		bool overlaps = std::any_of(loops.begin(), loops.end(),
+			[&candidate] (const LOOP_REGION& loop) { return (candidate.begin <= loop.end) && (loop.begin <= candidate.end); });
+		if(!overlaps)
+		{
+			loops.push_back(candidate);
+		}
+	}
+}
@@ -34,6 +34,27 @@ public:
 
 	static CallStackItemArray			GetCallStack(CMIPS*, uint32 pc, uint32 sp, uint32 ra);
 
+	//Checks if the loop going from 'begin' to the branch ending at 'end' only reads memory and registers
+	//it doesn't modify. Such a loop ends every iteration in the same state until something else changes
+	//the memory it polls.
+	static bool							IsBusyWaitLoop(CMIPS*, uint32 begin, uint32 end);
+
+	//Computes the physical addresses read by an iteration of a busy-wait loop using the current register
+	//values. Fails if an address depends on a value loaded by the loop.
+	static bool							GetBusyWaitLoopReads(CMIPS*, uint32 begin, uint32 end, std::vector<uint32>&);
+
+	//Loop that can be compiled as a single block, 'end' is the delay slot of the branch going back to 'begin'
+	struct LOOP_REGION
+	{
+		uint32			begin;
+		uint32			end;
+	};
+	typedef std::vector<LOOP_REGION> LoopRegionArray;
+
+	//Finds loops within the range that don't overlap. Every branch inside a loop must either leave it or go
+	//to another instruction of the loop, and the loop can't be entered from the range other than at its beginning.
+	static void							FindCompilableLoops(CMIPS*, uint32 begin, uint32 end, LoopRegionArray&);
+
 private:
 	typedef std::map<uint32, SUBROUTINE, std::greater<uint32>> SubroutineList;
 
@@ -61,6 +61,26 @@ void CMIPSInstructionFactory::ComputeMemAccessAddr()
 	}
 }
 
+//Pops the address computed by ComputeMemAccessAddr and begins a conditional block executed when it
+//falls within the fast memory region, a reference to the host memory is pushed on the stack for it.
+//Caller must provide the slow path with Else (address is in m_memAccessAddress) and close with EndIf.
+void CMIPSInstructionFactory::BeginFastMemAccess(uint32 accessSize)
+{
+	assert(m_pCtx->m_fastMemory != nullptr);
+
+	m_codeGen->PullRel(offsetof(CMIPS, m_memAccessAddress));
+
+	m_codeGen->PushRel(offsetof(CMIPS, m_memAccessAddress));
+	m_codeGen->PushCst(m_pCtx->m_fastMemorySize);
+	m_codeGen->BeginIf(Jitter::CONDITION_BL);
+
+	m_codeGen->PushRelRef(offsetof(CMIPS, m_fastMemory));
+	m_codeGen->PushRel(offsetof(CMIPS, m_memAccessAddress));
+	m_codeGen->PushCst(m_pCtx->m_fastMemoryMask & ~(accessSize - 1));
+	m_codeGen->And();
+	m_codeGen->AddRef();
+}
+
 void CMIPSInstructionFactory::Branch(Jitter::CONDITION condition)
 {
 	uint16 nImmediate = (uint16)(m_nOpcode & 0xFFFF);
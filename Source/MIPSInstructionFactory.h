@@ -27,6 +27,7 @@ public:
 
 protected:
 	void					ComputeMemAccessAddr();
+	void					BeginFastMemAccess(uint32);
 	void					Branch(Jitter::CONDITION);
 	void					BranchLikely(Jitter::CONDITION);
 
@@ -5,13 +5,14 @@
 
 bool CMailBox::IsPending() const
 {
-	return m_calls.size() != 0;
+	std::unique_lock<std::mutex> callLock(m_callMutex);
+	return !m_calls.empty();
 }
 
 void CMailBox::WaitForCall()
 {
 	std::unique_lock<std::mutex> callLock(m_callMutex);
-	while(!IsPending())
+	while(m_calls.empty())
 	{
 		m_waitCondition.wait(callLock);
 	}
@@ -20,8 +21,21 @@ void CMailBox::WaitForCall()
 void CMailBox::WaitForCall(unsigned int timeOut)
 {
 	std::unique_lock<std::mutex> callLock(m_callMutex);
-	if(IsPending()) return;
+	if(!m_calls.empty() || m_wakeUp)
+	{
+		m_wakeUp = false;
+		return;
+	}
 	m_waitCondition.wait_for(callLock, std::chrono::milliseconds(timeOut));
+	m_wakeUp = false;
+}
+
+//Makes a thread waiting for calls return without sending any call
+void CMailBox::WakeUp()
+{
+	std::unique_lock<std::mutex> callLock(m_callMutex);
+	m_wakeUp = true;
+	m_waitCondition.notify_all();
 }
 
 void CMailBox::FlushCalls()
@@ -64,7 +78,7 @@ void CMailBox::ReceiveCall()
 	MESSAGE message;
 	{
 		std::unique_lock<std::mutex> waitLock(m_callMutex);
-		if(!IsPending()) return;
+		if(m_calls.empty()) return;
 		message = *m_calls.begin();
 		m_calls.pop_front();
 	}
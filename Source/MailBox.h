@@ -19,6 +19,7 @@ public:
 	void				ReceiveCall();
 	void				WaitForCall();
 	void				WaitForCall(unsigned int);
+	void				WakeUp();
 
 private:
 	struct MESSAGE
@@ -30,8 +31,9 @@ private:
 	typedef std::deque<MESSAGE> FunctionCallQueue;
 
 	FunctionCallQueue		m_calls;
-	std::mutex				m_callMutex;
+	mutable std::mutex		m_callMutex;
 	std::condition_variable	m_callFinished;
 	std::condition_variable	m_waitCondition;
 	bool					m_callDone;
+	bool					m_wakeUp = false;
 };
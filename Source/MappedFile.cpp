@@ -0,0 +1,77 @@
+#include <limits>
+#include <stdexcept>
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+CMappedFile::CMappedFile(const boost::filesystem::path& path)
+{
+	uint64 size = boost::filesystem::file_size(path);
+	if((size == 0) || (size > std::numeric_limits<size_t>::max()))
+	{
+		throw std::runtime_error("Can't map file: invalid size.");
+	}
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileW(path.native().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(fileHandle == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("Can't map file: failed to open file.");
+	}
+	HANDLE mappingHandle = CreateFileMappingW(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(mappingHandle == NULL)
+	{
+		CloseHandle(fileHandle);
+		throw std::runtime_error("Can't map file: failed to create mapping.");
+	}
+	void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, static_cast<size_t>(size));
+	if(data == NULL)
+	{
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		throw std::runtime_error("Can't map file: failed to map view.");
+	}
+	m_fileHandle = fileHandle;
+	m_mappingHandle = mappingHandle;
+#else
+	int fd = open(path.native().c_str(), O_RDONLY);
+	if(fd < 0)
+	{
+		throw std::runtime_error("Can't map file: failed to open file.");
+	}
+	void* data = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED)
+	{
+		throw std::runtime_error("Can't map file: mmap failed.");
+	}
+#endif
+	m_data = reinterpret_cast<const uint8*>(data);
+	m_size = size;
+}
+
+CMappedFile::~CMappedFile()
+{
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mappingHandle);
+	CloseHandle(m_fileHandle);
+#else
+	munmap(const_cast<uint8*>(m_data), static_cast<size_t>(m_size));
+#endif
+}
+
+const uint8* CMappedFile::GetData() const
+{
+	return m_data;
+}
+
+uint64 CMappedFile::GetSize() const
+{
+	return m_size;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <boost/filesystem.hpp>
+#include "Types.h"
+
+//Read-only view of a whole file in memory, throws if the file can't be mapped
+//(ie.: a file bigger than what the address space can hold on 32-bit platforms)
+class CMappedFile
+{
+public:
+							CMappedFile(const boost::filesystem::path&);
+	virtual					~CMappedFile();
+
+							CMappedFile(const CMappedFile&) = delete;
+	CMappedFile&			operator =(const CMappedFile&) = delete;
+
+	const uint8*			GetData() const;
+	uint64					GetSize() const;
+
+private:
+	const uint8*			m_data = nullptr;
+	uint64					m_size = 0;
+#ifdef _WIN32
+	void*					m_fileHandle = nullptr;
+	void*					m_mappingHandle = nullptr;
+#endif
+};
@@ -11,40 +11,59 @@ void CMemoryMap::InsertReadMap(uint32 start, uint32 end, void* pointer, unsigned
 {
 	assert(GetReadMap(start) == nullptr);
 	InsertMap(m_readMap, start, end, pointer, key);
+	m_readPages.Build(m_readMap);
 }
 
 void CMemoryMap::InsertReadMap(uint32 start, uint32 end, const MemoryMapHandlerType& handler, unsigned char key)
 {
 	assert(GetReadMap(start) == nullptr);
 	InsertMap(m_readMap, start, end, handler, key);
+	m_readPages.Build(m_readMap);
+}
+
+void CMemoryMap::InsertReadMap(uint32 start, uint32 end, void* pointer, const MemoryMapHandlerType& accessHandler, unsigned char key)
+{
+	assert(GetReadMap(start) == nullptr);
+	InsertMap(m_readMap, start, end, pointer, accessHandler, key);
+	m_readPages.Build(m_readMap);
 }
 
 void CMemoryMap::InsertWriteMap(uint32 start, uint32 end, void* pointer, unsigned char key)
 {
 	assert(GetWriteMap(start) == nullptr);
 	InsertMap(m_writeMap, start, end, pointer, key);
+	m_writePages.Build(m_writeMap);
 }
 
 void CMemoryMap::InsertWriteMap(uint32 start, uint32 end, const MemoryMapHandlerType& handler, unsigned char key)
 {
 	assert(GetWriteMap(start) == nullptr);
 	InsertMap(m_writeMap, start, end, handler, key);
+	m_writePages.Build(m_writeMap);
+}
+
+void CMemoryMap::InsertWriteMap(uint32 start, uint32 end, void* pointer, const MemoryMapHandlerType& accessHandler, unsigned char key)
+{
+	assert(GetWriteMap(start) == nullptr);
+	InsertMap(m_writeMap, start, end, pointer, accessHandler, key);
+	m_writePages.Build(m_writeMap);
 }
 
 void CMemoryMap::InsertInstructionMap(uint32 start, uint32 end, void* pointer, unsigned char key)
 {
-	assert(GetMap(m_instructionMap, start) == nullptr);
+	assert(GetMap(m_instructionPages, m_instructionMap, start) == nullptr);
 	InsertMap(m_instructionMap, start, end, pointer, key);
+	m_instructionPages.Build(m_instructionMap);
 }
 
 const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetReadMap(uint32 address) const
 {
-	return GetMap(m_readMap, address);
+	return GetMap(m_readPages, m_readMap, address);
 }
 
 const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetWriteMap(uint32 address) const
 {
-	return GetMap(m_writeMap, address);
+	return GetMap(m_writePages, m_writeMap, address);
 }
 
 void CMemoryMap::InsertMap(MemoryMapListType& memoryMap, uint32 start, uint32 end, void* pointer, unsigned char key)
@@ -68,6 +87,17 @@ void CMemoryMap::InsertMap(MemoryMapListType& memoryMap, uint32 start, uint32 en
 	memoryMap.push_back(element);
 }
 
+void CMemoryMap::InsertMap(MemoryMapListType& memoryMap, uint32 start, uint32 end, void* pointer, const MemoryMapHandlerType& accessHandler, unsigned char key)
+{
+	MEMORYMAPELEMENT element;
+	element.nStart		= start;
+	element.nEnd		= end;
+	element.pPointer	= pointer;
+	element.handler		= accessHandler;
+	element.nType		= MEMORYMAP_TYPE_MEMORY;
+	memoryMap.push_back(element);
+}
+
 const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetMap(const MemoryMapListType& memoryMap, uint32 nAddress)
 {
 	for(MemoryMapListType::const_iterator element(memoryMap.begin());
@@ -83,13 +113,61 @@ const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetMap(const MemoryMapListType&
 	return NULL;
 }
 
+const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetMap(const CPageTable& pageTable, const MemoryMapListType& memoryMap, uint32 address)
+{
+	auto page = pageTable.GetPage(address);
+	if(page == nullptr) return nullptr;
+	if(page->element) return page->element;
+	return GetMap(memoryMap, address);
+}
+
+void CMemoryMap::CPageTable::Build(const MemoryMapListType& memoryMap)
+{
+	//Elements might have been moved around by the list, start over
+	for(auto& table : m_directory)
+	{
+		table.reset();
+	}
+
+	for(const auto& element : memoryMap)
+	{
+		assert(element.nEnd >= element.nStart);
+		uint32 firstPage = element.nStart >> PAGE_SHIFT;
+		uint32 lastPage = element.nEnd >> PAGE_SHIFT;
+		for(uint32 pageIndex = firstPage; pageIndex <= lastPage; pageIndex++)
+		{
+			uint32 pageStart = pageIndex << PAGE_SHIFT;
+			uint32 pageEnd = pageStart + PAGE_MASK;
+			auto& table = m_directory[pageStart >> DIRECTORY_SHIFT];
+			if(!table)
+			{
+				table = TablePtr(new PAGE[TABLE_SIZE]);
+			}
+			//Pages that are only partially covered by this element are left empty and will be resolved by scanning the list
+			if((pageStart < element.nStart) || (pageEnd > element.nEnd)) continue;
+			auto& page = table[pageIndex & (TABLE_SIZE - 1)];
+			page.element = &element;
+			//Memory with an access handler must always go through the element
+			if((element.nType == MEMORYMAP_TYPE_MEMORY) && !element.handler)
+			{
+				page.pointer = reinterpret_cast<uint8*>(element.pPointer) + (pageStart - element.nStart);
+			}
+		}
+	}
+}
+
 uint8 CMemoryMap::GetByte(uint32 nAddress)
 {
-	const MEMORYMAPELEMENT* e = GetMap(m_readMap, nAddress);
+	if(uint8* memory = m_readPages.GetPointer(nAddress))
+	{
+		return *memory;
+	}
+	const MEMORYMAPELEMENT* e = GetMap(m_readPages, m_readMap, nAddress);
 	if(e == NULL) return 0xCC;
 	switch(e->nType)
 	{
 	case MEMORYMAP_TYPE_MEMORY:
+		NotifyAccess(e, nAddress);
 		return *(uint8*)&((uint8*)e->pPointer)[nAddress - e->nStart];
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
@@ -104,7 +182,12 @@ uint8 CMemoryMap::GetByte(uint32 nAddress)
 
 void CMemoryMap::SetByte(uint32 nAddress, uint8 nValue)
 {
-	const MEMORYMAPELEMENT* e = GetMap(m_writeMap, nAddress);
+	if(uint8* memory = m_writePages.GetPointer(nAddress))
+	{
+		*memory = nValue;
+		return;
+	}
+	const MEMORYMAPELEMENT* e = GetMap(m_writePages, m_writeMap, nAddress);
 	if(e == NULL)
 	{
 		printf("MemoryMap: Wrote to unmapped memory (0x%0.8X, 0x%0.4X).\r\n", nAddress, nValue);
@@ -113,6 +196,7 @@ void CMemoryMap::SetByte(uint32 nAddress, uint8 nValue)
 	switch(e->nType)
 	{
 	case MEMORYMAP_TYPE_MEMORY:
+		NotifyAccess(e, nAddress);
 		*(uint8*)&((uint8*)e->pPointer)[nAddress - e->nStart] = nValue;
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
@@ -131,11 +215,16 @@ void CMemoryMap::SetByte(uint32 nAddress, uint8 nValue)
 uint16 CMemoryMap_LSBF::GetHalf(uint32 nAddress)
 {
 	assert((nAddress & 0x01) == 0);
-	const MEMORYMAPELEMENT* e = GetMap(m_readMap, nAddress);
+	if(uint8* memory = m_readPages.GetPointer(nAddress))
+	{
+		return *reinterpret_cast<uint16*>(memory);
+	}
+	const MEMORYMAPELEMENT* e = GetMap(m_readPages, m_readMap, nAddress);
 	if(e == NULL) return 0xCCCC;
 	switch(e->nType)
 	{
 	case MEMORYMAP_TYPE_MEMORY:
+		NotifyAccess(e, nAddress);
 		return *(uint16*)&((uint8*)e->pPointer)[nAddress - e->nStart];
 		break;
 	default:
@@ -147,11 +236,16 @@ uint16 CMemoryMap_LSBF::GetHalf(uint32 nAddress)
 uint32 CMemoryMap_LSBF::GetWord(uint32 nAddress)
 {
 	assert((nAddress & 0x03) == 0);
-	const MEMORYMAPELEMENT* e = GetMap(m_readMap, nAddress);
+	if(uint8* memory = m_readPages.GetPointer(nAddress))
+	{
+		return *reinterpret_cast<uint32*>(memory);
+	}
+	const MEMORYMAPELEMENT* e = GetMap(m_readPages, m_readMap, nAddress);
 	if(e == NULL) return 0xCCCCCCCC;
 	switch(e->nType)
 	{
 	case MEMORYMAP_TYPE_MEMORY:
+		NotifyAccess(e, nAddress);
 		return *(uint32*)&((uint8*)e->pPointer)[nAddress - e->nStart];
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
@@ -167,7 +261,11 @@ uint32 CMemoryMap_LSBF::GetWord(uint32 nAddress)
 uint32 CMemoryMap_LSBF::GetInstruction(uint32 address)
 {
 	assert((address & 0x03) == 0);
-	const MEMORYMAPELEMENT* e = GetMap(m_instructionMap, address);
+	if(uint8* memory = m_instructionPages.GetPointer(address))
+	{
+		return *reinterpret_cast<uint32*>(memory);
+	}
+	const MEMORYMAPELEMENT* e = GetMap(m_instructionPages, m_instructionMap, address);
 	if(e == NULL) return 0xCCCCCCCC;
 	switch(e->nType)
 	{
@@ -184,7 +282,12 @@ uint32 CMemoryMap_LSBF::GetInstruction(uint32 address)
 void CMemoryMap_LSBF::SetHalf(uint32 nAddress, uint16 nValue)
 {
 	assert((nAddress & 0x01) == 0);
-	const MEMORYMAPELEMENT* e = GetMap(m_writeMap, nAddress);
+	if(uint8* memory = m_writePages.GetPointer(nAddress))
+	{
+		*reinterpret_cast<uint16*>(memory) = nValue;
+		return;
+	}
+	const MEMORYMAPELEMENT* e = GetMap(m_writePages, m_writeMap, nAddress);
 	if(e == NULL) 
 	{
 		printf("MemoryMap: Wrote to unmapped memory (0x%0.8X, 0x%0.4X).\r\n", nAddress, nValue);
@@ -193,6 +296,7 @@ void CMemoryMap_LSBF::SetHalf(uint32 nAddress, uint16 nValue)
 	switch(e->nType)
 	{
 	case MEMORYMAP_TYPE_MEMORY:
+		NotifyAccess(e, nAddress);
 		*reinterpret_cast<uint16*>(&reinterpret_cast<uint8*>(e->pPointer)[nAddress - e->nStart]) = nValue;
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
@@ -207,7 +311,12 @@ void CMemoryMap_LSBF::SetHalf(uint32 nAddress, uint16 nValue)
 void CMemoryMap_LSBF::SetWord(uint32 nAddress, uint32 nValue)
 {
 	assert((nAddress & 0x03) == 0);
-	const MEMORYMAPELEMENT* e = GetMap(m_writeMap, nAddress);
+	if(uint8* memory = m_writePages.GetPointer(nAddress))
+	{
+		*reinterpret_cast<uint32*>(memory) = nValue;
+		return;
+	}
+	const MEMORYMAPELEMENT* e = GetMap(m_writePages, m_writeMap, nAddress);
 	if(e == NULL) 
 	{
 		printf("MemoryMap: Wrote to unmapped memory (0x%0.8X, 0x%0.8X).\r\n", nAddress, nValue);
@@ -216,6 +325,7 @@ void CMemoryMap_LSBF::SetWord(uint32 nAddress, uint32 nValue)
 	switch(e->nType)
 	{
 	case MEMORYMAP_TYPE_MEMORY:
+		NotifyAccess(e, nAddress);
 		*(uint32*)&((uint8*)e->pPointer)[nAddress - e->nStart] = nValue;
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
@@ -3,6 +3,7 @@
 
 #include "Types.h"
 #include <functional>
+#include <memory>
 #include <vector>
 
 enum MEMORYMAP_ENDIANESS
@@ -27,10 +28,18 @@ public:
 		uint32								nStart;
 		uint32								nEnd;
 		void*								pPointer;
+		//On memory elements, called with the address before every access if set
 		MemoryMapHandlerType				handler;
 		MEMORYMAP_TYPE						nType;
 	};
 
+	enum
+	{
+		PAGE_SHIFT = 12,
+		PAGE_SIZE = (1 << PAGE_SHIFT),
+		PAGE_MASK = (PAGE_SIZE - 1),
+	};
+
 	virtual									~CMemoryMap();
 	uint8									GetByte(uint32);
 	virtual uint16							GetHalf(uint32) = 0;
@@ -41,24 +50,82 @@ public:
 	virtual void							SetWord(uint32, uint32) = 0;
 	void									InsertReadMap(uint32, uint32, void*, unsigned char);
 	void									InsertReadMap(uint32, uint32, const MemoryMapHandlerType&, unsigned char);
+	void									InsertReadMap(uint32, uint32, void*, const MemoryMapHandlerType&, unsigned char);
 	void									InsertWriteMap(uint32, uint32, void*, unsigned char);
 	void									InsertWriteMap(uint32, uint32, const MemoryMapHandlerType&, unsigned char);
+	void									InsertWriteMap(uint32, uint32, void*, const MemoryMapHandlerType&, unsigned char);
 	void									InsertInstructionMap(uint32, uint32, void*, unsigned char);
 	const MEMORYMAPELEMENT*					GetReadMap(uint32) const;
 	const MEMORYMAPELEMENT*					GetWriteMap(uint32) const;
 
+	//Returns a host pointer to 'address' if it lies in a page entirely backed by memory, nullptr otherwise
+	uint8*									GetReadPointer(uint32 address) const { return m_readPages.GetPointer(address); }
+	uint8*									GetWritePointer(uint32 address) const { return m_writePages.GetPointer(address); }
+
+	//Calls the access handler of a memory element, if any. Such elements never get direct page pointers.
+	static void								NotifyAccess(const MEMORYMAPELEMENT* element, uint32 address)
+	{
+		if(element->handler) element->handler(address, 0);
+	}
+
 protected:
 	typedef std::vector<MEMORYMAPELEMENT> MemoryMapListType;
 
+	//Two level page table indexing map elements by 4KB pages.
+	//A page only has an entry if a single element covers it entirely, other pages fall back to a scan of the element list.
+	class CPageTable
+	{
+	public:
+		struct PAGE
+		{
+			uint8*							pointer = nullptr;
+			const MEMORYMAPELEMENT*			element = nullptr;
+		};
+
+		void								Build(const MemoryMapListType&);
+
+		const PAGE*							GetPage(uint32 address) const
+		{
+			const auto& table = m_directory[address >> DIRECTORY_SHIFT];
+			if(!table) return nullptr;
+			return &table[(address >> PAGE_SHIFT) & (TABLE_SIZE - 1)];
+		}
+
+		uint8*								GetPointer(uint32 address) const
+		{
+			auto page = GetPage(address);
+			if(!page || !page->pointer) return nullptr;
+			return page->pointer + (address & PAGE_MASK);
+		}
+
+	private:
+		enum
+		{
+			DIRECTORY_SHIFT = 22,
+			DIRECTORY_SIZE = (1 << (32 - DIRECTORY_SHIFT)),
+			TABLE_SIZE = (1 << (DIRECTORY_SHIFT - PAGE_SHIFT)),
+		};
+
+		typedef std::unique_ptr<PAGE[]> TablePtr;
+
+		TablePtr							m_directory[DIRECTORY_SIZE];
+	};
+
 	static const MEMORYMAPELEMENT*			GetMap(const MemoryMapListType&, uint32);
+	static const MEMORYMAPELEMENT*			GetMap(const CPageTable&, const MemoryMapListType&, uint32);
 
 	MemoryMapListType						m_instructionMap;
 	MemoryMapListType						m_readMap;
 	MemoryMapListType						m_writeMap;
 
+	CPageTable								m_instructionPages;
+	CPageTable								m_readPages;
+	CPageTable								m_writePages;
+
 private:
 	static void								InsertMap(MemoryMapListType&, uint32, uint32, void*, unsigned char);
 	static void								InsertMap(MemoryMapListType&, uint32, uint32, const MemoryMapHandlerType&, unsigned char);
+	static void								InsertMap(MemoryMapListType&, uint32, uint32, void*, const MemoryMapHandlerType&, unsigned char);
 };
 
 class CMemoryMap_LSBF : public CMemoryMap
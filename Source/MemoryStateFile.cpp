@@ -1,11 +1,16 @@
 #include "MemoryStateFile.h"
+#include "StateSnapshot.h"
 
 CMemoryStateFile::CMemoryStateFile(const char* name, const void* memory, size_t size) 
 : CZipFile(name)
 , m_memory(memory)
 , m_size(size)
 {
-
+	//Memory is only read when the archive is written, which might happen on another thread
+	if(auto snapshot = CStateSnapshot::GetCurrent())
+	{
+		m_memory = snapshot->CaptureRegion(name, memory, size);
+	}
 }
 
 CMemoryStateFile::~CMemoryStateFile()
@@ -19,6 +19,10 @@ uint32 MemoryUtils_GetWordProxy(CMIPS* pCtx, uint32 nAddress)
 uint64 MemoryUtils_GetDoubleProxy(CMIPS* context, uint32 address)
 {
 	assert((address & 0x07) == 0);
+	if(uint8* memory = context->m_pMemoryMap->GetReadPointer(address))
+	{
+		return *reinterpret_cast<uint64*>(memory);
+	}
 	const CMemoryMap::MEMORYMAPELEMENT* e = context->m_pMemoryMap->GetReadMap(address);
 	INTEGER64 result;
 #ifdef _DEBUG
@@ -29,6 +33,7 @@ uint64 MemoryUtils_GetDoubleProxy(CMIPS* context, uint32 address)
 		switch(e->nType)
 		{
 		case CMemoryMap::MEMORYMAP_TYPE_MEMORY:
+			CMemoryMap::NotifyAccess(e, address);
 			result.q = *reinterpret_cast<uint64*>(reinterpret_cast<uint8*>(e->pPointer) + (address - e->nStart));
 			break;
 		case CMemoryMap::MEMORYMAP_TYPE_FUNCTION:
@@ -48,6 +53,10 @@ uint64 MemoryUtils_GetDoubleProxy(CMIPS* context, uint32 address)
 uint128 MemoryUtils_GetQuadProxy(CMIPS* context, uint32 address)
 {
 	address &= ~0x0F;
+	if(uint8* memory = context->m_pMemoryMap->GetReadPointer(address))
+	{
+		return *reinterpret_cast<uint128*>(memory);
+	}
 	const CMemoryMap::MEMORYMAPELEMENT* e = context->m_pMemoryMap->GetReadMap(address);
 	uint128 result;
 #ifdef _DEBUG
@@ -58,6 +67,7 @@ uint128 MemoryUtils_GetQuadProxy(CMIPS* context, uint32 address)
 		switch(e->nType)
 		{
 		case CMemoryMap::MEMORYMAP_TYPE_MEMORY:
+			CMemoryMap::NotifyAccess(e, address);
 			result = *reinterpret_cast<uint128*>(reinterpret_cast<uint8*>(e->pPointer) + (address - e->nStart));
 			break;
 		case CMemoryMap::MEMORYMAP_TYPE_FUNCTION:
@@ -94,6 +104,11 @@ void MemoryUtils_SetDoubleProxy(CMIPS* context, uint64 value64, uint32 address)
 	assert((address & 0x07) == 0);
 	INTEGER64 value;
 	value.q = value64;
+	if(uint8* memory = context->m_pMemoryMap->GetWritePointer(address))
+	{
+		*reinterpret_cast<uint64*>(memory) = value.q;
+		return;
+	}
 	const CMemoryMap::MEMORYMAPELEMENT* e = context->m_pMemoryMap->GetWriteMap(address);
 	if(e == NULL) 
 	{
@@ -104,6 +119,7 @@ void MemoryUtils_SetDoubleProxy(CMIPS* context, uint64 value64, uint32 address)
 	switch(e->nType)
 	{
 	case CMemoryMap::MEMORYMAP_TYPE_MEMORY:
+		CMemoryMap::NotifyAccess(e, address);
 		*reinterpret_cast<uint64*>(reinterpret_cast<uint8*>(e->pPointer) + (address - e->nStart)) = value.q;
 		break;
 	case CMemoryMap::MEMORYMAP_TYPE_FUNCTION:
@@ -121,6 +137,11 @@ void MemoryUtils_SetDoubleProxy(CMIPS* context, uint64 value64, uint32 address)
 void MemoryUtils_SetQuadProxy(CMIPS* context, const uint128& value, uint32 address)
 {
 	address &= ~0x0F;
+	if(uint8* memory = context->m_pMemoryMap->GetWritePointer(address))
+	{
+		*reinterpret_cast<uint128*>(memory) = value;
+		return;
+	}
 	const CMemoryMap::MEMORYMAPELEMENT* e = context->m_pMemoryMap->GetWriteMap(address);
 	if(e == NULL) 
 	{
@@ -131,6 +152,7 @@ void MemoryUtils_SetQuadProxy(CMIPS* context, const uint128& value, uint32 addre
 	switch(e->nType)
 	{
 	case CMemoryMap::MEMORYMAP_TYPE_MEMORY:
+		CMemoryMap::NotifyAccess(e, address);
 		*reinterpret_cast<uint128*>(reinterpret_cast<uint8*>(e->pPointer) + (address - e->nStart)) = value;
 		break;
 	case CMemoryMap::MEMORYMAP_TYPE_FUNCTION:
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include "MipsExecutor.h"
+#include "MIPSAnalysis.h"
 
 static bool IsInsideRange(uint32 address, uint32 start, uint32 end)
 {
@@ -31,6 +33,8 @@ CMipsExecutor::CMipsExecutor(CMIPS& context, uint32 maxAddress)
 
 CMipsExecutor::~CMipsExecutor()
 {
+	//Worker might still be compiling a block
+	m_compileQueue.reset();
 	for(unsigned int i = 0; i < m_subTableCount; i++)
 	{
 		CBasicBlock** subTable = m_blockTable[i];
@@ -49,6 +53,16 @@ void CMipsExecutor::Reset()
 
 void CMipsExecutor::ClearActiveBlocks()
 {
+	if(m_compileQueue)
+	{
+		m_compileQueue->Flush();
+	}
+	for(const auto& blockPair : m_blocks)
+	{
+		blockPair.second->UnlinkBlocks();
+	}
+	OnBlocksRemoved();
+
 	for(unsigned int i = 0; i < m_subTableCount; i++)
 	{
 		CBasicBlock** subTable = m_blockTable[i];
@@ -62,6 +76,100 @@ void CMipsExecutor::ClearActiveBlocks()
 	m_blocks.clear();
 }
 
+void CMipsExecutor::SetBlockCache(CBlockCache* blockCache)
+{
+	//Previous cache might go away, make sure the worker isn't using it
+	if(m_compileQueue)
+	{
+		m_compileQueue->Flush();
+	}
+	m_blockCache = blockCache;
+}
+
+void CMipsExecutor::SetBackgroundCompileEnabled(bool enabled)
+{
+	if(enabled == (m_compileQueue != nullptr)) return;
+	if(enabled)
+	{
+		m_compileQueue = std::make_unique<CBlockCompileQueue>();
+	}
+	else
+	{
+		m_compileQueue.reset();
+	}
+}
+
+CBlockCompileQueue* CMipsExecutor::GetCompileQueue() const
+{
+	return m_compileQueue.get();
+}
+
+void CMipsExecutor::SetLoopBlocksEnabled(bool loopBlocksEnabled)
+{
+	m_loopBlocksEnabled = loopBlocksEnabled;
+}
+
+void CMipsExecutor::OnBlocksRemoved()
+{
+	m_blockRemovalCount++;
+	//A loop block might be running, make it return to the executor
+	m_context.m_loopIterationLimit = 0;
+}
+
+void CMipsExecutor::SetBusyWaitAddressHandler(const BusyWaitAddressHandler& busyWaitAddressHandler)
+{
+	m_busyWaitAddressHandler = busyWaitAddressHandler;
+}
+
+bool CMipsExecutor::IsBusyWaiting() const
+{
+	return m_busyWaiting;
+}
+
+bool CMipsExecutor::IsEnteringBusyWaitLoop(CBasicBlock* block, CBasicBlock* nextBlock)
+{
+	uint32 loopBegin = nextBlock->GetBeginAddress();
+	if(loopBegin > block->GetBeginAddress())
+	{
+		//Going forward, stop watching the loop if we've left it
+		if((m_busyWaitLoopBegin != MIPS_INVALID_PC) && (loopBegin > m_busyWaitLoopEnd))
+		{
+			m_busyWaitLoopBegin = MIPS_INVALID_PC;
+		}
+		return false;
+	}
+
+	uint32 loopEnd = block->GetEndAddress();
+	if((loopBegin != m_busyWaitLoopBegin) || (loopEnd != m_busyWaitLoopEnd))
+	{
+		//First time going back, CPU might have entered the loop from the middle.
+		//It needs to go through a whole iteration before we know it's stuck.
+		auto& loopInfo = block->GetBusyWaitLoopInfo();
+		if((loopInfo.loopBegin != loopBegin) || (loopInfo.generation != m_blockRemovalCount))
+		{
+			loopInfo.loopBegin = loopBegin;
+			loopInfo.generation = m_blockRemovalCount;
+			loopInfo.isBusyWaitLoop = CMIPSAnalysis::IsBusyWaitLoop(&m_context, loopBegin, loopEnd);
+		}
+		m_busyWaitLoopBegin = loopInfo.isBusyWaitLoop ? loopBegin : MIPS_INVALID_PC;
+		m_busyWaitLoopEnd = loopEnd;
+		m_busyWaitLoopRejected = false;
+		return false;
+	}
+
+	if(m_busyWaitLoopRejected) return false;
+
+	//Polled addresses depend on register values, they can only be checked now
+	if(CMIPSAnalysis::GetBusyWaitLoopReads(&m_context, loopBegin, loopEnd, m_busyWaitReads))
+	{
+		bool canWait = std::all_of(m_busyWaitReads.begin(), m_busyWaitReads.end(),
+			[this] (uint32 address) { return m_busyWaitAddressHandler(address); });
+		if(canWait) return true;
+	}
+	m_busyWaitLoopRejected = true;
+	return false;
+}
+
 void CMipsExecutor::ClearActiveBlocksInRange(uint32 start, uint32 end)
 {
 	ClearActiveBlocksInRangeInternal(start, end, nullptr);
@@ -99,45 +207,104 @@ void CMipsExecutor::ClearActiveBlocksInRangeInternal(uint32 start, uint32 end, C
 
 	if(!blocksToDelete.empty())
 	{
-		m_blocks.remove_if([&] (const BasicBlockPtr& block) { return blocksToDelete.find(block.get()) != std::end(blocksToDelete); });
+		for(const auto& block : blocksToDelete)
+		{
+			block->UnlinkBlocks();
+		}
+		OnBlocksRemoved();
+		for(const auto& block : blocksToDelete)
+		{
+			m_blocks.erase(block);
+		}
+		if(m_compileQueue)
+		{
+			//Caller is about to write over the range, worker might be reading code of one of
+			//the removed blocks. Queued removed blocks are skipped once the worker sees them.
+			m_compileQueue->WaitIdle();
+		}
 	}
 }
 
 int CMipsExecutor::Execute(int cycles)
 {
 	CBasicBlock* block(nullptr);
+	m_busyWaiting = false;
+	m_busyWaitLoopBegin = MIPS_INVALID_PC;
 	while(cycles > 0)
 	{
-		uint32 address = m_context.m_pAddrTranslator(&m_context, m_context.m_State.nPC);
-		if(!block || address != block->GetBeginAddress())
+		CBasicBlock* nextBlock = (block != nullptr) ? block->GetLinkedBlock(m_context.m_State.nPC) : nullptr;
+		if(nextBlock == nullptr)
 		{
-			block = FindBlockStartingAt(address);
-			if(block == NULL)
+			uint32 address = m_context.m_pAddrTranslator(&m_context, m_context.m_State.nPC);
+			if(block && (address == block->GetBeginAddress()))
+			{
+				nextBlock = block;
+			}
+			else
 			{
-				//We need to partition the space and compile the blocks
-				PartitionFunction(address);
-				block = FindBlockStartingAt(address);
-				if(block == NULL)
+				nextBlock = FindBlockStartingAt(address);
+				if(nextBlock == NULL)
+				{
+					//We need to partition the space and compile the blocks
+					PartitionFunction(address);
+					nextBlock = FindBlockStartingAt(address);
+					if(nextBlock == NULL)
+					{
+						throw std::runtime_error("Couldn't create block starting at address.");
+					}
+				}
+				if(!nextBlock->IsCompiled())
 				{
-					throw std::runtime_error("Couldn't create block starting at address.");
+					if(m_compileQueue)
+					{
+						m_compileQueue->EnsureCompiled(nextBlock);
+					}
+					else
+					{
+						nextBlock->Compile();
+					}
 				}
 			}
-			if(!block->IsCompiled())
+			if(block != nullptr)
 			{
-				block->Compile();
+				block->LinkBlock(m_context.m_State.nPC, address, nextBlock);
 			}
 		}
-		else if(block != NULL)
+
+		if(nextBlock == block)
 		{
 			block->SetSelfLoopCount(block->GetSelfLoopCount() + 1);
 		}
+		if(m_busyWaitAddressHandler && (block != nullptr) && IsEnteringBusyWaitLoop(block, nextBlock))
+		{
+			//Nothing will change until something else modifies memory, no need to go around the loop until then
+			m_busyWaiting = true;
+			break;
+		}
+		block = nextBlock;
 
 #ifdef DEBUGGER_INCLUDED
 		if(!m_breakpointsDisabledOnce && MustBreak()) break;
 		m_breakpointsDisabledOnce = false;
 #endif
+		if(block->IsLoop())
+		{
+			//Lets the block go around the loop for what's left of the time slice
+			uint32 blockSize = ((block->GetEndAddress() - block->GetBeginAddress()) / 4) + 1;
+			m_context.m_loopIterationLimit = static_cast<uint32>(cycles) / blockSize;
+#ifdef DEBUGGER_INCLUDED
+			if(!m_context.m_breakpoints.empty()) m_context.m_loopIterationLimit = 0;
+#endif
+		}
+		uint32 blockRemovalCount = m_blockRemovalCount;
 		cycles -= block->Execute();
 		if(m_context.m_State.nHasException) break;
+		if(blockRemovalCount != m_blockRemovalCount)
+		{
+			//Block might have been removed while it was running, don't use its links
+			block = nullptr;
+			m_busyWaitLoopBegin = MIPS_INVALID_PC;
+		}
 	}
 	return cycles;
 }
@@ -194,7 +361,7 @@ CBasicBlock* CMipsExecutor::FindBlockStartingAt(uint32 address) const
 	return result;
 }
 
-void CMipsExecutor::CreateBlock(uint32 start, uint32 end)
+void CMipsExecutor::CreateBlock(uint32 start, uint32 end, bool isLoop)
 {
 	{
 		CBasicBlock* block = FindBlockAt(start);
@@ -232,6 +399,12 @@ void CMipsExecutor::CreateBlock(uint32 start, uint32 end)
 	assert(FindBlockAt(end) == NULL);
 	{
 		BasicBlockPtr block = BlockFactory(m_context, start, end);
+		block->SetBlockCache(m_blockCache);
+		block->SetCodeArena(&m_codeArena);
+		if(isLoop)
+		{
+			block->SetIsLoop(true);
+		}
 		for(uint32 address = block->GetBeginAddress(); address <= block->GetEndAddress(); address += 4)
 		{
 			uint32 hiAddress = address >> 16;
@@ -247,12 +420,19 @@ void CMipsExecutor::CreateBlock(uint32 start, uint32 end)
 			assert(subTable[loAddress / 4] == NULL);
 			subTable[loAddress / 4] = block.get();
 		}
-		m_blocks.push_back(std::move(block));
+		if(m_compileQueue)
+		{
+			m_compileQueue->QueueBlock(block);
+		}
+		m_blocks.insert(std::make_pair(block.get(), std::move(block)));
 	}
 }
 
 void CMipsExecutor::DeleteBlock(CBasicBlock* block)
 {
+	block->UnlinkBlocks();
+	OnBlocksRemoved();
+
 	for(uint32 address = block->GetBeginAddress(); address <= block->GetEndAddress(); address += 4)
 	{
 		uint32 hiAddress = address >> 16;
@@ -265,7 +445,7 @@ void CMipsExecutor::DeleteBlock(CBasicBlock* block)
 	}
 
 	//Remove block from our lists
-	auto blockIterator = std::find_if(std::begin(m_blocks), std::end(m_blocks), [&] (const BasicBlockPtr& blockPtr) { return blockPtr.get() == block; });
+	auto blockIterator = m_blocks.find(block);
 	assert(blockIterator != std::end(m_blocks));
 	m_blocks.erase(blockIterator);
 }
@@ -305,6 +485,8 @@ void CMipsExecutor::PartitionFunction(uint32 functionAddress)
 		}
 	}
 
+	uint32 lastAddress = *partitionPoints.rbegin() - 4;
+
 	//Find partition points within the function
 	for(uint32 address = functionAddress; address <= endAddress; address += 4)
 	{
@@ -337,6 +519,12 @@ void CMipsExecutor::PartitionFunction(uint32 functionAddress)
 		}
 	}
 
+	PartitionPointSet loopBegins;
+	if(m_loopBlocksEnabled)
+	{
+		FindLoopBlocks(functionAddress, lastAddress, partitionPoints, loopBegins);
+	}
+
 	//Check if blocks are too big
 	{
 		uint32 currentPoint = -1;
@@ -368,9 +556,48 @@ void CMipsExecutor::PartitionFunction(uint32 functionAddress)
 		{
 			if(currentPoint != -1)
 			{
-				CreateBlock(currentPoint, *pointIterator - 4);
+				CreateBlock(currentPoint, *pointIterator - 4, loopBegins.find(currentPoint) != std::end(loopBegins));
 			}
 			currentPoint = *pointIterator;
 		}
 	}
 }
+
+void CMipsExecutor::FindLoopBlocks(uint32 functionAddress, uint32 lastAddress, std::set<uint32>& partitionPoints, std::set<uint32>& loopBegins)
+{
+	//Branches into a loop can come from anywhere in the subroutine, look at all of it if it's known
+	uint32 searchBegin = functionAddress;
+	uint32 searchEnd = lastAddress;
+	if(auto subroutine = m_context.m_analysis->FindSubroutine(functionAddress))
+	{
+		searchBegin = std::min<uint32>(searchBegin, subroutine->start);
+		searchEnd = std::max<uint32>(searchEnd, subroutine->end);
+	}
+
+	CMIPSAnalysis::LoopRegionArray loops;
+	CMIPSAnalysis::FindCompilableLoops(&m_context, searchBegin, searchEnd, loops);
+	for(const auto& loop : loops)
+	{
+		if((loop.begin < functionAddress) || (loop.end > lastAddress)) continue;
+
+		//Nothing to gain on loops waiting for something to happen, the executor stops on them
+		if(CMIPSAnalysis::IsBusyWaitLoop(&m_context, loop.begin, loop.end)) continue;
+
+		//Code already split in blocks stays that way (ie.: loop was entered from somewhere else before)
+		bool used = false;
+		for(uint32 address = loop.begin; address <= loop.end; address += 4)
+		{
+			if(FindBlockAt(address) != nullptr)
+			{
+				used = true;
+				break;
+			}
+		}
+		if(used) continue;
+
+		partitionPoints.erase(partitionPoints.upper_bound(loop.begin), partitionPoints.upper_bound(loop.end));
+		partitionPoints.insert(loop.begin);
+		partitionPoints.insert(loop.end + 4);
+		loopBegins.insert(loop.begin);
+	}
+}
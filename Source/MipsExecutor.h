@@ -1,9 +1,14 @@
 #ifndef _MIPSEXECUTOR_H_
 #define _MIPSEXECUTOR_H_
 
-#include <list>
+#include <set>
+#include <vector>
+#include <unordered_map>
+#include <functional>
 #include "MIPS.h"
 #include "BasicBlock.h"
+#include "BlockCompileQueue.h"
+#include "CodeArena.h"
 
 class CMipsExecutor
 {
@@ -18,6 +23,24 @@ public:
 	void						ClearActiveBlocks();
 	virtual void				ClearActiveBlocksInRange(uint32, uint32);
 
+	//Blocks created after this call will use the cache to load and store compiled code
+	void						SetBlockCache(CBlockCache*);
+
+	//New blocks are compiled on a worker thread while the CPU runs, the CPU only waits for blocks it reaches first
+	void						SetBackgroundCompileEnabled(bool);
+	CBlockCompileQueue*			GetCompileQueue() const;
+
+	//Loops found when partitioning functions are compiled as a single block (see CMIPSAnalysis::FindCompilableLoops)
+	void						SetLoopBlocksEnabled(bool);
+
+	//Lets Execute stop when the CPU goes around a loop that only polls memory (see CMIPSAnalysis::IsBusyWaitLoop).
+	//The handler tells if a physical address can be waited on, ie.: its value only changes when an event is processed.
+	typedef std::function<bool (uint32)> BusyWaitAddressHandler;
+	void						SetBusyWaitAddressHandler(const BusyWaitAddressHandler&);
+
+	//True if the last call to Execute stopped at the beginning of a busy-wait loop
+	bool						IsBusyWaiting() const;
+
 #ifdef DEBUGGER_INCLUDED
 	bool						MustBreak() const;
 	void						DisableBreakpointsOnce();
@@ -25,20 +48,42 @@ public:
 
 protected:
 	typedef std::shared_ptr<CBasicBlock> BasicBlockPtr;
-	typedef std::list<BasicBlockPtr> BlockList;
+	//Keyed by the block itself, removing a block doesn't need to go through all of them
+	typedef std::unordered_map<CBasicBlock*, BasicBlockPtr> BlockMap;
 
-	void						CreateBlock(uint32, uint32);
+	void						CreateBlock(uint32, uint32, bool = false);
 	virtual BasicBlockPtr		BlockFactory(CMIPS&, uint32, uint32);
 	virtual void				PartitionFunction(uint32);
 	
 	void						ClearActiveBlocksInRangeInternal(uint32, uint32, CBasicBlock*);
+	void						OnBlocksRemoved();
+	void						FindLoopBlocks(uint32, uint32, std::set<uint32>&, std::set<uint32>&);
 
-	BlockList					m_blocks;
+	bool						IsEnteringBusyWaitLoop(CBasicBlock*, CBasicBlock*);
+
+	//Declared before the blocks, must be destroyed after them
+	CCodeArena					m_codeArena;
+	BlockMap					m_blocks;
 	CMIPS&						m_context;
 
 	CBasicBlock***				m_blockTable;
 	uint32						m_subTableCount;
 
+	CBlockCache*				m_blockCache = nullptr;
+	std::unique_ptr<CBlockCompileQueue>	m_compileQueue;
+
+	//Incremented every time blocks are removed, lets Execute know that the last block might be gone
+	uint32						m_blockRemovalCount = 0;
+	bool						m_loopBlocksEnabled = false;
+
+	BusyWaitAddressHandler		m_busyWaitAddressHandler;
+	bool						m_busyWaiting = false;
+	//Loop the CPU went back to the beginning of, stays set while it doesn't leave it
+	uint32						m_busyWaitLoopBegin = MIPS_INVALID_PC;
+	uint32						m_busyWaitLoopEnd = MIPS_INVALID_PC;
+	bool						m_busyWaitLoopRejected = false;
+	std::vector<uint32>			m_busyWaitReads;
+
 #ifdef DEBUGGER_INCLUDED
 	bool						m_breakpointsDisabledOnce;
 #endif
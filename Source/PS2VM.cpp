@@ -2,6 +2,7 @@
 #include <exception>
 #include <boost/filesystem.hpp>
 #include <memory>
+#include <algorithm>
 #include <fenv.h>
 #include "make_unique.h"
 #include "PS2VM.h"
@@ -25,6 +26,8 @@
 #include "Log.h"
 #include "ISO9660/BlockProvider.h"
 #include "DiskUtils.h"
+#include "ImageBlockCache.h"
+#include "StateSnapshot.h"
 
 #define LOG_NAME		("ps2vm")
 
@@ -32,11 +35,23 @@
 #define PREF_PS2_MC0_DIRECTORY_DEFAULT		("vfs/mc0")
 #define PREF_PS2_MC1_DIRECTORY_DEFAULT		("vfs/mc1")
 
+#define JITCACHE_PATH		("jitcache/")
+#define SHADERCACHE_PATH	("shadercache/")
+
 #define FRAME_TICKS			(PS2::EE_CLOCK_FREQ / 60)
 #define ONSCREEN_TICKS		(FRAME_TICKS * 9 / 10)
 #define VBLANK_TICKS		(FRAME_TICKS / 10)
 
-#define SPU_UPDATE_TICKS	(PS2::IOP_CLOCK_OVER_FREQ / 1000)
+//EE CPU is 8 times faster than the IOP CPU, all scheduler times are in EE ticks
+#define EE_IOP_CLOCK_RATIO	(8)
+
+#define SPU_UPDATE_TICKS		((PS2::IOP_CLOCK_OVER_FREQ / 1000) * EE_IOP_CLOCK_RATIO)
+#define IOP_DMA_UPDATE_TICKS	(Iop::CSubSystem::DMA_UPDATE_TICKS * EE_IOP_CLOCK_RATIO)
+
+//Longest amount of time a processor can run before synchronizing with the other one
+#define MAX_SLICE_TICKS			(4800)
+//When both processors are idle, they can wait longer for the next event
+#define MAX_IDLE_SLICE_TICKS	(MAX_SLICE_TICKS * 4)
 
 namespace filesystem = boost::filesystem;
 
@@ -48,11 +63,9 @@ CPS2VM::CPS2VM()
 , m_singleStepIop(false)
 , m_singleStepVu0(false)
 , m_singleStepVu1(false)
-, m_vblankTicks(0)
 , m_inVblank(false)
 , m_eeExecutionTicks(0)
 , m_iopExecutionTicks(0)
-, m_spuUpdateTicks(SPU_UPDATE_TICKS)
 , m_eeProfilerZone(CProfiler::GetInstance().RegisterZone("EE"))
 , m_iopProfilerZone(CProfiler::GetInstance().RegisterZone("IOP"))
 , m_spuProfilerZone(CProfiler::GetInstance().RegisterZone("SPU"))
@@ -78,11 +91,24 @@ CPS2VM::CPS2VM()
 		CAppConfig::GetInstance().RegisterPreferenceString(setting, absolutePath.string().c_str());
 	}
 	
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_JITCACHE_ENABLED, true);
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_DISKCACHE_SIZE, CImageBlockCache::DEFAULT_MEMORY_BUDGET_MB);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_FASTMEM_ENABLED, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_BACKGROUNDJIT_ENABLED, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_LOOPBLOCKS_ENABLED, false);
+
 	m_iop = std::make_unique<Iop::CSubSystem>(true);
 	m_iopOs = std::make_shared<CIopBios>(m_iop->m_cpu, m_iop->m_ram, PS2::IOP_RAM_SIZE, m_iop->m_scratchPad);
 
 	m_ee = std::make_unique<Ee::CSubSystem>(m_iop->m_ram, *m_iopOs);
 	m_ee->m_os->OnRequestLoadExecutable.connect(boost::bind(&CPS2VM::ReloadExecutable, this, _1, _2));
+
+	m_vblankEvent		= m_scheduler.RegisterEvent("vblank",		[this] () { OnVBlankEvent(); });
+	m_spuUpdateEvent	= m_scheduler.RegisterEvent("spu",			[this] () { OnSpuUpdateEvent(); });
+	m_iopDmaEvent		= m_scheduler.RegisterEvent("iop_dma",		[this] () { OnIopDmaEvent(); });
+	//Timer interrupts are raised when executed ticks are counted, these only end slices at the right time
+	m_eeTimerEvent		= m_scheduler.RegisterEvent("ee_timer",		[] () { });
+	m_iopCounterEvent	= m_scheduler.RegisterEvent("iop_counter",	[] () { });
 }
 
 CPS2VM::~CPS2VM()
@@ -226,11 +252,12 @@ void CPS2VM::Destroy()
 	DestroyVM();
 }
 
-unsigned int CPS2VM::SaveState(const char* sPath)
+std::future<bool> CPS2VM::SaveState(const char* sPath)
 {
-	unsigned int result = 0;
-	m_mailBox.SendCall(std::bind(&CPS2VM::SaveVMState, this, sPath, std::ref(result)), true);
-	return result;
+	auto promise = std::make_shared<std::promise<bool>>();
+	auto future = promise->get_future();
+	m_mailBox.SendCall(std::bind(&CPS2VM::SaveVMState, this, std::string(sPath), promise), true);
+	return future;
 }
 
 unsigned int CPS2VM::LoadState(const char* sPath)
@@ -353,6 +380,18 @@ void CPS2VM::ResetVM()
 	m_iop->Reset();
 	m_iop->SetBios(m_iopOs);
 
+	bool fastMemoryEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_FASTMEM_ENABLED);
+	m_ee->SetFastMemoryEnabled(fastMemoryEnabled);
+	m_iop->SetFastMemoryEnabled(fastMemoryEnabled);
+
+	bool backgroundJitEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_BACKGROUNDJIT_ENABLED);
+	m_ee->m_executor.SetBackgroundCompileEnabled(backgroundJitEnabled);
+	m_iop->m_executor.SetBackgroundCompileEnabled(backgroundJitEnabled);
+
+	bool loopBlocksEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_LOOPBLOCKS_ENABLED);
+	m_ee->m_executor.SetLoopBlocksEnabled(loopBlocksEnabled);
+	m_iop->m_executor.SetLoopBlocksEnabled(loopBlocksEnabled);
+
 	//LoadBIOS();
 
 	if(m_ee->m_gs != NULL)
@@ -363,6 +402,8 @@ void CPS2VM::ResetVM()
 	m_iopOs->Reset(std::make_shared<Iop::CSifManPs2>(m_ee->m_sif, m_ee->m_ram, m_iop->m_ram));
 
 	CDROM0_Reset();
+	OpenBlockCaches();
+	OpenShaderCache();
 
 	m_iopOs->GetIoman()->RegisterDevice("host", Iop::CIoman::DevicePtr(new Iop::Ioman::CDirectoryDevice(PREF_PS2_HOST_DIRECTORY)));
 	m_iopOs->GetIoman()->RegisterDevice("mc0", Iop::CIoman::DevicePtr(new Iop::Ioman::CDirectoryDevice(PREF_PS2_MC0_DIRECTORY)));
@@ -372,54 +413,87 @@ void CPS2VM::ResetVM()
 
 	m_iopOs->GetLoadcore()->SetLoadExecutableHandler(std::bind(&CPS2OS::LoadExecutable, m_ee->m_os, std::placeholders::_1, std::placeholders::_2));
 
-	m_vblankTicks = ONSCREEN_TICKS;
 	m_inVblank = false;
 
 	m_eeExecutionTicks = 0;
 	m_iopExecutionTicks = 0;
 
-	m_spuUpdateTicks = SPU_UPDATE_TICKS;
-	m_currentSpuBlock = 0;
+	m_scheduler.Reset();
+	m_scheduler.ScheduleEvent(m_vblankEvent, ONSCREEN_TICKS);
+	m_scheduler.ScheduleEvent(m_spuUpdateEvent, SPU_UPDATE_TICKS);
+	m_scheduler.ScheduleEvent(m_iopDmaEvent, IOP_DMA_UPDATE_TICKS);
 
 	RegisterModulesInPadHandler();
 }
 
 void CPS2VM::DestroyVM()
 {
+	WaitForStateWrite();
+	m_stateSnapshot.Clear();
+	CloseBlockCaches();
 	CDROM0_Destroy();
 }
 
-void CPS2VM::SaveVMState(const char* sPath, unsigned int& result)
+void CPS2VM::SaveVMState(const std::string& statePath, const SaveStatePromisePtr& promise)
 {
 	if(m_ee->m_gs == NULL)
 	{
 		printf("PS2VM: GS Handler was not instancied. Cannot save state.\r\n");
-		result = 1;
+		promise->set_value(false);
 		return;
 	}
 
+	//Previous state might still be written from the snapshot we're about to update
+	WaitForStateWrite();
+
+	auto archive = std::make_shared<Framework::CZipArchiveWriter>();
 	try
 	{
-		Framework::CStdStream stateStream(sPath, "wb");
-		Framework::CZipArchiveWriter archive;
+		CStateSnapshot::CCaptureScope captureScope(m_stateSnapshot);
 
-		m_ee->SaveState(archive);
-		m_iop->SaveState(archive);
-		m_ee->m_gs->SaveState(archive);
-		m_iopOs->GetPadman()->SaveState(archive);
+		m_ee->SaveState(*archive);
+		m_iop->SaveState(*archive);
+		m_ee->m_gs->SaveState(*archive);
+		m_iopOs->GetPadman()->SaveState(*archive);
 		//TODO: Save CDVDFSV state
-
-		archive.Write(stateStream);
 	}
 	catch(...)
 	{
-		result = 1;
+		promise->set_value(false);
 		return;
 	}
 
-	printf("PS2VM: Saved state to file '%s'.\r\n", sPath);
+	CLog::GetInstance().Print(LOG_NAME, "Captured state, copied %d of %d bytes.\r\n",
+		static_cast<int>(m_stateSnapshot.GetCopiedSize()), static_cast<int>(m_stateSnapshot.GetCapturedSize()));
 
-	result = 0;
+	//Compression and disk I/O are done on another thread to let emulation carry on
+	m_stateWriteThread = std::thread(
+		[archive, statePath, promise] ()
+		{
+			try
+			{
+				Framework::CStdStream stateStream(statePath.c_str(), "wb");
+				archive->Write(stateStream);
+			}
+			catch(...)
+			{
+				promise->set_value(false);
+				return;
+			}
+
+			printf("PS2VM: Saved state to file '%s'.\r\n", statePath.c_str());
+
+			promise->set_value(true);
+		}
+	);
+}
+
+void CPS2VM::WaitForStateWrite()
+{
+	if(m_stateWriteThread.joinable())
+	{
+		m_stateWriteThread.join();
+	}
 }
 
 void CPS2VM::LoadVMState(const char* sPath, unsigned int& result)
@@ -431,17 +505,26 @@ void CPS2VM::LoadVMState(const char* sPath, unsigned int& result)
 		return;
 	}
 
+	//State being loaded might still be in the process of being written
+	WaitForStateWrite();
+
 	try
 	{
 		Framework::CStdStream stateStream(sPath, "rb");
 		Framework::CZipArchiveReader archive(stateStream);
-		
+
+		//GS state doesn't depend on anything else, it's decompressed in parallel
+		//using its own reader since readers can't be shared between threads
+		Framework::CStdStream gsStateStream(sPath, "rb");
+		Framework::CZipArchiveReader gsArchive(gsStateStream);
+
 		try
 		{
+			auto gsLoadFuture = std::async(std::launch::async, [&] () { m_ee->m_gs->LoadState(gsArchive); });
 			m_ee->LoadState(archive);
 			m_iop->LoadState(archive);
-			m_ee->m_gs->LoadState(archive);
 			m_iopOs->GetPadman()->LoadState(archive);
+			gsLoadFuture.get();
 		}
 		catch(...)
 		{
@@ -465,6 +548,7 @@ void CPS2VM::LoadVMState(const char* sPath, unsigned int& result)
 
 void CPS2VM::PauseImpl()
 {
+	m_audioStream.Stop();
 	m_nStatus = PAUSED;
 }
 
@@ -476,6 +560,10 @@ void CPS2VM::ResumeImpl()
 	m_ee->m_vpu1->DisableBreakpointsOnce();
 #endif
 	m_nStatus = RUNNING;
+	if(m_soundHandler != nullptr)
+	{
+		m_audioStream.Start(m_soundHandler);
+	}
 }
 
 void CPS2VM::DestroyImpl()
@@ -517,11 +605,16 @@ void CPS2VM::DestroyPadHandlerImpl()
 void CPS2VM::CreateSoundHandlerImpl(const CSoundHandler::FactoryFunction& factoryFunction)
 {
 	m_soundHandler = factoryFunction();
+	if(m_nStatus == RUNNING)
+	{
+		m_audioStream.Start(m_soundHandler);
+	}
 }
 
 void CPS2VM::DestroySoundHandlerImpl()
 {
 	if(m_soundHandler == nullptr) return;
+	m_audioStream.Stop();
 	delete m_soundHandler;
 	m_soundHandler = nullptr;
 }
@@ -574,7 +667,6 @@ void CPS2VM::UpdateEe()
 
 		m_eeExecutionTicks -= executed;
 		m_ee->CountTicks(executed);
-		m_vblankTicks -= executed;
 
 #ifdef DEBUGGER_INCLUDED
 		if(m_singleStepEe) break;
@@ -604,7 +696,6 @@ void CPS2VM::UpdateIop()
 #endif
 
 		m_iopExecutionTicks -= executed;
-		m_spuUpdateTicks -= executed;
 		m_iop->CountTicks(executed);
 
 #ifdef DEBUGGER_INCLUDED
@@ -620,9 +711,7 @@ void CPS2VM::UpdateSpu()
 	CProfilerZone profilerZone(m_spuProfilerZone);
 #endif
 
-	unsigned int blockOffset = (BLOCK_SIZE * m_currentSpuBlock);
-	int16* samplesSpu0 = m_samples + blockOffset;
-
+	int16 samplesSpu0[BLOCK_SIZE];
 	m_iop->m_spuCore0.Render(samplesSpu0, BLOCK_SIZE, 44100);
 
 	if(m_iop->m_spuCore1.IsEnabled())
@@ -630,27 +719,13 @@ void CPS2VM::UpdateSpu()
 		int16 samplesSpu1[BLOCK_SIZE];
 		m_iop->m_spuCore1.Render(samplesSpu1, BLOCK_SIZE, 44100);
 
-		for(unsigned int i = 0; i < BLOCK_SIZE; i++)
-		{
-			int32 resultSample = static_cast<int32>(samplesSpu0[i]) + static_cast<int32>(samplesSpu1[i]);
-			resultSample = std::max<int32>(resultSample, SHRT_MIN);
-			resultSample = std::min<int32>(resultSample, SHRT_MAX);
-			samplesSpu0[i] = static_cast<int16>(resultSample);
-		}
+		Iop::CSpuBase::MixOutput(samplesSpu0, samplesSpu1, BLOCK_SIZE);
 	}
 
-	m_currentSpuBlock++;
-	if(m_currentSpuBlock == BLOCK_COUNT)
+	//Samples are sent to the handler by the audio thread
+	if(m_audioStream.IsStarted())
 	{
-		if(m_soundHandler)
-		{
-			if(m_soundHandler->HasFreeBuffers())
-			{
-				m_soundHandler->RecycleBuffers();
-			}
-			m_soundHandler->Write(m_samples, BLOCK_SIZE * BLOCK_COUNT, 44100);
-		}
-		m_currentSpuBlock = 0;
+		m_audioStream.Write(samplesSpu0, BLOCK_SIZE);
 	}
 }
 
@@ -676,6 +751,9 @@ void CPS2VM::CDROM0_Mount(const char* path)
 	{
 		try
 		{
+			//Budget is in megabytes, only used by compressed images
+			size_t diskCacheSize = std::max<int>(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_DISKCACHE_SIZE), 1);
+			CImageBlockCache::GetInstance().SetMemoryBudget(diskCacheSize << 20);
 			m_cdrom0 = DiskUtils::CreateDiskImageFromPath(path);
 			SetIopCdImage(m_cdrom0.get());
 		}
@@ -694,6 +772,89 @@ void CPS2VM::CDROM0_Destroy()
 	m_cdrom0.reset();
 }
 
+void CPS2VM::OpenBlockCaches()
+{
+	CloseBlockCaches();
+
+	if(!CBlockCache::IsSupported()) return;
+	if(!CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_JITCACHE_ENABLED)) return;
+
+	//Compiled code is kept per game, only possible when booting from a disk image
+	std::string diskId;
+	if(!TryGetDiskId(diskId)) return;
+
+	try
+	{
+		auto cachePath = CAppConfig::GetBasePath() / boost::filesystem::path(JITCACHE_PATH) / diskId;
+		Framework::PathUtils::EnsurePathExists(cachePath);
+
+		//Code compiled with fast memory accesses can't be shared with code compiled without them
+		bool fastMemoryEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_FASTMEM_ENABLED);
+		m_eeBlockCache = std::make_unique<CBlockCache>(cachePath / (fastMemoryEnabled ? "ee_fastmem.blockcache" : "ee.blockcache"));
+		m_iopBlockCache = std::make_unique<CBlockCache>(cachePath / (fastMemoryEnabled ? "iop_fastmem.blockcache" : "iop.blockcache"));
+		m_vu0BlockCache = std::make_unique<CBlockCache>(cachePath / "vu0.blockcache");
+		m_vu1BlockCache = std::make_unique<CBlockCache>(cachePath / "vu1.blockcache");
+	}
+	catch(const std::exception& exception)
+	{
+		printf("PS2VM: Failed to open JIT cache for '%s': %s\r\n", diskId.c_str(), exception.what());
+		CloseBlockCaches();
+		return;
+	}
+
+	m_ee->m_executor.SetBlockCache(m_eeBlockCache.get());
+	m_iop->m_executor.SetBlockCache(m_iopBlockCache.get());
+	m_ee->m_vpu0->GetExecutor().SetBlockCache(m_vu0BlockCache.get());
+	m_ee->m_vpu1->GetExecutor().SetBlockCache(m_vu1BlockCache.get());
+
+	printf("PS2VM: Using JIT cache for '%s' (%d EE blocks, %d IOP blocks, %d VU0 blocks, %d VU1 blocks).\r\n", diskId.c_str(),
+		m_eeBlockCache->GetBlockCount(), m_iopBlockCache->GetBlockCount(), m_vu0BlockCache->GetBlockCount(), m_vu1BlockCache->GetBlockCount());
+}
+
+void CPS2VM::OpenShaderCache()
+{
+	if(m_ee->m_gs == nullptr) return;
+
+	//Shaders are kept per game, an empty path disables the cache
+	boost::filesystem::path cachePath;
+	std::string diskId;
+	if(TryGetDiskId(diskId))
+	{
+		try
+		{
+			cachePath = CAppConfig::GetBasePath() / boost::filesystem::path(SHADERCACHE_PATH) / diskId;
+			Framework::PathUtils::EnsurePathExists(cachePath);
+		}
+		catch(const std::exception& exception)
+		{
+			printf("PS2VM: Failed to create shader cache directory for '%s': %s\r\n", diskId.c_str(), exception.what());
+			cachePath.clear();
+		}
+	}
+	m_ee->m_gs->SetShaderCachePath(cachePath);
+}
+
+bool CPS2VM::TryGetDiskId(std::string& diskId)
+{
+	const char* cdrom0Path = CAppConfig::GetInstance().GetPreferenceString(PS2VM_CDROM0PATH);
+	if(strlen(cdrom0Path) == 0) return false;
+	return DiskUtils::TryGetDiskId(cdrom0Path, &diskId);
+}
+
+void CPS2VM::CloseBlockCaches()
+{
+	//Blocks created before this point keep their cache, they must have been cleared by a reset
+	m_ee->m_executor.SetBlockCache(nullptr);
+	m_iop->m_executor.SetBlockCache(nullptr);
+	m_ee->m_vpu0->GetExecutor().SetBlockCache(nullptr);
+	m_ee->m_vpu1->GetExecutor().SetBlockCache(nullptr);
+
+	m_eeBlockCache.reset();
+	m_iopBlockCache.reset();
+	m_vu0BlockCache.reset();
+	m_vu1BlockCache.reset();
+}
+
 void CPS2VM::SetIopCdImage(CISO9660* image)
 {
 	m_iopOs->GetCdvdfsv()->SetIsoImage(image);
@@ -715,6 +876,86 @@ void CPS2VM::ReloadExecutable(const char* executablePath, const CPS2OS::Argument
 	m_ee->m_os->BootFromVirtualPath(executablePath, arguments);
 }
 
+void CPS2VM::OnVBlankEvent()
+{
+	m_inVblank = !m_inVblank;
+	if(m_inVblank)
+	{
+		m_scheduler.ScheduleEvent(m_vblankEvent, VBLANK_TICKS);
+		m_ee->NotifyVBlankStart();
+		m_iop->NotifyVBlankStart();
+
+		if(m_ee->m_gs != NULL)
+		{
+#ifdef PROFILE
+			CProfilerZone profilerZone(m_gsSyncProfilerZone);
+#endif
+			m_ee->m_gs->SetVBlank();
+		}
+
+		if(m_pad != NULL)
+		{
+			m_pad->Update(m_ee->m_ram);
+		}
+
+		if(m_audioStream.IsStarted())
+		{
+			AudioStatsUpdated(m_audioStream.GetStats());
+		}
+#ifdef PROFILE
+		{
+			auto currentTime = std::chrono::high_resolution_clock::now();
+			if(m_frameStartTime != CProfiler::TimePoint())
+			{
+				auto frameTime = std::chrono::duration_cast<std::chrono::nanoseconds>(currentTime - m_frameStartTime).count();
+				m_cpuUtilisation.frameCount = 1;
+				m_cpuUtilisation.totalFrameTime = frameTime;
+				m_cpuUtilisation.maxFrameTime = frameTime;
+			}
+			m_frameStartTime = currentTime;
+		}
+
+		{
+			CProfiler::GetInstance().CountCurrentZone();
+			auto stats = CProfiler::GetInstance().GetStats();
+			ProfileFrameDone(stats);
+			CProfiler::GetInstance().Reset();
+		}
+
+		m_cpuUtilisation = CPU_UTILISATION_INFO();
+#endif
+	}
+	else
+	{
+		m_scheduler.ScheduleEvent(m_vblankEvent, ONSCREEN_TICKS);
+		m_ee->NotifyVBlankEnd();
+		m_iop->NotifyVBlankEnd();
+		if(m_ee->m_gs != NULL)
+		{
+			m_ee->m_gs->ResetVBlank();
+		}
+	}
+}
+
+void CPS2VM::OnSpuUpdateEvent()
+{
+	m_scheduler.ScheduleEvent(m_spuUpdateEvent, SPU_UPDATE_TICKS);
+	UpdateSpu();
+}
+
+void CPS2VM::OnIopDmaEvent()
+{
+	m_scheduler.ScheduleEvent(m_iopDmaEvent, IOP_DMA_UPDATE_TICKS);
+	m_iop->ResumeDma();
+}
+
+void CPS2VM::ScheduleTimerEvents()
+{
+	//Timers might have been reprogrammed during the last slice
+	m_scheduler.ScheduleEvent(m_eeTimerEvent, m_ee->m_timer.GetTicksUntilNextInterrupt());
+	m_scheduler.ScheduleEvent(m_iopCounterEvent, static_cast<uint64>(m_iop->m_counters.GetTicksUntilNextInterrupt()) * EE_IOP_CLOCK_RATIO);
+}
+
 void CPS2VM::EmuThread()
 {
 	fesetround(FE_TOWARDZERO);
@@ -736,67 +977,19 @@ void CPS2VM::EmuThread()
 		}
 		if(m_nStatus == RUNNING)
 		{
-			if(m_spuUpdateTicks <= 0)
-			{
-				UpdateSpu();
-				m_spuUpdateTicks += SPU_UPDATE_TICKS;
-			}
+			//Run processors until the next event is due
+			bool idle = m_ee->IsCpuIdle() && m_iop->IsCpuIdle();
+			uint32 sliceTicks = m_scheduler.GetTicksUntilNextEvent(idle ? MAX_IDLE_SLICE_TICKS : MAX_SLICE_TICKS);
 
-			//EE execution
-			{
-				//Check vblank stuff
-				if(m_vblankTicks <= 0)
-				{
-					m_inVblank = !m_inVblank;
-					if(m_inVblank)
-					{
-						m_vblankTicks += VBLANK_TICKS;
-						m_ee->NotifyVBlankStart();
-						m_iop->NotifyVBlankStart();
-
-						if(m_ee->m_gs != NULL)
-						{
-#ifdef PROFILE
-							CProfilerZone profilerZone(m_gsSyncProfilerZone);
-#endif
-							m_ee->m_gs->SetVBlank();
-						}
+			uint64 currentTime = m_scheduler.GetCurrentTime();
+			m_eeExecutionTicks += sliceTicks;
+			m_iopExecutionTicks += static_cast<int>(((currentTime + sliceTicks) / EE_IOP_CLOCK_RATIO) - (currentTime / EE_IOP_CLOCK_RATIO));
 
-						if(m_pad != NULL)
-						{
-							m_pad->Update(m_ee->m_ram);
-						}
-#ifdef PROFILE
-						{
-							CProfiler::GetInstance().CountCurrentZone();
-							auto stats = CProfiler::GetInstance().GetStats();
-							ProfileFrameDone(stats);
-							CProfiler::GetInstance().Reset();
-						}
-
-						m_cpuUtilisation = CPU_UTILISATION_INFO();
-#endif
-					}
-					else
-					{
-						m_vblankTicks += ONSCREEN_TICKS;
-						m_ee->NotifyVBlankEnd();
-						m_iop->NotifyVBlankEnd();
-						if(m_ee->m_gs != NULL)
-						{
-							m_ee->m_gs->ResetVBlank();
-						}
-					}
-				}
-
-				//EE CPU is 8 times faster than the IOP CPU
-				static const int tickStep = 4800;
-				m_eeExecutionTicks += tickStep;
-				m_iopExecutionTicks += tickStep / 8;
-
-				UpdateEe();
-				UpdateIop();
-			}
+			UpdateEe();
+			UpdateIop();
+
+			m_scheduler.Advance(sliceTicks);
+			ScheduleTimerEvents();
 #ifdef DEBUGGER_INCLUDED
 			if(
 			   m_ee->m_executor.MustBreak() || 
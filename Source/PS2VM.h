@@ -1,6 +1,7 @@
 #pragma once
 
 #include <thread>
+#include <future>
 #include "AppDef.h"
 #include "Types.h"
 #include "MIPS.h"
@@ -14,10 +15,19 @@
 #include "../tools/PsfPlayer/Source/SoundHandler.h"
 #include "FrameDump.h"
 #include "Profiler.h"
+#include "BlockCache.h"
+#include "EventScheduler.h"
+#include "AudioStream.h"
+#include "StateSnapshot.h"
 
 #define PREF_PS2_HOST_DIRECTORY				("ps2.host.directory")
 #define PREF_PS2_MC0_DIRECTORY				("ps2.mc0.directory")
 #define PREF_PS2_MC1_DIRECTORY				("ps2.mc1.directory")
+#define PREF_PS2_JITCACHE_ENABLED			("ps2.jitcache.enabled")
+#define PREF_PS2_DISKCACHE_SIZE				("ps2.diskcache.size")
+#define PREF_PS2_FASTMEM_ENABLED			("ps2.fastmem.enabled")
+#define PREF_PS2_BACKGROUNDJIT_ENABLED		("ps2.backgroundjit.enabled")
+#define PREF_PS2_LOOPBLOCKS_ENABLED			("ps2.loopblocks.enabled")
 
 class CPS2VM : public CVirtualMachine
 {
@@ -29,12 +39,18 @@ public:
 
 		int32 iopTotalTicks = 0;
 		int32 iopIdleTicks = 0;
+
+		//Host time spent emulating frames, in nanoseconds
+		uint32 frameCount = 0;
+		uint64 totalFrameTime = 0;
+		uint64 maxFrameTime = 0;
 	};
 
 	typedef std::unique_ptr<Ee::CSubSystem> EeSubSystemPtr;
 	typedef std::unique_ptr<Iop::CSubSystem> IopSubSystemPtr;
 	typedef std::function<void (const CFrameDump&)> FrameDumpCallback;
 	typedef boost::signals2::signal<void (const CProfiler::ZoneArray&)> ProfileFrameDoneSignal;
+	typedef boost::signals2::signal<void (const CAudioStream::STATS&)> AudioStatsUpdatedSignal;
 
 								CPS2VM();
 	virtual						~CPS2VM();
@@ -67,7 +83,8 @@ public:
 	void						CreateSoundHandler(const CSoundHandler::FactoryFunction&);
 	void						DestroySoundHandler();
 
-	unsigned int				SaveState(const char*);
+	//Returned future is set once the state is written, emulation is only held while the state is captured
+	std::future<bool>			SaveState(const char*);
 	unsigned int				LoadState(const char*);
 
 	void						TriggerFrameDump(const FrameDumpCallback&);
@@ -88,15 +105,19 @@ public:
 	IopBiosPtr					m_iopOs;
 
 	ProfileFrameDoneSignal		ProfileFrameDone;
+	AudioStatsUpdatedSignal		AudioStatsUpdated;
 
 private:
 	typedef std::unique_ptr<CISO9660> Iso9660Ptr;
+	typedef std::unique_ptr<CBlockCache> BlockCachePtr;
+	typedef std::shared_ptr<std::promise<bool>> SaveStatePromisePtr;
 
 	void						CreateVM();
 	void						ResetVM();
 	void						DestroyVM();
-	void						SaveVMState(const char*, unsigned int&);
+	void						SaveVMState(const std::string&, const SaveStatePromisePtr&);
 	void						LoadVMState(const char*, unsigned int&);
+	void						WaitForStateWrite();
 
 	void						ReloadExecutable(const char*, const CPS2OS::ArgumentList&);
 
@@ -117,6 +138,11 @@ private:
 	void						UpdateIop();
 	void						UpdateSpu();
 
+	void						OnVBlankEvent();
+	void						OnSpuUpdateEvent();
+	void						OnIopDmaEvent();
+	void						ScheduleTimerEvents();
+
 	void						OnGsNewFrame();
 
 	void						CDROM0_Initialize();
@@ -125,6 +151,11 @@ private:
 	void						CDROM0_Destroy();
 	void						SetIopCdImage(CISO9660*);
 
+	void						OpenBlockCaches();
+	void						CloseBlockCaches();
+	void						OpenShaderCache();
+	static bool					TryGetDiskId(std::string&);
+
 	void						RegisterModulesInPadHandler();
 
 	void						EmuThread();
@@ -134,9 +165,14 @@ private:
 	STATUS						m_nStatus;
 	bool						m_nEnd;
 
-	int							m_vblankTicks = 0;
+	CEventScheduler				m_scheduler;
+	CEventScheduler::EventHandle	m_vblankEvent = 0;
+	CEventScheduler::EventHandle	m_spuUpdateEvent = 0;
+	CEventScheduler::EventHandle	m_iopDmaEvent = 0;
+	CEventScheduler::EventHandle	m_eeTimerEvent = 0;
+	CEventScheduler::EventHandle	m_iopCounterEvent = 0;
+
 	bool						m_inVblank = 0;
-	int							m_spuUpdateTicks = 0;
 	int							m_eeExecutionTicks = 0;
 	int							m_iopExecutionTicks = 0;
 
@@ -154,20 +190,27 @@ private:
 
 	Iso9660Ptr					m_cdrom0;
 
+	BlockCachePtr				m_eeBlockCache;
+	BlockCachePtr				m_iopBlockCache;
+	BlockCachePtr				m_vu0BlockCache;
+	BlockCachePtr				m_vu1BlockCache;
+
 	enum
 	{
 		SAMPLE_COUNT = 44,
 		BLOCK_SIZE = SAMPLE_COUNT * 2,
-		BLOCK_COUNT = 400,
 	};
 
-	int16						m_samples[BLOCK_SIZE * BLOCK_COUNT];
-	int							m_currentSpuBlock = 0;
 	CSoundHandler*				m_soundHandler = nullptr;
+	CAudioStream				m_audioStream;
+
+	CStateSnapshot				m_stateSnapshot;
+	std::thread					m_stateWriteThread;
 
 	CProfiler::ZoneHandle		m_eeProfilerZone = 0;
 	CProfiler::ZoneHandle		m_iopProfilerZone = 0;
 	CProfiler::ZoneHandle		m_spuProfilerZone = 0;
 	CProfiler::ZoneHandle		m_gsSyncProfilerZone = 0;
 	CProfiler::ZoneHandle		m_otherProfilerZone = 0;
+	CProfiler::TimePoint		m_frameStartTime;
 };
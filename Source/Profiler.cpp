@@ -87,9 +87,12 @@ void CProfiler::Reset()
 
 void CProfiler::SetWorkThread()
 {
-#ifdef _DEBUG
 	m_workThreadId = std::this_thread::get_id();
-#endif
+}
+
+bool CProfiler::IsWorkThread() const
+{
+	return std::this_thread::get_id() == m_workThreadId;
 }
 
 void CProfiler::AddTimeToZone(ZoneHandle zoneHandle, uint64 timeNs)
@@ -105,13 +108,22 @@ void CProfiler::AddTimeToZone(ZoneHandle zoneHandle, uint64 timeNs)
 CProfilerZone::CProfilerZone(CProfiler::ZoneHandle handle)
 {
 #ifdef PROFILE
-	CProfiler::GetInstance().EnterZone(handle);
+	//Zones entered from other threads (ie.: VU1 worker) are not accounted for
+	auto& profiler = CProfiler::GetInstance();
+	if(profiler.IsWorkThread())
+	{
+		profiler.EnterZone(handle);
+		m_entered = true;
+	}
 #endif
 }
 
 CProfilerZone::~CProfilerZone()
 {
 #ifdef PROFILE
-	CProfiler::GetInstance().ExitZone();
+	if(m_entered)
+	{
+		CProfiler::GetInstance().ExitZone();
+	}
 #endif
 }
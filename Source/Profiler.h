@@ -36,6 +36,7 @@ public:
 	void				Reset();
 
 	void				SetWorkThread();
+	bool				IsWorkThread() const;
 	
 private:
 	typedef std::stack<ZoneHandle> ZoneStack;
@@ -45,10 +46,7 @@ private:
 	ZoneArray			m_zones;
 	ZoneStack			m_zoneStack;
 	TimePoint			m_currentTime;
-	
-#ifdef _DEBUG
 	std::thread::id		m_workThreadId;
-#endif
 };
 
 class CProfilerZone
@@ -56,4 +54,7 @@ class CProfilerZone
 public:
 							CProfilerZone(CProfiler::ZoneHandle);
 							~CProfilerZone();
+
+private:
+	bool					m_entered = false;
 };
@@ -0,0 +1,65 @@
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "SampleFifo.h"
+
+CSampleFifo::CSampleFifo(unsigned int capacity)
+: m_readPosition(0)
+, m_writePosition(0)
+{
+	//Capacity needs to be a power of 2 for positions to wrap correctly
+	assert((capacity != 0) && ((capacity & (capacity - 1)) == 0));
+	m_samples.resize(capacity);
+	m_mask = capacity - 1;
+}
+
+unsigned int CSampleFifo::Write(const int16* samples, unsigned int sampleCount)
+{
+	size_t writePosition = m_writePosition.load(std::memory_order_relaxed);
+	size_t readPosition = m_readPosition.load(std::memory_order_acquire);
+	size_t freeSamples = m_samples.size() - (writePosition - readPosition);
+	sampleCount = static_cast<unsigned int>(std::min<size_t>(sampleCount, freeSamples));
+
+	size_t offset = writePosition & m_mask;
+	size_t firstPart = std::min<size_t>(sampleCount, m_samples.size() - offset);
+	memcpy(m_samples.data() + offset, samples, firstPart * sizeof(int16));
+	memcpy(m_samples.data(), samples + firstPart, (sampleCount - firstPart) * sizeof(int16));
+
+	m_writePosition.store(writePosition + sampleCount, std::memory_order_release);
+	return sampleCount;
+}
+
+unsigned int CSampleFifo::Read(int16* samples, unsigned int sampleCount)
+{
+	size_t readPosition = m_readPosition.load(std::memory_order_relaxed);
+	size_t writePosition = m_writePosition.load(std::memory_order_acquire);
+	sampleCount = static_cast<unsigned int>(std::min<size_t>(sampleCount, writePosition - readPosition));
+
+	size_t offset = readPosition & m_mask;
+	size_t firstPart = std::min<size_t>(sampleCount, m_samples.size() - offset);
+	memcpy(samples, m_samples.data() + offset, firstPart * sizeof(int16));
+	memcpy(samples + firstPart, m_samples.data(), (sampleCount - firstPart) * sizeof(int16));
+
+	m_readPosition.store(readPosition + sampleCount, std::memory_order_release);
+	return sampleCount;
+}
+
+void CSampleFifo::Discard(unsigned int sampleCount)
+{
+	size_t readPosition = m_readPosition.load(std::memory_order_relaxed);
+	size_t writePosition = m_writePosition.load(std::memory_order_acquire);
+	sampleCount = static_cast<unsigned int>(std::min<size_t>(sampleCount, writePosition - readPosition));
+	m_readPosition.store(readPosition + sampleCount, std::memory_order_release);
+}
+
+unsigned int CSampleFifo::GetAvailableSamples() const
+{
+	size_t readPosition = m_readPosition.load(std::memory_order_acquire);
+	size_t writePosition = m_writePosition.load(std::memory_order_acquire);
+	return static_cast<unsigned int>(writePosition - readPosition);
+}
+
+unsigned int CSampleFifo::GetCapacity() const
+{
+	return static_cast<unsigned int>(m_samples.size());
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "Types.h"
+
+//Lock-free ring of audio samples with a single producer and a single consumer.
+//The producer only writes the write position and the consumer only writes the
+//read position, each side can thus work without waiting on the other.
+class CSampleFifo
+{
+public:
+							CSampleFifo(unsigned int);
+	virtual					~CSampleFifo() = default;
+
+	//Producer side, returns the amount of samples that could be written
+	unsigned int			Write(const int16*, unsigned int);
+
+	//Consumer side, returns the amount of samples that could be read
+	unsigned int			Read(int16*, unsigned int);
+	void					Discard(unsigned int);
+
+	//Can be called from either side, value might be outdated as soon as it's returned
+	unsigned int			GetAvailableSamples() const;
+	unsigned int			GetCapacity() const;
+
+private:
+	std::vector<int16>		m_samples;
+	size_t					m_mask = 0;
+
+	//Positions are free running, only masked when accessing samples
+	std::atomic<size_t>		m_readPosition;
+	std::atomic<size_t>		m_writePosition;
+};
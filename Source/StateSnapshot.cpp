@@ -0,0 +1,67 @@
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "StateSnapshot.h"
+
+static thread_local CStateSnapshot* g_currentSnapshot = nullptr;
+
+CStateSnapshot::CCaptureScope::CCaptureScope(CStateSnapshot& snapshot)
+{
+	assert(g_currentSnapshot == nullptr);
+	snapshot.m_capturedSize = 0;
+	snapshot.m_copiedSize = 0;
+	g_currentSnapshot = &snapshot;
+}
+
+CStateSnapshot::CCaptureScope::~CCaptureScope()
+{
+	g_currentSnapshot = nullptr;
+}
+
+CStateSnapshot* CStateSnapshot::GetCurrent()
+{
+	return g_currentSnapshot;
+}
+
+const void* CStateSnapshot::CaptureRegion(const std::string& name, const void* memory, size_t size)
+{
+	auto& region = m_regions[name];
+	auto source = reinterpret_cast<const uint8*>(memory);
+	if(region.size() != size)
+	{
+		region.assign(source, source + size);
+		m_capturedSize += size;
+		m_copiedSize += size;
+		return region.data();
+	}
+
+	//Most of the memory doesn't change between two snapshots, comparing is cheaper than writing it again
+	for(size_t offset = 0; offset < size; offset += PAGE_SIZE)
+	{
+		size_t pageSize = std::min<size_t>(PAGE_SIZE, size - offset);
+		if(memcmp(region.data() + offset, source + offset, pageSize) != 0)
+		{
+			memcpy(region.data() + offset, source + offset, pageSize);
+			m_copiedSize += pageSize;
+		}
+	}
+	m_capturedSize += size;
+	return region.data();
+}
+
+void CStateSnapshot::Clear()
+{
+	m_regions.clear();
+	m_capturedSize = 0;
+	m_copiedSize = 0;
+}
+
+size_t CStateSnapshot::GetCapturedSize() const
+{
+	return m_capturedSize;
+}
+
+size_t CStateSnapshot::GetCopiedSize() const
+{
+	return m_copiedSize;
+}
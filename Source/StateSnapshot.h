@@ -0,0 +1,47 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Types.h"
+
+//Copy of the memory saved in a state, kept from one save to the next. Only pages that
+//changed since the previous snapshot are copied. Once captured, the archive can be
+//compressed and written on another thread while emulation keeps modifying its memory.
+class CStateSnapshot
+{
+public:
+	//Memory state files created by this thread while the scope is alive read their contents from the snapshot
+	class CCaptureScope
+	{
+	public:
+							CCaptureScope(CStateSnapshot&);
+							~CCaptureScope();
+
+							CCaptureScope(const CCaptureScope&) = delete;
+		CCaptureScope&		operator =(const CCaptureScope&) = delete;
+	};
+
+	static CStateSnapshot*	GetCurrent();
+
+	//Returns a pointer to the captured copy of the memory
+	const void*				CaptureRegion(const std::string&, const void*, size_t);
+	void					Clear();
+
+	//Amount of bytes captured during the last capture and how much of it had to be copied
+	size_t					GetCapturedSize() const;
+	size_t					GetCopiedSize() const;
+
+private:
+	enum
+	{
+		PAGE_SIZE = 0x1000,
+	};
+
+	typedef std::vector<uint8> Region;
+	typedef std::map<std::string, Region> RegionMap;
+
+	RegionMap				m_regions;
+	size_t					m_capturedSize = 0;
+	size_t					m_copiedSize = 0;
+};
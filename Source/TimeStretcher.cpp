@@ -0,0 +1,133 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "TimeStretcher.h"
+
+//Lengths in milliseconds, shorter sequences react quicker but sound rougher
+#define SEQUENCE_LENGTH_MS	(30)
+#define OVERLAP_LENGTH_MS	(5)
+#define SEEK_LENGTH_MS		(10)
+
+CTimeStretcher::CTimeStretcher(unsigned int sampleRate)
+{
+	m_sequenceLength	= (sampleRate * SEQUENCE_LENGTH_MS) / 1000;
+	m_overlapLength		= (sampleRate * OVERLAP_LENGTH_MS) / 1000;
+	m_seekLength		= (sampleRate * SEEK_LENGTH_MS) / 1000;
+	assert(m_sequenceLength > (m_overlapLength * 2));
+	Clear();
+}
+
+void CTimeStretcher::SetTempo(float tempo)
+{
+	assert(tempo > 0);
+	m_tempo = tempo;
+}
+
+float CTimeStretcher::GetTempo() const
+{
+	return m_tempo;
+}
+
+void CTimeStretcher::PutSamples(const int16* samples, unsigned int frameCount)
+{
+	m_input.insert(m_input.end(), samples, samples + (frameCount * 2));
+	Process();
+}
+
+unsigned int CTimeStretcher::ReceiveSamples(int16* samples, unsigned int frameCount)
+{
+	frameCount = std::min<unsigned int>(frameCount, GetOutputFrameCount());
+	std::copy(m_output.begin(), m_output.begin() + (frameCount * 2), samples);
+	m_output.erase(m_output.begin(), m_output.begin() + (frameCount * 2));
+	return frameCount;
+}
+
+unsigned int CTimeStretcher::GetInputFrameCount() const
+{
+	return static_cast<unsigned int>(m_input.size() / 2);
+}
+
+unsigned int CTimeStretcher::GetOutputFrameCount() const
+{
+	return static_cast<unsigned int>(m_output.size() / 2);
+}
+
+void CTimeStretcher::Clear()
+{
+	m_input.clear();
+	m_output.clear();
+	m_overlap.assign(m_overlapLength * 2, 0);
+	m_skipFraction = 0;
+}
+
+void CTimeStretcher::Process()
+{
+	//Each sequence outputs (sequence - overlap) frames and consumes that amount scaled by tempo
+	unsigned int outputLength = m_sequenceLength - m_overlapLength;
+	unsigned int inputOffset = 0;
+	while(1)
+	{
+		float nominalSkip = (static_cast<float>(outputLength) * m_tempo) + m_skipFraction;
+		unsigned int skip = static_cast<unsigned int>(nominalSkip);
+		unsigned int requiredFrames = std::max<unsigned int>(m_seekLength + m_sequenceLength, skip);
+		if((GetInputFrameCount() - inputOffset) < requiredFrames) break;
+
+		const int16* input = m_input.data() + (inputOffset * 2);
+		unsigned int bestOffset = FindBestOverlapOffset(input);
+		const int16* sequence = input + (bestOffset * 2);
+
+		//Cross fade the end of the previous sequence with the beginning of this one
+		size_t outputPosition = m_output.size();
+		m_output.resize(outputPosition + (outputLength * 2));
+		int16* output = m_output.data() + outputPosition;
+		for(unsigned int i = 0; i < m_overlapLength; i++)
+		{
+			int32 fadeIn = static_cast<int32>(i);
+			int32 fadeOut = static_cast<int32>(m_overlapLength - i);
+			for(unsigned int channel = 0; channel < 2; channel++)
+			{
+				int32 sample = (m_overlap[(i * 2) + channel] * fadeOut) + (sequence[(i * 2) + channel] * fadeIn);
+				output[(i * 2) + channel] = static_cast<int16>(sample / static_cast<int32>(m_overlapLength));
+			}
+		}
+
+		unsigned int middleLength = m_sequenceLength - (m_overlapLength * 2);
+		std::copy(sequence + (m_overlapLength * 2), sequence + ((m_overlapLength + middleLength) * 2), output + (m_overlapLength * 2));
+
+		//Keep the end of the sequence to be mixed with the next one
+		std::copy(sequence + (outputLength * 2), sequence + (m_sequenceLength * 2), m_overlap.begin());
+
+		m_skipFraction = nominalSkip - static_cast<float>(skip);
+		inputOffset += skip;
+	}
+
+	m_input.erase(m_input.begin(), m_input.begin() + (inputOffset * 2));
+}
+
+unsigned int CTimeStretcher::FindBestOverlapOffset(const int16* input) const
+{
+	//Normalized cross correlation of the mono downmix against the pending overlap
+	unsigned int bestOffset = 0;
+	double bestCorrelation = std::numeric_limits<double>::lowest();
+	for(unsigned int offset = 0; offset < m_seekLength; offset++)
+	{
+		const int16* candidate = input + (offset * 2);
+		int64 correlation = 0;
+		int64 energy = 0;
+		for(unsigned int i = 0; i < m_overlapLength; i++)
+		{
+			int32 overlapSample = m_overlap[(i * 2) + 0] + m_overlap[(i * 2) + 1];
+			int32 candidateSample = candidate[(i * 2) + 0] + candidate[(i * 2) + 1];
+			correlation += static_cast<int64>(overlapSample) * candidateSample;
+			energy += static_cast<int64>(candidateSample) * candidateSample;
+		}
+		double normalizedCorrelation = static_cast<double>(correlation) / sqrt(static_cast<double>(energy) + 1.0);
+		if(normalizedCorrelation > bestCorrelation)
+		{
+			bestCorrelation = normalizedCorrelation;
+			bestOffset = offset;
+		}
+	}
+	return bestOffset;
+}
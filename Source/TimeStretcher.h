@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include "Types.h"
+
+//Changes the playback speed of 16-bit stereo samples without affecting their pitch (WSOLA).
+//Input is cut in overlapping sequences, each one being positioned where it best matches
+//the end of the previous one before being cross faded with it.
+class CTimeStretcher
+{
+public:
+							CTimeStretcher(unsigned int sampleRate);
+	virtual					~CTimeStretcher() = default;
+
+	//Ratio of input frames consumed for each output frame (> 1 plays faster)
+	void					SetTempo(float);
+	float					GetTempo() const;
+
+	void					PutSamples(const int16*, unsigned int frameCount);
+	unsigned int			ReceiveSamples(int16*, unsigned int frameCount);
+
+	unsigned int			GetInputFrameCount() const;
+	unsigned int			GetOutputFrameCount() const;
+
+	void					Clear();
+
+private:
+	void					Process();
+	unsigned int			FindBestOverlapOffset(const int16*) const;
+
+	unsigned int			m_sequenceLength = 0;
+	unsigned int			m_overlapLength = 0;
+	unsigned int			m_seekLength = 0;
+
+	float					m_tempo = 1.0f;
+	float					m_skipFraction = 0;
+
+	std::vector<int16>		m_input;
+	std::vector<int16>		m_output;
+	std::vector<int16>		m_overlap;
+};
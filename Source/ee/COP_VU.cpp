@@ -300,7 +300,7 @@ void CCOP_VU::V()
 //03
 void CCOP_VU::VADDbc()
 {
-	VUShared::ADDbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0);
+	VUShared::ADDbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0, 0);
 }
 
 //04
@@ -309,7 +309,7 @@ void CCOP_VU::VADDbc()
 //07
 void CCOP_VU::VSUBbc()
 {
-	VUShared::SUBbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0);
+	VUShared::SUBbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0, 0);
 }
 
 //08
@@ -318,7 +318,7 @@ void CCOP_VU::VSUBbc()
 //0B
 void CCOP_VU::VMADDbc()
 {
-	VUShared::MADDbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0);
+	VUShared::MADDbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0, 0);
 }
 
 //0C
@@ -327,7 +327,7 @@ void CCOP_VU::VMADDbc()
 //0F
 void CCOP_VU::VMSUBbc()
 {
-	VUShared::MSUBbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0);
+	VUShared::MSUBbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0, 0);
 }
 
 //10
@@ -354,13 +354,13 @@ void CCOP_VU::VMINIbc()
 //1B
 void CCOP_VU::VMULbc()
 {
-	VUShared::MULbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0);
+	VUShared::MULbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, 0, 0);
 }
 
 //1C
 void CCOP_VU::VMULq()
 {
-	VUShared::MULq(m_codeGen, m_nDest, m_nFD, m_nFS, 0);
+	VUShared::MULq(m_codeGen, m_nDest, m_nFD, m_nFS, 0, 0);
 }
 
 //1D
@@ -390,19 +390,19 @@ void CCOP_VU::VADDq()
 //21
 void CCOP_VU::VMADDq()
 {
-	VUShared::MADDq(m_codeGen, m_nDest, m_nFD, m_nFS, 0);
+	VUShared::MADDq(m_codeGen, m_nDest, m_nFD, m_nFS, 0, 0);
 }
 
 //22
 void CCOP_VU::VADDi()
 {
-	VUShared::ADDi(m_codeGen, m_nDest, m_nFD, m_nFS, 0);
+	VUShared::ADDi(m_codeGen, m_nDest, m_nFD, m_nFS, 0, 0);
 }
 
 //23
 void CCOP_VU::VMADDi()
 {
-	VUShared::MADDi(m_codeGen, m_nDest, m_nFD, m_nFS, 0);
+	VUShared::MADDi(m_codeGen, m_nDest, m_nFD, m_nFS, 0, 0);
 }
 
 //24
@@ -420,7 +420,7 @@ void CCOP_VU::VMSUBq()
 //26
 void CCOP_VU::VSUBi()
 {
-	VUShared::SUBi(m_codeGen, m_nDest, m_nFD, m_nFS, 0);
+	VUShared::SUBi(m_codeGen, m_nDest, m_nFD, m_nFS, 0, 0);
 }
 
 //27
@@ -432,19 +432,19 @@ void CCOP_VU::VMSUBi()
 //28
 void CCOP_VU::VADD()
 {
-	VUShared::ADD(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0);
+	VUShared::ADD(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0, 0);
 }
 
 //29
 void CCOP_VU::VMADD()
 {
-	VUShared::MADD(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0);
+	VUShared::MADD(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0, 0);
 }
 
 //2A
 void CCOP_VU::VMUL()
 {
-	VUShared::MUL(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0);
+	VUShared::MUL(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0, 0);
 }
 
 //2B
@@ -456,19 +456,19 @@ void CCOP_VU::VMAX()
 //2C
 void CCOP_VU::VSUB()
 {
-	VUShared::SUB(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0);
+	VUShared::SUB(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0, 0);
 }
 
 //2D
 void CCOP_VU::VMSUB()
 {
-	VUShared::MSUB(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0);
+	VUShared::MSUB(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, 0, 0);
 }
 
 //2E
 void CCOP_VU::VOPMSUB()
 {
-	VUShared::OPMSUB(m_codeGen, m_nFD, m_nFS, m_nFT, 0);
+	VUShared::OPMSUB(m_codeGen, m_nFD, m_nFS, m_nFT, 0, 0);
 }
 
 //2F
@@ -571,25 +571,25 @@ void CCOP_VU::VADDAbc()
 //
 void CCOP_VU::VSUBAbc()
 {
-	VUShared::SUBAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, 0);
+	VUShared::SUBAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, 0, 0);
 }
 
 //
 void CCOP_VU::VMADDAbc()
 {
-	VUShared::MADDAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, 0);
+	VUShared::MADDAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, 0, 0);
 }
 
 //
 void CCOP_VU::VMSUBAbc()
 {
-	VUShared::MSUBAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, 0);
+	VUShared::MSUBAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, 0, 0);
 }
 
 //
 void CCOP_VU::VMULAbc()
 {
-	VUShared::MULAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, 0);
+	VUShared::MULAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, 0, 0);
 }
 
 //////////////////////////////////////////////////
@@ -623,7 +623,7 @@ void CCOP_VU::VADDA()
 //0B
 void CCOP_VU::VSUBA()
 {
-	VUShared::SUBA(m_codeGen, m_nDest, m_nFS, m_nFT, 0);
+	VUShared::SUBA(m_codeGen, m_nDest, m_nFS, m_nFT, 0, 0);
 }
 
 //0C
@@ -681,13 +681,13 @@ void CCOP_VU::VABS()
 //0A
 void CCOP_VU::VMADDA()
 {
-	VUShared::MADDA(m_codeGen, m_nDest, m_nFS, m_nFT, 0);
+	VUShared::MADDA(m_codeGen, m_nDest, m_nFS, m_nFT, 0, 0);
 }
 
 //0B
 void CCOP_VU::VMSUBA()
 {
-	VUShared::MSUBA(m_codeGen, m_nDest, m_nFS, m_nFT, 0);
+	VUShared::MSUBA(m_codeGen, m_nDest, m_nFS, m_nFT, 0, 0);
 }
 
 //0C
@@ -803,13 +803,13 @@ void CCOP_VU::VCLIP()
 //08
 void CCOP_VU::VMADDAi()
 {
-	VUShared::MADDAi(m_codeGen, m_nDest, m_nFS, 0);
+	VUShared::MADDAi(m_codeGen, m_nDest, m_nFS, 0, 0);
 }
 
 //09
 void CCOP_VU::VMSUBAi()
 {
-	VUShared::MSUBAi(m_codeGen, m_nDest, m_nFS, 0);
+	VUShared::MSUBAi(m_codeGen, m_nDest, m_nFS, 0, 0);
 }
 
 //0B
@@ -1,6 +1,7 @@
 #include "Ee_SubSystem.h"
 #include "../Ps2Const.h"
 #include "../Log.h"
+#include "../AppConfig.h"
 #include "../MemoryStateFile.h"
 #include "../iop/IopBios.h"
 #include "Vif.h"
@@ -56,6 +57,13 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 	m_vpu0 = std::make_shared<CVpu>(0, CVpu::VPUINIT(m_microMem0, m_vuMem0, &m_VU0), m_gif, m_ram, m_spr);
 	m_vpu1 = std::make_shared<CVpu>(1, CVpu::VPUINIT(m_microMem1, m_vuMem1, &m_VU1), m_gif, m_ram, m_spr);
 
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_VPU1_USEWORKERTHREAD, false);
+	bool vu1Threaded = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_VPU1_USEWORKERTHREAD);
+	if(vu1Threaded)
+	{
+		m_vpu1->StartWorkerThread();
+	}
+
 	//EmotionEngine context setup
 	{
 		//Read map
@@ -64,8 +72,17 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 		m_EE.m_pMemoryMap->InsertReadMap(0x10000000,            0x10FFFFFF,                                     bind(&CSubSystem::IOPortReadHandler, this, PLACEHOLDER_1),    0x02);
 		m_EE.m_pMemoryMap->InsertReadMap(PS2::MICROMEM0ADDR,    PS2::MICROMEM0ADDR + PS2::MICROMEM0SIZE - 1,    m_microMem0,                                                  0x03);
 		m_EE.m_pMemoryMap->InsertReadMap(PS2::VUMEM0ADDR,       PS2::VUMEM0ADDR + PS2::VUMEM0SIZE - 1,          m_vuMem0,                                                     0x04);
-		m_EE.m_pMemoryMap->InsertReadMap(PS2::MICROMEM1ADDR,    PS2::MICROMEM1ADDR + PS2::MICROMEM1SIZE - 1,    m_microMem1,                                                  0x05);
-		m_EE.m_pMemoryMap->InsertReadMap(PS2::VUMEM1ADDR,       PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1,          m_vuMem1,                                                     0x06);
+		if(vu1Threaded)
+		{
+			//VU1 memories need to be synchronized with the worker thread before being accessed
+			m_EE.m_pMemoryMap->InsertReadMap(PS2::MICROMEM1ADDR,    PS2::MICROMEM1ADDR + PS2::MICROMEM1SIZE - 1,    m_microMem1, bind(&CSubSystem::Vu1MemAccessHandler, this, PLACEHOLDER_1),    0x05);
+			m_EE.m_pMemoryMap->InsertReadMap(PS2::VUMEM1ADDR,       PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1,          m_vuMem1,    bind(&CSubSystem::Vu1MemAccessHandler, this, PLACEHOLDER_1),    0x06);
+		}
+		else
+		{
+			m_EE.m_pMemoryMap->InsertReadMap(PS2::MICROMEM1ADDR,    PS2::MICROMEM1ADDR + PS2::MICROMEM1SIZE - 1,    m_microMem1,                                                  0x05);
+			m_EE.m_pMemoryMap->InsertReadMap(PS2::VUMEM1ADDR,       PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1,          m_vuMem1,                                                     0x06);
+		}
 		m_EE.m_pMemoryMap->InsertReadMap(0x12000000,            0x12FFFFFF,                                     bind(&CSubSystem::IOPortReadHandler, this, PLACEHOLDER_1),    0x07);
 		m_EE.m_pMemoryMap->InsertReadMap(0x1C000000,            0x1C001000,                                     m_fakeIopRam,                                                 0x08);
 		m_EE.m_pMemoryMap->InsertReadMap(0x1FC00000,            0x1FFFFFFF,                                     m_bios,                                                       0x09);
@@ -77,7 +94,14 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 		m_EE.m_pMemoryMap->InsertWriteMap(PS2::MICROMEM0ADDR,    PS2::MICROMEM0ADDR + PS2::MICROMEM0SIZE - 1,    bind(&CSubSystem::Vu0MicroMemWriteHandler, this, PLACEHOLDER_1, PLACEHOLDER_2),    0x03);
 		m_EE.m_pMemoryMap->InsertWriteMap(PS2::VUMEM0ADDR,       PS2::VUMEM0ADDR + PS2::VUMEM0SIZE - 1,          m_vuMem0,                                                                          0x04);
 		m_EE.m_pMemoryMap->InsertWriteMap(PS2::MICROMEM1ADDR,    PS2::MICROMEM1ADDR + PS2::MICROMEM1SIZE - 1,    bind(&CSubSystem::Vu1MicroMemWriteHandler, this, PLACEHOLDER_1, PLACEHOLDER_2),    0x05);
-		m_EE.m_pMemoryMap->InsertWriteMap(PS2::VUMEM1ADDR,       PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1,          m_vuMem1,                                                                          0x06);
+		if(vu1Threaded)
+		{
+			m_EE.m_pMemoryMap->InsertWriteMap(PS2::VUMEM1ADDR,       PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1,          m_vuMem1, bind(&CSubSystem::Vu1MemAccessHandler, this, PLACEHOLDER_1),                             0x06);
+		}
+		else
+		{
+			m_EE.m_pMemoryMap->InsertWriteMap(PS2::VUMEM1ADDR,       PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1,          m_vuMem1,                                                                          0x06);
+		}
 		m_EE.m_pMemoryMap->InsertWriteMap(0x12000000,            0x12FFFFFF,                                     bind(&CSubSystem::IOPortWriteHandler,	this, PLACEHOLDER_1, PLACEHOLDER_2),        0x07);
 
 		//Instruction map
@@ -90,6 +114,22 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 		m_EE.m_pCOP[2]			= &m_COP_VU;
 
 		m_EE.m_pAddrTranslator	= CPS2OS::TranslateAddress;
+
+		//Only memory and status registers that can be read without side effects and that are
+		//modified through processed events can be waited on. Other registers either change on their
+		//own (timers, units updated by other threads) or have reads that consume data (FIFOs).
+		m_executor.SetBusyWaitAddressHandler(
+			[] (uint32 address)
+			{
+				return
+					(address < PS2::EE_RAM_SIZE) ||
+					((address >= PS2::EE_SPR_ADDR) && (address < (PS2::EE_SPR_ADDR + PS2::EE_SPR_SIZE))) ||
+					((address >= 0x10008000) && (address <= 0x1000EFFC)) ||		//DMAC
+					((address >= 0x1000F000) && (address <= 0x1000F01C)) ||		//INTC
+					((address >= 0x1000F520) && (address <= 0x1000F59C)) ||		//DMAC
+					((address & ~0x0F) == CGSHandler::GS_CSR);
+			}
+		);
 	}
 
 	//Vector Unit 0 context setup
@@ -132,7 +172,7 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_VIF0,   bind(&CVif::ReceiveDMA, &m_vpu0->GetVif(), PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_VIF1,   bind(&CVif::ReceiveDMA, &m_vpu1->GetVif(), PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
-	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_GIF,    bind(&CGIF::ReceiveDMA, &m_gif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
+	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_GIF,    bind(&CSubSystem::GifReceiveDMA, this, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_TO_IPU, bind(&CIPU::ReceiveDMA4, &m_ipu, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_4, m_ram));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF0,   bind(&CSIF::ReceiveDMA5, &m_sif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF1,   bind(&CSIF::ReceiveDMA6, &m_sif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
@@ -167,8 +207,16 @@ void CSubSystem::SetVpu1(std::shared_ptr<CVpu> newVpu1)
 	m_vpu1 = newVpu1;
 }
 
+void CSubSystem::SetFastMemoryEnabled(bool enabled)
+{
+	//Main RAM isn't mirrored in the physical address space, code protection still applies to direct stores
+	m_EE.m_fastMemory = enabled ? m_ram : nullptr;
+	m_EE.m_fastMemorySize = PS2::EE_RAM_SIZE;
+}
+
 void CSubSystem::Reset()
 {
+	m_vpu1->Synchronize();
 	m_os->Release();
 	m_executor.Reset();
 
@@ -280,7 +328,7 @@ bool CSubSystem::IsCpuIdle() const
 	{
 		return true;
 	}
-	else if(m_os->IsIdle() || m_isIdle)
+	else if(m_os->IsIdle() || m_isIdle || m_executor.IsBusyWaiting())
 	{
 		return true;
 	}
@@ -349,6 +397,8 @@ void CSubSystem::NotifyVBlankEnd()
 
 void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 {
+	m_vpu1->Synchronize();
+
 	archive.InsertFile(new CMemoryStateFile(STATE_EE,			&m_EE.m_State,	sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_VU0,			&m_VU0.m_State,	sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_VU1,			&m_VU1.m_State,	sizeof(MIPSSTATE)));
@@ -370,6 +420,8 @@ void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 
 void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
 {
+	m_vpu1->Synchronize();
+
 	archive.BeginReadFile(STATE_EE			)->Read(&m_EE.m_State,	sizeof(MIPSSTATE));
 	archive.BeginReadFile(STATE_VU0			)->Read(&m_VU0.m_State,	sizeof(MIPSSTATE));
 	archive.BeginReadFile(STATE_VU1			)->Read(&m_VU1.m_State,	sizeof(MIPSSTATE));
@@ -404,6 +456,7 @@ uint32 CSubSystem::IOPortReadHandler(uint32 nAddress)
 	}
 	else if(nAddress >= CGIF::REGS_START && nAddress < CGIF::REGS_END)
 	{
+		m_vpu1->Synchronize();
 		nReturn = m_gif.GetRegister(nAddress);
 	}
 	else if(nAddress >= CVif::REGS0_START && nAddress < CVif::REGS0_END)
@@ -412,6 +465,7 @@ uint32 CSubSystem::IOPortReadHandler(uint32 nAddress)
 	}
 	else if(nAddress >= CVif::REGS1_START && nAddress < CVif::REGS1_END)
 	{
+		m_vpu1->Synchronize();
 		nReturn = m_vpu1->GetVif().GetRegister(nAddress);
 	}
 	else if(nAddress >= 0x10008000 && nAddress <= 0x1000EFFC)
@@ -428,6 +482,8 @@ uint32 CSubSystem::IOPortReadHandler(uint32 nAddress)
 	}
 	else if(nAddress >= 0x12000000 && nAddress <= 0x1200108C)
 	{
+		//Packets kicked by the VU1 worker thread can change privileged registers (ie.: SIGNAL, FINISH)
+		m_vpu1->Synchronize();
 		if(m_gs != NULL)
 		{
 			nReturn = m_gs->ReadPrivRegister(nAddress);
@@ -465,6 +521,7 @@ uint32 CSubSystem::IOPortWriteHandler(uint32 nAddress, uint32 nData)
 	}
 	else if(nAddress >= CGIF::REGS_START && nAddress < CGIF::REGS_END)
 	{
+		m_vpu1->Synchronize();
 		m_gif.SetRegister(nAddress, nData);
 	}
 	else if(nAddress >= CVif::REGS0_START && nAddress < CVif::REGS0_END)
@@ -473,6 +530,7 @@ uint32 CSubSystem::IOPortWriteHandler(uint32 nAddress, uint32 nData)
 	}
 	else if(nAddress >= CVif::REGS1_START && nAddress < CVif::REGS1_END)
 	{
+		m_vpu1->Synchronize();
 		m_vpu1->GetVif().SetRegister(nAddress, nData);
 	}
 	else if(nAddress >= CVif::VIF0_FIFO_START && nAddress < CVif::VIF0_FIFO_END)
@@ -515,6 +573,8 @@ uint32 CSubSystem::IOPortWriteHandler(uint32 nAddress, uint32 nData)
 	}
 	else if(nAddress >= 0x12000000 && nAddress <= 0x1200108C)
 	{
+		//Writes must come after packets the VU1 worker thread kicked before them
+		m_vpu1->Synchronize();
 		if(m_gs != NULL)
 		{
 			m_gs->WritePrivRegister(nAddress, nData);
@@ -573,21 +633,29 @@ uint32 CSubSystem::Vu0IoPortWriteHandler(uint32 address, uint32 value)
 
 uint32 CSubSystem::Vu1MicroMemWriteHandler(uint32 address, uint32 value)
 {
+	m_vpu1->Synchronize();
 	*reinterpret_cast<uint32*>(m_microMem1 + (address - PS2::MICROMEM1ADDR)) = value;
 	m_vpu1->InvalidateMicroProgram();
 	return 0;
 }
 
+uint32 CSubSystem::Vu1MemAccessHandler(uint32 address)
+{
+	//The access itself is done by the memory map, which takes care of its size
+	m_vpu1->Synchronize();
+	return 0;
+}
+
 uint32 CSubSystem::Vu1IoPortReadHandler(uint32 address)
 {
 	uint32 result = 0xCCCCCCCC;
 	switch(address)
 	{
 	case CVpu::VU_ITOP:
-		result = m_vpu1->GetVif().GetITOP();
+		result = m_vpu1->GetVuItop();
 		break;
 	case CVpu::VU_TOP:
-		result = m_vpu1->GetVif().GetTOP();
+		result = m_vpu1->GetVuTop();
 		break;
 	default:
 		CLog::GetInstance().Print(LOG_NAME, "Read an unhandled VU1 IO port (0x%0.8X).\r\n", address);
@@ -611,6 +679,13 @@ uint32 CSubSystem::Vu1IoPortWriteHandler(uint32 address, uint32 value)
 	return 0;
 }
 
+uint32 CSubSystem::GifReceiveDMA(uint32 address, uint32 qwc, uint32 direction, bool tagIncluded)
+{
+	//PATH3 transfers must not overtake packets kicked by VU1
+	m_vpu1->Synchronize();
+	return m_gif.ReceiveDMA(address, qwc, direction, tagIncluded);
+}
+
 void CSubSystem::CopyVuState(CMIPS& dst, const CMIPS& src)
 {
 	memcpy(&dst.m_State.nCOP2,   &src.m_State.nCOP2,   sizeof(dst.m_State.nCOP2));
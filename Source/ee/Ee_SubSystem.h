@@ -40,6 +40,9 @@ namespace Ee
 		void						SetVpu0(std::shared_ptr<CVpu>);
 		void						SetVpu1(std::shared_ptr<CVpu>);
 
+		//Only affects blocks compiled afterwards, should be set right after a reset
+		void						SetFastMemoryEnabled(bool);
+
 		uint8*						m_ram = nullptr;
 		uint8*						m_bios = nullptr;
 		uint8*						m_spr = nullptr;
@@ -90,10 +93,13 @@ namespace Ee
 		uint32						Vu0IoPortWriteHandler(uint32, uint32);
 
 		uint32						Vu1MicroMemWriteHandler(uint32, uint32);
+		uint32						Vu1MemAccessHandler(uint32);
 
 		uint32						Vu1IoPortReadHandler(uint32);
 		uint32						Vu1IoPortWriteHandler(uint32, uint32);
 
+		uint32						GifReceiveDMA(uint32, uint32, uint32, bool);
+
 		void						CopyVuState(CMIPS&, const CMIPS&);
 
 		void						ExecuteIpu();
@@ -345,6 +345,33 @@ uint32 CGIF::ProcessPacket(uint8* memory, uint32 address, uint32 end, const CGsP
 	return address - start;
 }
 
+//Returns the size of the packet starting at address, up to and including the data of its end of packet tag
+uint32 CGIF::GetPacketSize(const uint8* memory, uint32 address, uint32 end)
+{
+	uint32 start = address;
+	while(address < end)
+	{
+		auto tag = *reinterpret_cast<const TAG*>(&memory[address]);
+		address += 0x10;
+		uint32 regs = (tag.nreg == 0) ? 0x10 : tag.nreg;
+		switch(tag.cmd)
+		{
+		case 0x00:
+			address += tag.loops * regs * 0x10;
+			break;
+		case 0x01:
+			address += ((tag.loops * regs + 1) / 2) * 0x10;
+			break;
+		case 0x02:
+		case 0x03:
+			address += tag.loops * 0x10;
+			break;
+		}
+		if(tag.eop) break;
+	}
+	return std::min(address, end) - start;
+}
+
 uint32 CGIF::ReceiveDMA(uint32 address, uint32 qwc, uint32 unused, bool tagIncluded)
 {
 	uint8* memory(nullptr);
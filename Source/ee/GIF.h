@@ -47,6 +47,8 @@ public:
 	uint32			ReceiveDMA(uint32, uint32, uint32, bool);
 	uint32			ProcessPacket(uint8*, uint32, uint32, const CGsPacketMetadata&);
 
+	static uint32	GetPacketSize(const uint8*, uint32, uint32);
+
 	uint32			GetRegister(uint32);
 	void			SetRegister(uint32, uint32);
 
@@ -1,7 +1,9 @@
 #include <stdio.h>
+#include <fenv.h>
 #include <exception>
 #include <functional>
 #include "IPU.h"
+#include "IPU_Idct.h"
 #include "IPU_MacroblockAddressIncrementTable.h"
 #include "IPU_MacroblockTypeITable.h"
 #include "IPU_MacroblockTypePTable.h"
@@ -15,8 +17,6 @@
 #include "mpeg2/CodedBlockPatternTable.h"
 #include "mpeg2/QuantiserScaleTable.h"
 #include "mpeg2/InverseScanTable.h"
-#include "idct/TrivialC.h"
-#include "idct/IEEE1180.h"
 #include "../Log.h"
 #include "DMAC.h"
 #include "INTC.h"
@@ -287,13 +287,13 @@ void CIPU::InitializeCommand(uint32 value)
 		break;
 	case IPU_CMD_IDEC:
 		{
-			m_IDECCommand.Initialize(&m_BDECCommand, &m_CSCCommand, &m_IN_FIFO, &m_OUT_FIFO, value, GetDecoderContext(), m_nTH0, m_nTH1);
+			m_IDECCommand.Initialize(&m_BDECCommand, &m_IN_FIFO, &m_OUT_FIFO, value, GetDecoderContext(), m_nTH0, m_nTH1);
 			m_currentCmd = &m_IDECCommand;
 		}
 		break;
 	case IPU_CMD_BDEC:
 		{
-			m_BDECCommand.Initialize(&m_IN_FIFO, &m_OUT_FIFO, value, true, GetDecoderContext());
+			m_BDECCommand.Initialize(&m_IN_FIFO, &m_OUT_FIFO, value, true, true, GetDecoderContext());
 			m_currentCmd = &m_BDECCommand;
 		}
 		break;
@@ -856,6 +856,26 @@ unsigned int CIPU::CINFIFO::GetAvailableBits() const
 	return (m_size * 8) - m_bitPosition;
 }
 
+unsigned int CIPU::CINFIFO::ReadBytes(void* data, unsigned int size)
+{
+	//Bulk read for consumers that don't need to go through the bit reader, stream must be byte aligned
+	assert((m_bitPosition & 0x07) == 0);
+
+	unsigned int position = m_bitPosition / 8;
+	size = std::min<unsigned int>(size, m_size - position);
+	memcpy(data, m_buffer + position, size);
+	position += size;
+
+	//Discard the read qwords
+	unsigned int discardSize = position & ~0x0F;
+	memmove(m_buffer, m_buffer + discardSize, m_size - discardSize);
+	m_size -= discardSize;
+	m_bitPosition = (position - discardSize) * 8;
+	m_lookupBitsDirty = true;
+
+	return size;
+}
+
 void CIPU::CINFIFO::Reset()
 {
 	m_bitPosition = 0;
@@ -899,6 +919,142 @@ bool CIPU::CBCLRCommand::Execute()
 	return true;
 }
 
+/////////////////////////////////////////////
+//Macroblock worker implementation
+/////////////////////////////////////////////
+
+CIPU::CMacroblockWorker::CMacroblockWorker()
+{
+
+}
+
+CIPU::CMacroblockWorker::~CMacroblockWorker()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_threadDone = true;
+	}
+	m_workCondition.notify_all();
+	if(m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+void CIPU::CMacroblockWorker::SetConversionParams(bool ofm, bool dte, uint16 TH0, uint16 TH1)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	assert(m_completedCount == m_queuedCount);
+	m_ofm = ofm;
+	m_dte = dte;
+	m_TH0 = TH0;
+	m_TH1 = TH1;
+}
+
+bool CIPU::CMacroblockWorker::IsFull() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return (m_queuedCount - m_releasedCount) == MAX_MACROBLOCKS;
+}
+
+bool CIPU::CMacroblockWorker::IsEmpty() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return (m_queuedCount == m_releasedCount);
+}
+
+CIPU::CMacroblockWorker::MACROBLOCK* CIPU::CMacroblockWorker::GetQueueSlot()
+{
+	assert(!IsFull());
+	return &m_macroblocks[m_queuedCount % MAX_MACROBLOCKS];
+}
+
+void CIPU::CMacroblockWorker::Queue()
+{
+	if(!m_thread.joinable())
+	{
+		m_thread = std::thread([this] () { ThreadProc(); });
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queuedCount++;
+	}
+	m_workCondition.notify_one();
+}
+
+CIPU::CMacroblockWorker::MACROBLOCK* CIPU::CMacroblockWorker::GetCompleted()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_releasedCount == m_completedCount) return nullptr;
+	return &m_macroblocks[m_releasedCount % MAX_MACROBLOCKS];
+}
+
+void CIPU::CMacroblockWorker::Release()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	assert(m_releasedCount != m_completedCount);
+	m_releasedCount++;
+}
+
+void CIPU::CMacroblockWorker::Discard()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [this] () { return m_completedCount == m_queuedCount; });
+	m_releasedCount = m_completedCount;
+}
+
+void CIPU::CMacroblockWorker::ThreadProc()
+{
+	//Use the same rounding mode as the emulation thread
+	fesetround(FE_TOWARDZERO);
+
+	while(1)
+	{
+		MACROBLOCK* macroblock = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workCondition.wait(lock, [this] () { return m_threadDone || (m_completedCount != m_queuedCount); });
+			if(m_threadDone) break;
+			macroblock = &m_macroblocks[m_completedCount % MAX_MACROBLOCKS];
+		}
+		Reconstruct(*macroblock);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_completedCount++;
+		}
+		m_doneCondition.notify_all();
+	}
+}
+
+void CIPU::CMacroblockWorker::Reconstruct(MACROBLOCK& macroblock)
+{
+	int16 blocks[6][0x40];
+	for(unsigned int i = 0; i < 6; i++)
+	{
+		CIdct::Transform(macroblock.coeffs[i], blocks[i]);
+	}
+
+	//Arrange blocks like CSC expects them (16x16 luminance, Cb and Cr) and saturate to RAW8
+	uint8 rawBlock[CCsc::BLOCK_SIZE];
+	for(unsigned int y = 0; y < 16; y++)
+	{
+		for(unsigned int x = 0; x < 16; x++)
+		{
+			const int16* block = blocks[((y / 8) * 2) + (x / 8)];
+			int16 value = block[((y % 8) * 8) + (x % 8)];
+			rawBlock[(y * 16) + x] = static_cast<uint8>(std::min<int16>(std::max<int16>(value, 0), 255));
+		}
+	}
+	for(unsigned int i = 0; i < 0x40; i++)
+	{
+		rawBlock[0x100 + i] = static_cast<uint8>(std::min<int16>(std::max<int16>(blocks[4][i], 0), 255));
+		rawBlock[0x140 + i] = static_cast<uint8>(std::min<int16>(std::max<int16>(blocks[5][i], 0), 255));
+	}
+
+	CCsc::ConvertBlock(rawBlock, macroblock.pixels, m_ofm, m_dte, m_TH0, m_TH1);
+	macroblock.pixelsSize = m_ofm ? CCsc::RGB16_SIZE : CCsc::RGB32_SIZE;
+}
+
 /////////////////////////////////////////////
 //IDEC command implementation
 /////////////////////////////////////////////
@@ -914,7 +1070,7 @@ CIPU::CIDECCommand::CIDECCommand()
 	);
 }
 
-void CIPU::CIDECCommand::Initialize(CBDECCommand* BDECCommand, CCSCCommand* CSCCommand, CINFIFO* inFifo, COUTFIFO* outFifo, 
+void CIPU::CIDECCommand::Initialize(CBDECCommand* BDECCommand, CINFIFO* inFifo, COUTFIFO* outFifo, 
 	uint32 commandCode, const DECODER_CONTEXT& context, uint16 TH0, uint16 TH1)
 {
 	m_command <<= commandCode;
@@ -923,22 +1079,42 @@ void CIPU::CIDECCommand::Initialize(CBDECCommand* BDECCommand, CCSCCommand* CSCC
 	m_IN_FIFO		= inFifo;
 	m_OUT_FIFO		= outFifo;
 	m_BDECCommand	= BDECCommand;
-	m_CSCCommand	= CSCCommand;
 
 	m_state			= STATE_DELAY;
 	m_mbType		= 0;
 	m_qsc			= m_command.qsc;
 	m_context		= context;
-	m_TH0			= TH0;
-	m_TH1			= TH1;
 	m_mbCount		= 0;
 	m_delayTicks	= 1000;
+
+	//Drop anything left from a previous command that ended abruptly
+	m_worker.Discard();
+	m_worker.SetConversionParams(m_command.ofm != 0, m_command.dte != 0, TH0, TH1);
+	m_waitingForWorker = false;
 }
 
 bool CIPU::CIDECCommand::Execute()
+{
+	try
+	{
+		return ExecuteState();
+	}
+	catch(const CVLCTable::CVLCTableException&)
+	{
+		if(m_state == STATE_ERROR) throw;
+		//Let macroblocks decoded before the error reach the OUT FIFO before reporting it
+		m_state = STATE_ERROR;
+		return false;
+	}
+}
+
+bool CIPU::CIDECCommand::ExecuteState()
 {
 	while(1)
 	{
+		WriteMacroblocks();
+		m_waitingForWorker = false;
+
 		switch(m_state)
 		{
 		case STATE_DELAY:
@@ -984,6 +1160,12 @@ bool CIPU::CIDECCommand::Execute()
 			break;
 		case STATE_INITREADBLOCK:
 			{
+				if(m_worker.IsFull())
+				{
+					//Can't run ahead anymore, wait for the worker or for DMA3 to accept the data
+					m_waitingForWorker = (m_OUT_FIFO->GetSize() == 0);
+					return false;
+				}
 				auto bdecCommand = make_convertible<CMD_BDEC>(0);
 				bdecCommand.cmdId	= IPU_CMD_BDEC;
 				bdecCommand.fb		= 0;
@@ -991,7 +1173,7 @@ bool CIPU::CIDECCommand::Execute()
 				bdecCommand.dt		= 0;
 				bdecCommand.dcr		= (m_mbCount == 0) ? 1 : 0;
 				bdecCommand.qsc		= m_qsc;
-				m_BDECCommand->Initialize(m_IN_FIFO, &m_temp_OUT_FIFO, bdecCommand, false, m_context);
+				m_BDECCommand->Initialize(m_IN_FIFO, &m_temp_OUT_FIFO, bdecCommand, false, false, m_context);
 				m_state = STATE_READBLOCK;
 				m_blockStream.ResetBuffer();
 			}
@@ -1002,53 +1184,11 @@ bool CIPU::CIDECCommand::Execute()
 				{
 					return false;
 				}
-				//BDEC will yield 384 elements in RAW16 format
-				assert(m_blockStream.GetSize() == (CCSCCommand::BLOCK_SIZE * sizeof(int16)));
-				ConvertRawBlock();
-				m_state = STATE_CSCINIT;
+				QueueMacroblock();
+				m_state = STATE_CHECKSTARTCODE;
 				m_mbCount++;
 			}
 			break;
-		case STATE_CSCINIT:
-			{
-				auto cscCommand = make_convertible<CMD_CSC>(0);
-				cscCommand.cmdId	= IPU_CMD_CSC;
-				cscCommand.mbc		= 1;
-				cscCommand.dte		= m_command.dte;
-				cscCommand.ofm		= m_command.ofm;
-				m_CSCCommand->Initialize(&m_temp_IN_FIFO, m_OUT_FIFO, cscCommand, m_TH0, m_TH1);
-				m_state = STATE_CSC;
-				//CSC requires 384 elements in RAW8 format to proceed
-				assert(m_blockStream.GetSize() == (CCSCCommand::BLOCK_SIZE * sizeof(uint8)));
-				m_blockStream.Seek(0, Framework::STREAM_SEEK_SET);
-			}
-			break;
-		case STATE_CSC:
-			while(1)
-			{
-				uint8 readBuffer[CINFIFO::BUFFERSIZE];
-				auto readSize = CINFIFO::BUFFERSIZE - m_temp_IN_FIFO.GetSize();
-				if(readSize != 0)
-				{
-					readSize = m_blockStream.Read(readBuffer, readSize);
-					m_temp_IN_FIFO.Write(readBuffer, readSize);
-				}
-				if(m_CSCCommand->Execute())
-				{
-					//All data should have been consumed by CSC, so nothing should remain
-					uint32 remainLength = m_temp_IN_FIFO.GetAvailableBits() + (m_blockStream.GetRemainingLength() * 8);
-					assert(remainLength == 0);
-					m_state = STATE_CHECKSTARTCODE;
-					break;
-				}
-				if(m_OUT_FIFO->GetSize() != 0)
-				{
-					//We assume that DMA3 didn't proceed and that we need to wait
-					//for CPU to accept the data
-					return false;
-				}
-			}
-			break;
 		case STATE_CHECKSTARTCODE:
 			{
 				uint32 startCode = 0;
@@ -1058,7 +1198,7 @@ bool CIPU::CIDECCommand::Execute()
 				}
 				if(startCode == 0)
 				{
-					m_state = STATE_DONE;
+					m_state = STATE_FLUSH;
 				}
 				else
 				{
@@ -1077,6 +1217,22 @@ bool CIPU::CIDECCommand::Execute()
 				m_state = STATE_READMBTYPE;
 			}
 			break;
+		case STATE_FLUSH:
+		case STATE_ERROR:
+			{
+				//Every macroblock needs to be accepted by DMA3 before we're done
+				if(!m_worker.IsEmpty() || (m_OUT_FIFO->GetSize() != 0))
+				{
+					m_waitingForWorker = (m_OUT_FIFO->GetSize() == 0);
+					return false;
+				}
+				if(m_state == STATE_ERROR)
+				{
+					throw CVLCTable::CVLCTableException();
+				}
+				m_state = STATE_DONE;
+			}
+			break;
 		case STATE_DONE:
 			return true;
 			break;
@@ -1095,22 +1251,35 @@ void CIPU::CIDECCommand::CountTicks(uint32 ticks)
 
 bool CIPU::CIDECCommand::IsDelayed() const
 {
-	return (m_state == STATE_DELAY);
+	return (m_state == STATE_DELAY) || m_waitingForWorker;
 }
 
-void CIPU::CIDECCommand::ConvertRawBlock()
+void CIPU::CIDECCommand::QueueMacroblock()
 {
-	//Convert block from RAW16 to RAW8
-	int16 blockData[CCSCCommand::BLOCK_SIZE];
+	//BDEC will yield the dequantised coefficients of the 6 blocks
+	auto macroblock = m_worker.GetQueueSlot();
+	assert(m_blockStream.GetSize() == sizeof(macroblock->coeffs));
 	m_blockStream.Seek(0, Framework::STREAM_SEEK_SET);
-	m_blockStream.Read(blockData, CCSCCommand::BLOCK_SIZE * sizeof(int16));
+	m_blockStream.Read(macroblock->coeffs, sizeof(macroblock->coeffs));
 	m_blockStream.ResetBuffer();
-	for(uint32 i = 0; i < CCSCCommand::BLOCK_SIZE; i++)
+	m_worker.Queue();
+}
+
+void CIPU::CIDECCommand::WriteMacroblocks()
+{
+	if(m_OUT_FIFO->GetSize() != 0)
 	{
-		int16 blockValue = blockData[i];
-		blockValue = std::max<int16>(blockValue, 0);
-		blockValue = std::min<int16>(blockValue, 255);
-		m_blockStream.Write8(static_cast<uint8>(blockValue));
+		m_OUT_FIFO->Flush();
+	}
+
+	//Only hand a macroblock to DMA3 when the previous one has been completely accepted
+	while(m_OUT_FIFO->GetSize() == 0)
+	{
+		auto macroblock = m_worker.GetCompleted();
+		if(macroblock == nullptr) break;
+		m_OUT_FIFO->Write(macroblock->pixels, macroblock->pixelsSize);
+		m_worker.Release();
+		m_OUT_FIFO->Flush();
 	}
 }
 
@@ -1128,12 +1297,13 @@ CIPU::CBDECCommand::CBDECCommand()
 	m_blocks[5].block = m_crBlock;		m_blocks[5].channel = 2;
 }
 
-void CIPU::CBDECCommand::Initialize(CINFIFO* inFifo, COUTFIFO* outFifo, uint32 commandCode, bool checkStartCode, const DECODER_CONTEXT& context)
+void CIPU::CBDECCommand::Initialize(CINFIFO* inFifo, COUTFIFO* outFifo, uint32 commandCode, bool checkStartCode, bool transform, const DECODER_CONTEXT& context)
 {
 	m_command <<= commandCode;
 	assert(m_command.cmdId == IPU_CMD_BDEC);
 
 	m_checkStartCode = checkStartCode;
+	m_transform = transform;
 
 	m_context = context;
 
@@ -1234,15 +1404,17 @@ bool CIPU::CBDECCommand::Execute()
 				}
 
 				BLOCKENTRY& blockInfo(m_blocks[m_currentBlockIndex]);
-				int16 blockTemp[0x40];
 
 				InverseScan(blockInfo.block, m_context.isZigZag);
 				DequantiseBlock(blockInfo.block, (m_command.mbi != 0), m_command.qsc, 
 					m_context.isLinearQScale, m_context.dcPrecision, m_context.intraIq, m_context.nonIntraIq);
 
-				memcpy(blockTemp, blockInfo.block, sizeof(int16) * 0x40);
-
-				IDCT::CIEEE1180::GetInstance()->Transform(blockTemp, blockInfo.block);
+				if(m_transform)
+				{
+					int16 blockTemp[0x40];
+					memcpy(blockTemp, blockInfo.block, sizeof(int16) * 0x40);
+					CIdct::Transform(blockTemp, blockInfo.block);
+				}
 
 				m_state = STATE_DECODEBLOCK_GOTONEXT;
 			}
@@ -1263,21 +1435,32 @@ bool CIPU::CBDECCommand::Execute()
 		case STATE_DONE:
 			{
 				//Write blocks into out FIFO
-				for(unsigned int i = 0; i < 8; i++)
+				if(m_transform)
 				{
-					m_OUT_FIFO->Write(m_blocks[0].block + (i * 8), sizeof(int16) * 0x8);
-					m_OUT_FIFO->Write(m_blocks[1].block + (i * 8), sizeof(int16) * 0x8);
-				}
+					for(unsigned int i = 0; i < 8; i++)
+					{
+						m_OUT_FIFO->Write(m_blocks[0].block + (i * 8), sizeof(int16) * 0x8);
+						m_OUT_FIFO->Write(m_blocks[1].block + (i * 8), sizeof(int16) * 0x8);
+					}
 
-				for(unsigned int i = 0; i < 8; i++)
+					for(unsigned int i = 0; i < 8; i++)
+					{
+						m_OUT_FIFO->Write(m_blocks[2].block + (i * 8), sizeof(int16) * 0x8);
+						m_OUT_FIFO->Write(m_blocks[3].block + (i * 8), sizeof(int16) * 0x8);
+					}
+
+					m_OUT_FIFO->Write(m_blocks[4].block, sizeof(int16) * 0x40);
+					m_OUT_FIFO->Write(m_blocks[5].block, sizeof(int16) * 0x40);
+				}
+				else
 				{
-					m_OUT_FIFO->Write(m_blocks[2].block + (i * 8), sizeof(int16) * 0x8);
-					m_OUT_FIFO->Write(m_blocks[3].block + (i * 8), sizeof(int16) * 0x8);
+					//Coefficients are transformed by the caller, keep them in block order
+					for(unsigned int i = 0; i < 6; i++)
+					{
+						m_OUT_FIFO->Write(m_blocks[i].block, sizeof(int16) * 0x40);
+					}
 				}
 
-				m_OUT_FIFO->Write(m_blocks[4].block, sizeof(int16) * 0x40);
-				m_OUT_FIFO->Write(m_blocks[5].block, sizeof(int16) * 0x40);
-
 				m_OUT_FIFO->Flush();
 
 				//Check if there's more than 7 zero bits after this and set "start code detected"
@@ -1760,7 +1943,7 @@ bool CIPU::CSETVQCommand::Execute()
 
 CIPU::CCSCCommand::CCSCCommand()
 {
-	GenerateCbCrMap();
+
 }
 
 void CIPU::CCSCCommand::Initialize(CINFIFO* input, COUTFIFO* output, uint32 commandCode, uint16 TH0, uint16 TH1)
@@ -1800,10 +1983,19 @@ bool CIPU::CCSCCommand::Execute()
 			break;
 		case STATE_READBLOCK:
 			{
-				if(m_currentIndex == BLOCK_SIZE)
+				if(m_currentIndex == CCsc::BLOCK_SIZE)
 				{
 					m_state = STATE_CONVERTBLOCK;
 				}
+				else if((m_IN_FIFO->GetBitIndex() & 0x07) == 0)
+				{
+					uint32 readSize = m_IN_FIFO->ReadBytes(m_block + m_currentIndex, CCsc::BLOCK_SIZE - m_currentIndex);
+					if(readSize == 0)
+					{
+						return false;
+					}
+					m_currentIndex += readSize;
+				}
 				else
 				{
 					uint32 blockValue = 0;
@@ -1818,58 +2010,9 @@ bool CIPU::CCSCCommand::Execute()
 			break;
 		case STATE_CONVERTBLOCK:
 			{
-				uint32 nPixel[0x100];
-
-				uint8* pY = m_block;
-				uint8* nBlockCb = m_block + 0x100;
-				uint8* nBlockCr = m_block + 0x140;
-
-				uint32* pPixel = nPixel;
-				unsigned int* pCbCrMap = m_nCbCrMap;
-				
-				uint32 alphaTh0 = (m_TH0 & 0xFF) | ((m_TH0 & 0xFF) << 8) | ((m_TH0 & 0xFF) << 16);
-				uint32 alphaTh1 = (m_TH1 & 0xFF) | ((m_TH1 & 0xFF) << 8) | ((m_TH1 & 0xFF) << 16);
-
-				for(unsigned int i = 0; i < 16; i++)
-				{
-					for(unsigned int j = 0; j < 16; j++)
-					{
-						float nY  = pY[j];
-						float nCb = nBlockCb[pCbCrMap[j]];
-						float nCr = nBlockCr[pCbCrMap[j]];
-
-						float nR = nY								+ 1.402f	* (nCr - 128);
-						float nG = nY - 0.34414f	* (nCb - 128)	- 0.71414f	* (nCr - 128);
-						float nB = nY + 1.772f		* (nCb - 128);
-
-						if(nR < 0) { nR = 0; } if(nR > 255) { nR = 255; }
-						if(nG < 0) { nG = 0; } if(nG > 255) { nG = 255; }
-						if(nB < 0) { nB = 0; } if(nB > 255) { nB = 255; }
-
-						uint8 a = 0;
-						uint32 rgb = (static_cast<uint8>(nB) << 16) | (static_cast<uint8>(nG) << 8) | (static_cast<uint8>(nR) << 0);
-						if(rgb < alphaTh0)
-						{
-							a = 0;
-						}
-						else if(rgb < alphaTh1)
-						{
-							a = 0x40;
-						}
-						else
-						{
-							a = 0x80;
-						}
-
-						pPixel[j] = (a << 24) | rgb;
-					}
-
-					pY			+= 0x10;
-					pCbCrMap	+= 0x10;
-					pPixel		+= 0x10;
-				}
-
-				m_OUT_FIFO->Write(nPixel, sizeof(uint32) * 0x100);
+				uint8 pixels[CCsc::RGB32_SIZE];
+				CCsc::ConvertBlock(m_block, pixels, (m_command.ofm != 0), (m_command.dte != 0), m_TH0, m_TH1);
+				m_OUT_FIFO->Write(pixels, m_command.ofm ? CCsc::RGB16_SIZE : CCsc::RGB32_SIZE);
 
 				m_mbCount--;
 				m_state = STATE_FLUSHBLOCK;
@@ -1892,24 +2035,6 @@ bool CIPU::CCSCCommand::Execute()
 	}
 }
 
-void CIPU::CCSCCommand::GenerateCbCrMap()
-{
-	unsigned int* pCbCrMap = m_nCbCrMap;
-	for(unsigned int i = 0; i < 0x40; i += 0x8)
-	{
-		for(unsigned int j = 0; j < 0x10; j += 2)
-		{
-			pCbCrMap[j + 0x00] = (j / 2) + i;
-			pCbCrMap[j + 0x01] = (j / 2) + i;
-
-			pCbCrMap[j + 0x10] = (j / 2) + i;
-			pCbCrMap[j + 0x11] = (j / 2) + i;
-		}
-
-		pCbCrMap += 0x20;
-	}
-}
-
 /////////////////////////////////////////////
 //SETTH command implementation
 /////////////////////////////////////////////
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "Types.h"
 #include "BitStream.h"
 #include "MemStream.h"
@@ -8,6 +11,7 @@
 #include "mpeg2/DctCoefficientTable.h"
 #include "../MailBox.h"
 #include "Convertible.h"
+#include "IPU_Csc.h"
 
 class CINTC;
 
@@ -160,6 +164,8 @@ private:
 		bool				TryPeekBits_LSBF(uint8, uint32&) override;
 		bool				TryPeekBits_MSBF(uint8, uint32&) override;
 
+		unsigned int		ReadBytes(void*, unsigned int);
+
 		void				SetBitPosition(unsigned int);
 		unsigned int		GetSize() const;
 		unsigned int		GetAvailableBits() const;
@@ -212,14 +218,67 @@ private:
 
 	//0x01 ------------------------------------------------------------
 	class CBDECCommand;
-	class CCSCCommand;
+
+	//Reconstructs macroblocks decoded by IDEC (IDCT and color space conversion) on a worker
+	//thread, allowing the bitstream decoder to run ahead of it. Macroblocks are kept in a ring
+	//and are handed back in the order they were queued.
+	class CMacroblockWorker
+	{
+	public:
+		enum
+		{
+			MAX_MACROBLOCKS = 8,
+		};
+
+		struct MACROBLOCK
+		{
+			int16		coeffs[6][0x40];
+			uint8		pixels[IPU::CCsc::RGB32_SIZE];
+			uint32		pixelsSize;
+		};
+
+						CMacroblockWorker();
+		virtual			~CMacroblockWorker();
+
+		void			SetConversionParams(bool, bool, uint16, uint16);
+
+		bool			IsFull() const;
+		bool			IsEmpty() const;
+		MACROBLOCK*		GetQueueSlot();
+		void			Queue();
+		MACROBLOCK*		GetCompleted();
+		void			Release();
+		void			Discard();
+
+	private:
+		void			ThreadProc();
+		void			Reconstruct(MACROBLOCK&);
+
+		MACROBLOCK		m_macroblocks[MAX_MACROBLOCKS];
+
+		std::thread				m_thread;
+		mutable std::mutex		m_mutex;
+		std::condition_variable	m_workCondition;
+		std::condition_variable	m_doneCondition;
+		bool			m_threadDone = false;
+
+		//Macroblocks [m_releasedCount, m_completedCount) are ready, [m_completedCount, m_queuedCount) are being worked on
+		uint32			m_queuedCount = 0;
+		uint32			m_completedCount = 0;
+		uint32			m_releasedCount = 0;
+
+		bool			m_ofm = false;
+		bool			m_dte = false;
+		uint16			m_TH0 = 0;
+		uint16			m_TH1 = 0;
+	};
 
 	class CIDECCommand : public CCommand
 	{
 	public:
 						CIDECCommand();
 
-		void			Initialize(CBDECCommand*, CCSCCommand*, CINFIFO*, COUTFIFO*, uint32, const DECODER_CONTEXT&, uint16, uint16);
+		void			Initialize(CBDECCommand*, CINFIFO*, COUTFIFO*, uint32, const DECODER_CONTEXT&, uint16, uint16);
 		bool			Execute() override;
 		void			CountTicks(uint32) override;
 		bool			IsDelayed() const override;
@@ -236,29 +295,30 @@ private:
 			STATE_READBLOCK,
 			STATE_CHECKSTARTCODE,
 			STATE_READMBINCREMENT,
-			STATE_CSCINIT,
-			STATE_CSC,
+			STATE_FLUSH,
+			STATE_ERROR,
 			STATE_DONE
 		};
 
-		void					ConvertRawBlock();
+		bool					ExecuteState();
+		void					QueueMacroblock();
+		void					WriteMacroblocks();
 
 		CMD_IDEC				m_command = make_convertible<CMD_IDEC>(0);
 		STATE					m_state = STATE_DONE;
 
 		CBDECCommand*			m_BDECCommand = nullptr;
-		CCSCCommand*			m_CSCCommand = nullptr;
 		CINFIFO*				m_IN_FIFO = nullptr;
 		COUTFIFO*				m_OUT_FIFO = nullptr;
 
-		CINFIFO					m_temp_IN_FIFO;
 		COUTFIFO				m_temp_OUT_FIFO;
 
 		Framework::CMemStream	m_blockStream;
 
+		CMacroblockWorker		m_worker;
+		bool					m_waitingForWorker = false;
+
 		DECODER_CONTEXT			m_context;
-		uint16					m_TH0 = 0;
-		uint16					m_TH1 = 0;
 		uint32					m_mbType = 0;
 		uint32					m_qsc = 0;
 		uint32					m_mbCount = 0;
@@ -326,7 +386,7 @@ private:
 	public:
 										CBDECCommand();
 
-		void							Initialize(CINFIFO*, COUTFIFO*, uint32, bool, const DECODER_CONTEXT&);
+		void							Initialize(CINFIFO*, COUTFIFO*, uint32, bool, bool, const DECODER_CONTEXT&);
 		bool							Execute() override;
 
 	private:
@@ -353,6 +413,7 @@ private:
 		CINFIFO*						m_IN_FIFO = nullptr;
 		COUTFIFO*						m_OUT_FIFO = nullptr;
 		bool							m_checkStartCode = false;
+		bool							m_transform = true;
 
 		uint8							m_codedBlockPattern = 0;
 
@@ -449,11 +510,6 @@ private:
 	class CCSCCommand : public CCommand
 	{
 	public:
-		enum
-		{
-			BLOCK_SIZE = 0x180,
-		};
-
 						CCSCCommand();
 
 		void			Initialize(CINFIFO*, COUTFIFO*, uint32, uint16, uint16);
@@ -469,8 +525,6 @@ private:
 			STATE_DONE,
 		};
 
-		void			GenerateCbCrMap();
-
 		STATE			m_state = STATE_DONE;
 		CMD_CSC			m_command = make_convertible<CMD_CSC>(0);
 
@@ -482,9 +536,7 @@ private:
 		unsigned int	m_currentIndex = 0;
 		unsigned int	m_mbCount = 0;
 
-		unsigned int	m_nCbCrMap[0x100];
-
-		uint8			m_block[BLOCK_SIZE];
+		uint8			m_block[IPU::CCsc::BLOCK_SIZE];
 	};
 
 	//0x09 ------------------------------------------------------------
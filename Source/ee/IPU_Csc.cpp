@@ -0,0 +1,190 @@
+#include <algorithm>
+#include "IPU_Csc.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define IPU_CSC_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace IPU;
+
+//Added to color components before they are truncated to 5 bits when dithering is enabled
+static const int32 g_ditherMatrix[4][4] =
+{
+	{ -4,  0, -3,  1 },
+	{  2, -2,  3, -1 },
+	{ -3,  1, -4,  0 },
+	{  3, -1,  2, -2 },
+};
+
+#ifdef IPU_CSC_SSE2
+
+static inline __m128 UnpackCscComponent(__m128i values, unsigned int group)
+{
+	//Extracts 4 consecutive bytes (starting at group * 4) as floats
+	auto zero = _mm_setzero_si128();
+	auto words = (group < 2) ? _mm_unpacklo_epi8(values, zero) : _mm_unpackhi_epi8(values, zero);
+	auto dwords = (group & 1) ? _mm_unpackhi_epi16(words, zero) : _mm_unpacklo_epi16(words, zero);
+	return _mm_cvtepi32_ps(dwords);
+}
+
+static inline __m128i ClampCscComponent(__m128i value)
+{
+	auto zero = _mm_setzero_si128();
+	auto maxValue = _mm_set1_epi32(255);
+	value = _mm_andnot_si128(_mm_cmplt_epi32(value, zero), value);
+	auto greater = _mm_cmpgt_epi32(value, maxValue);
+	return _mm_or_si128(_mm_andnot_si128(greater, value), _mm_and_si128(greater, maxValue));
+}
+
+#endif
+
+void CCsc::ConvertBlock(const uint8* block, void* output, bool ofm, bool dte, uint16 TH0, uint16 TH1)
+{
+#ifdef IPU_CSC_SSE2
+	const uint8* blockY = block;
+	const uint8* blockCb = block + 0x100;
+	const uint8* blockCr = block + 0x140;
+
+	auto pixels32 = reinterpret_cast<uint32*>(output);
+	auto pixels16 = reinterpret_cast<uint16*>(output);
+
+	uint32 alphaTh0 = (TH0 & 0xFF) | ((TH0 & 0xFF) << 8) | ((TH0 & 0xFF) << 16);
+	uint32 alphaTh1 = (TH1 & 0xFF) | ((TH1 & 0xFF) << 8) | ((TH1 & 0xFF) << 16);
+
+	auto zero = _mm_setzero_ps();
+	auto value128 = _mm_set1_ps(128.f);
+	auto value255 = _mm_set1_ps(255.f);
+	auto crToR = _mm_set1_ps(1.402f);
+	auto cbToG = _mm_set1_ps(0.34414f);
+	auto crToG = _mm_set1_ps(0.71414f);
+	auto cbToB = _mm_set1_ps(1.772f);
+	auto th0 = _mm_set1_epi32(alphaTh0);
+	auto th1 = _mm_set1_epi32(alphaTh1);
+	auto alpha40 = _mm_set1_epi32(0x40);
+	auto alpha80 = _mm_set1_epi32(0x80);
+
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		auto rowY = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockY + (i * 0x10)));
+		auto rowCb = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(blockCb + ((i / 2) * 8)));
+		auto rowCr = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(blockCr + ((i / 2) * 8)));
+
+		//Each chroma sample covers 2 pixels
+		rowCb = _mm_unpacklo_epi8(rowCb, rowCb);
+		rowCr = _mm_unpacklo_epi8(rowCr, rowCr);
+
+		auto dither = dte ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(g_ditherMatrix[i & 3])) : _mm_setzero_si128();
+
+		for(unsigned int group = 0; group < 4; group++)
+		{
+			auto nY = UnpackCscComponent(rowY, group);
+			auto nCb = _mm_sub_ps(UnpackCscComponent(rowCb, group), value128);
+			auto nCr = _mm_sub_ps(UnpackCscComponent(rowCr, group), value128);
+
+			auto nR = _mm_add_ps(nY, _mm_mul_ps(crToR, nCr));
+			auto nG = _mm_sub_ps(_mm_sub_ps(nY, _mm_mul_ps(cbToG, nCb)), _mm_mul_ps(crToG, nCr));
+			auto nB = _mm_add_ps(nY, _mm_mul_ps(cbToB, nCb));
+
+			auto r = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(nR, zero), value255));
+			auto g = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(nG, zero), value255));
+			auto b = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(nB, zero), value255));
+
+			auto rgb = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_slli_epi32(b, 16));
+
+			auto belowTh0 = _mm_cmplt_epi32(rgb, th0);
+			auto belowTh1 = _mm_cmplt_epi32(rgb, th1);
+			auto a = _mm_or_si128(_mm_and_si128(belowTh1, alpha40), _mm_andnot_si128(belowTh1, alpha80));
+			a = _mm_andnot_si128(belowTh0, a);
+
+			unsigned int pixelIndex = (i * 0x10) + (group * 4);
+			if(!ofm)
+			{
+				auto pixel = _mm_or_si128(rgb, _mm_slli_epi32(a, 24));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels32 + pixelIndex), pixel);
+			}
+			else
+			{
+				r = _mm_srli_epi32(ClampCscComponent(_mm_add_epi32(r, dither)), 3);
+				g = _mm_srli_epi32(ClampCscComponent(_mm_add_epi32(g, dither)), 3);
+				b = _mm_srli_epi32(ClampCscComponent(_mm_add_epi32(b, dither)), 3);
+				a = _mm_srli_epi32(_mm_cmpeq_epi32(a, alpha40), 31);
+
+				auto pixel = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 5)), _mm_or_si128(_mm_slli_epi32(b, 10), _mm_slli_epi32(a, 15)));
+				pixel = _mm_srai_epi32(_mm_slli_epi32(pixel, 16), 16);
+				pixel = _mm_packs_epi32(pixel, pixel);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(pixels16 + pixelIndex), pixel);
+			}
+		}
+	}
+#else
+	ConvertBlockScalar(block, output, ofm, dte, TH0, TH1);
+#endif
+}
+
+void CCsc::ConvertBlockScalar(const uint8* block, void* output, bool ofm, bool dte, uint16 TH0, uint16 TH1)
+{
+	const uint8* blockY = block;
+	const uint8* blockCb = block + 0x100;
+	const uint8* blockCr = block + 0x140;
+
+	auto pixels32 = reinterpret_cast<uint32*>(output);
+	auto pixels16 = reinterpret_cast<uint16*>(output);
+
+	uint32 alphaTh0 = (TH0 & 0xFF) | ((TH0 & 0xFF) << 8) | ((TH0 & 0xFF) << 16);
+	uint32 alphaTh1 = (TH1 & 0xFF) | ((TH1 & 0xFF) << 8) | ((TH1 & 0xFF) << 16);
+
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		for(unsigned int j = 0; j < 16; j++)
+		{
+			unsigned int chromaIndex = ((i / 2) * 8) + (j / 2);
+
+			float nY  = blockY[(i * 0x10) + j];
+			float nCb = blockCb[chromaIndex];
+			float nCr = blockCr[chromaIndex];
+
+			float nR = nY								+ 1.402f	* (nCr - 128);
+			float nG = nY - 0.34414f	* (nCb - 128)	- 0.71414f	* (nCr - 128);
+			float nB = nY + 1.772f		* (nCb - 128);
+
+			if(nR < 0) { nR = 0; } if(nR > 255) { nR = 255; }
+			if(nG < 0) { nG = 0; } if(nG > 255) { nG = 255; }
+			if(nB < 0) { nB = 0; } if(nB > 255) { nB = 255; }
+
+			uint32 r = static_cast<uint8>(nR);
+			uint32 g = static_cast<uint8>(nG);
+			uint32 b = static_cast<uint8>(nB);
+
+			uint8 a = 0;
+			uint32 rgb = (b << 16) | (g << 8) | (r << 0);
+			if(rgb < alphaTh0)
+			{
+				a = 0;
+			}
+			else if(rgb < alphaTh1)
+			{
+				a = 0x40;
+			}
+			else
+			{
+				a = 0x80;
+			}
+
+			unsigned int pixelIndex = (i * 0x10) + j;
+			if(!ofm)
+			{
+				pixels32[pixelIndex] = (static_cast<uint32>(a) << 24) | rgb;
+			}
+			else
+			{
+				int32 dither = dte ? g_ditherMatrix[i & 3][j & 3] : 0;
+				r = std::min<int32>(std::max<int32>(static_cast<int32>(r) + dither, 0), 255) >> 3;
+				g = std::min<int32>(std::max<int32>(static_cast<int32>(g) + dither, 0), 255) >> 3;
+				b = std::min<int32>(std::max<int32>(static_cast<int32>(b) + dither, 0), 255) >> 3;
+				uint32 a16 = (a == 0x40) ? 1 : 0;
+				pixels16[pixelIndex] = static_cast<uint16>((a16 << 15) | (b << 10) | (g << 5) | r);
+			}
+		}
+	}
+}
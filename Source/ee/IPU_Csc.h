@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Types.h"
+
+namespace IPU
+{
+	//Converts 16x16 YCbCr 4:2:0 macroblocks to RGB32 or RGB16 (optionally dithered), as done by the CSC command.
+	//Uses SSE2 when available, the scalar version yields the same results.
+	class CCsc
+	{
+	public:
+		enum
+		{
+			BLOCK_SIZE = 0x180,
+			RGB32_SIZE = 0x400,
+			RGB16_SIZE = 0x200,
+		};
+
+		static void		ConvertBlock(const uint8*, void*, bool, bool, uint16, uint16);
+
+	private:
+		static void		ConvertBlockScalar(const uint8*, void*, bool, bool, uint16, uint16);
+	};
+}
@@ -0,0 +1,123 @@
+#include <cmath>
+#include <algorithm>
+#include "IPU_Idct.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define IPU_IDCT_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace IPU;
+
+namespace
+{
+	//g_basis[x][u] = C(u) / 2 * cos((2x + 1) * u * pi / 16)
+	struct BASIS
+	{
+		BASIS()
+		{
+			static const double pi = 3.14159265358979323846;
+			for(unsigned int x = 0; x < 8; x++)
+			{
+				for(unsigned int u = 0; u < 8; u++)
+				{
+					double scale = (u == 0) ? sqrt(0.5) : 1.0;
+					double value = 0.5 * scale * cos(static_cast<double>((2 * x + 1) * u) * pi / 16.0);
+					values[x][u] = static_cast<float>(value);
+					transposed[u][x] = static_cast<float>(value);
+				}
+			}
+		}
+
+		alignas(16) float	values[8][8];
+		alignas(16) float	transposed[8][8];
+	};
+
+	const BASIS g_basis;
+}
+
+void CIdct::Transform(const int16* input, int16* output)
+{
+#ifdef IPU_IDCT_SSE2
+	//Rows: temp[r] = sum(input[r][u] * basis[.][u])
+	__m128 temp[8][2];
+	for(unsigned int r = 0; r < 8; r++)
+	{
+		__m128 sumLo = _mm_setzero_ps();
+		__m128 sumHi = _mm_setzero_ps();
+		for(unsigned int u = 0; u < 8; u++)
+		{
+			__m128 coeff = _mm_set1_ps(static_cast<float>(input[(r * 8) + u]));
+			sumLo = _mm_add_ps(sumLo, _mm_mul_ps(coeff, _mm_load_ps(g_basis.transposed[u] + 0)));
+			sumHi = _mm_add_ps(sumHi, _mm_mul_ps(coeff, _mm_load_ps(g_basis.transposed[u] + 4)));
+		}
+		temp[r][0] = sumLo;
+		temp[r][1] = sumHi;
+	}
+
+	//Columns: output[y] = sum(basis[y][v] * temp[v]), rounded to nearest and clamped to [-256, 255]
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128i one = _mm_set1_epi32(1);
+	__m128i minValue = _mm_set1_epi16(-256);
+	__m128i maxValue = _mm_set1_epi16(255);
+	for(unsigned int y = 0; y < 8; y++)
+	{
+		__m128 sumLo = _mm_setzero_ps();
+		__m128 sumHi = _mm_setzero_ps();
+		for(unsigned int v = 0; v < 8; v++)
+		{
+			__m128 factor = _mm_set1_ps(g_basis.values[y][v]);
+			sumLo = _mm_add_ps(sumLo, _mm_mul_ps(factor, temp[v][0]));
+			sumHi = _mm_add_ps(sumHi, _mm_mul_ps(factor, temp[v][1]));
+		}
+
+		//floor(x + 0.5): truncate and fix up values that were rounded up
+		sumLo = _mm_add_ps(sumLo, half);
+		sumHi = _mm_add_ps(sumHi, half);
+		__m128i intLo = _mm_cvttps_epi32(sumLo);
+		__m128i intHi = _mm_cvttps_epi32(sumHi);
+		intLo = _mm_sub_epi32(intLo, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(intLo), sumLo)), one));
+		intHi = _mm_sub_epi32(intHi, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(intHi), sumHi)), one));
+
+		__m128i result = _mm_packs_epi32(intLo, intHi);
+		result = _mm_max_epi16(result, minValue);
+		result = _mm_min_epi16(result, maxValue);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output + (y * 8)), result);
+	}
+#else
+	TransformScalar(input, output);
+#endif
+}
+
+void CIdct::TransformScalar(const int16* input, int16* output)
+{
+	float temp[8][8];
+	for(unsigned int r = 0; r < 8; r++)
+	{
+		for(unsigned int x = 0; x < 8; x++)
+		{
+			float sum = 0;
+			for(unsigned int u = 0; u < 8; u++)
+			{
+				sum += static_cast<float>(input[(r * 8) + u]) * g_basis.transposed[u][x];
+			}
+			temp[r][x] = sum;
+		}
+	}
+
+	for(unsigned int y = 0; y < 8; y++)
+	{
+		for(unsigned int x = 0; x < 8; x++)
+		{
+			float sum = 0;
+			for(unsigned int v = 0; v < 8; v++)
+			{
+				sum += g_basis.values[y][v] * temp[v][x];
+			}
+			int32 value = static_cast<int32>(std::floor(sum + 0.5f));
+			value = std::max<int32>(value, -256);
+			value = std::min<int32>(value, 255);
+			output[(y * 8) + x] = static_cast<int16>(value);
+		}
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Types.h"
+
+namespace IPU
+{
+	//Separable 8x8 inverse DCT computed in single precision floating point.
+	//Accurate enough to satisfy IEEE 1180 while being a lot cheaper than the double precision
+	//reference implementation. Uses SSE2 when available, the scalar version yields the same results.
+	class CIdct
+	{
+	public:
+		static void		Transform(const int16*, int16*);
+
+	private:
+		static void		TransformScalar(const int16*, int16*);
+	};
+}
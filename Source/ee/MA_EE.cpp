@@ -114,6 +114,24 @@ void CMA_EE::LQ()
 
 	ComputeMemAccessAddr();
 
+	if(m_pCtx->m_fastMemory != nullptr)
+	{
+		BeginFastMemAccess(16);
+		{
+			m_codeGen->MD_LoadFromRef();
+			m_codeGen->MD_PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		}
+		m_codeGen->Else();
+		{
+			m_codeGen->PushCtx();
+			m_codeGen->PushRel(offsetof(CMIPS, m_memAccessAddress));
+			m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_GetQuadProxy), 2, Jitter::CJitter::RETURN_VALUE_128);
+			m_codeGen->MD_PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		}
+		m_codeGen->EndIf();
+		return;
+	}
+
 	m_codeGen->PushCtx();
 	m_codeGen->PushIdx(1);
 	m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_GetQuadProxy), 2, Jitter::CJitter::RETURN_VALUE_128);
@@ -127,6 +145,24 @@ void CMA_EE::SQ()
 {
 	ComputeMemAccessAddr();
 
+	if(m_pCtx->m_fastMemory != nullptr)
+	{
+		BeginFastMemAccess(16);
+		{
+			m_codeGen->MD_PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+			m_codeGen->MD_StoreAtRef();
+		}
+		m_codeGen->Else();
+		{
+			m_codeGen->PushCtx();
+			m_codeGen->MD_PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+			m_codeGen->PushRel(offsetof(CMIPS, m_memAccessAddress));
+			m_codeGen->Call(reinterpret_cast<void*>(&MemoryUtils_SetQuadProxy), 3, Jitter::CJitter::RETURN_VALUE_NONE);
+		}
+		m_codeGen->EndIf();
+		return;
+	}
+
 	m_codeGen->PushCtx();
 	m_codeGen->MD_PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
 	m_codeGen->PushIdx(2);
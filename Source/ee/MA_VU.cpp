@@ -32,6 +32,12 @@ void CMA_VU::SetRelativePipeTime(uint32 relativePipeTime)
 	m_Upper.SetRelativePipeTime(relativePipeTime);
 }
 
+void CMA_VU::SetCompileHints(uint32 compileHints)
+{
+	//Only upper instructions make use of hints for now
+	m_Upper.SetCompileHints(compileHints);
+}
+
 void CMA_VU::SetupReflectionTables()
 {
 	m_Lower.SetupReflectionTables();
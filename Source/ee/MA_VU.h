@@ -20,6 +20,7 @@ public:
 	VUShared::OPERANDSET					GetAffectedOperands(CMIPS*, uint32, uint32);
 
 	void									SetRelativePipeTime(uint32);
+	void									SetCompileHints(uint32);
 
 private:
 	void									SetupReflectionTables();
@@ -38,6 +39,7 @@ private:
 		uint32								GetInstructionEffectiveAddress(CMIPS*, uint32, uint32);
 
 		void								SetRelativePipeTime(uint32);
+		void								SetCompileHints(uint32);
 
 	private:
 		typedef void (CUpper::*InstructionFuncConstant)();
@@ -54,6 +56,7 @@ private:
 		uint8								m_nBc;
 		uint8								m_nDest;
 		uint32								m_relativePipeTime;
+		uint32								m_compileHints;
 
 		static void							ReflOpFtFs(MIPSReflection::INSTRUCTION*, CMIPS*, uint32, uint32, char*, unsigned int);
 
@@ -250,9 +253,11 @@ private:
 		static void							ReflOpAffWrIdRdItIs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void							ReflOpAffWrIt(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void							ReflOpAffWrItBv(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
+		static void							ReflOpAffWrItBvRdMf(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void							ReflOpAffWrItRdFs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void							ReflOpAffWrItRdIs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void							ReflOpAffWrItBvRdIs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
+		static void							ReflOpAffWrItBvRdIsMf(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void							ReflOpAffWrItRdItFs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void							ReflOpAffWrPRdFs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void							ReflOpAffWrVi1Bv(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
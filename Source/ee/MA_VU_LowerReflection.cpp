@@ -283,6 +283,12 @@ void CMA_VU::CLower::ReflOpAffWrItBv(VUINSTRUCTION*, CMIPS*, uint32, uint32 opco
 	operandSet.branchValue = true;
 }
 
+void CMA_VU::CLower::ReflOpAffWrItBvRdMf(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrItBv(instr, context, address, opcode, operandSet);
+	operandSet.readMACflags = true;
+}
+
 void CMA_VU::CLower::ReflOpAffWrItRdFs(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode, OPERANDSET& operandSet)
 {
 	auto it = static_cast<uint8>((opcode >> 16) & 0x001F);
@@ -311,6 +317,12 @@ void CMA_VU::CLower::ReflOpAffWrItBvRdIs(VUINSTRUCTION*, CMIPS*, uint32, uint32
 	operandSet.branchValue = true;
 }
 
+void CMA_VU::CLower::ReflOpAffWrItBvRdIsMf(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrItBvRdIs(instr, context, address, opcode, operandSet);
+	operandSet.readMACflags = true;
+}
+
 void CMA_VU::CLower::ReflOpAffWrItRdItFs(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode, OPERANDSET& operandSet)
 {
 	auto it = static_cast<uint8>((opcode >> 16) & 0x001F);
@@ -746,13 +758,13 @@ VUINSTRUCTION CMA_VU::CLower::m_cVuReflGeneral[128] =
 	{	"FCOR",		NULL,			ReflOpAffWrVi1Bv	},
 	{	NULL,		NULL,			NULL				},
 	{	"FSSET",	NULL,			ReflOpAffNone		},
-	{	"FSAND",	NULL,			ReflOpAffWrItBv		},
-	{	"FSOR",		NULL,			ReflOpAffWrItBv		},
+	{	"FSAND",	NULL,			ReflOpAffWrItBvRdMf	},
+	{	"FSOR",		NULL,			ReflOpAffWrItBvRdMf	},
 	//0x18
-	{	"FMEQ",		NULL,			ReflOpAffWrItBvRdIs	},
+	{	"FMEQ",		NULL,			ReflOpAffWrItBvRdIsMf	},
 	{	NULL,		NULL,			NULL				},
-	{	"FMAND",	NULL,			ReflOpAffWrItBvRdIs	},
-	{	"FMOR",		NULL,			ReflOpAffWrItBvRdIs	},
+	{	"FMAND",	NULL,			ReflOpAffWrItBvRdIsMf	},
+	{	"FMOR",		NULL,			ReflOpAffWrItBvRdIsMf	},
 	{	"FCGET",	NULL,			ReflOpAffWrItBv		},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
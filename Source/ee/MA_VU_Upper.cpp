@@ -13,6 +13,7 @@ CMA_VU::CUpper::CUpper()
 , m_nBc(0)
 , m_nDest(0)
 , m_relativePipeTime(0)
+, m_compileHints(0)
 {
 
 }
@@ -53,6 +54,11 @@ void CMA_VU::CUpper::SetRelativePipeTime(uint32 relativePipeTime)
 	m_relativePipeTime = relativePipeTime;
 }
 
+void CMA_VU::CUpper::SetCompileHints(uint32 compileHints)
+{
+	m_compileHints = compileHints;
+}
+
 void CMA_VU::CUpper::LOI(uint32 nValue)
 {
 	m_codeGen->PushCst(nValue);
@@ -69,7 +75,7 @@ void CMA_VU::CUpper::LOI(uint32 nValue)
 //03
 void CMA_VU::CUpper::ADDbc()
 {
-	VUShared::ADDbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime);
+	VUShared::ADDbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime, m_compileHints);
 }
 
 //04
@@ -78,7 +84,7 @@ void CMA_VU::CUpper::ADDbc()
 //07
 void CMA_VU::CUpper::SUBbc()
 {
-	VUShared::SUBbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime);
+	VUShared::SUBbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime, m_compileHints);
 }
 
 //08
@@ -87,7 +93,7 @@ void CMA_VU::CUpper::SUBbc()
 //0B
 void CMA_VU::CUpper::MADDbc()
 {
-	VUShared::MADDbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime);
+	VUShared::MADDbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime, m_compileHints);
 }
 
 //0C
@@ -96,7 +102,7 @@ void CMA_VU::CUpper::MADDbc()
 //0F
 void CMA_VU::CUpper::MSUBbc()
 {
-	VUShared::MSUBbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime);
+	VUShared::MSUBbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime, m_compileHints);
 }
 
 //10
@@ -123,13 +129,13 @@ void CMA_VU::CUpper::MINIbc()
 //1B
 void CMA_VU::CUpper::MULbc()
 {
-	VUShared::MULbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime);
+	VUShared::MULbc(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_nBc, m_relativePipeTime, m_compileHints);
 }
 
 //1C
 void CMA_VU::CUpper::MULq()
 {
-	VUShared::MULq(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime);
+	VUShared::MULq(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime, m_compileHints);
 }
 
 //1D
@@ -159,19 +165,19 @@ void CMA_VU::CUpper::ADDq()
 //21
 void CMA_VU::CUpper::MADDq()
 {
-	VUShared::MADDq(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime);
+	VUShared::MADDq(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime, m_compileHints);
 }
 
 //22
 void CMA_VU::CUpper::ADDi()
 {
-	VUShared::ADDi(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime);
+	VUShared::ADDi(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime, m_compileHints);
 }
 
 //23
 void CMA_VU::CUpper::MADDi()
 {
-	VUShared::MADDi(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime);
+	VUShared::MADDi(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime, m_compileHints);
 }
 
 //24
@@ -189,7 +195,7 @@ void CMA_VU::CUpper::MSUBq()
 //26
 void CMA_VU::CUpper::SUBi()
 {
-	VUShared::SUBi(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime);
+	VUShared::SUBi(m_codeGen, m_nDest, m_nFD, m_nFS, m_relativePipeTime, m_compileHints);
 }
 
 //27
@@ -201,19 +207,19 @@ void CMA_VU::CUpper::MSUBi()
 //28
 void CMA_VU::CUpper::ADD()
 {
-	VUShared::ADD(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime);
+	VUShared::ADD(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime, m_compileHints);
 }
 
 //29
 void CMA_VU::CUpper::MADD()
 {
-	VUShared::MADD(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime);
+	VUShared::MADD(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime, m_compileHints);
 }
 
 //2A
 void CMA_VU::CUpper::MUL()
 {
-	VUShared::MUL(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime);
+	VUShared::MUL(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime, m_compileHints);
 }
 
 //2B
@@ -225,19 +231,19 @@ void CMA_VU::CUpper::MAX()
 //2C
 void CMA_VU::CUpper::SUB()
 {
-	VUShared::SUB(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime);
+	VUShared::SUB(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime, m_compileHints);
 }
 
 //2D
 void CMA_VU::CUpper::MSUB()
 {
-	VUShared::MSUB(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime);
+	VUShared::MSUB(m_codeGen, m_nDest, m_nFD, m_nFS, m_nFT, m_relativePipeTime, m_compileHints);
 }
 
 //2E
 void CMA_VU::CUpper::OPMSUB()
 {
-	VUShared::OPMSUB(m_codeGen, m_nFD, m_nFS, m_nFT, m_relativePipeTime);
+	VUShared::OPMSUB(m_codeGen, m_nFD, m_nFS, m_nFT, m_relativePipeTime, m_compileHints);
 }
 
 //2F
@@ -283,25 +289,25 @@ void CMA_VU::CUpper::ADDAbc()
 //01
 void CMA_VU::CUpper::SUBAbc()
 {
-	VUShared::SUBAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, m_relativePipeTime);
+	VUShared::SUBAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, m_relativePipeTime, m_compileHints);
 }
 
 //02
 void CMA_VU::CUpper::MADDAbc()
 {
-	VUShared::MADDAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, m_relativePipeTime);
+	VUShared::MADDAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, m_relativePipeTime, m_compileHints);
 }
 
 //03
 void CMA_VU::CUpper::MSUBAbc()
 {
-	VUShared::MSUBAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, m_relativePipeTime);
+	VUShared::MSUBAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, m_relativePipeTime, m_compileHints);
 }
 
 //06
 void CMA_VU::CUpper::MULAbc()
 {
-	VUShared::MULAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, m_relativePipeTime);
+	VUShared::MULAbc(m_codeGen, m_nDest, m_nFS, m_nFT, m_nBc, m_relativePipeTime, m_compileHints);
 }
 
 //////////////////////////////////////////////////
@@ -335,7 +341,7 @@ void CMA_VU::CUpper::ADDA()
 //0B
 void CMA_VU::CUpper::SUBA()
 {
-	VUShared::SUBA(m_codeGen, m_nDest, m_nFS, m_nFT, m_relativePipeTime);
+	VUShared::SUBA(m_codeGen, m_nDest, m_nFS, m_nFT, m_relativePipeTime, m_compileHints);
 }
 
 //////////////////////////////////////////////////
@@ -363,19 +369,19 @@ void CMA_VU::CUpper::ABS()
 //09
 void CMA_VU::CUpper::MSUBAq()
 {
-	VUShared::MSUBAq(m_codeGen, m_nDest, m_nFS, m_relativePipeTime);
+	VUShared::MSUBAq(m_codeGen, m_nDest, m_nFS, m_relativePipeTime, m_compileHints);
 }
 
 //0A
 void CMA_VU::CUpper::MADDA()
 {
-	VUShared::MADDA(m_codeGen, m_nDest, m_nFS, m_nFT, m_relativePipeTime);
+	VUShared::MADDA(m_codeGen, m_nDest, m_nFS, m_nFT, m_relativePipeTime, m_compileHints);
 }
 
 //0B
 void CMA_VU::CUpper::MSUBA()
 {
-	VUShared::MSUBA(m_codeGen, m_nDest, m_nFS, m_nFT, m_relativePipeTime);
+	VUShared::MSUBA(m_codeGen, m_nDest, m_nFS, m_nFT, m_relativePipeTime, m_compileHints);
 }
 
 //////////////////////////////////////////////////
@@ -409,7 +415,7 @@ void CMA_VU::CUpper::ADDAi()
 //09
 void CMA_VU::CUpper::SUBAi()
 {
-	VUShared::SUBAi(m_codeGen, m_nDest, m_nFS, m_relativePipeTime);
+	VUShared::SUBAi(m_codeGen, m_nDest, m_nFS, m_relativePipeTime, m_compileHints);
 }
 
 //0A
@@ -449,13 +455,13 @@ void CMA_VU::CUpper::CLIP()
 //08
 void CMA_VU::CUpper::MADDAi()
 {
-	VUShared::MADDAi(m_codeGen, m_nDest, m_nFS, m_relativePipeTime);
+	VUShared::MADDAi(m_codeGen, m_nDest, m_nFS, m_relativePipeTime, m_compileHints);
 }
 
 //09
 void CMA_VU::CUpper::MSUBAi()
 {
-	VUShared::MSUBAi(m_codeGen, m_nDest, m_nFS, m_relativePipeTime);
+	VUShared::MSUBAi(m_codeGen, m_nDest, m_nFS, m_relativePipeTime, m_compileHints);
 }
 
 //0B
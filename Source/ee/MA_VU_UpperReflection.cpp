@@ -254,23 +254,23 @@ INSTRUCTION CMA_VU::CUpper::m_cReflVX3[32] =
 VUINSTRUCTION CMA_VU::CUpper::m_cVuReflV[64] =
 {
 	//0x00
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
+	{	"ADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"ADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"ADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"ADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"SUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"SUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"SUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"SUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
 	//0x08
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
+	{	"MADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
 	//0x10
 	{	"MAX",		NULL,			ReflOpAffWrFdRdFtFs	},
 	{	"MAX",		NULL,			ReflOpAffWrFdRdFtFs	},
@@ -281,31 +281,31 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflV[64] =
 	{	"MINI",		NULL,			ReflOpAffWrFdRdFtFs	},
 	{	"MINI",		NULL,			ReflOpAffWrFdRdFtFs	},
 	//0x18
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffFdFsQ		},
+	{	"MUL",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MUL",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MUL",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MUL",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MUL",		NULL,			ReflOpAffWrFdMfRdFsQ	},
 	{	"MAX",		NULL,			ReflOpAffFdFsI		},
 	{	"MUL",		NULL,			ReflOpAffFdFsI		},
 	{	"MINI",		NULL,			ReflOpAffFdFsI		},
 	//0x20
 	{	"ADD",		NULL,			ReflOpAffFdFsQ		},
-	{	"MADD",		NULL,			ReflOpAffFdFsQ		},
-	{	"ADD",		NULL,			ReflOpAffFdFsI		},
-	{	"MADD",		NULL,			ReflOpAffFdFsI		},
+	{	"MADD",		NULL,			ReflOpAffWrFdMfRdFsQ	},
+	{	"ADD",		NULL,			ReflOpAffWrFdMfRdFsI	},
+	{	"MADD",		NULL,			ReflOpAffWrFdMfRdFsI	},
 	{	"SUB",		NULL,			ReflOpAffFdFsQ		},
 	{	"MSUB",		NULL,			ReflOpAffFdFsQ		},
-	{	"SUB",		NULL,			ReflOpAffFdFsI		},
+	{	"SUB",		NULL,			ReflOpAffWrFdMfRdFsI	},
 	{	"MSUB",		NULL,			ReflOpAffFdFsI		},
 	//0x28
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
+	{	"ADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MADD",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MUL",		NULL,			ReflOpAffWrFdMfRdFtFs	},
 	{	"MAX",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"OPMSUB",	NULL,			ReflOpAffWrFdRdFtFs	},
+	{	"SUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdMfRdFtFs	},
+	{	"OPMSUB",	NULL,			ReflOpAffWrFdMfRdFtFs	},
 	{	"MINI",		NULL,			ReflOpAffWrFdRdFtFs	},
 	//0x30
 	{	NULL,		NULL,			NULL				},
@@ -331,18 +331,18 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX0[32] =
 {
 	//0x00
 	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"SUBA",		NULL,			ReflOpAffWrAMfRdFtFs	},
+	{	"MADDA",	NULL,			ReflOpAffWrAMfRdFtFs	},
+	{	"MSUBA",	NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	"ITOF0",	NULL,			ReflOpAffFtFs		},
 	{	"FTOI0",	NULL,			ReflOpAffFtFs		},
-	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
+	{	"MULA",		NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	"MULA",		NULL,			ReflOpAffWrARdFsQ	},
 	//0x08
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
 	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
+	{	"SUBA",		NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
@@ -371,18 +371,18 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX1[32] =
 {
 	//0x00
 	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"SUBA",		NULL,			ReflOpAffWrAMfRdFtFs	},
+	{	"MADDA",	NULL,			ReflOpAffWrAMfRdFtFs	},
+	{	"MSUBA",	NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	"ITOF4",	NULL,			ReflOpAffFtFs,		},
 	{	"FTOI4",	NULL,			ReflOpAffFtFs,		},
-	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
+	{	"MULA",		NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	"ABS",		NULL,			ReflOpAffFtFs		},
 	//0x08
 	{	NULL,		NULL,			NULL				},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFsQ	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"MSUBA",	NULL,			ReflOpAffWrAMfRdFsQ	},
+	{	"MADDA",	NULL,			ReflOpAffWrAMfRdFtFs	},
+	{	"MSUBA",	NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
@@ -411,16 +411,16 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX2[32] =
 {
 	//0x00
 	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"SUBA",		NULL,			ReflOpAffWrAMfRdFtFs	},
+	{	"MADDA",	NULL,			ReflOpAffWrAMfRdFtFs	},
+	{	"MSUBA",	NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	"ITOF12",	NULL,			ReflOpAffFtFs		},
 	{	"FTOI12",	NULL,			ReflOpAffFtFs		},
-	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
+	{	"MULA",		NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	"MULA",		NULL,			ReflOpAffAccFsI		},
 	//0x08
 	{	"ADDA",		NULL,			ReflOpAffAccFsI,	},
-	{	"SUBA",		NULL,			ReflOpAffAccFsI,	},
+	{	"SUBA",		NULL,			ReflOpAffWrAMfRdFsI	},
 	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
 	{	"OPMULA",	NULL,			ReflOpAffWrARdFtFs	},
 	{	NULL,		NULL,			NULL				},
@@ -451,16 +451,16 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX3[32] =
 {
 	//0x00
 	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"SUBA",		NULL,			ReflOpAffWrAMfRdFtFs	},
+	{	"MADDA",	NULL,			ReflOpAffWrAMfRdFtFs	},
+	{	"MSUBA",	NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	"ITOF15",	NULL,			ReflOpAffFtFs		},
 	{	"FTOI15",	NULL,			ReflOpAffFtFs		},
-	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
+	{	"MULA",		NULL,			ReflOpAffWrAMfRdFtFs	},
 	{	"CLIP",		NULL,			ReflOpAffWrCfRdFtFs	},
 	//0x08
-	{	"MADDA",	NULL,			ReflOpAffAccFsI		},
-	{	"MSUBA",	NULL,			ReflOpAffAccFsI		},
+	{	"MADDA",	NULL,			ReflOpAffWrAMfRdFsI	},
+	{	"MSUBA",	NULL,			ReflOpAffWrAMfRdFsI	},
 	{	NULL,		NULL,			NULL				},
 	{	"NOP",		NULL,			ReflOpAffNone		},
 	{	NULL,		NULL,			NULL				},
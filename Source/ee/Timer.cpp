@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <algorithm>
 #include "../Log.h"
 #include "../RegisterStateFile.h"
 #include "Timer.h"
@@ -34,22 +35,7 @@ void CTimer::Count(unsigned int ticks)
 		uint32 previousCount	= timer->nCOUNT;
 		uint32 nextCount		= timer->nCOUNT;
 
-		uint32 divider = 1;
-		switch(timer->nMODE & 0x03)
-		{
-		case 0x00:
-			divider = 1;
-			break;
-		case 0x01:
-			divider = 16;
-			break;
-		case 0x02:
-			divider = 256;
-			break;
-		case 0x03:
-			divider = 9437;		// PAL
-			break;
-		}
+		uint32 divider = GetClockDivider(timer->nMODE);
 
 		//Compute increment
 		uint32 totalTicks = timer->clockRemain + ticks;
@@ -94,6 +80,52 @@ void CTimer::Count(unsigned int ticks)
 	}
 }
 
+uint32 CTimer::GetTicksUntilNextInterrupt() const
+{
+	uint64 result = 0xFFFFFFFF;
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		const TIMER* timer = &m_timer[i];
+
+		if(!(timer->nMODE & MODE_COUNT_ENABLE)) continue;
+
+		uint32 compare = (timer->nCOMP == 0) ? 0x10000 : timer->nCOMP;
+		uint32 count = timer->nCOUNT;
+
+		//Count increments needed to reach the next interrupt condition
+		uint32 increments = 0xFFFFFFFF;
+		if(timer->nMODE & MODE_EQUAL_INTERRUPT)
+		{
+			increments = (count < compare) ? (compare - count) : ((0x10000 - count) + compare);
+		}
+		if(timer->nMODE & MODE_OVERFLOW_INTERRUPT)
+		{
+			increments = std::min<uint32>(increments, (count < 0xFFFF) ? (0xFFFF - count) : 1);
+		}
+		if(increments == 0xFFFFFFFF) continue;
+
+		uint64 ticks = (static_cast<uint64>(increments) * GetClockDivider(timer->nMODE)) - timer->clockRemain;
+		result = std::min<uint64>(result, ticks);
+	}
+	return static_cast<uint32>(std::max<uint64>(result, 1));
+}
+
+uint32 CTimer::GetClockDivider(uint32 mode)
+{
+	switch(mode & 0x03)
+	{
+	default:
+	case 0x00:
+		return 1;
+	case 0x01:
+		return 16;
+	case 0x02:
+		return 256;
+	case 0x03:
+		return 9437;		// PAL
+	}
+}
+
 uint32 CTimer::GetRegister(uint32 nAddress)
 {
 	DisassembleGet(nAddress);
@@ -13,6 +13,8 @@ public:
 	{
 		MODE_ZERO_RETURN	= 0x040,
 		MODE_COUNT_ENABLE	= 0x080,
+		MODE_EQUAL_INTERRUPT	= 0x100,
+		MODE_OVERFLOW_INTERRUPT	= 0x200,
 		MODE_EQUAL_FLAG		= 0x400,
 		MODE_OVERFLOW_FLAG	= 0x800,
 	};
@@ -24,6 +26,9 @@ public:
 
 	void					Count(unsigned int);
 
+	//Amount of ticks before a timer raises an interrupt, might be a bit early but never late
+	uint32					GetTicksUntilNextInterrupt() const;
+
 	uint32					GetRegister(uint32);
 	void					SetRegister(uint32, uint32);
 
@@ -34,6 +39,8 @@ private:
 	void					DisassembleGet(uint32);
 	void					DisassembleSet(uint32, uint32);
 
+	static uint32			GetClockDivider(uint32);
+
 	struct TIMER
 	{
 		uint32	nCOUNT;
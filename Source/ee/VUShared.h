@@ -19,6 +19,16 @@ namespace VUShared
 		VECTOR_COMPW = 3,
 	};
 
+	enum COMPILEHINT
+	{
+		COMPILEHINT_SKIPFMACUPDATE = 0x01,
+	};
+
+	enum
+	{
+		LATENCY_MAC = 4,
+	};
+
 	struct REGISTER_PIPEINFO
 	{
 		size_t value;
@@ -44,6 +54,8 @@ namespace VUShared
 		unsigned int			readI1;
 		bool					syncQ;
 		bool					readQ;
+		bool					readMACflags;
+		bool					writeMACflags;
 
 		//When set, means that a branch following the instruction will be
 		//able to use the integer value directly
@@ -83,20 +95,20 @@ namespace VUShared
 	void						PushIntegerRegister(CMipsJitter*, unsigned int);
 
 	void						ClampVector(CMipsJitter*);
-	void						TestSZFlags(CMipsJitter*, uint8, size_t, uint32);
+	void						TestSZFlags(CMipsJitter*, uint8, size_t, uint32, uint32);
 
 	void						ADDA_base(CMipsJitter*, uint8, size_t, size_t, bool);
-	void						MADD_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32);
-	void						MADDA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32);
-	void						SUBA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32);
+	void						MADD_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32, uint32);
+	void						MADDA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32, uint32);
+	void						SUBA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32, uint32);
 	void						MSUB_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool);
-	void						MSUBA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32);
+	void						MSUBA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32, uint32);
 
 	//Shared instructions
 	void						ABS(CMipsJitter*, uint8, uint8, uint8);
-	void						ADD(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void						ADDbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
-	void						ADDi(CMipsJitter*, uint8, uint8, uint8, uint32);
+	void						ADD(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						ADDbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						ADDi(CMipsJitter*, uint8, uint8, uint8, uint32, uint32);
 	void						ADDq(CMipsJitter*, uint8, uint8, uint8);
 	void						ADDA(CMipsJitter*, uint8, uint8, uint8);
 	void						ADDAbc(CMipsJitter*, uint8, uint8, uint8, uint8);
@@ -123,13 +135,13 @@ namespace VUShared
 	void						LQbase(CMipsJitter*, uint8, uint8);
 	void						LQD(CMipsJitter*, uint8, uint8, uint8, uint32);
 	void						LQI(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void						MADD(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void						MADDbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
-	void						MADDi(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void						MADDq(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void						MADDA(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void						MADDAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void						MADDAi(CMipsJitter*, uint8, uint8, uint32);
+	void						MADD(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						MADDbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						MADDi(CMipsJitter*, uint8, uint8, uint8, uint32, uint32);
+	void						MADDq(CMipsJitter*, uint8, uint8, uint8, uint32, uint32);
+	void						MADDA(CMipsJitter*, uint8, uint8, uint8, uint32, uint32);
+	void						MADDAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						MADDAi(CMipsJitter*, uint8, uint8, uint32, uint32);
 	void						MAX(CMipsJitter*, uint8, uint8, uint8, uint8);
 	void						MAXbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8);
 	void						MAXi(CMipsJitter*, uint8, uint8, uint8);
@@ -138,25 +150,25 @@ namespace VUShared
 	void						MINIi(CMipsJitter*, uint8, uint8, uint8);
 	void						MOVE(CMipsJitter*, uint8, uint8, uint8);
 	void						MR32(CMipsJitter*, uint8, uint8, uint8);
-	void						MSUB(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void						MSUBbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
+	void						MSUB(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						MSUBbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, uint32);
 	void						MSUBi(CMipsJitter*, uint8, uint8, uint8);
 	void						MSUBq(CMipsJitter*, uint8, uint8, uint8);
-	void						MSUBA(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void						MSUBAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void						MSUBAi(CMipsJitter*, uint8, uint8, uint32);
-	void						MSUBAq(CMipsJitter*, uint8, uint8, uint32);
+	void						MSUBA(CMipsJitter*, uint8, uint8, uint8, uint32, uint32);
+	void						MSUBAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						MSUBAi(CMipsJitter*, uint8, uint8, uint32, uint32);
+	void						MSUBAq(CMipsJitter*, uint8, uint8, uint32, uint32);
 	void						MFIR(CMipsJitter*, uint8, uint8, uint8);
 	void						MTIR(CMipsJitter*, uint8, uint8, uint8);
-	void						MUL(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void						MULbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
+	void						MUL(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						MULbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, uint32);
 	void						MULi(CMipsJitter*, uint8, uint8, uint8);
-	void						MULq(CMipsJitter*, uint8, uint8, uint8, uint32);
+	void						MULq(CMipsJitter*, uint8, uint8, uint8, uint32, uint32);
 	void						MULA(CMipsJitter*, uint8, uint8, uint8);
-	void						MULAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
+	void						MULAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, uint32);
 	void						MULAi(CMipsJitter*, uint8, uint8);
 	void						MULAq(CMipsJitter*, uint8, uint8);
-	void						OPMSUB(CMipsJitter*, uint8, uint8, uint8, uint32);
+	void						OPMSUB(CMipsJitter*, uint8, uint8, uint8, uint32, uint32);
 	void						OPMULA(CMipsJitter*, uint8, uint8);
 	void						RINIT(CMipsJitter*, uint8, uint8);
 	void						RGET(CMipsJitter*, uint8, uint8);
@@ -167,13 +179,13 @@ namespace VUShared
 	void						SQD(CMipsJitter*, uint8, uint8, uint8, uint32);
 	void						SQI(CMipsJitter*, uint8, uint8, uint8, uint32);
 	void						SQRT(CMipsJitter*, uint8, uint8, uint32);
-	void						SUB(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void						SUBbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
-	void						SUBi(CMipsJitter*, uint8, uint8, uint8, uint32);
+	void						SUB(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						SUBbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						SUBi(CMipsJitter*, uint8, uint8, uint8, uint32, uint32);
 	void						SUBq(CMipsJitter*, uint8, uint8, uint8);
-	void						SUBA(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void						SUBAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void						SUBAi(CMipsJitter*, uint8, uint8, uint32);
+	void						SUBA(CMipsJitter*, uint8, uint8, uint8, uint32, uint32);
+	void						SUBAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, uint32);
+	void						SUBAi(CMipsJitter*, uint8, uint8, uint32, uint32);
 	void						WAITQ(CMipsJitter*);
 
 	void						FlushPipeline(const REGISTER_PIPEINFO&, CMipsJitter*);
@@ -219,8 +231,14 @@ namespace VUShared
 	
 	void						ReflOpAffWrARdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
 	void						ReflOpAffWrARdFsQ(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void						ReflOpAffWrAMfRdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void						ReflOpAffWrAMfRdFsQ(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void						ReflOpAffWrAMfRdFsI(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
 	void						ReflOpAffWrCfRdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
 	void						ReflOpAffWrFdRdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void						ReflOpAffWrFdMfRdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void						ReflOpAffWrFdMfRdFsQ(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void						ReflOpAffWrFdMfRdFsI(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
 	void						ReflOpAffWrQRdFt(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
 	void						ReflOpAffWrQRdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
 
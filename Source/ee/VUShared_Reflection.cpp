@@ -382,6 +382,24 @@ void VUShared::ReflOpAffWrARdFsQ(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode,
 	operandSet.readQ = true;
 }
 
+void VUShared::ReflOpAffWrAMfRdFtFs(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrARdFtFs(instr, context, address, opcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
+void VUShared::ReflOpAffWrAMfRdFsQ(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrARdFsQ(instr, context, address, opcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
+void VUShared::ReflOpAffWrAMfRdFsI(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffAccFsI(instr, context, address, opcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
 void VUShared::ReflOpAffWrCfRdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode, OPERANDSET& operandSet)
 {
 	auto ft = static_cast<uint8>((opcode >> 16) & 0x001F);
@@ -403,6 +421,24 @@ void VUShared::ReflOpAffWrFdRdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode
 	operandSet.readF1 = fs;
 }
 
+void VUShared::ReflOpAffWrFdMfRdFtFs(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrFdRdFtFs(instr, context, address, opcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
+void VUShared::ReflOpAffWrFdMfRdFsQ(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffFdFsQ(instr, context, address, opcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
+void VUShared::ReflOpAffWrFdMfRdFsI(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffFdFsI(instr, context, address, opcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
 void VUShared::ReflOpAffWrQRdFt(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode, OPERANDSET& operandSet)
 {
 	auto ft = static_cast<uint8>((opcode >> 16) & 0x001F);
@@ -7,6 +7,7 @@
 #include "../MemoryStateFile.h"
 #include "Vpu.h"
 #include "Vif.h"
+#include "VifUnpack.h"
 
 #define LOG_NAME ("vif")
 
@@ -453,7 +454,7 @@ void CVif::ExecuteCommand(StreamType& stream, CODE nCommand)
 		break;
 	case 0x17:
 		//MSCNT
-		StartMicroProgram(m_vpu.GetContext().m_State.nPC);
+		StartMicroProgram(CVpu::MICROPROGRAM_CONTINUE);
 		break;
 	case 0x20:
 		//STMASK
@@ -503,14 +504,7 @@ void CVif::Cmd_MPG(StreamType& stream, CODE nCommand)
 	{
 		uint8* microProgram = reinterpret_cast<uint8*>(alloca(nSize));
 		stream.Read(microProgram, nSize);
-
-		//Check if there's a change
-		auto microMem = m_vpu.GetMicroMemory();
-		if(memcmp(microMem + nDstAddr, microProgram, nSize) != 0)
-		{
-			m_vpu.InvalidateMicroProgram();
-			memcpy(microMem + nDstAddr, microProgram, nSize);
-		}
+		m_vpu.WriteMicroMemory(nDstAddr, microProgram, nSize);
 	}
 
 	m_NUM -= static_cast<uint8>(nSize / 8);
@@ -601,6 +595,8 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 
 	const auto vuMem = m_vpu.GetVuMemory();
 	const auto vuMemSize = m_vpu.GetVuMemorySize();
+	//When the VU runs on its own thread, writes need to be ordered with the micro programs
+	bool queueWrites = m_vpu.IsThreaded();
 	bool usn = (m_CODE.nIMM & 0x4000) != 0;
 	bool useMask = (nCommand.nCMD & 0x10) != 0;
 	uint32 cl = m_CYCLE.nCL;
@@ -632,6 +628,33 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 
 	nDstAddr *= 0x10;
 
+	if((cl == wl) && !queueWrites)
+	{
+		//Fast path: unpack every whole element available in the stream with a specialised kernel
+		uint32 format = nCommand.nCMD & 0x0F;
+		auto unpackFunction = VifUnpack::GetFunction(format, usn, useMask, m_MODE);
+		if(unpackFunction)
+		{
+			uint32 elementSize = VifUnpack::GetElementSize(format);
+			uint32 elementCount = std::min<uint32>(currentNum, stream.GetAvailableReadBytes() / elementSize);
+			if(elementCount != 0)
+			{
+				VifUnpack::STATE state;
+				memcpy(state.row, m_R, sizeof(m_R));
+				memcpy(state.col, m_C, sizeof(m_C));
+				state.mask = m_MASK;
+				state.cycleLength = wl;
+				state.writeTick = m_writeTick;
+				nDstAddr = unpackFunction(state, vuMem, vuMemSize, nDstAddr, stream.GetDirectPointer(), elementCount);
+				stream.Skip(elementCount * elementSize);
+				memcpy(m_R, state.row, sizeof(m_R));
+				m_writeTick = state.writeTick;
+				m_readTick = state.writeTick;
+				currentNum -= elementCount;
+			}
+		}
+	}
+
 	while(currentNum != 0)
 	{
 		bool mustWrite = false;
@@ -660,7 +683,8 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 
 		if(mustWrite)
 		{
-			auto dst = reinterpret_cast<uint128*>(vuMem + nDstAddr);
+			uint128 output;
+			uint32 writeMask = 0;
 
 			for(unsigned int i = 0; i < 4; i++)
 			{
@@ -678,25 +702,44 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 						m_R[i] = writeValue.nV[i];
 					}
 
-					dst->nV[i] = writeValue.nV[i];
+					output.nV[i] = writeValue.nV[i];
 				}
 				else if(maskOp == MASK_ROW)
 				{
-					dst->nV[i] = m_R[i];
+					output.nV[i] = m_R[i];
 				}
 				else if(maskOp == MASK_COL)
 				{
 					int index = (m_writeTick > 3) ? 3 : m_writeTick;
-					dst->nV[i] = m_C[index];
+					output.nV[i] = m_C[index];
 				}
 				else if(maskOp == MASK_MASK)
 				{
 					//Don't write anything
+					continue;
 				}
 				else
 				{
 					assert(0);
 				}
+
+				writeMask |= (1 << i);
+			}
+
+			if(queueWrites)
+			{
+				m_vpu.QueueVuMemoryWrite(nDstAddr, output, writeMask);
+			}
+			else
+			{
+				auto dst = reinterpret_cast<uint128*>(vuMem + nDstAddr);
+				for(unsigned int i = 0; i < 4; i++)
+				{
+					if(writeMask & (1 << i))
+					{
+						dst->nV[i] = output.nV[i];
+					}
+				}
 			}
 			
 			currentNum--;
@@ -1195,6 +1238,37 @@ void CVif::CFifoStream::Read(void* buffer, uint32 size)
 	}
 }
 
+//Returns a pointer to the next bytes to be read, all available bytes are contiguous in the source
+const uint8* CVif::CFifoStream::GetDirectPointer() const
+{
+	assert(m_source != nullptr);
+	assert(!m_tagIncluded);
+	if(m_bufferPosition == BUFFERSIZE)
+	{
+		return m_source + m_nextAddress;
+	}
+	return m_source + m_nextAddress - BUFFERSIZE + m_bufferPosition;
+}
+
+void CVif::CFifoStream::Skip(uint32 size)
+{
+	assert(size <= GetAvailableReadBytes());
+	uint32 bufferRemain = BUFFERSIZE - m_bufferPosition;
+	if(size <= bufferRemain)
+	{
+		m_bufferPosition += size;
+		return;
+	}
+	size -= bufferRemain;
+	m_nextAddress += (size & ~(BUFFERSIZE - 1));
+	m_bufferPosition = BUFFERSIZE;
+	if(size & (BUFFERSIZE - 1))
+	{
+		SyncBuffer();
+		m_bufferPosition = size & (BUFFERSIZE - 1);
+	}
+}
+
 void CVif::CFifoStream::Flush()
 {
 	m_bufferPosition = BUFFERSIZE;
@@ -95,6 +95,8 @@ protected:
 		uint32					GetAvailableReadBytes() const;
 		uint32					GetRemainingDmaTransferSize() const;
 		void					Read(void*, uint32);
+		const uint8*			GetDirectPointer() const;
+		void					Skip(uint32);
 		void					Flush();
 		void					Align32();
 		void					SetDmaParams(uint32, uint32, bool);
@@ -162,6 +162,9 @@ void CVif1::Cmd_DIRECT(StreamType& stream, CODE nCommand)
 
 	if(nSize != 0)
 	{
+		//Packets kicked by VU1 must reach the GIF first
+		m_vpu.Synchronize();
+
 		if(m_directBuffer.size() < nSize)
 		{
 			m_directBuffer.resize(nSize);
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <cstring>
+#include <algorithm>
+#include "Types.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define VIF_UNPACK_SSE2
+#include <emmintrin.h>
+#endif
+
+//Specialised UNPACK kernels, used by the VIF when a run of whole elements is directly
+//available in its input stream and when CL == WL (every written qword consumes one element).
+//Split elements and other write cycles go through the generic path in CVif::Cmd_UNPACK.
+
+namespace VifUnpack
+{
+	enum FORMAT
+	{
+		FORMAT_S32		= 0x00,
+		FORMAT_S16		= 0x01,
+		FORMAT_S8		= 0x02,
+		FORMAT_V2_32	= 0x04,
+		FORMAT_V2_16	= 0x05,
+		FORMAT_V2_8		= 0x06,
+		FORMAT_V3_32	= 0x08,
+		FORMAT_V3_16	= 0x09,
+		FORMAT_V3_8		= 0x0A,
+		FORMAT_V4_32	= 0x0C,
+		FORMAT_V4_16	= 0x0D,
+		FORMAT_V4_8		= 0x0E,
+		FORMAT_V4_5		= 0x0F,
+	};
+
+	enum MODE
+	{
+		MODE_NORMAL		= 0,
+		MODE_OFFSET		= 1,
+		MODE_DIFFERENCE	= 2,
+	};
+
+	enum MASKOP
+	{
+		MASKOP_DATA		= 0,
+		MASKOP_ROW		= 1,
+		MASKOP_COL		= 2,
+		MASKOP_MASK		= 3,
+	};
+
+	struct STATE
+	{
+		uint32	row[4];
+		uint32	col[4];
+		uint32	mask;
+		uint32	cycleLength;
+		uint32	writeTick;
+	};
+
+	//Unpacks 'count' elements from 'src' to 'vuMem' starting at 'dstAddr', returns the next destination address
+	typedef uint32 (*FunctionType)(STATE&, uint8*, uint32, uint32, const uint8*, uint32);
+
+	inline uint32 GetElementSize(uint32 format)
+	{
+		if(format == FORMAT_V4_5) return 2;
+		uint32 fieldCount = ((format >> 2) & 0x03) + 1;
+		uint32 fieldSize = 4 >> (format & 0x03);
+		return fieldCount * fieldSize;
+	}
+
+#ifdef VIF_UNPACK_SSE2
+
+	template <uint32 size>
+	inline __m128i LoadElement(const uint8* src)
+	{
+		if(size == 16)
+		{
+			return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		}
+		else if(size > 8)
+		{
+			uint32 high = 0;
+			memcpy(&high, src + 8, size - 8);
+			return _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)), _mm_cvtsi32_si128(high));
+		}
+		else if(size > 4)
+		{
+			uint64 value = 0;
+			memcpy(&value, src, size);
+			return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&value));
+		}
+		else
+		{
+			uint32 value = 0;
+			memcpy(&value, src, size);
+			return _mm_cvtsi32_si128(value);
+		}
+	}
+
+	template <bool usn>
+	inline __m128i Widen16(__m128i value)
+	{
+		if(usn)
+		{
+			return _mm_unpacklo_epi16(value, _mm_setzero_si128());
+		}
+		else
+		{
+			return _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+		}
+	}
+
+	template <bool usn>
+	inline __m128i Widen8(__m128i value)
+	{
+		if(usn)
+		{
+			value = _mm_unpacklo_epi8(value, _mm_setzero_si128());
+			return _mm_unpacklo_epi16(value, _mm_setzero_si128());
+		}
+		else
+		{
+			value = _mm_unpacklo_epi8(value, value);
+			return _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 24);
+		}
+	}
+
+	//Fields that are not present in the element are cleared
+	template <uint32 format, bool usn>
+	inline __m128i ReadElement(const uint8* src)
+	{
+		if(format == FORMAT_V4_5)
+		{
+			uint16 color = 0;
+			memcpy(&color, src, 2);
+			return _mm_setr_epi32(
+				((color >>  0) & 0x1F) << 3,
+				((color >>  5) & 0x1F) << 3,
+				((color >> 10) & 0x1F) << 3,
+				((color >> 15) & 0x01) << 7);
+		}
+
+		auto value = LoadElement<(((format >> 2) & 0x03) + 1) * (4 >> (format & 0x03))>(src);
+		switch(format & 0x03)
+		{
+		case 1:
+			value = Widen16<usn>(value);
+			break;
+		case 2:
+			value = Widen8<usn>(value);
+			break;
+		}
+		if((format & 0x0C) == 0)
+		{
+			//Scalar formats are broadcast to all fields
+			value = _mm_shuffle_epi32(value, 0);
+		}
+		return value;
+	}
+
+	template <uint32 format, bool usn, bool useMask, uint32 mode>
+	uint32 Unpack(STATE& state, uint8* vuMem, uint32 vuMemSize, uint32 dstAddr, const uint8* src, uint32 count)
+	{
+		static const uint32 elementSize = (format == FORMAT_V4_5) ? 2 : ((((format >> 2) & 0x03) + 1) * (4 >> (format & 0x03)));
+
+		//Lane selectors for every column of the mask register
+		__m128i dataSelect[4];
+		__m128i rowSelect[4];
+		__m128i colValue[4];
+		__m128i writeSelect[4];
+		if(useMask)
+		{
+			for(unsigned int col = 0; col < 4; col++)
+			{
+				uint32 lanes[4][4] = {};
+				for(unsigned int i = 0; i < 4; i++)
+				{
+					uint32 maskOp = (state.mask >> (((col * 4) + i) * 2)) & 0x03;
+					lanes[MASKOP_DATA][i] = (maskOp == MASKOP_DATA) ? ~0U : 0;
+					lanes[MASKOP_ROW][i] = (maskOp == MASKOP_ROW) ? ~0U : 0;
+					lanes[MASKOP_COL][i] = (maskOp == MASKOP_COL) ? state.col[col] : 0;
+					lanes[MASKOP_MASK][i] = (maskOp != MASKOP_MASK) ? ~0U : 0;
+				}
+				dataSelect[col] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes[MASKOP_DATA]));
+				rowSelect[col] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes[MASKOP_ROW]));
+				colValue[col] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes[MASKOP_COL]));
+				writeSelect[col] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes[MASKOP_MASK]));
+			}
+		}
+
+		auto row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.row));
+		uint32 writeTick = state.writeTick;
+		for(uint32 i = 0; i < count; i++)
+		{
+			auto value = ReadElement<format, usn>(src);
+			auto dst = reinterpret_cast<__m128i*>(vuMem + dstAddr);
+			src += elementSize;
+
+			if(useMask)
+			{
+				unsigned int col = std::min<uint32>(writeTick, 3);
+				if(mode != MODE_NORMAL)
+				{
+					value = _mm_add_epi32(value, row);
+				}
+				if(mode == MODE_DIFFERENCE)
+				{
+					row = _mm_or_si128(_mm_and_si128(dataSelect[col], value), _mm_andnot_si128(dataSelect[col], row));
+				}
+				auto output = _mm_and_si128(dataSelect[col], value);
+				output = _mm_or_si128(output, _mm_and_si128(rowSelect[col], row));
+				output = _mm_or_si128(output, colValue[col]);
+				output = _mm_or_si128(_mm_and_si128(writeSelect[col], output), _mm_andnot_si128(writeSelect[col], _mm_loadu_si128(dst)));
+				_mm_storeu_si128(dst, output);
+			}
+			else
+			{
+				if(mode != MODE_NORMAL)
+				{
+					value = _mm_add_epi32(value, row);
+				}
+				if(mode == MODE_DIFFERENCE)
+				{
+					row = value;
+				}
+				_mm_storeu_si128(dst, value);
+			}
+
+			writeTick++;
+			if(writeTick == state.cycleLength)
+			{
+				writeTick = 0;
+			}
+			dstAddr += 0x10;
+			dstAddr &= (vuMemSize - 1);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state.row), row);
+		state.writeTick = writeTick;
+		return dstAddr;
+	}
+
+	template <uint32 format, bool usn, bool useMask>
+	FunctionType GetFunctionForMode(uint32 mode)
+	{
+		switch(mode)
+		{
+		case MODE_NORMAL:
+			return &Unpack<format, usn, useMask, MODE_NORMAL>;
+		case MODE_OFFSET:
+			return &Unpack<format, usn, useMask, MODE_OFFSET>;
+		case MODE_DIFFERENCE:
+			return &Unpack<format, usn, useMask, MODE_DIFFERENCE>;
+		default:
+			return nullptr;
+		}
+	}
+
+	template <uint32 format>
+	FunctionType GetFunctionForFormat(bool usn, bool useMask, uint32 mode)
+	{
+		if(usn)
+		{
+			return useMask ? GetFunctionForMode<format, true, true>(mode) : GetFunctionForMode<format, true, false>(mode);
+		}
+		else
+		{
+			return useMask ? GetFunctionForMode<format, false, true>(mode) : GetFunctionForMode<format, false, false>(mode);
+		}
+	}
+
+#endif
+
+	//Returns nullptr if there's no specialised kernel for this combination
+	inline FunctionType GetFunction(uint32 format, bool usn, bool useMask, uint32 mode)
+	{
+#ifdef VIF_UNPACK_SSE2
+		switch(format)
+		{
+		case FORMAT_S32:
+			//Sign extension doesn't apply to 32-bit formats
+			return GetFunctionForFormat<FORMAT_S32>(false, useMask, mode);
+		case FORMAT_S16:
+			return GetFunctionForFormat<FORMAT_S16>(usn, useMask, mode);
+		case FORMAT_S8:
+			return GetFunctionForFormat<FORMAT_S8>(usn, useMask, mode);
+		case FORMAT_V2_32:
+			return GetFunctionForFormat<FORMAT_V2_32>(false, useMask, mode);
+		case FORMAT_V2_16:
+			return GetFunctionForFormat<FORMAT_V2_16>(usn, useMask, mode);
+		case FORMAT_V2_8:
+			return GetFunctionForFormat<FORMAT_V2_8>(usn, useMask, mode);
+		case FORMAT_V3_32:
+			return GetFunctionForFormat<FORMAT_V3_32>(false, useMask, mode);
+		case FORMAT_V3_16:
+			return GetFunctionForFormat<FORMAT_V3_16>(usn, useMask, mode);
+		case FORMAT_V3_8:
+			return GetFunctionForFormat<FORMAT_V3_8>(usn, useMask, mode);
+		case FORMAT_V4_32:
+			return GetFunctionForFormat<FORMAT_V4_32>(false, useMask, mode);
+		case FORMAT_V4_16:
+			return GetFunctionForFormat<FORMAT_V4_16>(usn, useMask, mode);
+		case FORMAT_V4_8:
+			return GetFunctionForFormat<FORMAT_V4_8>(usn, useMask, mode);
+		case FORMAT_V4_5:
+			return GetFunctionForFormat<FORMAT_V4_5>(false, useMask, mode);
+		default:
+			return nullptr;
+		}
+#else
+		return nullptr;
+#endif
+	}
+}
@@ -1,3 +1,4 @@
+#include <fenv.h>
 #include "make_unique.h"
 #include "../Log.h"
 #include "../RegisterStateFile.h"
@@ -19,7 +20,12 @@ CVpu::CVpu(unsigned int number, const VPUINIT& vpuInit, CGIF& gif, uint8* ram, u
 , m_ctx(vpuInit.context)
 , m_gif(gif)
 , m_executor(*vpuInit.context)
+, m_workerIdle(false)
+, m_workerEnd(false)
+, m_commandReadIndex(0)
+, m_commandWriteIndex(0)
 , m_vuProfilerZone(CProfiler::GetInstance().RegisterZone("VU"))
+, m_vuSyncProfilerZone(CProfiler::GetInstance().RegisterZone("VUSYNC"))
 #ifdef DEBUGGER_INCLUDED
 , m_microMemMiniState(new uint8[(number == 0) ? PS2::MICROMEM0SIZE : PS2::MICROMEM1SIZE])
 , m_vuMemMiniState(new uint8[(number == 0) ? PS2::VUMEM0SIZE : PS2::VUMEM1SIZE])
@@ -32,6 +38,7 @@ CVpu::CVpu(unsigned int number, const VPUINIT& vpuInit, CGIF& gif, uint8* ram, u
 
 CVpu::~CVpu()
 {
+	StopWorkerThread();
 #ifdef DEBUGGER_INCLUDED
 	delete [] m_microMemMiniState;
 	delete [] m_vuMemMiniState;
@@ -40,6 +47,12 @@ CVpu::~CVpu()
 
 void CVpu::Execute(int32 quota)
 {
+	//Worker thread runs micro programs to completion by itself, only forward what it kicked to the GIF
+	if(IsThreaded())
+	{
+		FlushXgKicks();
+		return;
+	}
 	if(!m_running) return;
 
 #ifdef PROFILE
@@ -71,8 +84,8 @@ void CVpu::SaveMiniState()
 	memcpy(m_microMemMiniState, m_microMem, (m_number == 0) ? PS2::MICROMEM0SIZE : PS2::MICROMEM1SIZE);
 	memcpy(m_vuMemMiniState, m_vuMem, (m_number == 0) ? PS2::VUMEM0SIZE : PS2::VUMEM1SIZE);
 	memcpy(&m_vuMiniState, &m_ctx->m_State, sizeof(MIPSSTATE));
-	m_topMiniState = (m_number == 0) ? 0 : m_vif->GetTOP();
-	m_itopMiniState = m_vif->GetITOP();
+	m_topMiniState = m_vuTop;
+	m_itopMiniState = m_vuItop;
 }
 
 const MIPSSTATE& CVpu::GetVuMiniState() const
@@ -104,19 +117,189 @@ uint32 CVpu::GetVuItopMiniState() const
 
 void CVpu::Reset()
 {
+	Synchronize();
 	m_running = false;
+	m_vuTop = 0;
+	m_vuItop = 0;
 	m_executor.Reset();
 	m_vif->Reset();
 }
 
 void CVpu::SaveState(Framework::CZipArchiveWriter& archive)
 {
+	Synchronize();
 	m_vif->SaveState(archive);
 }
 
 void CVpu::LoadState(Framework::CZipArchiveReader& archive)
 {
+	Synchronize();
 	m_vif->LoadState(archive);
+	m_vuTop = (m_number == 0) ? 0 : m_vif->GetTOP();
+	m_vuItop = m_vif->GetITOP();
+}
+
+void CVpu::StartWorkerThread()
+{
+	//Only VU1 is independent enough from the EE to run on its own
+	assert(m_number == 1);
+	assert(!IsThreaded());
+	m_commands = std::unique_ptr<COMMAND[]>(new COMMAND[COMMAND_RING_SIZE]);
+	m_commandReadIndex = 0;
+	m_commandWriteIndex = 0;
+	m_workerEnd = false;
+	m_workerThread = std::thread([this] () { WorkerThreadProc(); });
+}
+
+void CVpu::StopWorkerThread()
+{
+	if(!IsThreaded()) return;
+	{
+		std::lock_guard<std::mutex> workerLock(m_workerMutex);
+		m_workerEnd = true;
+	}
+	m_workerCondition.notify_one();
+	m_workerThread.join();
+}
+
+bool CVpu::IsThreaded() const
+{
+	return m_workerThread.joinable();
+}
+
+//Waits until the worker thread has processed every pending command. Needs to be
+//called by the EE thread before it observes anything the micro programs can modify.
+void CVpu::Synchronize()
+{
+	if(!IsThreaded()) return;
+
+	if(m_commandReadIndex.load() != m_commandWriteIndex.load(std::memory_order_relaxed))
+	{
+#ifdef PROFILE
+		CProfilerZone profilerZone(m_vuSyncProfilerZone);
+#endif
+
+		while(m_commandReadIndex.load() != m_commandWriteIndex.load(std::memory_order_relaxed))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	FlushXgKicks();
+}
+
+//Called by the worker thread. The GIF and the GS command ring belong to the EE thread,
+//the packet is copied out of VU memory and sent from there.
+void CVpu::QueueXgKick(uint32 address)
+{
+	uint32 size = CGIF::GetPacketSize(m_vuMem, address, PS2::VUMEM1SIZE);
+	XGKICK xgKick;
+	xgKick.address = address;
+	xgKick.size = size;
+	std::lock_guard<std::mutex> xgKickLock(m_xgKickMutex);
+	m_queuedXgKicks.push_back(xgKick);
+	m_queuedXgKickData.insert(m_queuedXgKickData.end(), m_vuMem + address, m_vuMem + address + size);
+}
+
+//Sends packets kicked by the worker thread to the GIF, in the order they were kicked
+void CVpu::FlushXgKicks()
+{
+	{
+		std::lock_guard<std::mutex> xgKickLock(m_xgKickMutex);
+		if(m_queuedXgKicks.empty()) return;
+		std::swap(m_queuedXgKicks, m_processingXgKicks);
+		std::swap(m_queuedXgKickData, m_processingXgKickData);
+	}
+
+	CGsPacketMetadata metadata(1);
+	uint32 offset = 0;
+	for(const auto& xgKick : m_processingXgKicks)
+	{
+#ifdef DEBUGGER_INCLUDED
+		metadata.vuMemPacketAddress = xgKick.address;
+#endif
+		m_gif.ProcessPacket(m_processingXgKickData.data(), offset, offset + xgKick.size, metadata);
+		offset += xgKick.size;
+	}
+
+	m_processingXgKicks.clear();
+	m_processingXgKickData.clear();
+}
+
+void CVpu::PushCommand(const COMMAND& command)
+{
+	uint32 writeIndex = m_commandWriteIndex.load(std::memory_order_relaxed);
+	uint32 nextWriteIndex = (writeIndex + 1) & (COMMAND_RING_SIZE - 1);
+	while(nextWriteIndex == m_commandReadIndex.load())
+	{
+		//Ring is full, wait for the worker to catch up
+		std::this_thread::yield();
+	}
+	m_commands[writeIndex] = command;
+	m_commandWriteIndex.store(nextWriteIndex);
+	if(m_workerIdle.load())
+	{
+		std::lock_guard<std::mutex> workerLock(m_workerMutex);
+		m_workerCondition.notify_one();
+	}
+}
+
+void CVpu::WorkerThreadProc()
+{
+	fesetround(FE_TOWARDZERO);
+	while(!m_workerEnd)
+	{
+		uint32 readIndex = m_commandReadIndex.load(std::memory_order_relaxed);
+		if(readIndex == m_commandWriteIndex.load())
+		{
+			std::unique_lock<std::mutex> workerLock(m_workerMutex);
+			m_workerIdle = true;
+			m_workerCondition.wait(workerLock, 
+				[&] () { return m_workerEnd || (readIndex != m_commandWriteIndex.load()); });
+			m_workerIdle = false;
+			continue;
+		}
+		ProcessCommand(m_commands[readIndex]);
+		m_commandReadIndex.store((readIndex + 1) & (COMMAND_RING_SIZE - 1));
+	}
+}
+
+void CVpu::ProcessCommand(const COMMAND& command)
+{
+	switch(command.type)
+	{
+	case COMMAND_WRITE_VUMEM:
+		{
+			auto dst = reinterpret_cast<uint128*>(m_vuMem + command.address);
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				if(command.param0 & (1 << i))
+				{
+					dst->nV[i] = command.value.nV[i];
+				}
+			}
+		}
+		break;
+	case COMMAND_WRITE_MICROMEM:
+		WriteMicroMemoryImpl(command.address, reinterpret_cast<const uint8*>(&command.value), command.param0);
+		break;
+	case COMMAND_EXECUTE:
+		m_vuTop = command.param0;
+		m_vuItop = command.param1;
+		ExecuteMicroProgramImpl(command.address);
+		while(m_running && !m_workerEnd)
+		{
+			m_executor.Execute(5000);
+			if(m_ctx->m_State.nHasException)
+			{
+				m_running = false;
+			}
+		}
+		break;
+	default:
+		assert(false);
+		break;
+	}
 }
 
 CMIPS& CVpu::GetContext() const
@@ -141,6 +324,8 @@ uint32 CVpu::GetVuMemorySize() const
 
 bool CVpu::IsVuRunning() const
 {
+	//Commands sent to the worker thread are processed in order, the VU never appears as busy to the VIF
+	if(IsThreaded()) return false;
 	return m_running;
 }
 
@@ -149,8 +334,54 @@ CVif& CVpu::GetVif()
 	return *m_vif.get();
 }
 
+CMipsExecutor& CVpu::GetExecutor()
+{
+	return m_executor;
+}
+
+uint32 CVpu::GetVuTop() const
+{
+	return m_vuTop;
+}
+
+uint32 CVpu::GetVuItop() const
+{
+	return m_vuItop;
+}
+
 void CVpu::ExecuteMicroProgram(uint32 nAddress)
 {
+	uint32 top = (m_number == 0) ? 0 : m_vif->GetTOP();
+	uint32 itop = m_vif->GetITOP();
+
+	if(IsThreaded())
+	{
+		COMMAND command = {};
+		command.type = COMMAND_EXECUTE;
+		command.address = nAddress;
+		command.param0 = top;
+		command.param1 = itop;
+		PushCommand(command);
+		return;
+	}
+
+	m_vuTop = top;
+	m_vuItop = itop;
+	ExecuteMicroProgramImpl(nAddress);
+	for(unsigned int i = 0; i < 100; i++)
+	{
+		Execute(5000);
+		if(!m_running) break;
+	}
+}
+
+void CVpu::ExecuteMicroProgramImpl(uint32 nAddress)
+{
+	if(nAddress == MICROPROGRAM_CONTINUE)
+	{
+		nAddress = m_ctx->m_State.nPC;
+	}
+
 	CLog::GetInstance().Print(LOG_NAME, "Starting microprogram execution at 0x%0.8X.\r\n", nAddress);
 
 	m_ctx->m_State.nPC = nAddress;
@@ -163,11 +394,6 @@ void CVpu::ExecuteMicroProgram(uint32 nAddress)
 
 	assert(!m_running);
 	m_running = true;
-	for(unsigned int i = 0; i < 100; i++)
-	{
-		Execute(5000);
-		if(!m_running) break;
-	}
 }
 
 void CVpu::InvalidateMicroProgram()
@@ -175,11 +401,61 @@ void CVpu::InvalidateMicroProgram()
 	m_executor.ClearActiveBlocks();
 }
 
+void CVpu::WriteMicroMemory(uint32 address, const uint8* data, uint32 size)
+{
+	if(IsThreaded())
+	{
+		assert((size & 0x07) == 0);
+		while(size != 0)
+		{
+			uint32 chunkSize = std::min<uint32>(size, sizeof(uint128));
+			COMMAND command = {};
+			command.type = COMMAND_WRITE_MICROMEM;
+			command.address = address;
+			command.param0 = chunkSize;
+			memcpy(&command.value, data, chunkSize);
+			PushCommand(command);
+			address += chunkSize;
+			data += chunkSize;
+			size -= chunkSize;
+		}
+		return;
+	}
+	WriteMicroMemoryImpl(address, data, size);
+}
+
+void CVpu::WriteMicroMemoryImpl(uint32 address, const uint8* data, uint32 size)
+{
+	//Check if there's a change
+	if(memcmp(m_microMem + address, data, size) != 0)
+	{
+		InvalidateMicroProgram();
+		memcpy(m_microMem + address, data, size);
+	}
+}
+
+void CVpu::QueueVuMemoryWrite(uint32 address, const uint128& value, uint32 writeMask)
+{
+	assert(IsThreaded());
+	COMMAND command = {};
+	command.type = COMMAND_WRITE_VUMEM;
+	command.address = address;
+	command.param0 = writeMask;
+	command.value = value;
+	PushCommand(command);
+}
+
 void CVpu::ProcessXgKick(uint32 address)
 {
 	address &= 0x3FF;
 	address *= 0x10;
 
+	if(IsThreaded())
+	{
+		QueueXgKick(address);
+		return;
+	}
+
 //	assert(nAddress < PS2::VUMEM1SIZE);
 
 	CGsPacketMetadata metadata;
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 #include "Types.h"
 #include "../MIPS.h"
 #include "../Profiler.h"
@@ -8,6 +13,8 @@
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
 
+#define PREF_VPU1_USEWORKERTHREAD ("ee.vpu1.useworkerthread")
+
 class CVif;
 class CGIF;
 
@@ -22,6 +29,11 @@ public:
 		VU_CMSAR1	= 0x1000FFC0,		//This is meant to be used by the EE through CTC2
 	};
 
+	enum
+	{
+		MICROPROGRAM_CONTINUE = ~0U,	//Resumes execution from the current PC (MSCNT)
+	};
+
 	struct VPUINIT
 	{
 		VPUINIT(uint8* microMem, uint8* vuMem, CMIPS* context) 
@@ -42,6 +54,10 @@ public:
 
 	void					Execute(int32);
 	void					Reset();
+
+	void					StartWorkerThread();
+	bool					IsThreaded() const;
+	void					Synchronize();
 	void					SaveState(Framework::CZipArchiveWriter&);
 	void					LoadState(Framework::CZipArchiveReader&);
 
@@ -52,10 +68,17 @@ public:
 	bool					IsVuRunning() const;
 
 	CVif&					GetVif();
+	CMipsExecutor&			GetExecutor();
+
+	uint32					GetVuTop() const;
+	uint32					GetVuItop() const;
 
 	void					ExecuteMicroProgram(uint32);
 	void					InvalidateMicroProgram();
 
+	void					WriteMicroMemory(uint32, const uint8*, uint32);
+	void					QueueVuMemoryWrite(uint32, const uint128&, uint32);
+
 	void					ProcessXgKick(uint32);
 
 #ifdef DEBUGGER_INCLUDED
@@ -73,6 +96,48 @@ public:
 protected:
 	typedef std::unique_ptr<CVif> VifPtr;
 
+	enum
+	{
+		//Must be a power of 2
+		COMMAND_RING_SIZE = 0x4000,
+	};
+
+	enum COMMAND_TYPE
+	{
+		COMMAND_WRITE_VUMEM,
+		COMMAND_WRITE_MICROMEM,
+		COMMAND_EXECUTE,
+	};
+
+	struct COMMAND
+	{
+		uint32				type;
+		uint32				address;
+		uint32				param0;		//VUMEM: Write mask, MICROMEM: Size, EXECUTE: TOP
+		uint32				param1;		//EXECUTE: ITOP
+		uint128				value;
+	};
+
+	void					ExecuteMicroProgramImpl(uint32);
+	void					WriteMicroMemoryImpl(uint32, const uint8*, uint32);
+
+	struct XGKICK
+	{
+		uint32				address;
+		uint32				size;
+	};
+
+	typedef std::vector<XGKICK> XgKickArray;
+	typedef std::vector<uint8> XgKickDataArray;
+
+	void					QueueXgKick(uint32);
+	void					FlushXgKicks();
+
+	void					PushCommand(const COMMAND&);
+	void					ProcessCommand(const COMMAND&);
+	void					WorkerThreadProc();
+	void					StopWorkerThread();
+
 	uint8*					m_microMem = nullptr;
 	uint8*					m_vuMem = nullptr;
 	uint32					m_vuMemSize = 0;
@@ -91,6 +156,26 @@ protected:
 	unsigned int			m_number = 0;
 	CVuExecutor				m_executor;
 	bool					m_running = false;
+	uint32					m_vuTop = 0;
+	uint32					m_vuItop = 0;
+
+	//Worker thread state, the EE thread produces commands and the worker thread consumes them
+	std::thread				m_workerThread;
+	std::mutex				m_workerMutex;
+	std::condition_variable	m_workerCondition;
+	std::atomic<bool>		m_workerIdle;
+	std::atomic<bool>		m_workerEnd;
+	std::unique_ptr<COMMAND[]>	m_commands;
+	std::atomic<uint32>		m_commandReadIndex;
+	std::atomic<uint32>		m_commandWriteIndex;
+
+	//Packets kicked by the worker thread, waiting to be sent to the GIF by the EE thread
+	std::mutex				m_xgKickMutex;
+	XgKickArray				m_queuedXgKicks;
+	XgKickDataArray			m_queuedXgKickData;
+	XgKickArray				m_processingXgKicks;
+	XgKickDataArray			m_processingXgKickData;
 
 	CProfiler::ZoneHandle	m_vuProfilerZone = 0;
+	CProfiler::ZoneHandle	m_vuSyncProfilerZone = 0;
 };
@@ -19,31 +19,11 @@ void CVuBasicBlock::CompileRange(CMipsJitter* jitter)
 	assert(((m_end + 4) & 0x07) == 0);
 	auto arch = static_cast<CMA_VU*>(m_context.m_pArch);
 
-	uint32 fixedEnd = m_end;
 	bool needsPcAdjust = false;
-
-	//Make sure the delay slot instruction is present in the block.
-	//CVuExecutor can sometimes cut the blocks in a way that removes the delay slot instruction for branches.
-	{
-		uint32 addressLo = fixedEnd - 4;
-		uint32 addressHi = fixedEnd - 0;
-
-		uint32 opcodeLo = m_context.m_pMemoryMap->GetInstruction(addressLo);
-		uint32 opcodeHi = m_context.m_pMemoryMap->GetInstruction(addressHi);
-
-		//Check for LOI
-		if((opcodeHi & 0x80000000) == 0)
-		{
-			auto branchType = arch->IsInstructionBranch(&m_context, addressLo, opcodeLo);
-			if(branchType == MIPS_BRANCH_NORMAL)
-			{
-				fixedEnd += 8;
-				needsPcAdjust = true;
-			}
-		}
-	}
+	uint32 fixedEnd = GetFixedEnd(needsPcAdjust);
 
 	auto integerBranchDelayInfo = GetIntegerBranchDelayInfo(fixedEnd);
+	auto compileHints = ComputeCompileHints(fixedEnd);
 
 	for(uint32 address = m_begin; address <= fixedEnd; address += 8)
 	{
@@ -98,7 +78,9 @@ void CVuBasicBlock::CompileRange(CMipsJitter* jitter)
 		}
 
 		arch->SetRelativePipeTime(relativePipeTime);
+		arch->SetCompileHints(compileHints[relativePipeTime]);
 		arch->CompileInstruction(addressHi, jitter, &m_context);
+		arch->SetCompileHints(0);
 
 		if(savedReg != 0)
 		{
@@ -162,6 +144,60 @@ void CVuBasicBlock::CompileRange(CMipsJitter* jitter)
 	}
 }
 
+void CVuBasicBlock::GetCompiledRange(uint32& begin, uint32& end) const
+{
+	//CompileRange can pull the next instruction pair in for a delay slot and
+	//looks at the instructions preceding a conditional branch
+	begin = (m_begin >= 0x10) ? (m_begin - 0x10) : 0;
+	end = m_end + 8;
+}
+
+void CVuBasicBlock::GetCompileParameters(std::vector<uint32>& parameters) const
+{
+	bool needsPcAdjust = false;
+	uint32 fixedEnd = GetFixedEnd(needsPcAdjust);
+	auto integerBranchDelayInfo = GetIntegerBranchDelayInfo(fixedEnd);
+	auto compileHints = ComputeCompileHints(fixedEnd);
+
+	parameters.push_back(fixedEnd);
+	parameters.push_back(needsPcAdjust ? 1 : 0);
+	parameters.push_back(integerBranchDelayInfo.regIndex);
+	parameters.push_back(integerBranchDelayInfo.saveRegAddress);
+	parameters.push_back(integerBranchDelayInfo.useRegAddress);
+	//Pipeline checks depend on the position of every instruction within the block
+	parameters.push_back(static_cast<uint32>(compileHints.size()));
+	parameters.insert(parameters.end(), compileHints.begin(), compileHints.end());
+}
+
+uint32 CVuBasicBlock::GetFixedEnd(bool& needsPcAdjust) const
+{
+	//Make sure the delay slot instruction is present in the block.
+	//CVuExecutor can sometimes cut the blocks in a way that removes the delay slot instruction for branches.
+	auto arch = static_cast<CMA_VU*>(m_context.m_pArch);
+
+	uint32 fixedEnd = m_end;
+	needsPcAdjust = false;
+
+	uint32 addressLo = fixedEnd - 4;
+	uint32 addressHi = fixedEnd - 0;
+
+	uint32 opcodeLo = m_context.m_pMemoryMap->GetInstruction(addressLo);
+	uint32 opcodeHi = m_context.m_pMemoryMap->GetInstruction(addressHi);
+
+	//Check for LOI
+	if((opcodeHi & 0x80000000) == 0)
+	{
+		auto branchType = arch->IsInstructionBranch(&m_context, addressLo, opcodeLo);
+		if(branchType == MIPS_BRANCH_NORMAL)
+		{
+			fixedEnd += 8;
+			needsPcAdjust = true;
+		}
+	}
+
+	return fixedEnd;
+}
+
 bool CVuBasicBlock::IsConditionalBranch(uint32 opcodeLo)
 {
 	//Conditional branches are in the contiguous opcode range 0x28 -> 0x2F inclusive
@@ -245,3 +281,66 @@ bool CVuBasicBlock::CheckIsSpecialIntegerLoop(uint32 fixedEnd, unsigned int regI
 
 	return true;
 }
+
+CVuBasicBlock::CompileHintArray CVuBasicBlock::ComputeCompileHints(uint32 fixedEnd) const
+{
+	//Find MAC flag updates that can't be observed by anyone. An update is dead if
+	//another FMAC instruction of this block overwrites it before any instruction reads
+	//the MAC flag pipeline, and that other update is visible before the block ends.
+	//Sticky status flags are always updated.
+
+	auto arch = static_cast<CMA_VU*>(m_context.m_pArch);
+	uint32 instructionCount = ((fixedEnd - m_begin) / 8) + 1;
+	CompileHintArray hints(instructionCount, 0);
+
+	std::vector<bool> writesMac(instructionCount, false);
+	std::vector<bool> readsMac(instructionCount, false);
+	for(uint32 index = 0; index < instructionCount; index++)
+	{
+		uint32 addressLo = m_begin + (index * 8) + 0;
+		uint32 addressHi = m_begin + (index * 8) + 4;
+
+		uint32 opcodeLo = m_context.m_pMemoryMap->GetInstruction(addressLo);
+		uint32 opcodeHi = m_context.m_pMemoryMap->GetInstruction(addressHi);
+
+		auto hiOps = arch->GetAffectedOperands(&m_context, addressHi, opcodeHi);
+		writesMac[index] = hiOps.writeMACflags;
+
+		//Lower instruction is an immediate if I bit is set
+		if((opcodeHi & 0x80000000) == 0)
+		{
+			auto loOps = arch->GetAffectedOperands(&m_context, addressLo, opcodeLo);
+			readsMac[index] = loOps.readMACflags;
+		}
+	}
+
+	for(uint32 index = 0; index < instructionCount; index++)
+	{
+		if(!writesMac[index]) continue;
+
+		uint32 nextWriteIndex = index + 1;
+		while((nextWriteIndex < instructionCount) && !writesMac[nextWriteIndex])
+		{
+			nextWriteIndex++;
+		}
+
+		//Next update needs to be visible when the following block starts
+		if((nextWriteIndex + VUShared::LATENCY_MAC) > instructionCount) continue;
+
+		//Check if anyone reads the flags while this update is the current one
+		bool isRead = false;
+		for(uint32 readIndex = index + VUShared::LATENCY_MAC; readIndex < (nextWriteIndex + VUShared::LATENCY_MAC); readIndex++)
+		{
+			if(readsMac[readIndex])
+			{
+				isRead = true;
+				break;
+			}
+		}
+		if(isRead) continue;
+
+		hints[index] |= VUShared::COMPILEHINT_SKIPFMACUPDATE;
+	}
+
+	return hints;
+}
@@ -10,6 +10,8 @@ public:
 
 protected:
 	void			CompileRange(CMipsJitter*) override;
+	void			GetCompiledRange(uint32&, uint32&) const override;
+	void			GetCompileParameters(std::vector<uint32>&) const override;
 
 private:
 	struct INTEGER_BRANCH_DELAY_INFO
@@ -19,8 +21,13 @@ private:
 		uint32       useRegAddress = MIPS_INVALID_PC;
 	};
 
+	typedef std::vector<uint32> CompileHintArray;
+
 	static bool					IsConditionalBranch(uint32);
 
+	uint32						GetFixedEnd(bool&) const;
+
 	INTEGER_BRANCH_DELAY_INFO	GetIntegerBranchDelayInfo(uint32) const;
 	bool						CheckIsSpecialIntegerLoop(uint32, unsigned int) const;
+	CompileHintArray			ComputeCompileHints(uint32) const;
 };
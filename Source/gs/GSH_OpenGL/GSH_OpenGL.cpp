@@ -1,13 +1,21 @@
 #include <stdio.h>
 #include <assert.h>
 #include <math.h>
+#include <string.h>
 
 #include "../../Log.h"
 #include "../../AppConfig.h"
 #include "../GsPixelFormats.h"
 #include "GSH_OpenGL.h"
+#include "make_unique.h"
 
 #define NUM_SAMPLES 8
+//Time (in nanoseconds) to wait on a fence before trying again
+#define FENCE_WAIT_TIMEOUT 1000000
+
+//Vertex segments can hold a few full batches, uniform blocks are small
+#define VERTEX_STREAM_SEGMENT_SIZE (VERTEX_BUFFER_SIZE * sizeof(PRIM_VERTEX) * 4)
+#define UNIFORM_STREAM_SEGMENT_SIZE (0x10000)
 
 const GLenum CGSH_OpenGL::g_nativeClampModes[CGSHandler::CLAMP_MODE_MAX] =
 {
@@ -65,11 +73,6 @@ void CGSH_OpenGL::InitializeImpl()
 
 	m_nVtxCount = 0;
 
-	for(unsigned int i = 0; i < MAX_TEXTURE_CACHE; i++)
-	{
-		m_textureCache.push_back(TexturePtr(new CTexture()));
-	}
-
 	for(unsigned int i = 0; i < MAX_PALETTE_CACHE; i++)
 	{
 		m_paletteCache.push_back(PalettePtr(new CPalette()));
@@ -83,8 +86,9 @@ void CGSH_OpenGL::InitializeImpl()
 void CGSH_OpenGL::ReleaseImpl()
 {
 	ResetImpl();
+	CloseProgramCache();
 
-	m_textureCache.clear();
+	m_textureCache.Flush();
 	m_paletteCache.clear();
 	m_shaders.clear();
 	m_presentProgram.reset();
@@ -94,10 +98,9 @@ void CGSH_OpenGL::ReleaseImpl()
 	m_copyToFbTexture.Reset();
 	m_copyToFbVertexBuffer.Reset();
 	m_copyToFbVertexArray.Reset();
-	m_primBuffer.Reset();
+	m_vertexStreamBuffer.reset();
 	m_primVertexArray.Reset();
-	m_vertexParamsBuffer.Reset();
-	m_fragmentParamsBuffer.Reset();
+	m_uniformStreamBuffer.reset();
 }
 
 void CGSH_OpenGL::ResetImpl()
@@ -105,6 +108,7 @@ void CGSH_OpenGL::ResetImpl()
 	LoadPreferences();
 	TexCache_Flush();
 	PalCache_Flush();
+	DiscardLocalToHostTransfers();
 	m_framebuffers.clear();
 	m_depthbuffers.clear();
 	m_vertexBuffer.clear();
@@ -286,7 +290,7 @@ void CGSH_OpenGL::LoadState(Framework::CZipArchiveReader& archive)
 {
 	CGSHandler::LoadState(archive);
 
-	m_mailBox.SendCall(std::bind(&CGSH_OpenGL::TexCache_InvalidateTextures, this, 0, RAMSIZE));
+	SendGSCall(std::bind(&CGSH_OpenGL::TexCache_InvalidateTextures, this, 0, RAMSIZE));
 }
 
 void CGSH_OpenGL::RegisterPreferences()
@@ -294,10 +298,13 @@ void CGSH_OpenGL::RegisterPreferences()
 	CGSHandler::RegisterPreferences();
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_OPENGL_ENABLEHIGHRESMODE, false);
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES, false);
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_CGSH_OPENGL_TEXTURECACHESIZE, TextureCache::DEFAULT_TEXTURE_CACHE_SIZE);
 }
 
 void CGSH_OpenGL::NotifyPreferencesChangedImpl()
 {
+	//Caches and buffers are about to be released, draw what still refers to them
+	FlushVertexBuffer();
 	LoadPreferences();
 	TexCache_Flush();
 	PalCache_Flush();
@@ -310,6 +317,12 @@ void CGSH_OpenGL::LoadPreferences()
 {
 	m_fbScale = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_OPENGL_ENABLEHIGHRESMODE) ? 2 : 1;
 	m_forceBilinearTextures = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES);
+
+	unsigned int textureCacheSize = std::max<int>(CAppConfig::GetInstance().GetPreferenceInteger(PREF_CGSH_OPENGL_TEXTURECACHESIZE), 1);
+	if(textureCacheSize != m_textureCache.GetSize())
+	{
+		m_textureCache.SetSize(textureCacheSize);
+	}
 }
 
 void CGSH_OpenGL::InitializeRC()
@@ -333,11 +346,12 @@ void CGSH_OpenGL::InitializeRC()
 	m_copyToFbSrcPositionUniform = glGetUniformLocation(*m_copyToFbProgram, "g_srcPosition");
 	m_copyToFbSrcSizeUniform = glGetUniformLocation(*m_copyToFbProgram, "g_srcSize");
 
-	m_primBuffer = Framework::OpenGl::CBuffer::Create();
+	m_vertexStreamBuffer = std::make_unique<CStreamBuffer>(GL_ARRAY_BUFFER, VERTEX_STREAM_SEGMENT_SIZE, sizeof(PRIM_VERTEX));
 	m_primVertexArray = GeneratePrimVertexArray();
 
-	m_vertexParamsBuffer = GenerateUniformBlockBuffer(sizeof(VERTEXPARAMS));
-	m_fragmentParamsBuffer = GenerateUniformBlockBuffer(sizeof(FRAGMENTPARAMS));
+	GLint uniformBufferAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferAlignment);
+	m_uniformStreamBuffer = std::make_unique<CStreamBuffer>(GL_UNIFORM_BUFFER, UNIFORM_STREAM_SEGMENT_SIZE, std::max<GLint>(uniformBufferAlignment, 1));
 
 	PresentBackbuffer();
 
@@ -441,7 +455,7 @@ Framework::OpenGl::CVertexArray CGSH_OpenGL::GeneratePrimVertexArray()
 
 	glBindVertexArray(vertexArray);
 
-	glBindBuffer(GL_ARRAY_BUFFER, m_primBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexStreamBuffer->GetBuffer());
 
 	glEnableVertexAttribArray(static_cast<GLuint>(PRIM_VERTEX_ATTRIB::POSITION));
 	glVertexAttribPointer(static_cast<GLuint>(PRIM_VERTEX_ATTRIB::POSITION), 3, GL_FLOAT, 
@@ -466,17 +480,6 @@ Framework::OpenGl::CVertexArray CGSH_OpenGL::GeneratePrimVertexArray()
 	return vertexArray;
 }
 
-Framework::OpenGl::CBuffer CGSH_OpenGL::GenerateUniformBlockBuffer(size_t blockSize)
-{
-	auto uniformBlockBuffer = Framework::OpenGl::CBuffer::Create();
-
-	glBindBuffer(GL_UNIFORM_BUFFER, uniformBlockBuffer);
-	glBufferData(GL_UNIFORM_BUFFER, blockSize, nullptr, GL_STREAM_DRAW);
-	CHECKGLERROR();
-
-	return uniformBlockBuffer;
-}
-
 void CGSH_OpenGL::MakeLinearZOrtho(float* matrix, float left, float right, float bottom, float top)
 {
 	matrix[ 0] = 2.0f / (right - left);
@@ -514,6 +517,11 @@ uint32 CGSH_OpenGL::RGBA16ToRGBA32(uint16 nColor)
 	return (nColor & 0x8000 ? 0xFF000000 : 0) | ((nColor & 0x7C00) << 9) | ((nColor & 0x03E0) << 6) | ((nColor & 0x001F) << 3);
 }
 
+uint16 CGSH_OpenGL::RGBA32ToRGBA16(uint32 nColor)
+{
+	return static_cast<uint16>(((nColor >> 16) & 0x8000) | ((nColor >> 9) & 0x7C00) | ((nColor >> 6) & 0x03E0) | ((nColor >> 3) & 0x001F));
+}
+
 float CGSH_OpenGL::GetZ(float nZ)
 {
 	if(nZ == 0)
@@ -536,36 +544,15 @@ Framework::OpenGl::ProgramPtr CGSH_OpenGL::GetShaderFromCaps(const SHADERCAPS& s
 	auto shaderIterator = m_shaders.find(static_cast<uint32>(shaderCaps));
 	if(shaderIterator == m_shaders.end())
 	{
-		auto shader = GenerateShader(shaderCaps);
-
-		glUseProgram(*shader);
-		m_validGlState &= ~GLSTATE_PROGRAM;
-
-		auto textureUniform = glGetUniformLocation(*shader, "g_texture");
-		if(textureUniform != -1)
-		{
-			glUniform1i(textureUniform, 0);
-		}
-
-		auto paletteUniform = glGetUniformLocation(*shader, "g_palette");
-		if(paletteUniform != -1)
-		{
-			glUniform1i(paletteUniform, 1);
-		}
-
-		auto vertexParamsUniformBlock = glGetUniformBlockIndex(*shader, "VertexParams");
-		if(vertexParamsUniformBlock != GL_INVALID_INDEX)
+		//Might have been compiled in the background already, waits if it's being compiled
+		auto shader = TakeCompiledProgram(static_cast<uint32>(shaderCaps));
+		if(!shader)
 		{
-			glUniformBlockBinding(*shader, vertexParamsUniformBlock, 0);
+			shader = GenerateShader(shaderCaps);
+			SaveProgram(static_cast<uint32>(shaderCaps), shader);
 		}
 
-		auto fragmentParamsUniformBlock = glGetUniformBlockIndex(*shader, "FragmentParams");
-		if(fragmentParamsUniformBlock != GL_INVALID_INDEX)
-		{
-			glUniformBlockBinding(*shader, fragmentParamsUniformBlock, 1);
-		}
-
-		CHECKGLERROR();
+		SetupProgram(shader);
 
 		m_shaders.insert(std::make_pair(static_cast<uint32>(shaderCaps), shader));
 		shaderIterator = m_shaders.find(static_cast<uint32>(shaderCaps));
@@ -610,32 +597,21 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 	}
 
 	//--------------------------------------------------------
-	//Check if a different shader is needed
+	//Build the new render state
 	//--------------------------------------------------------
 
-	if(!m_renderState.isValid ||
-		(static_cast<uint32>(m_renderState.shaderCaps) != static_cast<uint32>(shaderCaps)))
-	{
-		FlushVertexBuffer();
-		m_renderState.shaderCaps = shaderCaps;
-	}
-
-	if(!m_renderState.isValid ||
-		(m_renderState.technique != technique))
-	{
-		FlushVertexBuffer();
-		m_renderState.technique = technique;
-	}
+	//Pending primitives are drawn with the current state, new state is built aside
+	//and only replaces it (breaking the batch) if OpenGL would see a difference
+	auto renderState = m_renderState;
+	auto vertexParams = m_vertexParams;
+	auto fragmentParams = m_fragmentParams;
 
-	//--------------------------------------------------------
-	//Set render states
-	//--------------------------------------------------------
+	renderState.shaderCaps = shaderCaps;
+	renderState.technique = technique;
 
 	if(!m_renderState.isValid ||
 		(m_renderState.primReg != primReg))
 	{
-		FlushVertexBuffer();
-
 		//Humm, not quite sure about this
 //		if(prim.nAntiAliasing)
 //		{
@@ -646,33 +622,26 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 //			glDisable(GL_BLEND);
 //		}
 
-		m_renderState.blendEnabled = prim.nAlpha ? GL_TRUE : GL_FALSE;
-		m_validGlState &= ~GLSTATE_BLEND;
+		renderState.blendEnabled = prim.nAlpha ? GL_TRUE : GL_FALSE;
 	}
 
 	if(!m_renderState.isValid ||
 		(m_renderState.alphaReg != alphaReg))
 	{
-		FlushVertexBuffer();
-		SetupBlendingFunction(alphaReg);
-		CHECKGLERROR();
+		SetupBlendingFunction(renderState, alphaReg);
 	}
 
 	if(!m_renderState.isValid ||
 		(m_renderState.testReg != testReg))
 	{
-		FlushVertexBuffer();
-		SetupTestFunctions(testReg);
-		CHECKGLERROR();
+		SetupTestFunctions(renderState, fragmentParams, testReg);
 	}
 
 	if(!m_renderState.isValid ||
 		(m_renderState.zbufReg != zbufReg) ||
 		(m_renderState.testReg != testReg))
 	{
-		FlushVertexBuffer();
-		SetupDepthBuffer(zbufReg, testReg);
-		CHECKGLERROR();
+		SetupDepthBuffer(renderState, zbufReg, testReg);
 	}
 
 	if(!m_renderState.isValid ||
@@ -681,8 +650,7 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 		(m_renderState.scissorReg != scissorReg) ||
 		(m_renderState.testReg != testReg))
 	{
-		FlushVertexBuffer();
-		SetupFramebuffer(frameReg, zbufReg, scissorReg, testReg);
+		SetupFramebuffer(renderState, vertexParams, frameReg, zbufReg, scissorReg, testReg);
 		CHECKGLERROR();
 	}
 
@@ -693,8 +661,7 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 		(m_renderState.clampReg != clampReg) ||
 		(m_renderState.primReg != primReg))
 	{
-		FlushVertexBuffer();
-		SetupTexture(primReg, tex0Reg, tex1Reg, texAReg, clampReg);
+		SetupTexture(renderState, vertexParams, fragmentParams, primReg, tex0Reg, tex1Reg, texAReg, clampReg);
 		CHECKGLERROR();
 	}
 
@@ -703,12 +670,41 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 			!m_renderState.isValid ||
 			(m_renderState.fogColReg != fogColReg)
 		))
+	{
+		SetupFogColor(fragmentParams, fogColReg);
+	}
+
+	//--------------------------------------------------------
+	//Flush if OpenGL state changed
+	//--------------------------------------------------------
+
+	uint32 changes = m_renderState.isValid ? GetRenderStateChanges(m_renderState, renderState) : 0xFFFFFFFF;
+	if(memcmp(&m_vertexParams, &vertexParams, sizeof(VERTEXPARAMS)) != 0)
+	{
+		changes |= GLSTATE_VERTEX_PARAMS;
+	}
+	if(memcmp(&m_fragmentParams, &fragmentParams, sizeof(FRAGMENTPARAMS)) != 0)
+	{
+		changes |= GLSTATE_FRAGMENT_PARAMS;
+	}
+
+	bool programChanged =
+		(static_cast<uint32>(m_renderState.shaderCaps) != static_cast<uint32>(shaderCaps)) ||
+		(m_renderState.technique != technique);
+
+	if((changes != 0) || programChanged)
 	{
 		FlushVertexBuffer();
-		SetupFogColor(fogColReg);
-		CHECKGLERROR();
 	}
 
+	//Shader handle is resolved when flushing, keep the one that's currently in use
+	renderState.shaderHandle = m_renderState.shaderHandle;
+
+	m_renderState = renderState;
+	m_vertexParams = vertexParams;
+	m_fragmentParams = fragmentParams;
+	m_validGlState &= ~changes;
+
 	auto offset = make_convertible<XYOFFSET>(m_nReg[GS_REG_XYOFFSET_1 + context]);
 	m_nPrimOfsX = offset.GetX();
 	m_nPrimOfsY = offset.GetY();
@@ -729,154 +725,265 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 	m_renderState.fogColReg  = fogColReg;
 }
 
-void CGSH_OpenGL::SetupBlendingFunction(uint64 alphaReg)
+uint32 CGSH_OpenGL::GetRenderStateChanges(const RENDERSTATE& prevState, const RENDERSTATE& nextState)
+{
+	//States that have no effect on what's drawn (ie.: blend function while blending
+	//is disabled) are not considered, they will be applied when they become relevant
+	uint32 changes = 0;
+
+	if(
+		(prevState.framebufferHandle != nextState.framebufferHandle) ||
+		(prevState.depthbufferHandle != nextState.depthbufferHandle)
+		)
+	{
+		changes |= GLSTATE_FRAMEBUFFER;
+	}
+
+	if(
+		(prevState.viewportWidth != nextState.viewportWidth) ||
+		(prevState.viewportHeight != nextState.viewportHeight)
+		)
+	{
+		changes |= GLSTATE_VIEWPORT;
+	}
+
+	if(
+		(prevState.scissorX != nextState.scissorX) ||
+		(prevState.scissorY != nextState.scissorY) ||
+		(prevState.scissorWidth != nextState.scissorWidth) ||
+		(prevState.scissorHeight != nextState.scissorHeight)
+		)
+	{
+		changes |= GLSTATE_SCISSOR;
+	}
+
+	if(
+		(prevState.texture0Handle != nextState.texture0Handle) ||
+		(prevState.texture0MinFilter != nextState.texture0MinFilter) ||
+		(prevState.texture0MagFilter != nextState.texture0MagFilter) ||
+		(prevState.texture0WrapS != nextState.texture0WrapS) ||
+		(prevState.texture0WrapT != nextState.texture0WrapT) ||
+		(prevState.texture1Handle != nextState.texture1Handle)
+		)
+	{
+		changes |= GLSTATE_TEXTURE;
+	}
+
+	if(prevState.blendEnabled != nextState.blendEnabled)
+	{
+		changes |= GLSTATE_BLEND;
+	}
+	else if(nextState.blendEnabled &&
+		(
+			(prevState.blendEquation != nextState.blendEquation) ||
+			(prevState.blendSrcFactor != nextState.blendSrcFactor) ||
+			(prevState.blendDstFactor != nextState.blendDstFactor) ||
+			(prevState.blendAlpha != nextState.blendAlpha)
+		))
+	{
+		changes |= GLSTATE_BLEND;
+	}
+
+	if(prevState.depthTestEnabled != nextState.depthTestEnabled)
+	{
+		changes |= GLSTATE_DEPTHTEST;
+	}
+	else if(nextState.depthTestEnabled && (prevState.depthFunc != nextState.depthFunc))
+	{
+		changes |= GLSTATE_DEPTHTEST;
+	}
+
+	if(
+		(prevState.colorMaskR != nextState.colorMaskR) ||
+		(prevState.colorMaskG != nextState.colorMaskG) ||
+		(prevState.colorMaskB != nextState.colorMaskB) ||
+		(prevState.colorMaskA != nextState.colorMaskA)
+		)
+	{
+		changes |= GLSTATE_COLORMASK;
+	}
+
+	if(prevState.depthMask != nextState.depthMask)
+	{
+		changes |= GLSTATE_DEPTHMASK;
+	}
+
+	return changes;
+}
+
+void CGSH_OpenGL::SetupBlendingFunction(RENDERSTATE& renderState, uint64 alphaReg)
 {
-	int nFunction = GL_FUNC_ADD;
+	GLenum nFunction = GL_FUNC_ADD;
+	float blendAlpha = 0;
 	auto alpha = make_convertible<ALPHA>(alphaReg);
 
 	if((alpha.nA == alpha.nB) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//ab*0 (when a == b) - Cs
-		glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ONE;
+		renderState.blendDstFactor = GL_ZERO;
 	}
 	else if((alpha.nA == alpha.nB) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//ab*1 (when a == b) - Cd
-		glBlendFuncSeparate(GL_ZERO, GL_ONE, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ZERO;
+		renderState.blendDstFactor = GL_ONE;
 	}
 	else if((alpha.nA == alpha.nB) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//ab*2 (when a == b) - Zero
-		glBlendFuncSeparate(GL_ZERO, GL_ZERO, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ZERO;
+		renderState.blendDstFactor = GL_ZERO;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CS) && (alpha.nB == ALPHABLEND_ABD_CD) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//0101 - Cs * As + Cd * (1 - As)
-		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_SRC_ALPHA;
+		renderState.blendDstFactor = GL_ONE_MINUS_SRC_ALPHA;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 1) && (alpha.nC == 1) && (alpha.nD == 1))
 	{
 		//Cs * Ad + Cd * (1 - Ad)
-		glBlendFuncSeparate(GL_DST_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_DST_ALPHA;
+		renderState.blendDstFactor = GL_ONE_MINUS_DST_ALPHA;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 1) && (alpha.nC == 2) && (alpha.nD == 1))
 	{
 		if(alpha.nFix == 0x80)
 		{
-			glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+			renderState.blendSrcFactor = GL_ONE;
+			renderState.blendDstFactor = GL_ZERO;
 		}
 		else
 		{
 			//Source alpha value is implied in the formula
 			//As = FIX / 0x80
-			glBlendColor(0.0f, 0.0f, 0.0f, (float)alpha.nFix / 128.0f);
-			glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+			blendAlpha = (float)alpha.nFix / 128.0f;
+			renderState.blendSrcFactor = GL_CONSTANT_ALPHA;
+			renderState.blendDstFactor = GL_ONE_MINUS_CONSTANT_ALPHA;
 		}
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 0) && (alpha.nD == 1))
 	{
-		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_SRC_ALPHA;
+		renderState.blendDstFactor = GL_ONE;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 0) && (alpha.nD == 2))
 	{
 		//Cs * As
-		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ZERO, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_SRC_ALPHA;
+		renderState.blendDstFactor = GL_ZERO;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 1) && (alpha.nD == 1))
 	{
 		//Cs * Ad + Cd
-		glBlendFuncSeparate(GL_DST_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_DST_ALPHA;
+		renderState.blendDstFactor = GL_ONE;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 2) && (alpha.nD == 1))
 	{
 		if(alpha.nFix == 0x80)
 		{
-			glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ZERO);
+			renderState.blendSrcFactor = GL_ONE;
+			renderState.blendDstFactor = GL_ONE;
 		}
 		else
 		{
 			//Cs * FIX + Cd
-			glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-			glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+			blendAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+			renderState.blendSrcFactor = GL_CONSTANT_ALPHA;
+			renderState.blendDstFactor = GL_ONE;
 		}
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 0) && (alpha.nC == 0) && (alpha.nD == 0))
 	{
 		//(Cd - Cs) * As + Cs
-		glBlendFuncSeparate(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ONE_MINUS_SRC_ALPHA;
+		renderState.blendDstFactor = GL_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AD) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1010 -> Cs * (1 - Ad) + Cd * Ad
-		glBlendFuncSeparate(GL_ONE_MINUS_DST_ALPHA, GL_DST_ALPHA, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ONE_MINUS_DST_ALPHA;
+		renderState.blendDstFactor = GL_DST_ALPHA;
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 0) && (alpha.nC == 2) && (alpha.nD == 2))
 	{
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendColor(0.0f, 0.0f, 0.0f, (float)alpha.nFix / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		blendAlpha = (float)alpha.nFix / 128.0f;
+		renderState.blendSrcFactor = GL_CONSTANT_ALPHA;
+		renderState.blendDstFactor = GL_CONSTANT_ALPHA;
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 2) && (alpha.nC == 0) && (alpha.nD == 0))
 	{
 		//Cd * As + Cs
-		glBlendFuncSeparate(GL_ONE, GL_SRC_ALPHA, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ONE;
+		renderState.blendDstFactor = GL_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//1201 -> Cd * (As + 1)
 		//TODO: Implement this properly (multiple passes?)
-		glBlendFuncSeparate(GL_ZERO, GL_ONE, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ZERO;
+		renderState.blendDstFactor = GL_ONE;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//1202 - Cd * As
-		glBlendFuncSeparate(GL_ZERO, GL_SRC_ALPHA, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ZERO;
+		renderState.blendDstFactor = GL_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1220 -> Cd * FIX + Cs
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ONE, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		blendAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		renderState.blendSrcFactor = GL_ONE;
+		renderState.blendDstFactor = GL_CONSTANT_ALPHA;
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 2) && (alpha.nC == 2) && (alpha.nD == 2))
 	{
 		//Cd * FIX
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ZERO, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		blendAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		renderState.blendSrcFactor = GL_ZERO;
+		renderState.blendDstFactor = GL_CONSTANT_ALPHA;
 	}
 	else if((alpha.nA == 2) && (alpha.nB == 0) && (alpha.nC == 0) && (alpha.nD == 1))
 	{
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_SRC_ALPHA;
+		renderState.blendDstFactor = GL_ONE;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2021 -> Cd - Cs * FIX
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		blendAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		renderState.blendSrcFactor = GL_CONSTANT_ALPHA;
+		renderState.blendDstFactor = GL_ONE;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CD) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2101 -> Cd * (1 - As)
-		glBlendFuncSeparate(GL_ZERO, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ZERO;
+		renderState.blendDstFactor = GL_ONE_MINUS_SRC_ALPHA;
 	}
 	else
 	{
 		assert(0);
 		//Default blending
-		glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+		renderState.blendSrcFactor = GL_ONE;
+		renderState.blendDstFactor = GL_ZERO;
 	}
 
-	glBlendEquation(nFunction);
+	renderState.blendEquation = nFunction;
+	renderState.blendAlpha = blendAlpha;
 }
 
-void CGSH_OpenGL::SetupTestFunctions(uint64 testReg)
+void CGSH_OpenGL::SetupTestFunctions(RENDERSTATE& renderState, FRAGMENTPARAMS& fragmentParams, uint64 testReg)
 {
 	auto test = make_convertible<TEST>(testReg);
 
-	m_fragmentParams.alphaRef = static_cast<float>(test.nAlphaRef) / 255.0f;
-	m_validGlState &= ~GLSTATE_FRAGMENT_PARAMS;
+	fragmentParams.alphaRef = static_cast<float>(test.nAlphaRef) / 255.0f;
 
 	if(test.nDepthEnabled)
 	{
@@ -898,17 +1005,16 @@ void CGSH_OpenGL::SetupTestFunctions(uint64 testReg)
 			break;
 		}
 
-		glDepthFunc(nFunc);
-
-		glEnable(GL_DEPTH_TEST);
+		renderState.depthFunc = nFunc;
+		renderState.depthTestEnabled = true;
 	}
 	else
 	{
-		glDisable(GL_DEPTH_TEST);
+		renderState.depthTestEnabled = false;
 	}
 }
 
-void CGSH_OpenGL::SetupDepthBuffer(uint64 zbufReg, uint64 testReg)
+void CGSH_OpenGL::SetupDepthBuffer(RENDERSTATE& renderState, uint64 zbufReg, uint64 testReg)
 {
 	auto zbuf = make_convertible<ZBUF>(zbufReg);
 	auto test = make_convertible<TEST>(testReg);
@@ -936,11 +1042,10 @@ void CGSH_OpenGL::SetupDepthBuffer(uint64 zbufReg, uint64 testReg)
 	{
 		depthWriteEnabled = false;
 	}
-	m_renderState.depthMask = depthWriteEnabled;
-	m_validGlState &= ~GLSTATE_DEPTHMASK;
+	renderState.depthMask = depthWriteEnabled;
 }
 
-void CGSH_OpenGL::SetupFramebuffer(uint64 frameReg, uint64 zbufReg, uint64 scissorReg, uint64 testReg)
+void CGSH_OpenGL::SetupFramebuffer(RENDERSTATE& renderState, VERTEXPARAMS& vertexParams, uint64 frameReg, uint64 zbufReg, uint64 scissorReg, uint64 testReg)
 {
 	if(frameReg == 0) return;
 
@@ -966,11 +1071,10 @@ void CGSH_OpenGL::SetupFramebuffer(uint64 frameReg, uint64 zbufReg, uint64 sciss
 		}
 	}
 
-	m_renderState.colorMaskR = r;
-	m_renderState.colorMaskG = g;
-	m_renderState.colorMaskB = b;
-	m_renderState.colorMaskA = a;
-	m_validGlState &= ~GLSTATE_COLORMASK;
+	renderState.colorMaskR = r;
+	renderState.colorMaskG = g;
+	renderState.colorMaskB = b;
+	renderState.colorMaskA = a;
 
 	//Check if we're drawing into a buffer that's been used for depth before
 	{
@@ -999,51 +1103,34 @@ void CGSH_OpenGL::SetupFramebuffer(uint64 frameReg, uint64 zbufReg, uint64 sciss
 
 	assert(framebuffer->m_width == depthbuffer->m_width);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->m_framebuffer);
-
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthbuffer->m_depthBuffer);
-	CHECKGLERROR();
-
-	GLenum result = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-	assert(result == GL_FRAMEBUFFER_COMPLETE);
-
-	m_renderState.framebufferHandle = framebuffer->m_framebuffer;
-	m_validGlState &= ~GLSTATE_FRAMEBUFFER;
+	//Depth buffer is attached when the framebuffer gets bound
+	renderState.framebufferHandle = framebuffer->m_framebuffer;
+	renderState.depthbufferHandle = depthbuffer->m_depthBuffer;
 
 	//We assume that we will be drawing to this framebuffer and that we'll need
 	//to resolve samples at some point if multisampling is enabled
 	framebuffer->m_resolveNeeded = true;
 
-	{
-		GLenum drawBufferId = GL_COLOR_ATTACHMENT0;
-		glDrawBuffers(1, &drawBufferId);
-		CHECKGLERROR();
-	}
-
-	m_renderState.viewportWidth = framebuffer->m_width;
-	m_renderState.viewportHeight = framebuffer->m_height;
-	m_validGlState &= ~GLSTATE_VIEWPORT;
+	renderState.viewportWidth = framebuffer->m_width;
+	renderState.viewportHeight = framebuffer->m_height;
 
 	float projWidth = static_cast<float>(framebuffer->m_width);
 	float projHeight = static_cast<float>(framebuffer->m_height);
 
-	MakeLinearZOrtho(m_vertexParams.projMatrix, 0, projWidth, 0, projHeight);
-	m_validGlState &= ~GLSTATE_VERTEX_PARAMS;
+	MakeLinearZOrtho(vertexParams.projMatrix, 0, projWidth, 0, projHeight);
 
-	m_renderState.scissorX = scissor.scax0;
-	m_renderState.scissorY = scissor.scay0;
-	m_renderState.scissorWidth = scissor.scax1 - scissor.scax0 + 1;
-	m_renderState.scissorHeight = scissor.scay1 - scissor.scay0 + 1;
-	m_validGlState &= ~GLSTATE_SCISSOR;
+	renderState.scissorX = scissor.scax0;
+	renderState.scissorY = scissor.scay0;
+	renderState.scissorWidth = scissor.scax1 - scissor.scax0 + 1;
+	renderState.scissorHeight = scissor.scay1 - scissor.scay0 + 1;
 }
 
-void CGSH_OpenGL::SetupFogColor(uint64 fogColReg)
+void CGSH_OpenGL::SetupFogColor(FRAGMENTPARAMS& fragmentParams, uint64 fogColReg)
 {
 	auto fogCol = make_convertible<FOGCOL>(fogColReg);
-	m_fragmentParams.fogColor[0] = static_cast<float>(fogCol.nFCR) / 255.0f;
-	m_fragmentParams.fogColor[1] = static_cast<float>(fogCol.nFCG) / 255.0f;
-	m_fragmentParams.fogColor[2] = static_cast<float>(fogCol.nFCB) / 255.0f;
-	m_validGlState &= ~GLSTATE_FRAGMENT_PARAMS;
+	fragmentParams.fogColor[0] = static_cast<float>(fogCol.nFCR) / 255.0f;
+	fragmentParams.fogColor[1] = static_cast<float>(fogCol.nFCG) / 255.0f;
+	fragmentParams.fogColor[2] = static_cast<float>(fogCol.nFCB) / 255.0f;
 }
 
 bool CGSH_OpenGL::CanRegionRepeatClampModeSimplified(uint32 clampMin, uint32 clampMax)
@@ -1177,15 +1264,14 @@ CGSH_OpenGL::TECHNIQUE CGSH_OpenGL::GetTechniqueFromTest(const uint64& testReg)
 	return technique;
 }
 
-void CGSH_OpenGL::SetupTexture(uint64 primReg, uint64 tex0Reg, uint64 tex1Reg, uint64 texAReg, uint64 clampReg)
+void CGSH_OpenGL::SetupTexture(RENDERSTATE& renderState, VERTEXPARAMS& vertexParams, FRAGMENTPARAMS& fragmentParams, uint64 primReg, uint64 tex0Reg, uint64 tex1Reg, uint64 texAReg, uint64 clampReg)
 {
-	m_renderState.texture0Handle = 0;
-	m_renderState.texture1Handle = 0;
-	m_renderState.texture0MinFilter = GL_NEAREST;
-	m_renderState.texture0MagFilter = GL_NEAREST;
-	m_renderState.texture0WrapS = GL_CLAMP_TO_EDGE;
-	m_renderState.texture0WrapT = GL_CLAMP_TO_EDGE;
-	m_validGlState &= ~GLSTATE_TEXTURE;
+	renderState.texture0Handle = 0;
+	renderState.texture1Handle = 0;
+	renderState.texture0MinFilter = GL_NEAREST;
+	renderState.texture0MagFilter = GL_NEAREST;
+	renderState.texture0WrapS = GL_CLAMP_TO_EDGE;
+	renderState.texture0WrapT = GL_CLAMP_TO_EDGE;
 
 	auto prim = make_convertible<PRMODE>(primReg);
 
@@ -1203,16 +1289,16 @@ void CGSH_OpenGL::SetupTexture(uint64 primReg, uint64 tex0Reg, uint64 tex1Reg, u
 	m_nTexHeight = tex0.GetHeight();
 
 	auto texInfo = PrepareTexture(tex0);
-	m_renderState.texture0Handle = texInfo.textureHandle;
+	renderState.texture0Handle = texInfo.textureHandle;
 
 	//Setup sampling modes
 	switch(tex1.nMagFilter)
 	{
 	case MAG_FILTER_NEAREST:
-		m_renderState.texture0MagFilter = GL_NEAREST;
+		renderState.texture0MagFilter = GL_NEAREST;
 		break;
 	case MAG_FILTER_LINEAR:
-		m_renderState.texture0MagFilter = GL_LINEAR;
+		renderState.texture0MagFilter = GL_LINEAR;
 		break;
 	}
 
@@ -1221,12 +1307,12 @@ void CGSH_OpenGL::SetupTexture(uint64 primReg, uint64 tex0Reg, uint64 tex1Reg, u
 	case MIN_FILTER_NEAREST:
 	case MIN_FILTER_NEAREST_MIP_NEAREST:
 	case MIN_FILTER_NEAREST_MIP_LINEAR:
-		m_renderState.texture0MinFilter = GL_NEAREST;
+		renderState.texture0MinFilter = GL_NEAREST;
 		break;
 	case MIN_FILTER_LINEAR:
 	case MIN_FILTER_LINEAR_MIP_NEAREST:
 	case MIN_FILTER_LINEAR_MIP_LINEAR:
-		m_renderState.texture0MinFilter = GL_LINEAR;
+		renderState.texture0MinFilter = GL_LINEAR;
 		break;
 	default:
 		assert(0);
@@ -1235,15 +1321,15 @@ void CGSH_OpenGL::SetupTexture(uint64 primReg, uint64 tex0Reg, uint64 tex1Reg, u
 
 	if(m_forceBilinearTextures)
 	{
-		m_renderState.texture0MagFilter = GL_LINEAR;
-		m_renderState.texture0MinFilter = GL_LINEAR;
+		renderState.texture0MagFilter = GL_LINEAR;
+		renderState.texture0MinFilter = GL_LINEAR;
 	}
 
 	unsigned int clampMin[2] = { 0, 0 };
 	unsigned int clampMax[2] = { 0, 0 };
 	float textureScaleRatio[2] = { texInfo.scaleRatioX, texInfo.scaleRatioY };
-	m_renderState.texture0WrapS = g_nativeClampModes[clamp.nWMS];
-	m_renderState.texture0WrapT = g_nativeClampModes[clamp.nWMT];
+	renderState.texture0WrapS = g_nativeClampModes[clamp.nWMS];
+	renderState.texture0WrapT = g_nativeClampModes[clamp.nWMT];
 
 	if((clamp.nWMS > CLAMP_MODE_CLAMP) || (clamp.nWMT > CLAMP_MODE_CLAMP))
 	{
@@ -1276,37 +1362,35 @@ void CGSH_OpenGL::SetupTexture(uint64 primReg, uint64 tex0Reg, uint64 tex1Reg, u
 	}
 
 	if(CGsPixelFormats::IsPsmIDTEX(tex0.nPsm) && 
-		(m_renderState.texture0MinFilter != GL_NEAREST || m_renderState.texture0MagFilter != GL_NEAREST))
+		(renderState.texture0MinFilter != GL_NEAREST || renderState.texture0MagFilter != GL_NEAREST))
 	{
 		//We'll need to filter the texture manually
-		m_renderState.texture0MinFilter = GL_NEAREST;
-		m_renderState.texture0MagFilter = GL_NEAREST;
+		renderState.texture0MinFilter = GL_NEAREST;
+		renderState.texture0MagFilter = GL_NEAREST;
 	}
 
 	if(CGsPixelFormats::IsPsmIDTEX(tex0.nPsm))
 	{
-		m_renderState.texture1Handle = PreparePalette(tex0);
-	}
-
-	memset(m_vertexParams.texMatrix, 0, sizeof(m_vertexParams.texMatrix));
-	m_vertexParams.texMatrix[0 + (0 * 4)] = texInfo.scaleRatioX;
-	m_vertexParams.texMatrix[1 + (1 * 4)] = texInfo.scaleRatioY;
-	m_vertexParams.texMatrix[2 + (2 * 4)] = 1;
-	m_vertexParams.texMatrix[0 + (3 * 4)] = texInfo.offsetX;
-	m_vertexParams.texMatrix[3 + (3 * 4)] = 1;
-	m_validGlState &= ~GLSTATE_VERTEX_PARAMS;
-
-	m_fragmentParams.textureSize[0] = static_cast<float>(tex0.GetWidth());
-	m_fragmentParams.textureSize[1] = static_cast<float>(tex0.GetHeight());
-	m_fragmentParams.texelSize[0] = 1.0f / static_cast<float>(tex0.GetWidth());
-	m_fragmentParams.texelSize[1] = 1.0f / static_cast<float>(tex0.GetHeight());
-	m_fragmentParams.clampMin[0] = static_cast<float>(clampMin[0]);
-	m_fragmentParams.clampMin[1] = static_cast<float>(clampMin[1]);
-	m_fragmentParams.clampMax[0] = static_cast<float>(clampMax[0]);
-	m_fragmentParams.clampMax[1] = static_cast<float>(clampMax[1]);
-	m_fragmentParams.texA0 = static_cast<float>(texA.nTA0) / 255.f;
-	m_fragmentParams.texA1 = static_cast<float>(texA.nTA1) / 255.f;
-	m_validGlState &= ~GLSTATE_FRAGMENT_PARAMS;
+		renderState.texture1Handle = PreparePalette(tex0);
+	}
+
+	memset(vertexParams.texMatrix, 0, sizeof(vertexParams.texMatrix));
+	vertexParams.texMatrix[0 + (0 * 4)] = texInfo.scaleRatioX;
+	vertexParams.texMatrix[1 + (1 * 4)] = texInfo.scaleRatioY;
+	vertexParams.texMatrix[2 + (2 * 4)] = 1;
+	vertexParams.texMatrix[0 + (3 * 4)] = texInfo.offsetX;
+	vertexParams.texMatrix[3 + (3 * 4)] = 1;
+
+	fragmentParams.textureSize[0] = static_cast<float>(tex0.GetWidth());
+	fragmentParams.textureSize[1] = static_cast<float>(tex0.GetHeight());
+	fragmentParams.texelSize[0] = 1.0f / static_cast<float>(tex0.GetWidth());
+	fragmentParams.texelSize[1] = 1.0f / static_cast<float>(tex0.GetHeight());
+	fragmentParams.clampMin[0] = static_cast<float>(clampMin[0]);
+	fragmentParams.clampMin[1] = static_cast<float>(clampMin[1]);
+	fragmentParams.clampMax[0] = static_cast<float>(clampMax[0]);
+	fragmentParams.clampMax[1] = static_cast<float>(clampMax[1]);
+	fragmentParams.texA0 = static_cast<float>(texA.nTA0) / 255.f;
+	fragmentParams.texA1 = static_cast<float>(texA.nTA1) / 255.f;
 }
 
 CGSH_OpenGL::FramebufferPtr CGSH_OpenGL::FindFramebuffer(const FRAME& frame) const
@@ -1609,6 +1693,10 @@ void CGSH_OpenGL::FlushVertexBuffer()
 
 	assert(m_renderState.isValid == true);
 
+	//Vertices are shared by all passes
+	uint32 vertexBufferOffset = m_vertexStreamBuffer->Write(m_vertexBuffer.data(), sizeof(PRIM_VERTEX) * m_vertexBuffer.size());
+	m_vertexBufferStart = vertexBufferOffset / sizeof(PRIM_VERTEX);
+
 	if(m_renderState.technique == TECHNIQUE::STANDARD)
 	{
 		auto shader = GetShaderFromCaps(m_renderState.shaderCaps);
@@ -1655,20 +1743,15 @@ void CGSH_OpenGL::FlushVertexBuffer()
 
 void CGSH_OpenGL::DoRenderPass()
 {
-	if((m_validGlState & GLSTATE_VERTEX_PARAMS) == 0)
-	{
-		glBindBuffer(GL_UNIFORM_BUFFER, m_vertexParamsBuffer);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(VERTEXPARAMS), &m_vertexParams, GL_STREAM_DRAW);
-		CHECKGLERROR();
-		m_validGlState |= GLSTATE_VERTEX_PARAMS;
-	}
-
-	if((m_validGlState & GLSTATE_FRAGMENT_PARAMS) == 0)
+	//Both blocks are written together, an older block could otherwise end up in a segment being reused
+	if((m_validGlState & (GLSTATE_VERTEX_PARAMS | GLSTATE_FRAGMENT_PARAMS)) != (GLSTATE_VERTEX_PARAMS | GLSTATE_FRAGMENT_PARAMS))
 	{
-		glBindBuffer(GL_UNIFORM_BUFFER, m_fragmentParamsBuffer);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(FRAGMENTPARAMS), &m_fragmentParams, GL_STREAM_DRAW);
+		uint32 vertexParamsOffset = m_uniformStreamBuffer->Write(&m_vertexParams, sizeof(VERTEXPARAMS));
+		uint32 fragmentParamsOffset = m_uniformStreamBuffer->Write(&m_fragmentParams, sizeof(FRAGMENTPARAMS));
+		glBindBufferRange(GL_UNIFORM_BUFFER, 0, m_uniformStreamBuffer->GetBuffer(), vertexParamsOffset, sizeof(VERTEXPARAMS));
+		glBindBufferRange(GL_UNIFORM_BUFFER, 1, m_uniformStreamBuffer->GetBuffer(), fragmentParamsOffset, sizeof(FRAGMENTPARAMS));
 		CHECKGLERROR();
-		m_validGlState |= GLSTATE_FRAGMENT_PARAMS;
+		m_validGlState |= (GLSTATE_VERTEX_PARAMS | GLSTATE_FRAGMENT_PARAMS);
 	}
 
 	if((m_validGlState & GLSTATE_PROGRAM) == 0)
@@ -1694,9 +1777,19 @@ void CGSH_OpenGL::DoRenderPass()
 	if((m_validGlState & GLSTATE_BLEND) == 0)
 	{
 		m_renderState.blendEnabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+		glBlendColor(0, 0, 0, m_renderState.blendAlpha);
+		glBlendEquation(m_renderState.blendEquation);
+		glBlendFuncSeparate(m_renderState.blendSrcFactor, m_renderState.blendDstFactor, GL_ONE, GL_ZERO);
 		m_validGlState |= GLSTATE_BLEND;
 	}
 
+	if((m_validGlState & GLSTATE_DEPTHTEST) == 0)
+	{
+		m_renderState.depthTestEnabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+		glDepthFunc(m_renderState.depthFunc);
+		m_validGlState |= GLSTATE_DEPTHTEST;
+	}
+
 	if((m_validGlState & GLSTATE_COLORMASK) == 0)
 	{
 		glColorMask(
@@ -1733,19 +1826,33 @@ void CGSH_OpenGL::DoRenderPass()
 	if((m_validGlState & GLSTATE_FRAMEBUFFER) == 0)
 	{
 		glBindFramebuffer(GL_FRAMEBUFFER, m_renderState.framebufferHandle);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_renderState.depthbufferHandle);
+		CHECKGLERROR();
+
+		GLenum result = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		assert(result == GL_FRAMEBUFFER_COMPLETE);
+
+		GLenum drawBufferId = GL_COLOR_ATTACHMENT0;
+		glDrawBuffers(1, &drawBufferId);
+		CHECKGLERROR();
+
 		m_validGlState |= GLSTATE_FRAMEBUFFER;
 	}
 
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_vertexParamsBuffer);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, m_fragmentParamsBuffer);
+	glBindVertexArray(m_primVertexArray);
 
-	glBindBuffer(GL_ARRAY_BUFFER, m_primBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(PRIM_VERTEX) * m_vertexBuffer.size(), m_vertexBuffer.data(), GL_STREAM_DRAW);
+	GLenum primitiveMode = GetPrimitiveMode(m_primitiveType);
+	assert(primitiveMode != GL_NONE);
 
-	glBindVertexArray(m_primVertexArray);
+	glDrawArrays(primitiveMode, m_vertexBufferStart, m_vertexBuffer.size());
 
+	m_drawCallCount++;
+}
+
+GLenum CGSH_OpenGL::GetPrimitiveMode(unsigned int primitiveType)
+{
 	GLenum primitiveMode = GL_NONE;
-	switch(m_primitiveType)
+	switch(primitiveType)
 	{
 	case PRIM_POINT:
 		primitiveMode = GL_POINTS;
@@ -1760,14 +1867,8 @@ void CGSH_OpenGL::DoRenderPass()
 	case PRIM_SPRITE:
 		primitiveMode = GL_TRIANGLES;
 		break;
-	default:
-		assert(false);
-		break;
 	}
-
-	glDrawArrays(primitiveMode, 0, m_vertexBuffer.size());
-
-	m_drawCallCount++;
+	return primitiveMode;
 }
 
 void CGSH_OpenGL::DrawToDepth(unsigned int primitiveType, uint64 primReg)
@@ -1796,6 +1897,7 @@ void CGSH_OpenGL::DrawToDepth(unsigned int primitiveType, uint64 primReg)
 	auto depthbuffer = FindDepthbuffer(zbufWrite, frame);
 	assert(depthbuffer);
 
+	glBindFramebuffer(GL_FRAMEBUFFER, m_renderState.framebufferHandle);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthbuffer->m_depthBuffer);
 	CHECKGLERROR();
 
@@ -1806,7 +1908,7 @@ void CGSH_OpenGL::DrawToDepth(unsigned int primitiveType, uint64 primReg)
 	glClearDepthf(0);
 	glClear(GL_DEPTH_BUFFER_BIT);
 
-	m_validGlState &= ~GLSTATE_DEPTHMASK;
+	m_validGlState &= ~(GLSTATE_DEPTHMASK | GLSTATE_FRAMEBUFFER);
 }
 
 void CGSH_OpenGL::CopyToFb(
@@ -1815,7 +1917,7 @@ void CGSH_OpenGL::CopyToFb(
 	int32 dstX0, int32 dstY0, int32 dstX1, int32 dstY1)
 {
 	m_validGlState &= ~(GLSTATE_BLEND | GLSTATE_COLORMASK | GLSTATE_SCISSOR | GLSTATE_PROGRAM);
-	m_validGlState &= ~(GLSTATE_VIEWPORT);
+	m_validGlState &= ~(GLSTATE_VIEWPORT | GLSTATE_DEPTHTEST);
 
 	assert(srcX1 >= srcX0);
 	assert(srcY1 >= srcY0);
@@ -1863,7 +1965,8 @@ void CGSH_OpenGL::WriteRegisterImpl(uint8 nRegister, uint64 nData)
 	case GS_REG_PRIM:
 		{
 			unsigned int newPrimitiveType = static_cast<unsigned int>(nData & 0x07);
-			if(newPrimitiveType != m_primitiveType)
+			//Primitives that end up as the same OpenGL primitive can share a batch
+			if(GetPrimitiveMode(newPrimitiveType) != GetPrimitiveMode(m_primitiveType))
 			{
 				FlushVertexBuffer();
 			}
@@ -2021,52 +2124,146 @@ void CGSH_OpenGL::ProcessHostToLocalTransfer()
 
 void CGSH_OpenGL::ProcessLocalToHostTransfer()
 {
-	//This is constrained to work only with ps2autotest, will be unconstrained later
-
 	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
 	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
 	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
 
-	if(bltBuf.nSrcPsm != PSMCT32) return;
-
-	uint32 transferAddress = bltBuf.GetSrcPtr();
-	if(transferAddress != 0) return;
-
-	if((trxReg.nRRW != 32) || (trxReg.nRRH != 32)) return;
-	if((trxPos.nSSAX != 0) || (trxPos.nSSAY != 0)) return;
+	//Only color buffers live on the host
+	switch(bltBuf.nSrcPsm)
+	{
+	case PSMCT32:
+	case PSMCT24:
+	case PSMCT16:
+	case PSMCT16S:
+		break;
+	default:
+		return;
+	}
 
 	auto framebufferIterator = std::find_if(m_framebuffers.begin(), m_framebuffers.end(), 
-		[] (const FramebufferPtr& framebuffer)
+		[&] (const FramebufferPtr& framebuffer)
 		{
-			return (framebuffer->m_psm == PSMCT32) && (framebuffer->m_basePtr == 0);
+			return (framebuffer->m_basePtr == bltBuf.GetSrcPtr()) &&
+				(framebuffer->m_width == bltBuf.GetSrcWidth()) &&
+				(CGsPixelFormats::GetPsmPixelSize(framebuffer->m_psm) == CGsPixelFormats::GetPsmPixelSize(bltBuf.nSrcPsm));
 		}
 	);
 	if(framebufferIterator == std::end(m_framebuffers)) return;
 	const auto& framebuffer = (*framebufferIterator);
 
+	if((trxPos.nSSAX >= framebuffer->m_width) || (trxPos.nSSAY >= framebuffer->m_height)) return;
+	uint32 width = std::min<uint32>(trxReg.nRRW, framebuffer->m_width - trxPos.nSSAX);
+	uint32 height = std::min<uint32>(trxReg.nRRH, framebuffer->m_height - trxPos.nSSAY);
+	if((width == 0) || (height == 0)) return;
+
 	FlushVertexBuffer();
 	m_renderState.isValid = false;
 
-	auto pixels = new uint32[trxReg.nRRW * trxReg.nRRH];
+	ResolveFramebufferMultisample(framebuffer, m_fbScale);
+	m_validGlState &= ~GLSTATE_FRAMEBUFFER;
 
-	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->m_framebuffer);
-	glReadPixels(trxPos.nSSAX, trxPos.nSSAY, trxReg.nRRW, trxReg.nRRH, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	PENDING_READBACK readback;
+	readback.buffer   = Framework::OpenGl::CBuffer::Create();
+	readback.psm      = bltBuf.nSrcPsm;
+	readback.bufPtr   = bltBuf.GetSrcPtr();
+	readback.bufWidth = bltBuf.nSrcWidth;
+	readback.x        = trxPos.nSSAX;
+	readback.y        = trxPos.nSSAY;
+	readback.width    = width;
+	readback.height   = height;
+	readback.scale    = m_fbScale;
+
+	//Copy at the framebuffer's resolution, pixels are sampled back to native resolution when written to RAM
+	uint32 scale = readback.scale;
+	GLuint readFramebuffer = (framebuffer->m_resolveFramebuffer != 0) ? framebuffer->m_resolveFramebuffer : framebuffer->m_framebuffer;
+	glBindFramebuffer(GL_FRAMEBUFFER, readFramebuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+	glBufferData(GL_PIXEL_PACK_BUFFER, width * scale * height * scale * sizeof(uint32), nullptr, GL_STREAM_READ);
+	glReadPixels(readback.x * scale, readback.y * scale, width * scale, height * scale, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 	CHECKGLERROR();
 
-	//Write back to RAM
+	//Get the copy going right away, we'll only wait on it when the data is consumed
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+
+	m_pendingReadbacks.push_back(std::move(readback));
+}
+
+void CGSH_OpenGL::SyncLocalToHostTransfers()
+{
+	if(m_pendingReadbacks.empty()) return;
+
+	for(const auto& readback : m_pendingReadbacks)
 	{
-		CGsPixelFormats::CPixelIndexorPSMCT32 indexor(m_pRAM, bltBuf.GetSrcPtr(), bltBuf.nSrcWidth);
-		for(uint32 y = trxPos.nSSAY; y < (trxPos.nSSAY + trxReg.nRRH); y++)
+		while(glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT) == GL_TIMEOUT_EXPIRED)
 		{
-			for(uint32 x = trxPos.nSSAX; x < (trxPos.nSSAX + trxReg.nRRH); x++)
-			{
-				uint32 pixel = pixels[x + (y * trxReg.nRRW)];
-				indexor.SetPixel(x, y, pixel);
-			}
+
 		}
+		glDeleteSync(readback.fence);
+
+		uint32 scale = readback.scale;
+		GLsizeiptr size = readback.width * scale * readback.height * scale * sizeof(uint32);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		auto pixels = reinterpret_cast<const uint32*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+		if(pixels == nullptr)
+		{
+			assert(false);
+			continue;
+		}
+
+		switch(readback.psm)
+		{
+		case PSMCT32:
+			WriteReadbackToRam<CGsPixelFormats::CPixelIndexorPSMCT32>(readback, pixels,
+				[] (uint32& dst, uint32 src) { dst = src; });
+			break;
+		case PSMCT24:
+			WriteReadbackToRam<CGsPixelFormats::CPixelIndexorPSMCT32>(readback, pixels,
+				[] (uint32& dst, uint32 src) { dst = (dst & 0xFF000000) | (src & 0x00FFFFFF); });
+			break;
+		case PSMCT16:
+			WriteReadbackToRam<CGsPixelFormats::CPixelIndexorPSMCT16>(readback, pixels,
+				[] (uint16& dst, uint32 src) { dst = RGBA32ToRGBA16(src); });
+			break;
+		case PSMCT16S:
+			WriteReadbackToRam<CGsPixelFormats::CPixelIndexorPSMCT16S>(readback, pixels,
+				[] (uint16& dst, uint32 src) { dst = RGBA32ToRGBA16(src); });
+			break;
+		default:
+			assert(false);
+			break;
+		}
+
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	CHECKGLERROR();
+
+	m_pendingReadbacks.clear();
+}
+
+void CGSH_OpenGL::DiscardLocalToHostTransfers()
+{
+	for(const auto& readback : m_pendingReadbacks)
+	{
+		glDeleteSync(readback.fence);
 	}
+	m_pendingReadbacks.clear();
+}
 
-	delete [] pixels;
+template <typename Indexor, typename Converter>
+void CGSH_OpenGL::WriteReadbackToRam(const PENDING_READBACK& readback, const uint32* pixels, Converter converter)
+{
+	uint32 scale = readback.scale;
+	uint32 pitch = readback.width * scale;
+	Indexor indexor(m_pRAM, readback.bufPtr, readback.bufWidth);
+	for(uint32 y = 0; y < readback.height; y++)
+	{
+		const uint32* row = pixels + (y * scale * pitch);
+		indexor.SetPixelRow(readback.x, readback.y + y, row, readback.width, scale, converter);
+	}
 }
 
 void CGSH_OpenGL::ProcessLocalToLocalTransfer()
@@ -2205,6 +2402,9 @@ CGSH_OpenGL::CFramebuffer::~CFramebuffer()
 
 void CGSH_OpenGL::PopulateFramebuffer(const FramebufferPtr& framebuffer)
 {
+	FlushVertexBuffer();
+	m_validGlState &= ~(GLSTATE_FRAMEBUFFER | GLSTATE_TEXTURE);
+
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, m_copyToFbTexture);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -2264,6 +2464,9 @@ void CGSH_OpenGL::CommitFramebufferDirtyPages(const FramebufferPtr& framebuffer,
 
 	if(cachedArea.HasDirtyPages())
 	{
+		//Pending primitives might be drawn to this framebuffer
+		FlushVertexBuffer();
+
 		CCopyToFbEnabler copyToFbEnabler;
 
 		auto texturePageSize = CGsPixelFormats::GetPsmPageSize(framebuffer->m_psm);
@@ -2319,6 +2522,9 @@ void CGSH_OpenGL::ResolveFramebufferMultisample(const FramebufferPtr& framebuffe
 {
 	if(!framebuffer->m_resolveNeeded) return;
 
+	//Pending primitives might be drawn to this framebuffer
+	FlushVertexBuffer();
+
 	m_validGlState &= ~(GLSTATE_SCISSOR | GLSTATE_FRAMEBUFFER);
 
 	glDisable(GL_SCISSOR_TEST);
@@ -2365,3 +2571,128 @@ CGSH_OpenGL::CDepthbuffer::~CDepthbuffer()
 		glDeleteRenderbuffers(1, &m_depthBuffer);
 	}
 }
+
+/////////////////////////////////////////////////////////////
+// Stream buffer
+/////////////////////////////////////////////////////////////
+
+static bool HasBufferStorage()
+{
+#ifdef GLES_COMPATIBILITY
+	return false;
+#else
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for(GLint i = 0; i < extensionCount; i++)
+	{
+		auto extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if((extension != nullptr) && !strcmp(extension, "GL_ARB_buffer_storage")) return true;
+	}
+	return false;
+#endif
+}
+
+CGSH_OpenGL::CStreamBuffer::CStreamBuffer(GLenum target, uint32 segmentSize, uint32 alignment)
+: m_target(target)
+, m_segmentSize(segmentSize - (segmentSize % alignment))
+, m_alignment(alignment)
+{
+	for(auto& fence : m_fences)
+	{
+		fence = nullptr;
+	}
+
+	uint32 bufferSize = m_segmentSize * SEGMENT_COUNT;
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(m_target, m_buffer);
+#ifndef GLES_COMPATIBILITY
+	if(HasBufferStorage())
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(m_target, bufferSize, nullptr, flags);
+		m_mapping = reinterpret_cast<uint8*>(glMapBufferRange(m_target, 0, bufferSize, flags));
+		assert(m_mapping != nullptr);
+	}
+	else
+#endif
+	{
+		glBufferData(m_target, bufferSize, nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(m_target, 0);
+	CHECKGLERROR();
+}
+
+CGSH_OpenGL::CStreamBuffer::~CStreamBuffer()
+{
+	for(const auto& fence : m_fences)
+	{
+		if(fence != nullptr)
+		{
+			glDeleteSync(fence);
+		}
+	}
+	if(m_mapping != nullptr)
+	{
+		glBindBuffer(m_target, m_buffer);
+		glUnmapBuffer(m_target);
+		glBindBuffer(m_target, 0);
+	}
+	if(m_buffer != 0)
+	{
+		glDeleteBuffers(1, &m_buffer);
+	}
+}
+
+GLuint CGSH_OpenGL::CStreamBuffer::GetBuffer() const
+{
+	return m_buffer;
+}
+
+uint32 CGSH_OpenGL::CStreamBuffer::Write(const void* data, uint32 size)
+{
+	assert(size <= m_segmentSize);
+
+	//Data never straddles two segments, fences would otherwise be inserted before the data is used
+	uint32 offset = ((m_position + m_alignment - 1) / m_alignment) * m_alignment;
+	if((offset + size) > ((m_currentSegment + 1) * m_segmentSize))
+	{
+		BeginNextSegment();
+		offset = m_currentSegment * m_segmentSize;
+	}
+
+	if(m_mapping != nullptr)
+	{
+		memcpy(m_mapping + offset, data, size);
+	}
+	else
+	{
+		//Fences guarantee the range isn't used by the GPU anymore
+		glBindBuffer(m_target, m_buffer);
+		auto mapping = glMapBufferRange(m_target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		assert(mapping != nullptr);
+		memcpy(mapping, data, size);
+		glUnmapBuffer(m_target);
+	}
+
+	m_position = offset + size;
+	return offset;
+}
+
+void CGSH_OpenGL::CStreamBuffer::BeginNextSegment()
+{
+	//Everything submitted up to now is done with the segment we're leaving
+	assert(m_fences[m_currentSegment] == nullptr);
+	m_fences[m_currentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	m_currentSegment = (m_currentSegment + 1) % SEGMENT_COUNT;
+	auto& fence = m_fences[m_currentSegment];
+	if(fence != nullptr)
+	{
+		while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT) == GL_TIMEOUT_EXPIRED)
+		{
+
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
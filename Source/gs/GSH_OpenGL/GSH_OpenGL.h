@@ -1,16 +1,27 @@
 #pragma once
 
 #include <list>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include "../GSHandler.h"
 #include "../GsCachedArea.h"
+#include "../GsTextureCache.h"
 #include "opengl/OpenGlDef.h"
 #include "opengl/Program.h"
 #include "opengl/Shader.h"
 #include "opengl/Resource.h"
 
+namespace Framework
+{
+	class CStdStream;
+}
+
 #define PREF_CGSH_OPENGL_ENABLEHIGHRESMODE        "renderer.opengl.enablehighresmode"
 #define PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES    "renderer.opengl.forcebilineartextures"
+#define PREF_CGSH_OPENGL_TEXTURECACHESIZE         "renderer.opengl.texturecachesize"
 
 class CGSH_OpenGL : public CGSHandler
 {
@@ -37,6 +48,15 @@ protected:
 	virtual void					ResetImpl() override;
 	virtual void					NotifyPreferencesChangedImpl() override;
 	virtual void					FlipImpl() override;
+	virtual void					SyncLocalToHostTransfers() override;
+	virtual void					SetShaderCachePathImpl(const boost::filesystem::path&) override;
+
+	//Platform specific, provides a context sharing objects with the main one to compile programs in the background.
+	//CreateSharedContext/DestroySharedContext are called on the GS thread, returns false if not supported.
+	virtual bool					CreateSharedContext();
+	virtual void					DestroySharedContext();
+	virtual void					MakeSharedContextCurrent();
+	virtual void					ReleaseSharedContext();
 
 	GLuint							m_presentFramebuffer = 0;
 
@@ -90,6 +110,7 @@ private:
 		//OpenGL state
 		GLuint		shaderHandle;
 		GLuint		framebufferHandle;
+		GLuint		depthbufferHandle;
 		GLuint		texture0Handle;
 		GLint		texture0MinFilter;
 		GLint		texture0MagFilter;
@@ -103,6 +124,12 @@ private:
 		GLsizei		scissorWidth;
 		GLsizei		scissorHeight;
 		bool		blendEnabled;
+		GLenum		blendEquation;
+		GLenum		blendSrcFactor;
+		GLenum		blendDstFactor;
+		float		blendAlpha;
+		bool		depthTestEnabled;
+		GLenum		depthFunc;
 		bool		colorMaskR;
 		bool		colorMaskG;
 		bool		colorMaskB;
@@ -135,7 +162,6 @@ private:
 
 	enum
 	{
-		MAX_TEXTURE_CACHE = 256,
 		MAX_PALETTE_CACHE = 256,
 	};
 
@@ -174,21 +200,7 @@ private:
 
 	typedef std::unordered_map<uint32, Framework::OpenGl::ProgramPtr> ShaderMap;
 
-	class CTexture
-	{
-	public:
-									CTexture();
-									~CTexture();
-		void						Free();
-
-		uint64						m_tex0;
-		GLuint						m_texture;
-		bool						m_live;
-
-		CGsCachedArea				m_cachedArea;
-	};
-	typedef std::shared_ptr<CTexture> TexturePtr;
-	typedef std::list<TexturePtr> TextureList;
+	typedef CGsTextureCache<Framework::OpenGl::CTexture> TextureCache;
 
 	class CPalette
 	{
@@ -246,8 +258,56 @@ private:
 		GLuint						m_depthBuffer;
 	};
 	typedef std::shared_ptr<CDepthbuffer> DepthbufferPtr;
+
+	//Ring buffer split in segments, each segment is guarded by a fence before being written to again.
+	//Uses a persistently mapped buffer when ARB_buffer_storage is available, unsynchronized mapping otherwise.
+	class CStreamBuffer
+	{
+	public:
+		enum
+		{
+			SEGMENT_COUNT = 3,
+		};
+
+									CStreamBuffer(GLenum, uint32, uint32);
+									~CStreamBuffer();
+
+		GLuint						GetBuffer() const;
+
+		//Returns the offset where data was written in the buffer
+		uint32						Write(const void*, uint32);
+
+	private:
+		void						BeginNextSegment();
+
+		GLenum						m_target = GL_NONE;
+		uint32						m_segmentSize = 0;
+		uint32						m_alignment = 1;
+		uint32						m_position = 0;
+		uint32						m_currentSegment = 0;
+		GLuint						m_buffer = 0;
+		uint8*						m_mapping = nullptr;
+		GLsync						m_fences[SEGMENT_COUNT];
+	};
+	typedef std::unique_ptr<CStreamBuffer> StreamBufferPtr;
 	typedef std::vector<DepthbufferPtr> DepthbufferList;
 
+	//Framebuffer area being copied to a pixel buffer, written back to RAM once the fence is signaled
+	struct PENDING_READBACK
+	{
+		Framework::OpenGl::CBuffer	buffer;
+		GLsync						fence = nullptr;
+		uint32						psm = 0;
+		uint32						bufPtr = 0;
+		uint32						bufWidth = 0;
+		uint32						x = 0;
+		uint32						y = 0;
+		uint32						width = 0;
+		uint32						height = 0;
+		uint32						scale = 1;
+	};
+	typedef std::vector<PENDING_READBACK> PendingReadbackList;
+
 	struct TEXTURE_INFO
 	{
 		GLuint	textureHandle = 0;
@@ -290,14 +350,26 @@ private:
 	GLuint							PreparePalette(const TEX0&);
 
 	uint32							RGBA16ToRGBA32(uint16);
+	static uint16					RGBA32ToRGBA16(uint32);
 	float							GetZ(float);
 
 	void							VertexKick(uint8, uint64);
 
 	Framework::OpenGl::ProgramPtr	GetShaderFromCaps(const SHADERCAPS&);
 	Framework::OpenGl::ProgramPtr	GenerateShader(const SHADERCAPS&);
-	Framework::OpenGl::CShader		GenerateVertexShader(const SHADERCAPS&);
-	Framework::OpenGl::CShader		GenerateFragmentShader(const SHADERCAPS&);
+
+	//Program cache
+	void							LoadProgramCache(const boost::filesystem::path&, std::vector<uint32>&);
+	void							CloseProgramCache();
+	void							SaveProgram(uint32, const Framework::OpenGl::ProgramPtr&);
+	Framework::OpenGl::ProgramPtr	TakeCompiledProgram(uint32);
+	void							SetupProgram(const Framework::OpenGl::ProgramPtr&);
+	void							ProgramCompilerThreadProc();
+	static std::string				GetProgramCacheSignature();
+	static Framework::OpenGl::CShader	CompileShader(GLenum, const std::string&);
+	std::string						GenerateVertexShaderSource(const SHADERCAPS&);
+	std::string						GenerateFragmentShaderSource(const SHADERCAPS&);
+	uint32							GetShaderSourceHash(const SHADERCAPS&);
 	std::string						GenerateTexCoordClampingSection(TEXTURE_CLAMP_MODE, const char*);
 	std::string						GenerateAlphaTestSection(ALPHA_TEST_METHOD);
 
@@ -310,7 +382,6 @@ private:
 	Framework::OpenGl::CVertexArray	GenerateCopyToFbVertexArray();
 
 	Framework::OpenGl::CVertexArray	GeneratePrimVertexArray();
-	Framework::OpenGl::CBuffer		GenerateUniformBlockBuffer(size_t);
 
 	void							Prim_Point();
 	void							Prim_Line();
@@ -319,23 +390,25 @@ private:
 
 	void							FlushVertexBuffer();
 	void							DoRenderPass();
+	static GLenum					GetPrimitiveMode(unsigned int);
 
 	void							CopyToFb(int32, int32, int32, int32, int32, int32, int32, int32, int32, int32);
 	void							DrawToDepth(unsigned int, uint64);
 
 	void							SetRenderingContext(uint64);
-	void							SetupTestFunctions(uint64);
-	void							SetupDepthBuffer(uint64, uint64);
-	void							SetupFramebuffer(uint64, uint64, uint64, uint64);
-	void							SetupBlendingFunction(uint64);
-	void							SetupFogColor(uint64);
+	static uint32					GetRenderStateChanges(const RENDERSTATE&, const RENDERSTATE&);
+	void							SetupTestFunctions(RENDERSTATE&, FRAGMENTPARAMS&, uint64);
+	void							SetupDepthBuffer(RENDERSTATE&, uint64, uint64);
+	void							SetupFramebuffer(RENDERSTATE&, VERTEXPARAMS&, uint64, uint64, uint64, uint64);
+	void							SetupBlendingFunction(RENDERSTATE&, uint64);
+	void							SetupFogColor(FRAGMENTPARAMS&, uint64);
 
 	static bool						CanRegionRepeatClampModeSimplified(uint32, uint32);
 	void							FillShaderCapsFromTexture(SHADERCAPS&, const uint64&, const uint64&, const uint64&, const uint64&);
 	void							FillShaderCapsFromTest(SHADERCAPS&, const uint64&);
 	TECHNIQUE						GetTechniqueFromTest(const uint64&);
 
-	void							SetupTexture(uint64, uint64, uint64, uint64, uint64);
+	void							SetupTexture(RENDERSTATE&, VERTEXPARAMS&, FRAGMENTPARAMS&, uint64, uint64, uint64, uint64, uint64);
 	static bool						IsCompatibleFramebufferPSM(unsigned int, unsigned int);
 	static uint32					GetFramebufferBitDepth(uint32);
 
@@ -376,8 +449,6 @@ private:
 
 	uint8*							m_pCvtBuffer;
 
-	CTexture*						TexCache_Search(const TEX0&);
-	void							TexCache_Insert(const TEX0&, GLuint);
 	void							TexCache_InvalidateTextures(uint32, uint32);
 
 	GLuint							PalCache_Search(const TEX0&);
@@ -389,6 +460,10 @@ private:
 	void							CommitFramebufferDirtyPages(const FramebufferPtr&, unsigned int, unsigned int);
 	void							ResolveFramebufferMultisample(const FramebufferPtr&, uint32);
 
+	void							DiscardLocalToHostTransfers();
+	template <typename Indexor, typename Converter>
+	void							WriteReadbackToRam(const PENDING_READBACK&, const uint32*, Converter);
+
 	Framework::OpenGl::ProgramPtr	m_presentProgram;
 	Framework::OpenGl::CBuffer		m_presentVertexBuffer;
 	Framework::OpenGl::CVertexArray	m_presentVertexArray;
@@ -402,12 +477,13 @@ private:
 	GLint							m_copyToFbSrcPositionUniform = -1;
 	GLint							m_copyToFbSrcSizeUniform = -1;
 
-	TextureList						m_textureCache;
+	TextureCache					m_textureCache;
 	PaletteList						m_paletteCache;
 	FramebufferList					m_framebuffers;
 	DepthbufferList					m_depthbuffers;
+	PendingReadbackList				m_pendingReadbacks;
 
-	Framework::OpenGl::CBuffer		m_primBuffer;
+	StreamBufferPtr					m_vertexStreamBuffer;
 	Framework::OpenGl::CVertexArray	m_primVertexArray;
 
 	VERTEX							m_VtxBuffer[3];
@@ -436,14 +512,29 @@ private:
 		GLSTATE_TEXTURE         = 0x0080,
 		GLSTATE_FRAMEBUFFER     = 0x0100,
 		GLSTATE_VIEWPORT        = 0x0200,
+		GLSTATE_DEPTHTEST       = 0x0400,
 	};
 
 	ShaderMap						m_shaders;
+
+	typedef std::unique_ptr<Framework::CStdStream> StreamPtr;
+	bool							m_programBinarySupported = false;
+	std::mutex						m_programCacheMutex;
+	StreamPtr						m_programCacheStream;
+	std::unordered_set<uint32>		m_programCacheCaps;
+	std::vector<uint32>				m_programCompileQueue;
+	ShaderMap						m_compiledPrograms;
+	std::condition_variable			m_programCompiledCondition;
+	uint32							m_programCompilingCaps = 0;
+	bool							m_programCompiling = false;
+	std::thread						m_programCompilerThread;
+	bool							m_programCompilerStop = false;
+	bool							m_sharedContextCreated = false;
 	RENDERSTATE						m_renderState;
 	uint32							m_validGlState = 0;
 	VERTEXPARAMS					m_vertexParams;
 	FRAGMENTPARAMS					m_fragmentParams;
-	Framework::OpenGl::CBuffer		m_vertexParamsBuffer;
-	Framework::OpenGl::CBuffer		m_fragmentParamsBuffer;
+	StreamBufferPtr					m_uniformStreamBuffer;
+	uint32							m_vertexBufferStart = 0;
 	VertexBuffer					m_vertexBuffer;
 };
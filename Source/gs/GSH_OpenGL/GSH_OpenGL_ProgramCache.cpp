@@ -0,0 +1,390 @@
+#include <stdio.h>
+#include <assert.h>
+#include <cstring>
+#include <algorithm>
+#include <zlib.h>
+#include "GSH_OpenGL.h"
+#include "StdStream.h"
+#include "make_unique.h"
+
+//Programs are stored per game, along with the list of shader caps used by it.
+//Binaries are only valid for the driver that produced them and for the exact GLSL
+//source they were compiled from. The caps list is kept when they become stale to
+//recompile those programs in the background.
+
+#define PROGRAM_CACHE_FILENAME	("gl_programs.bin")
+#define PROGRAM_CACHE_MAGIC		(0x474F5250)	//'PROG'
+#define PROGRAM_CACHE_VERSION	(2)
+
+struct PROGRAM_CACHE_HEADER
+{
+	uint32	magic;
+	uint32	version;
+	uint32	signatureSize;
+};
+
+struct PROGRAM_CACHE_RECORD
+{
+	uint32	caps;
+	uint32	sourceHash;		//Hash of the GLSL source the binary was compiled from
+	uint32	binaryFormat;
+	uint32	binarySize;		//0 if the driver can't provide binaries
+};
+
+void CGSH_OpenGL::SetShaderCachePathImpl(const boost::filesystem::path& cachePath)
+{
+	CloseProgramCache();
+	if(cachePath.empty()) return;
+
+	GLint binaryFormatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+	glGetError();
+	m_programBinarySupported = (binaryFormatCount > 0);
+
+	auto cacheFilePath = cachePath / PROGRAM_CACHE_FILENAME;
+	std::vector<uint32> staleCaps;
+	try
+	{
+		LoadProgramCache(cacheFilePath, staleCaps);
+	}
+	catch(const std::exception& exception)
+	{
+		printf("GSH_OpenGL: Failed to open program cache: %s\r\n", exception.what());
+		CloseProgramCache();
+		return;
+	}
+
+	if(staleCaps.empty()) return;
+
+	m_sharedContextCreated = CreateSharedContext();
+	if(!m_sharedContextCreated) return;
+
+	m_programCompileQueue = std::move(staleCaps);
+	m_programCompilerStop = false;
+	m_programCompilerThread = std::thread([this] () { ProgramCompilerThreadProc(); });
+}
+
+void CGSH_OpenGL::LoadProgramCache(const boost::filesystem::path& path, std::vector<uint32>& staleCaps)
+{
+	std::vector<uint8> contents;
+	{
+		boost::system::error_code errorCode;
+		auto fileSize = boost::filesystem::file_size(path, errorCode);
+		if(!errorCode && (fileSize != 0))
+		{
+			contents.resize(static_cast<size_t>(fileSize));
+			Framework::CStdStream inputStream(path.string().c_str(), "rb");
+			contents.resize(static_cast<size_t>(inputStream.Read(contents.data(), contents.size())));
+		}
+	}
+
+	auto signature = GetProgramCacheSignature();
+	bool signatureMatches = false;
+	size_t offset = 0;
+	if(contents.size() >= sizeof(PROGRAM_CACHE_HEADER))
+	{
+		PROGRAM_CACHE_HEADER header;
+		memcpy(&header, contents.data(), sizeof(PROGRAM_CACHE_HEADER));
+		offset = sizeof(PROGRAM_CACHE_HEADER) + header.signatureSize;
+		if((header.magic != PROGRAM_CACHE_MAGIC) || (header.version != PROGRAM_CACHE_VERSION) || (offset > contents.size()))
+		{
+			offset = contents.size();
+		}
+		else
+		{
+			signatureMatches = (header.signatureSize == signature.size()) &&
+				(memcmp(contents.data() + sizeof(PROGRAM_CACHE_HEADER), signature.c_str(), signature.size()) == 0);
+		}
+	}
+
+	//Later records for the same caps replace earlier ones
+	std::unordered_map<uint32, size_t> recordOffsets;
+	std::vector<uint32> recordedCaps;
+	while((offset + sizeof(PROGRAM_CACHE_RECORD)) <= contents.size())
+	{
+		PROGRAM_CACHE_RECORD record;
+		memcpy(&record, contents.data() + offset, sizeof(PROGRAM_CACHE_RECORD));
+		size_t recordSize = sizeof(PROGRAM_CACHE_RECORD) + record.binarySize;
+		if((offset + recordSize) > contents.size()) break;
+		if(recordOffsets.find(record.caps) == std::end(recordOffsets))
+		{
+			recordedCaps.push_back(record.caps);
+		}
+		if(signatureMatches && (record.binarySize != 0))
+		{
+			recordOffsets[record.caps] = offset;
+		}
+		else
+		{
+			recordOffsets.insert(std::make_pair(record.caps, 0));
+		}
+		offset += recordSize;
+	}
+
+	for(const auto& caps : recordedCaps)
+	{
+		Framework::OpenGl::ProgramPtr program;
+		size_t recordOffset = recordOffsets[caps];
+		if(m_programBinarySupported && (recordOffset != 0))
+		{
+			PROGRAM_CACHE_RECORD record;
+			memcpy(&record, contents.data() + recordOffset, sizeof(PROGRAM_CACHE_RECORD));
+			//Shader generator might have changed since the binary was made
+			if(record.sourceHash != GetShaderSourceHash(make_convertible<SHADERCAPS>(caps)))
+			{
+				staleCaps.push_back(caps);
+				continue;
+			}
+			program = std::make_shared<Framework::OpenGl::CProgram>();
+			glProgramBinary(*program, record.binaryFormat, contents.data() + recordOffset + sizeof(PROGRAM_CACHE_RECORD), record.binarySize);
+			GLint linkStatus = GL_FALSE;
+			glGetProgramiv(*program, GL_LINK_STATUS, &linkStatus);
+			if(linkStatus != GL_TRUE)
+			{
+				//Driver refused the binary
+				glGetError();
+				program.reset();
+			}
+		}
+		if(program)
+		{
+			SetupProgram(program);
+			m_shaders.insert(std::make_pair(caps, program));
+			m_programCacheCaps.insert(caps);
+		}
+		else
+		{
+			staleCaps.push_back(caps);
+		}
+	}
+
+	//Rewrite the file if binaries can't be used anymore, only keeping the caps list
+	bool rewrite = !signatureMatches || !staleCaps.empty();
+	m_programCacheStream = std::make_unique<Framework::CStdStream>(path.string().c_str(), rewrite ? "wb" : "ab");
+	if(rewrite)
+	{
+		m_programCacheCaps.clear();
+
+		PROGRAM_CACHE_HEADER header = {};
+		header.magic			= PROGRAM_CACHE_MAGIC;
+		header.version			= PROGRAM_CACHE_VERSION;
+		header.signatureSize	= static_cast<uint32>(signature.size());
+		m_programCacheStream->Write(&header, sizeof(PROGRAM_CACHE_HEADER));
+		m_programCacheStream->Write(signature.c_str(), signature.size());
+
+		for(const auto& caps : recordedCaps)
+		{
+			auto programIterator = m_shaders.find(caps);
+			if(programIterator != std::end(m_shaders))
+			{
+				SaveProgram(caps, programIterator->second);
+			}
+			else
+			{
+				PROGRAM_CACHE_RECORD record = {};
+				record.caps = caps;
+				m_programCacheStream->Write(&record, sizeof(PROGRAM_CACHE_RECORD));
+			}
+		}
+	}
+}
+
+void CGSH_OpenGL::CloseProgramCache()
+{
+	if(m_programCompilerThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> programCacheLock(m_programCacheMutex);
+			m_programCompilerStop = true;
+		}
+		m_programCompilerThread.join();
+	}
+	if(m_sharedContextCreated)
+	{
+		DestroySharedContext();
+		m_sharedContextCreated = false;
+	}
+
+	std::lock_guard<std::mutex> programCacheLock(m_programCacheMutex);
+	m_programCompileQueue.clear();
+	m_compiledPrograms.clear();
+	m_programCacheCaps.clear();
+	m_programCacheStream.reset();
+}
+
+void CGSH_OpenGL::SaveProgram(uint32 caps, const Framework::OpenGl::ProgramPtr& program)
+{
+	//Can be called from the GS thread or the compiler thread, context must be current
+	{
+		std::lock_guard<std::mutex> programCacheLock(m_programCacheMutex);
+		if(!m_programCacheStream) return;
+		if(m_programCacheCaps.find(caps) != std::end(m_programCacheCaps)) return;
+	}
+
+	std::vector<uint8> binary;
+	PROGRAM_CACHE_RECORD record = {};
+	record.caps = caps;
+	record.sourceHash = GetShaderSourceHash(make_convertible<SHADERCAPS>(caps));
+	if(m_programBinarySupported)
+	{
+		GLint binaryLength = 0;
+		glGetProgramiv(*program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+		if(binaryLength > 0)
+		{
+			binary.resize(binaryLength);
+			GLsizei length = 0;
+			GLenum binaryFormat = 0;
+			glGetProgramBinary(*program, binaryLength, &length, &binaryFormat, binary.data());
+			binary.resize(length);
+			record.binaryFormat = binaryFormat;
+			record.binarySize = static_cast<uint32>(binary.size());
+		}
+	}
+
+	std::lock_guard<std::mutex> programCacheLock(m_programCacheMutex);
+	if(!m_programCacheStream) return;
+	if(m_programCacheCaps.find(caps) != std::end(m_programCacheCaps)) return;
+	try
+	{
+		m_programCacheStream->Write(&record, sizeof(PROGRAM_CACHE_RECORD));
+		m_programCacheStream->Write(binary.data(), binary.size());
+	}
+	catch(const std::exception& exception)
+	{
+		printf("GSH_OpenGL: Failed to write program: %s\r\n", exception.what());
+		m_programCacheStream.reset();
+		return;
+	}
+	m_programCacheCaps.insert(caps);
+}
+
+Framework::OpenGl::ProgramPtr CGSH_OpenGL::TakeCompiledProgram(uint32 caps)
+{
+	std::unique_lock<std::mutex> programCacheLock(m_programCacheMutex);
+
+	//Don't compile the same program twice: take it off the queue if the compiler
+	//thread didn't get to it yet, wait for it if it's being compiled
+	auto queueIterator = std::find(std::begin(m_programCompileQueue), std::end(m_programCompileQueue), caps);
+	if(queueIterator != std::end(m_programCompileQueue))
+	{
+		m_programCompileQueue.erase(queueIterator);
+		return Framework::OpenGl::ProgramPtr();
+	}
+	m_programCompiledCondition.wait(programCacheLock,
+		[&] () { return !m_programCompiling || (m_programCompilingCaps != caps); });
+
+	auto programIterator = m_compiledPrograms.find(caps);
+	if(programIterator == std::end(m_compiledPrograms)) return Framework::OpenGl::ProgramPtr();
+	auto program = programIterator->second;
+	m_compiledPrograms.erase(programIterator);
+	return program;
+}
+
+void CGSH_OpenGL::SetupProgram(const Framework::OpenGl::ProgramPtr& program)
+{
+	glUseProgram(*program);
+	m_validGlState &= ~GLSTATE_PROGRAM;
+
+	auto textureUniform = glGetUniformLocation(*program, "g_texture");
+	if(textureUniform != -1)
+	{
+		glUniform1i(textureUniform, 0);
+	}
+
+	auto paletteUniform = glGetUniformLocation(*program, "g_palette");
+	if(paletteUniform != -1)
+	{
+		glUniform1i(paletteUniform, 1);
+	}
+
+	auto vertexParamsUniformBlock = glGetUniformBlockIndex(*program, "VertexParams");
+	if(vertexParamsUniformBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(*program, vertexParamsUniformBlock, 0);
+	}
+
+	auto fragmentParamsUniformBlock = glGetUniformBlockIndex(*program, "FragmentParams");
+	if(fragmentParamsUniformBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(*program, fragmentParamsUniformBlock, 1);
+	}
+
+	CHECKGLERROR();
+}
+
+void CGSH_OpenGL::ProgramCompilerThreadProc()
+{
+	MakeSharedContextCurrent();
+
+	while(1)
+	{
+		uint32 caps = 0;
+		{
+			std::lock_guard<std::mutex> programCacheLock(m_programCacheMutex);
+			if(m_programCompilerStop || m_programCompileQueue.empty()) break;
+			caps = m_programCompileQueue.back();
+			m_programCompileQueue.pop_back();
+			m_programCompilingCaps = caps;
+			m_programCompiling = true;
+		}
+
+		auto program = GenerateShader(make_convertible<SHADERCAPS>(caps));
+		SaveProgram(caps, program);
+
+		//Program must be complete before it can be used by the GS thread's context
+		glFinish();
+
+		{
+			std::lock_guard<std::mutex> programCacheLock(m_programCacheMutex);
+			m_compiledPrograms.insert(std::make_pair(caps, program));
+			m_programCompiling = false;
+		}
+		m_programCompiledCondition.notify_all();
+	}
+
+	ReleaseSharedContext();
+}
+
+std::string CGSH_OpenGL::GetProgramCacheSignature()
+{
+	//Binaries depend on the driver, changes in the shader generator are caught by the source hash of each record
+	std::string signature;
+	for(auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+	{
+		auto value = reinterpret_cast<const char*>(glGetString(name));
+		signature += (value != nullptr) ? value : "";
+		signature += ';';
+	}
+	return signature;
+}
+
+uint32 CGSH_OpenGL::GetShaderSourceHash(const SHADERCAPS& caps)
+{
+	auto vertexShaderSource = GenerateVertexShaderSource(caps);
+	auto fragmentShaderSource = GenerateFragmentShaderSource(caps);
+	uLong hash = crc32(0, Z_NULL, 0);
+	//Include terminators to tell where one source ends and the other begins
+	hash = crc32(hash, reinterpret_cast<const Bytef*>(vertexShaderSource.c_str()), static_cast<uInt>(vertexShaderSource.size() + 1));
+	hash = crc32(hash, reinterpret_cast<const Bytef*>(fragmentShaderSource.c_str()), static_cast<uInt>(fragmentShaderSource.size() + 1));
+	return static_cast<uint32>(hash);
+}
+
+bool CGSH_OpenGL::CreateSharedContext()
+{
+	return false;
+}
+
+void CGSH_OpenGL::DestroySharedContext()
+{
+
+}
+
+void CGSH_OpenGL::MakeSharedContextCurrent()
+{
+
+}
+
+void CGSH_OpenGL::ReleaseSharedContext()
+{
+
+}
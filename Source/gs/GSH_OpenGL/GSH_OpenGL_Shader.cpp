@@ -56,8 +56,8 @@ static const char* s_orFunction =
 
 Framework::OpenGl::ProgramPtr CGSH_OpenGL::GenerateShader(const SHADERCAPS& caps)
 {
-	auto vertexShader = GenerateVertexShader(caps);
-	auto fragmentShader = GenerateFragmentShader(caps);
+	auto vertexShader = CompileShader(GL_VERTEX_SHADER, GenerateVertexShaderSource(caps));
+	auto fragmentShader = CompileShader(GL_FRAGMENT_SHADER, GenerateFragmentShaderSource(caps));
 
 	auto result = std::make_shared<Framework::OpenGl::CProgram>();
 
@@ -69,6 +69,11 @@ Framework::OpenGl::ProgramPtr CGSH_OpenGL::GenerateShader(const SHADERCAPS& caps
 	glBindAttribLocation(*result, static_cast<GLuint>(PRIM_VERTEX_ATTRIB::TEXCOORD), "a_texCoord");
 	glBindAttribLocation(*result, static_cast<GLuint>(PRIM_VERTEX_ATTRIB::FOG), "a_fog");
 
+	if(m_programBinarySupported)
+	{
+		glProgramParameteri(*result, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
 	bool linkResult = result->Link();
 	assert(linkResult);
 
@@ -77,7 +82,19 @@ Framework::OpenGl::ProgramPtr CGSH_OpenGL::GenerateShader(const SHADERCAPS& caps
 	return result;
 }
 
-Framework::OpenGl::CShader CGSH_OpenGL::GenerateVertexShader(const SHADERCAPS& caps)
+Framework::OpenGl::CShader CGSH_OpenGL::CompileShader(GLenum type, const std::string& shaderSource)
+{
+	Framework::OpenGl::CShader result(type);
+	result.SetSource(shaderSource.c_str(), shaderSource.size());
+	bool compilationResult = result.Compile();
+	assert(compilationResult);
+
+	CHECKGLERROR();
+
+	return result;
+}
+
+std::string CGSH_OpenGL::GenerateVertexShaderSource(const SHADERCAPS& caps)
 {
 	std::stringstream shaderBuilder;
 	shaderBuilder << GLSL_VERSION << std::endl;
@@ -112,19 +129,10 @@ Framework::OpenGl::CShader CGSH_OpenGL::GenerateVertexShader(const SHADERCAPS& c
 	shaderBuilder << "	gl_Position = g_projMatrix * vec4(a_position, 1);" << std::endl;
 	shaderBuilder << "}" << std::endl;
 
-	auto shaderSource = shaderBuilder.str();
-
-	Framework::OpenGl::CShader result(GL_VERTEX_SHADER);
-	result.SetSource(shaderSource.c_str(), shaderSource.size());
-	bool compilationResult = result.Compile();
-	assert(compilationResult);
-
-	CHECKGLERROR();
-
-	return result;
+	return shaderBuilder.str();
 }
 
-Framework::OpenGl::CShader CGSH_OpenGL::GenerateFragmentShader(const SHADERCAPS& caps)
+std::string CGSH_OpenGL::GenerateFragmentShaderSource(const SHADERCAPS& caps)
 {
 	std::stringstream shaderBuilder;
 
@@ -308,16 +316,7 @@ Framework::OpenGl::CShader CGSH_OpenGL::GenerateFragmentShader(const SHADERCAPS&
 
 	shaderBuilder << "}" << std::endl;
 
-	auto shaderSource = shaderBuilder.str();
-
-	Framework::OpenGl::CShader result(GL_FRAGMENT_SHADER);
-	result.SetSource(shaderSource.c_str(), shaderSource.size());
-	bool compilationResult = result.Compile();
-	assert(compilationResult);
-
-	CHECKGLERROR();
-
-	return result;
+	return shaderBuilder.str();
 }
 
 std::string CGSH_OpenGL::GenerateTexCoordClampingSection(TEXTURE_CLAMP_MODE clampMode, const char* coordinate)
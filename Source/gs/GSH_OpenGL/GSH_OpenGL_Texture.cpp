@@ -132,16 +132,21 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::PrepareTexture(const TEX0& tex0)
 		}
 	}
 
-	auto texture = TexCache_Search(tex0);
+	auto texture = m_textureCache.Search(tex0);
 	if(texture)
 	{
-		texInfo.textureHandle = texture->m_texture;
+		texInfo.textureHandle = texture->m_textureHandle;
 
-		glBindTexture(GL_TEXTURE_2D, texture->m_texture);
 		auto& cachedArea = texture->m_cachedArea;
 
 		if(cachedArea.HasDirtyPages())
 		{
+			//Pending primitives might be sampling the previous contents
+			FlushVertexBuffer();
+			m_validGlState &= ~GLSTATE_TEXTURE;
+
+			glBindTexture(GL_TEXTURE_2D, texture->m_textureHandle);
+
 			auto texturePageSize = CGsPixelFormats::GetPsmPageSize(tex0.nPsm);
 			auto pageRect = cachedArea.GetPageRect();
 
@@ -183,13 +188,16 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::PrepareTexture(const TEX0& tex0)
 		texWidth = std::min<uint32>(texWidth, 1024);
 		texHeight = std::min<uint32>(texHeight, 1024);
 
-		GLuint textureHandle = 0;
-		glGenTextures(1, &textureHandle);
+		//Inserting will evict the least recently used texture and delete its GL object,
+		//pending primitives might still be sampling it
+		FlushVertexBuffer();
+
+		auto textureHandle = Framework::OpenGl::CTexture::Create();
+		m_validGlState &= ~GLSTATE_TEXTURE;
 		glBindTexture(GL_TEXTURE_2D, textureHandle);
 		((this)->*(m_textureUploader[tex0.nPsm]))(tex0.GetBufPtr(), tex0.nBufWidth, texWidth, texHeight);
-		TexCache_Insert(tex0, textureHandle);
-
 		texInfo.textureHandle = textureHandle;
+		m_textureCache.Insert(tex0, std::move(textureHandle));
 	}
 
 	return texInfo;
@@ -270,7 +278,11 @@ GLuint CGSH_OpenGL::PreparePalette(const TEX0& tex0)
 		return textureHandle;
 	}
 
+	//Inserting will delete the least recently used palette, pending primitives might still be using it
+	FlushVertexBuffer();
+
 	glGenTextures(1, &textureHandle);
+	m_validGlState &= ~GLSTATE_TEXTURE;
 	glBindTexture(GL_TEXTURE_2D, textureHandle);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, entryCount, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, convertedClut);
 
@@ -484,81 +496,18 @@ void CGSH_OpenGL::TexUpdater_Psm48H(uint32 bufPtr, uint32 bufWidth, unsigned int
 	CHECKGLERROR();
 }
 
-/////////////////////////////////////////////////////////////
-// Texture
-/////////////////////////////////////////////////////////////
-
-CGSH_OpenGL::CTexture::CTexture()
-: m_tex0(0)
-, m_texture(0)
-, m_live(false)
-{
-
-}
-
-CGSH_OpenGL::CTexture::~CTexture()
-{
-	Free();
-}
-
-void CGSH_OpenGL::CTexture::Free()
-{
-	if(m_texture != 0)
-	{
-		glDeleteTextures(1, &m_texture);
-		m_texture = 0;
-	}
-	m_live = false;
-	m_cachedArea.ClearDirtyPages();
-}
-
 /////////////////////////////////////////////////////////////
 // Texture Caching
 /////////////////////////////////////////////////////////////
 
-CGSH_OpenGL::CTexture* CGSH_OpenGL::TexCache_Search(const TEX0& tex0)
-{
-	uint64 maskedTex0 = static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
-
-	for(auto textureIterator(m_textureCache.begin());
-		textureIterator != m_textureCache.end(); textureIterator++)
-	{
-		auto texture = *textureIterator;
-		if(!texture->m_live) continue;
-		if(maskedTex0 != texture->m_tex0) continue;
-		m_textureCache.erase(textureIterator);
-		m_textureCache.push_front(texture);
-		return texture.get();
-	}
-
-	return nullptr;
-}
-
-void CGSH_OpenGL::TexCache_Insert(const TEX0& tex0, GLuint textureHandle)
-{
-	auto texture = *m_textureCache.rbegin();
-	texture->Free();
-
-	texture->m_cachedArea.SetArea(tex0.nPsm, tex0.GetBufPtr(), tex0.GetBufWidth(), tex0.GetHeight());
-
-	texture->m_tex0			= static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
-	texture->m_texture		= textureHandle;
-	texture->m_live			= true;
-
-	m_textureCache.pop_back();
-	m_textureCache.push_front(texture);
-}
-
 void CGSH_OpenGL::TexCache_InvalidateTextures(uint32 start, uint32 size)
 {
-	std::for_each(std::begin(m_textureCache), std::end(m_textureCache), 
-		[start, size] (TexturePtr& texture) { if(texture->m_live) { texture->m_cachedArea.Invalidate(start, size); } });
+	m_textureCache.InvalidateRange(start, size);
 }
 
 void CGSH_OpenGL::TexCache_Flush()
 {
-	std::for_each(std::begin(m_textureCache), std::end(m_textureCache), 
-		[] (TexturePtr& texture) { texture->Free(); });
+	m_textureCache.Flush();
 }
 
 /////////////////////////////////////////////////////////////
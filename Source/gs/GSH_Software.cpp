@@ -0,0 +1,1696 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "GsPixelFormats.h"
+#include "../AppConfig.h"
+#include "GSH_Software.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define GSH_SOFTWARE_SSE2
+#include <emmintrin.h>
+#endif
+
+//Z buffer pages use the same layout as color pages with their blocks arranged differently
+#define DEPTH_BLOCK_SWIZZLE (0x18 * CGsPixelFormats::BLOCKSIZE)
+
+enum DEPTH_TEST_METHOD
+{
+	DEPTH_TEST_NEVER,
+	DEPTH_TEST_ALWAYS,
+	DEPTH_TEST_GEQUAL,
+	DEPTH_TEST_GREATER,
+};
+
+static int64 FloorDiv(int64 numerator, int64 denominator)
+{
+	assert(denominator > 0);
+	if(numerator >= 0) return numerator / denominator;
+	return -((-numerator + denominator - 1) / denominator);
+}
+
+static uint32 ClampColor(float value)
+{
+	return static_cast<uint32>(std::min<float>(std::max<float>(value, 0), 255));
+}
+
+static uint32 Color16ToColor32(uint16 color)
+{
+	return ((color & 0x001F) << 3) | ((color & 0x03E0) << 6) | ((color & 0x7C00) << 9) | ((color & 0x8000) ? 0x80000000 : 0);
+}
+
+static uint16 Color32ToColor16(uint32 color)
+{
+	return static_cast<uint16>(
+		((color >>  3) & 0x001F) |
+		((color >>  6) & 0x03E0) |
+		((color >>  9) & 0x7C00) |
+		((color >> 16) & 0x8000));
+}
+
+static uint32 ApplyTexa(uint32 color, bool alphaBit, const CGSHandler::TEXA& texa)
+{
+	color &= 0x00FFFFFF;
+	if(alphaBit) return color | (texa.nTA1 << 24);
+	if(texa.nAEM && (color == 0)) return 0;
+	return color | (texa.nTA0 << 24);
+}
+
+static int32 WrapTexCoord(int32 coord, uint32 size, unsigned int mode, uint32 minValue, uint32 maxValue)
+{
+	switch(mode)
+	{
+	case 0:
+		//REPEAT
+		return coord & (size - 1);
+	case 1:
+		//CLAMP
+		return std::min<int32>(std::max<int32>(coord, 0), size - 1);
+	case 2:
+		//REGION_CLAMP
+		return std::min<int32>(std::max<int32>(coord, minValue), maxValue);
+	default:
+		//REGION_REPEAT
+		return (coord & minValue) | maxValue;
+	}
+}
+
+CGSH_Software::CGSH_Software()
+: m_nextTile(0)
+, m_completedTiles(0)
+{
+	//Page offset tables are lazily built, make sure this is done before any worker uses them
+	CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMT8(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMT4(m_pRAM, 0, 1);
+
+	m_primitiveMode <<= 0;
+	m_primitives.reserve(MAX_PRIMITIVES);
+}
+
+CGSH_Software::~CGSH_Software()
+{
+	StopWorkers();
+}
+
+CGSHandler::FactoryFunction CGSH_Software::GetFactoryFunction()
+{
+	return std::bind(&CGSH_Software::GSHandlerFactory);
+}
+
+CGSHandler* CGSH_Software::GSHandlerFactory()
+{
+	return new CGSH_Software();
+}
+
+void CGSH_Software::RegisterPreferences()
+{
+	CGSHandler::RegisterPreferences();
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_SOFTWARE_ENABLED, false);
+}
+
+void CGSH_Software::InitializeImpl()
+{
+	StartWorkers();
+}
+
+void CGSH_Software::ReleaseImpl()
+{
+	DiscardPrimitives();
+	StopWorkers();
+}
+
+void CGSH_Software::ResetImpl()
+{
+	DiscardPrimitives();
+	m_vtxCount = 0;
+	m_primitiveType = PRIM_INVALID;
+	m_linearClutDirty = true;
+}
+
+void CGSH_Software::FlipImpl()
+{
+	FlushPrimitives();
+	PresentFramebuffer();
+	CGSHandler::FlipImpl();
+}
+
+void CGSH_Software::SaveState(Framework::CZipArchiveWriter& archive)
+{
+	//Make sure everything that was drawn made it to GS RAM
+	SendGSCall(std::bind(&CGSH_Software::FlushPrimitives, this), true);
+	CGSHandler::SaveState(archive);
+}
+
+void CGSH_Software::LoadState(Framework::CZipArchiveReader& archive)
+{
+	SendGSCall(
+		[this] ()
+		{
+			DiscardPrimitives();
+			m_linearClutDirty = true;
+		},
+		true
+	);
+	CGSHandler::LoadState(archive);
+}
+
+uint32 CGSH_Software::GetCurrentReadCircuit() const
+{
+	if(m_nPMODE & 0x1) return 0;
+	if(m_nPMODE & 0x2) return 1;
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////
+// Register Handling
+/////////////////////////////////////////////////////////////
+
+void CGSH_Software::WriteRegisterImpl(uint8 registerId, uint64 data)
+{
+	switch(registerId)
+	{
+	case GS_REG_TRXDIR:
+	case GS_REG_TEXFLUSH:
+		//Transfers and textures need to see what was drawn before
+		FlushPrimitives();
+		break;
+	case GS_REG_TEX0_1:
+	case GS_REG_TEX0_2:
+	case GS_REG_TEX2_1:
+	case GS_REG_TEX2_2:
+		//CLUT loads read from GS RAM
+		if((data >> 61) != 0)
+		{
+			FlushPrimitives();
+		}
+		break;
+	}
+
+	CGSHandler::WriteRegisterImpl(registerId, data);
+
+	switch(registerId)
+	{
+	case GS_REG_PRIM:
+		m_primitiveType = static_cast<unsigned int>(data & 0x07);
+		switch(m_primitiveType)
+		{
+		case PRIM_POINT:
+			m_vtxCount = 1;
+			break;
+		case PRIM_LINE:
+		case PRIM_LINESTRIP:
+		case PRIM_SPRITE:
+			m_vtxCount = 2;
+			break;
+		case PRIM_TRIANGLE:
+		case PRIM_TRIANGLESTRIP:
+		case PRIM_TRIANGLEFAN:
+			m_vtxCount = 3;
+			break;
+		default:
+			m_vtxCount = 0;
+			break;
+		}
+		break;
+
+	case GS_REG_XYZ2:
+	case GS_REG_XYZ3:
+	case GS_REG_XYZF2:
+	case GS_REG_XYZF3:
+		VertexKick(registerId, data);
+		break;
+	}
+}
+
+void CGSH_Software::VertexKick(uint8 registerId, uint64 value)
+{
+	if(m_vtxCount == 0) return;
+
+	bool drawingKick = (registerId == GS_REG_XYZ2) || (registerId == GS_REG_XYZF2);
+	bool fog = (registerId == GS_REG_XYZF2) || (registerId == GS_REG_XYZF3);
+
+	if(!m_drawEnabled) drawingKick = false;
+
+	auto& vertex = m_vtxBuffer[m_vtxCount - 1];
+	vertex.position = fog ? (value & 0x00FFFFFFFFFFFFFFULL) : value;
+	vertex.rgbaq = m_nReg[GS_REG_RGBAQ];
+	vertex.uv = m_nReg[GS_REG_UV];
+	vertex.st = m_nReg[GS_REG_ST];
+
+	m_vtxCount--;
+
+	if(m_vtxCount != 0) return;
+
+	if((m_nReg[GS_REG_PRMODECONT] & 1) != 0)
+	{
+		m_primitiveMode <<= m_nReg[GS_REG_PRIM];
+	}
+	else
+	{
+		m_primitiveMode <<= m_nReg[GS_REG_PRMODE];
+	}
+
+	switch(m_primitiveType)
+	{
+	case PRIM_POINT:
+		if(drawingKick) Prim_Point();
+		m_vtxCount = 1;
+		break;
+	case PRIM_LINE:
+		if(drawingKick) Prim_Line();
+		m_vtxCount = 2;
+		break;
+	case PRIM_LINESTRIP:
+		if(drawingKick) Prim_Line();
+		m_vtxBuffer[1] = m_vtxBuffer[0];
+		m_vtxCount = 1;
+		break;
+	case PRIM_TRIANGLE:
+		if(drawingKick) Prim_Triangle();
+		m_vtxCount = 3;
+		break;
+	case PRIM_TRIANGLESTRIP:
+		if(drawingKick) Prim_Triangle();
+		m_vtxBuffer[2] = m_vtxBuffer[1];
+		m_vtxBuffer[1] = m_vtxBuffer[0];
+		m_vtxCount = 1;
+		break;
+	case PRIM_TRIANGLEFAN:
+		if(drawingKick) Prim_Triangle();
+		m_vtxBuffer[1] = m_vtxBuffer[0];
+		m_vtxCount = 1;
+		break;
+	case PRIM_SPRITE:
+		if(drawingKick) Prim_Sprite();
+		m_vtxCount = 2;
+		break;
+	}
+}
+
+/////////////////////////////////////////////////////////////
+// Primitive Setup
+/////////////////////////////////////////////////////////////
+
+void CGSH_Software::Prim_Point()
+{
+	auto offset = make_convertible<XYOFFSET>(m_nReg[GS_REG_XYOFFSET_1 + m_primitiveMode.nContext]);
+	auto xyz = make_convertible<XYZ>(m_vtxBuffer[0].position);
+	auto rgbaq = make_convertible<RGBAQ>(m_vtxBuffer[0].rgbaq);
+
+	PRIMITIVE primitive = {};
+	primitive.type = RASTER_POINT;
+	primitive.minX = primitive.maxX = (static_cast<int32>(xyz.nX) - static_cast<int32>(offset.nOffsetX) + 8) >> 4;
+	primitive.minY = primitive.maxY = (static_cast<int32>(xyz.nY) - static_cast<int32>(offset.nOffsetY) + 8) >> 4;
+	primitive.color[0].c = rgbaq.nR;
+	primitive.color[1].c = rgbaq.nG;
+	primitive.color[2].c = rgbaq.nB;
+	primitive.color[3].c = rgbaq.nA;
+	primitive.z.c = xyz.nZ;
+
+	if(m_primitiveMode.nTexture)
+	{
+		if(m_primitiveMode.nUseUV)
+		{
+			auto uv = make_convertible<UV>(m_vtxBuffer[0].uv);
+			primitive.tex[0].c = uv.GetU();
+			primitive.tex[1].c = uv.GetV();
+			primitive.tex[2].c = 1;
+		}
+		else
+		{
+			auto st = make_convertible<ST>(m_vtxBuffer[0].st);
+			primitive.tex[0].c = st.nS;
+			primitive.tex[1].c = st.nT;
+			primitive.tex[2].c = rgbaq.nQ;
+		}
+	}
+
+	AddPrimitive(primitive);
+}
+
+void CGSH_Software::Prim_Line()
+{
+	auto offset = make_convertible<XYOFFSET>(m_nReg[GS_REG_XYOFFSET_1 + m_primitiveMode.nContext]);
+
+	XYZ xyz[2];
+	RGBAQ rgbaq[2];
+	xyz[0] <<= m_vtxBuffer[1].position;
+	xyz[1] <<= m_vtxBuffer[0].position;
+	rgbaq[0] <<= m_vtxBuffer[1].rgbaq;
+	rgbaq[1] <<= m_vtxBuffer[0].rgbaq;
+
+	PRIMITIVE primitive = {};
+	primitive.type = RASTER_LINE;
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		primitive.x[i] = (static_cast<int32>(xyz[i].nX) - static_cast<int32>(offset.nOffsetX) + 8) >> 4;
+		primitive.y[i] = (static_cast<int32>(xyz[i].nY) - static_cast<int32>(offset.nOffsetY) + 8) >> 4;
+	}
+	primitive.minX = std::min(primitive.x[0], primitive.x[1]);
+	primitive.maxX = std::max(primitive.x[0], primitive.x[1]);
+	primitive.minY = std::min(primitive.y[0], primitive.y[1]);
+	primitive.maxY = std::max(primitive.y[0], primitive.y[1]);
+
+	//Attributes only need to be right along the line, interpolate them on the major axis
+	int32 deltaX = primitive.x[1] - primitive.x[0];
+	int32 deltaY = primitive.y[1] - primitive.y[0];
+	bool xMajor = abs(deltaX) >= abs(deltaY);
+	int32 start = xMajor ? primitive.x[0] : primitive.y[0];
+	int32 length = xMajor ? deltaX : deltaY;
+
+	auto makeGradient =
+		[&] (double value0, double value1)
+		{
+			GRADIENTD gradient = {};
+			double slope = (length != 0) ? (value1 - value0) / static_cast<double>(length) : 0;
+			gradient.c = value0 - (slope * start);
+			(xMajor ? gradient.dx : gradient.dy) = slope;
+			return gradient;
+		};
+
+	auto makeGradientF =
+		[&] (float value0, float value1)
+		{
+			auto gradient = makeGradient(value0, value1);
+			GRADIENTF result = { static_cast<float>(gradient.c), static_cast<float>(gradient.dx), static_cast<float>(gradient.dy) };
+			return result;
+		};
+
+	unsigned int flatIndex = m_primitiveMode.nShading ? 0 : 1;
+	primitive.color[0] = makeGradientF(rgbaq[flatIndex].nR, rgbaq[1].nR);
+	primitive.color[1] = makeGradientF(rgbaq[flatIndex].nG, rgbaq[1].nG);
+	primitive.color[2] = makeGradientF(rgbaq[flatIndex].nB, rgbaq[1].nB);
+	primitive.color[3] = makeGradientF(rgbaq[flatIndex].nA, rgbaq[1].nA);
+	primitive.z = makeGradient(xyz[0].nZ, xyz[1].nZ);
+
+	if(m_primitiveMode.nTexture)
+	{
+		if(m_primitiveMode.nUseUV)
+		{
+			UV uv[2];
+			uv[0] <<= m_vtxBuffer[1].uv;
+			uv[1] <<= m_vtxBuffer[0].uv;
+			primitive.tex[0] = makeGradientF(uv[0].GetU(), uv[1].GetU());
+			primitive.tex[1] = makeGradientF(uv[0].GetV(), uv[1].GetV());
+			primitive.tex[2] = makeGradientF(1, 1);
+		}
+		else
+		{
+			ST st[2];
+			st[0] <<= m_vtxBuffer[1].st;
+			st[1] <<= m_vtxBuffer[0].st;
+			primitive.tex[0] = makeGradientF(st[0].nS, st[1].nS);
+			primitive.tex[1] = makeGradientF(st[0].nT, st[1].nT);
+			primitive.tex[2] = makeGradientF(rgbaq[0].nQ, rgbaq[1].nQ);
+		}
+	}
+
+	AddPrimitive(primitive);
+}
+
+void CGSH_Software::Prim_Triangle()
+{
+	auto offset = make_convertible<XYOFFSET>(m_nReg[GS_REG_XYOFFSET_1 + m_primitiveMode.nContext]);
+
+	XYZ xyz[3];
+	RGBAQ rgbaq[3];
+	PRIMITIVE primitive = {};
+	primitive.type = RASTER_TRIANGLE;
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		xyz[i] <<= m_vtxBuffer[2 - i].position;
+		rgbaq[i] <<= m_vtxBuffer[2 - i].rgbaq;
+		primitive.x[i] = static_cast<int32>(xyz[i].nX) - static_cast<int32>(offset.nOffsetX);
+		primitive.y[i] = static_cast<int32>(xyz[i].nY) - static_cast<int32>(offset.nOffsetY);
+	}
+
+	int64 area =
+		static_cast<int64>(primitive.x[1] - primitive.x[0]) * (primitive.y[2] - primitive.y[0]) -
+		static_cast<int64>(primitive.x[2] - primitive.x[0]) * (primitive.y[1] - primitive.y[0]);
+	if(area == 0) return;
+
+	//Gradients are computed in pixel units
+	double x0 = primitive.x[0] / 16.0, x1 = primitive.x[1] / 16.0, x2 = primitive.x[2] / 16.0;
+	double y0 = primitive.y[0] / 16.0, y1 = primitive.y[1] / 16.0, y2 = primitive.y[2] / 16.0;
+	double pixelArea = static_cast<double>(area) / 256.0;
+
+	auto makeGradient =
+		[&] (double value0, double value1, double value2)
+		{
+			GRADIENTD gradient;
+			gradient.dx = ((value1 - value0) * (y2 - y0) - (value2 - value0) * (y1 - y0)) / pixelArea;
+			gradient.dy = ((value2 - value0) * (x1 - x0) - (value1 - value0) * (x2 - x0)) / pixelArea;
+			gradient.c = value0 - (gradient.dx * x0) - (gradient.dy * y0);
+			return gradient;
+		};
+
+	auto makeGradientF =
+		[&] (float value0, float value1, float value2)
+		{
+			auto gradient = makeGradient(value0, value1, value2);
+			GRADIENTF result = { static_cast<float>(gradient.c), static_cast<float>(gradient.dx), static_cast<float>(gradient.dy) };
+			return result;
+		};
+
+	if(m_primitiveMode.nShading)
+	{
+		primitive.color[0] = makeGradientF(rgbaq[0].nR, rgbaq[1].nR, rgbaq[2].nR);
+		primitive.color[1] = makeGradientF(rgbaq[0].nG, rgbaq[1].nG, rgbaq[2].nG);
+		primitive.color[2] = makeGradientF(rgbaq[0].nB, rgbaq[1].nB, rgbaq[2].nB);
+		primitive.color[3] = makeGradientF(rgbaq[0].nA, rgbaq[1].nA, rgbaq[2].nA);
+	}
+	else
+	{
+		//Flat shading uses the color of the last vertex
+		primitive.color[0].c = rgbaq[2].nR;
+		primitive.color[1].c = rgbaq[2].nG;
+		primitive.color[2].c = rgbaq[2].nB;
+		primitive.color[3].c = rgbaq[2].nA;
+	}
+	primitive.z = makeGradient(xyz[0].nZ, xyz[1].nZ, xyz[2].nZ);
+
+	if(m_primitiveMode.nTexture)
+	{
+		if(m_primitiveMode.nUseUV)
+		{
+			UV uv[3];
+			for(unsigned int i = 0; i < 3; i++) uv[i] <<= m_vtxBuffer[2 - i].uv;
+			primitive.tex[0] = makeGradientF(uv[0].GetU(), uv[1].GetU(), uv[2].GetU());
+			primitive.tex[1] = makeGradientF(uv[0].GetV(), uv[1].GetV(), uv[2].GetV());
+			primitive.tex[2].c = 1;
+		}
+		else
+		{
+			ST st[3];
+			for(unsigned int i = 0; i < 3; i++) st[i] <<= m_vtxBuffer[2 - i].st;
+			primitive.tex[0] = makeGradientF(st[0].nS, st[1].nS, st[2].nS);
+			primitive.tex[1] = makeGradientF(st[0].nT, st[1].nT, st[2].nT);
+			primitive.tex[2] = makeGradientF(rgbaq[0].nQ, rgbaq[1].nQ, rgbaq[2].nQ);
+		}
+	}
+
+	//Edge functions expect vertices in a specific winding order
+	if(area < 0)
+	{
+		std::swap(primitive.x[1], primitive.x[2]);
+		std::swap(primitive.y[1], primitive.y[2]);
+	}
+
+	primitive.minX = (std::min(std::min(primitive.x[0], primitive.x[1]), primitive.x[2]) + 15) >> 4;
+	primitive.minY = (std::min(std::min(primitive.y[0], primitive.y[1]), primitive.y[2]) + 15) >> 4;
+	primitive.maxX = std::max(std::max(primitive.x[0], primitive.x[1]), primitive.x[2]) >> 4;
+	primitive.maxY = std::max(std::max(primitive.y[0], primitive.y[1]), primitive.y[2]) >> 4;
+
+	AddPrimitive(primitive);
+}
+
+void CGSH_Software::Prim_Sprite()
+{
+	auto offset = make_convertible<XYOFFSET>(m_nReg[GS_REG_XYOFFSET_1 + m_primitiveMode.nContext]);
+
+	XYZ xyz[2];
+	xyz[0] <<= m_vtxBuffer[1].position;
+	xyz[1] <<= m_vtxBuffer[0].position;
+	auto rgbaq = make_convertible<RGBAQ>(m_vtxBuffer[0].rgbaq);
+
+	int32 x[2], y[2];
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		x[i] = static_cast<int32>(xyz[i].nX) - static_cast<int32>(offset.nOffsetX);
+		y[i] = static_cast<int32>(xyz[i].nY) - static_cast<int32>(offset.nOffsetY);
+	}
+
+	PRIMITIVE primitive = {};
+	primitive.type = RASTER_SPRITE;
+	primitive.minX = (std::min(x[0], x[1]) + 15) >> 4;
+	primitive.minY = (std::min(y[0], y[1]) + 15) >> 4;
+	primitive.maxX = ((std::max(x[0], x[1]) + 15) >> 4) - 1;
+	primitive.maxY = ((std::max(y[0], y[1]) + 15) >> 4) - 1;
+	primitive.color[0].c = rgbaq.nR;
+	primitive.color[1].c = rgbaq.nG;
+	primitive.color[2].c = rgbaq.nB;
+	primitive.color[3].c = rgbaq.nA;
+	primitive.z.c = xyz[1].nZ;
+
+	if(m_primitiveMode.nTexture)
+	{
+		float s[2], t[2];
+		if(m_primitiveMode.nUseUV)
+		{
+			UV uv[2];
+			uv[0] <<= m_vtxBuffer[1].uv;
+			uv[1] <<= m_vtxBuffer[0].uv;
+			for(unsigned int i = 0; i < 2; i++)
+			{
+				s[i] = uv[i].GetU();
+				t[i] = uv[i].GetV();
+			}
+		}
+		else
+		{
+			ST st[2];
+			st[0] <<= m_vtxBuffer[1].st;
+			st[1] <<= m_vtxBuffer[0].st;
+			float q[2] = { make_convertible<RGBAQ>(m_vtxBuffer[1].rgbaq).nQ, rgbaq.nQ };
+			auto tex0 = make_convertible<TEX0>(m_nReg[GS_REG_TEX0_1 + m_primitiveMode.nContext]);
+			for(unsigned int i = 0; i < 2; i++)
+			{
+				if(q[i] == 0) q[i] = 1;
+				s[i] = (st[i].nS / q[i]) * static_cast<float>(tex0.GetWidth());
+				t[i] = (st[i].nT / q[i]) * static_cast<float>(tex0.GetHeight());
+			}
+		}
+
+		float x0 = x[0] / 16.0f, x1 = x[1] / 16.0f;
+		float y0 = y[0] / 16.0f, y1 = y[1] / 16.0f;
+		primitive.tex[0].dx = (x1 != x0) ? (s[1] - s[0]) / (x1 - x0) : 0;
+		primitive.tex[0].c = s[0] - (primitive.tex[0].dx * x0);
+		primitive.tex[1].dy = (y1 != y0) ? (t[1] - t[0]) / (y1 - y0) : 0;
+		primitive.tex[1].c = t[0] - (primitive.tex[1].dy * y0);
+		primitive.tex[2].c = 1;
+	}
+
+	AddPrimitive(primitive);
+}
+
+void CGSH_Software::BuildRenderState(RENDERSTATE& state)
+{
+	unsigned int context = m_primitiveMode.nContext;
+
+	state.prim = m_primitiveMode;
+	state.frame <<= m_nReg[GS_REG_FRAME_1 + context];
+	state.zbuf <<= m_nReg[GS_REG_ZBUF_1 + context];
+	state.test <<= m_nReg[GS_REG_TEST_1 + context];
+	state.alpha <<= m_nReg[GS_REG_ALPHA_1 + context];
+	state.tex0 <<= m_nReg[GS_REG_TEX0_1 + context];
+	state.clamp <<= m_nReg[GS_REG_CLAMP_1 + context];
+	state.texa <<= m_nReg[GS_REG_TEXA];
+	state.scissor <<= m_nReg[GS_REG_SCISSOR_1 + context];
+	state.fba = m_nReg[GS_REG_FBA_1 + context] & 1;
+	state.pabe = m_nReg[GS_REG_PABE] & 1;
+
+	if(!state.test.nAlphaEnabled)
+	{
+		state.test.nAlphaMethod = ALPHA_TEST_ALWAYS;
+	}
+
+	state.zPsm = state.zbuf.nPsm | 0x30;
+	switch(state.zPsm)
+	{
+	case PSMZ24:
+		state.zMax = 0xFFFFFF;
+		break;
+	case PSMZ16:
+	case PSMZ16S:
+		state.zMax = 0xFFFF;
+		break;
+	default:
+		state.zMax = 0xFFFFFFFF;
+		break;
+	}
+
+	//Without depth testing, the depth buffer is left alone
+	state.depthMethod = state.test.nDepthEnabled ? state.test.nDepthMethod : static_cast<uint32>(DEPTH_TEST_ALWAYS);
+	state.zWrite = state.test.nDepthEnabled && !state.zbuf.nMask;
+
+	state.colorMask = state.frame.nMask;
+	if(state.frame.nPsm == PSMCT24)
+	{
+		state.colorMask |= 0xFF000000;
+	}
+	state.fbaMask = state.fba ? 0x80000000 : 0;
+	state.blendEnabled = (state.prim.nAlpha != 0);
+	state.pabeEnabled = (state.pabe != 0);
+	state.dateEnabled = state.test.nDestAlphaEnabled && (state.frame.nPsm != PSMCT24);
+
+	if(state.prim.nTexture && CGsPixelFormats::IsPsmIDTEX(state.tex0.nPsm))
+	{
+		//Only fields that select entries in the CLUT buffer matter
+		uint64 clutTex0 = (CGsPixelFormats::IsPsmIDTEX4(state.tex0.nPsm) ? 1 : 0) | (state.tex0.nCPSM << 1) | (state.tex0.nCSA << 8);
+		uint64 clutTexa = static_cast<uint64>(state.texa);
+		if(m_linearClutDirty || (m_linearClutTex0 != clutTex0) || (m_linearClutTexa != clutTexa))
+		{
+			MakeLinearCLUT(state.tex0, m_linearClut);
+			if((state.tex0.nCPSM == PSMCT16) || (state.tex0.nCPSM == PSMCT16S))
+			{
+				for(auto& color : m_linearClut)
+				{
+					color = ApplyTexa(color, (color & 0x80000000) != 0, state.texa);
+				}
+			}
+			m_linearClutTex0 = clutTex0;
+			m_linearClutTexa = clutTexa;
+			m_linearClutDirty = false;
+		}
+		state.clut = m_linearClut;
+	}
+	else
+	{
+		state.clut.fill(0);
+	}
+}
+
+void CGSH_Software::AddPrimitive(PRIMITIVE& primitive)
+{
+	RENDERSTATE state;
+	BuildRenderState(state);
+
+	switch(state.frame.nPsm)
+	{
+	case PSMCT32:
+	case PSMCT24:
+	case PSMCT16:
+	case PSMCT16S:
+		break;
+	default:
+		//Not a supported render target format
+		return;
+	}
+
+	//Clip against scissor and render target
+	primitive.minX = std::max<int32>(primitive.minX, state.scissor.scax0);
+	primitive.minY = std::max<int32>(primitive.minY, state.scissor.scay0);
+	primitive.maxX = std::min<int32>(primitive.maxX, std::min<int32>(state.scissor.scax1, state.frame.GetWidth() - 1));
+	primitive.maxY = std::min<int32>(primitive.maxY, state.scissor.scay1);
+	primitive.maxX = std::min<int32>(primitive.maxX, MAX_SURFACE_SIZE - 1);
+	primitive.maxY = std::min<int32>(primitive.maxY, MAX_SURFACE_SIZE - 1);
+	if((primitive.minX > primitive.maxX) || (primitive.minY > primitive.maxY)) return;
+
+	//Tiles can only be drawn in parallel if they don't alias, keep a single render target in each batch
+	uint64 frameTarget = static_cast<uint64>(state.frame) & 0x3F3F01FFULL;
+	uint64 zbufTarget = static_cast<uint64>(state.zbuf) & 0x0F0001FFULL;
+	if(!m_primitives.empty() && ((frameTarget != m_batchFrame) || (zbufTarget != m_batchZbuf)))
+	{
+		FlushPrimitives();
+	}
+
+	//Range of GS RAM that can be fetched by this primitive's texture
+	uint32 texStart = 0;
+	uint32 texEnd = 0;
+	if(state.prim.nTexture)
+	{
+		//Region clamp modes can fetch outside of the texture's dimensions
+		uint32 texMaxU = (state.clamp.nWMS >= CLAMP_MODE_REGION_CLAMP) ? 1023 : (state.tex0.GetWidth() - 1);
+		uint32 texMaxV = (state.clamp.nWMT >= CLAMP_MODE_REGION_CLAMP) ? 1023 : (state.tex0.GetHeight() - 1);
+		auto texPageSize = CGsPixelFormats::GetPsmPageSize(state.tex0.nPsm);
+		uint32 texPagesPerRow = std::max<uint32>(state.tex0.GetBufWidth() / texPageSize.first, 1);
+		texStart = state.tex0.GetBufPtr();
+		texEnd = texStart + ((texMaxU / texPageSize.first) + (texMaxV / texPageSize.second) * texPagesPerRow + 1) * CGsPixelFormats::PAGESIZE;
+	}
+
+	bool usesDepth = (state.depthMethod >= DEPTH_TEST_GEQUAL) || state.zWrite;
+
+	//Tiles can't be rasterized in parallel if primitives sample from their own render target
+	//or if the depth buffer aliases the color buffer
+	auto needsSerial =
+		[&] (uint32 rangeStart, uint32 rangeEnd, bool batchUsesDepth, int32 maxY)
+		{
+			auto getTargetEnd =
+				[&] (uint32 targetStart, const std::pair<uint32, uint32>& pageSize)
+				{
+					uint32 pagesPerRow = std::max<uint32>(state.frame.GetWidth() / pageSize.first, 1);
+					return targetStart + pagesPerRow * ((maxY / pageSize.second) + 1) * CGsPixelFormats::PAGESIZE;
+				};
+			bool depth16 = (state.zPsm == PSMZ16) || (state.zPsm == PSMZ16S);
+			uint32 frameStart = state.frame.GetBasePtr();
+			uint32 frameEnd = getTargetEnd(frameStart, CGsPixelFormats::GetPsmPageSize(state.frame.nPsm));
+			uint32 zbufStart = state.zbuf.GetBasePtr();
+			uint32 zbufEnd = getTargetEnd(zbufStart, CGsPixelFormats::GetPsmPageSize(depth16 ? state.zPsm : static_cast<uint32>(PSMZ32)));
+			if(batchUsesDepth && (frameStart < zbufEnd) && (zbufStart < frameEnd)) return true;
+			if(rangeStart == rangeEnd) return false;
+			//Texture fetches and render target writes wrap around the end of GS RAM
+			if((rangeEnd > RAMSIZE) || (frameEnd > RAMSIZE) || (zbufEnd > RAMSIZE)) return true;
+			return ((rangeStart < frameEnd) && (frameStart < rangeEnd)) ||
+				((rangeStart < zbufEnd) && (zbufStart < rangeEnd));
+		};
+
+	if(!m_primitives.empty() && !m_batchSerial)
+	{
+		uint32 batchTexStart = texStart;
+		uint32 batchTexEnd = texEnd;
+		if(m_batchTexStart != m_batchTexEnd)
+		{
+			batchTexStart = (texStart != texEnd) ? std::min(texStart, m_batchTexStart) : m_batchTexStart;
+			batchTexEnd = std::max(texEnd, m_batchTexEnd);
+		}
+		if(needsSerial(batchTexStart, batchTexEnd, m_batchUsesDepth || usesDepth, std::max(m_batchMaxY, primitive.maxY)))
+		{
+			//Keep the parallel part of the batch and start a new one for this primitive
+			FlushPrimitives();
+		}
+	}
+
+	if(m_primitives.size() == MAX_PRIMITIVES)
+	{
+		FlushPrimitives();
+	}
+
+	if(m_primitives.empty())
+	{
+		m_batchFrame = frameTarget;
+		m_batchZbuf = zbufTarget;
+		m_batchMaxY = primitive.maxY;
+		m_batchTexStart = texStart;
+		m_batchTexEnd = texEnd;
+		m_batchUsesDepth = usesDepth;
+	}
+	else if(texStart != texEnd)
+	{
+		m_batchTexStart = (m_batchTexStart != m_batchTexEnd) ? std::min(m_batchTexStart, texStart) : texStart;
+		m_batchTexEnd = std::max(m_batchTexEnd, texEnd);
+	}
+	m_batchMaxY = std::max(m_batchMaxY, primitive.maxY);
+	m_batchUsesDepth = m_batchUsesDepth || usesDepth;
+	m_batchSerial = m_batchSerial || needsSerial(m_batchTexStart, m_batchTexEnd, m_batchUsesDepth, m_batchMaxY);
+
+	//Primitives usually come in long runs with the same state
+	bool sameState = false;
+	if(!m_renderStates.empty())
+	{
+		const auto& prevState = m_renderStates.back();
+		sameState =
+			(static_cast<uint64>(prevState.prim) == static_cast<uint64>(state.prim)) &&
+			(static_cast<uint64>(prevState.frame) == static_cast<uint64>(state.frame)) &&
+			(static_cast<uint64>(prevState.zbuf) == static_cast<uint64>(state.zbuf)) &&
+			(static_cast<uint64>(prevState.test) == static_cast<uint64>(state.test)) &&
+			(static_cast<uint64>(prevState.alpha) == static_cast<uint64>(state.alpha)) &&
+			(static_cast<uint64>(prevState.tex0) == static_cast<uint64>(state.tex0)) &&
+			(static_cast<uint64>(prevState.clamp) == static_cast<uint64>(state.clamp)) &&
+			(static_cast<uint64>(prevState.texa) == static_cast<uint64>(state.texa)) &&
+			(prevState.fba == state.fba) &&
+			(prevState.pabe == state.pabe) &&
+			(prevState.clut == state.clut);
+	}
+	if(!sameState)
+	{
+		m_renderStates.push_back(state);
+	}
+
+	primitive.stateIndex = static_cast<uint32>(m_renderStates.size() - 1);
+	m_primitives.push_back(primitive);
+}
+
+/////////////////////////////////////////////////////////////
+// Batch Processing
+/////////////////////////////////////////////////////////////
+
+void CGSH_Software::StartWorkers()
+{
+	assert(m_workers.empty());
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	//The GS thread also rasterizes tiles
+	unsigned int workerCount = std::min<unsigned int>((threadCount > 1) ? (threadCount - 1) : 0, MAX_WORKER_COUNT);
+	m_workersDone = false;
+	for(unsigned int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread([this] () { WorkerThreadProc(); }));
+	}
+}
+
+void CGSH_Software::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> workerLock(m_workerMutex);
+		m_workersDone = true;
+	}
+	m_workerCondition.notify_all();
+	for(auto& worker : m_workers)
+	{
+		worker.join();
+	}
+	m_workers.clear();
+}
+
+void CGSH_Software::WorkerThreadProc()
+{
+	uint32 generation = 0;
+	while(1)
+	{
+		{
+			std::unique_lock<std::mutex> workerLock(m_workerMutex);
+			m_workerCondition.wait(workerLock,
+				[&] ()
+				{
+					return m_workersDone || (m_workOpen && (m_workGeneration != generation));
+				}
+			);
+			if(m_workersDone) break;
+			generation = m_workGeneration;
+			m_busyWorkerCount++;
+		}
+
+		ProcessTiles();
+
+		{
+			std::lock_guard<std::mutex> workerLock(m_workerMutex);
+			m_busyWorkerCount--;
+		}
+		m_workDoneCondition.notify_one();
+	}
+}
+
+void CGSH_Software::ProcessTiles()
+{
+	uint32 tileCount = static_cast<uint32>(m_activeTiles.size());
+	while(1)
+	{
+		uint32 index = m_nextTile++;
+		if(index >= tileCount) break;
+		RasterizeTile(m_activeTiles[index]);
+		if((++m_completedTiles) == tileCount)
+		{
+			std::lock_guard<std::mutex> workerLock(m_workerMutex);
+			m_workDoneCondition.notify_one();
+		}
+	}
+}
+
+void CGSH_Software::FlushPrimitives()
+{
+	if(m_primitives.empty()) return;
+
+	//Bin primitives in the tiles they overlap, order inside a tile is preserved
+	for(uint32 primitiveIndex = 0; primitiveIndex < m_primitives.size(); primitiveIndex++)
+	{
+		const auto& primitive = m_primitives[primitiveIndex];
+		for(int32 tileY = (primitive.minY >> TILE_SHIFT); tileY <= (primitive.maxY >> TILE_SHIFT); tileY++)
+		{
+			for(int32 tileX = (primitive.minX >> TILE_SHIFT); tileX <= (primitive.maxX >> TILE_SHIFT); tileX++)
+			{
+				uint32 tileIndex = tileX + (tileY * TILE_COUNT_X);
+				auto& tileBin = m_tileBins[tileIndex];
+				if(tileBin.empty())
+				{
+					m_activeTiles.push_back(tileIndex);
+				}
+				tileBin.push_back(primitiveIndex);
+			}
+		}
+	}
+
+	m_nextTile = 0;
+	m_completedTiles = 0;
+	if(!m_workers.empty() && !m_batchSerial && (m_activeTiles.size() > 1))
+	{
+		{
+			std::lock_guard<std::mutex> workerLock(m_workerMutex);
+			m_workGeneration++;
+			m_workOpen = true;
+		}
+		m_workerCondition.notify_all();
+		ProcessTiles();
+		{
+			std::unique_lock<std::mutex> workerLock(m_workerMutex);
+			m_workDoneCondition.wait(workerLock,
+				[this] ()
+				{
+					return (m_completedTiles == m_activeTiles.size()) && (m_busyWorkerCount == 0);
+				}
+			);
+			m_workOpen = false;
+		}
+	}
+	else
+	{
+		ProcessTiles();
+	}
+
+	for(auto tileIndex : m_activeTiles)
+	{
+		m_tileBins[tileIndex].clear();
+	}
+	m_activeTiles.clear();
+	m_primitives.clear();
+	m_renderStates.clear();
+	m_batchSerial = false;
+	m_drawCallCount++;
+}
+
+void CGSH_Software::DiscardPrimitives()
+{
+	m_primitives.clear();
+	m_renderStates.clear();
+	m_batchSerial = false;
+}
+
+/////////////////////////////////////////////////////////////
+// Rasterization
+/////////////////////////////////////////////////////////////
+
+void CGSH_Software::RasterizeTile(uint32 tileIndex)
+{
+	int32 tileMinX = (tileIndex % TILE_COUNT_X) << TILE_SHIFT;
+	int32 tileMinY = (tileIndex / TILE_COUNT_X) << TILE_SHIFT;
+	int32 tileMaxX = tileMinX + TILE_SIZE - 1;
+	int32 tileMaxY = tileMinY + TILE_SIZE - 1;
+
+	for(auto primitiveIndex : m_tileBins[tileIndex])
+	{
+		const auto& primitive = m_primitives[primitiveIndex];
+		int32 minX = std::max(primitive.minX, tileMinX);
+		int32 minY = std::max(primitive.minY, tileMinY);
+		int32 maxX = std::min(primitive.maxX, tileMaxX);
+		int32 maxY = std::min(primitive.maxY, tileMaxY);
+		if((minX > maxX) || (minY > maxY)) continue;
+		RasterizePrimitive(primitive, minX, minY, maxX, maxY);
+	}
+}
+
+void CGSH_Software::RasterizePrimitive(const PRIMITIVE& primitive, int32 minX, int32 minY, int32 maxX, int32 maxY)
+{
+	const auto& state = m_renderStates[primitive.stateIndex];
+	switch(primitive.type)
+	{
+	case RASTER_POINT:
+		FillSpan(primitive, state, minY, minX, minX);
+		break;
+	case RASTER_SPRITE:
+		for(int32 y = minY; y <= maxY; y++)
+		{
+			FillSpan(primitive, state, y, minX, maxX);
+		}
+		break;
+	case RASTER_LINE:
+		{
+			int32 deltaX = primitive.x[1] - primitive.x[0];
+			int32 deltaY = primitive.y[1] - primitive.y[0];
+			int32 stepCount = std::max(abs(deltaX), abs(deltaY));
+			//Last pixel is left out to avoid drawing it twice in strips
+			for(int32 step = 0; step < std::max(stepCount, 1); step++)
+			{
+				float ratio = (stepCount != 0) ? static_cast<float>(step) / static_cast<float>(stepCount) : 0;
+				int32 x = primitive.x[0] + static_cast<int32>(floorf((deltaX * ratio) + 0.5f));
+				int32 y = primitive.y[0] + static_cast<int32>(floorf((deltaY * ratio) + 0.5f));
+				if((x < minX) || (x > maxX) || (y < minY) || (y > maxY)) continue;
+				FillSpan(primitive, state, y, x, x);
+			}
+		}
+		break;
+	case RASTER_TRIANGLE:
+		for(int32 y = minY; y <= maxY; y++)
+		{
+			int32 spanMinX = minX;
+			int32 spanMaxX = maxX;
+			int64 sampleY = y * 16;
+			for(unsigned int i = 0; i < 3; i++)
+			{
+				unsigned int j = (i + 1) % 3;
+				int64 edgeX = primitive.x[j] - primitive.x[i];
+				int64 edgeY = primitive.y[j] - primitive.y[i];
+				//Pixels exactly on an edge are only drawn for one of the two triangles sharing it
+				int64 bias = ((edgeY < 0) || ((edgeY == 0) && (edgeX > 0))) ? 0 : 1;
+				//Inside if (edgeX * (sampleY - y[i]) - edgeY * (sampleX - x[i])) >= bias
+				int64 c = (edgeX * (sampleY - primitive.y[i])) + (edgeY * primitive.x[i]) - bias;
+				if(edgeY == 0)
+				{
+					if(c < 0)
+					{
+						spanMaxX = spanMinX - 1;
+						break;
+					}
+				}
+				else if(edgeY > 0)
+				{
+					spanMaxX = static_cast<int32>(std::min<int64>(spanMaxX, FloorDiv(c, edgeY * 16)));
+				}
+				else
+				{
+					spanMinX = static_cast<int32>(std::max<int64>(spanMinX, -FloorDiv(c, -edgeY * 16)));
+				}
+			}
+			if(spanMinX <= spanMaxX)
+			{
+				FillSpan(primitive, state, y, spanMinX, spanMaxX);
+			}
+		}
+		break;
+	}
+}
+
+void CGSH_Software::FillSpan(const PRIMITIVE& primitive, const RENDERSTATE& state, int32 y, int32 minX, int32 maxX)
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 CT32;
+	typedef CGsPixelFormats::STORAGEPSMCT16 CT16;
+	typedef CGsPixelFormats::STORAGEPSMCT16S CT16S;
+
+	bool depth16 = (state.zPsm == PSMZ16) || (state.zPsm == PSMZ16S);
+	bool depth16S = (state.zPsm == PSMZ16S);
+	switch(state.frame.nPsm)
+	{
+	case PSMCT16:
+		if(depth16)
+		{
+			depth16S ? FillSpanImpl<CT16, CT16S>(primitive, state, y, minX, maxX) : FillSpanImpl<CT16, CT16>(primitive, state, y, minX, maxX);
+		}
+		else
+		{
+			FillSpanImpl<CT16, CT32>(primitive, state, y, minX, maxX);
+		}
+		break;
+	case PSMCT16S:
+		if(depth16)
+		{
+			depth16S ? FillSpanImpl<CT16S, CT16S>(primitive, state, y, minX, maxX) : FillSpanImpl<CT16S, CT16>(primitive, state, y, minX, maxX);
+		}
+		else
+		{
+			FillSpanImpl<CT16S, CT32>(primitive, state, y, minX, maxX);
+		}
+		break;
+	default:
+		if(depth16)
+		{
+			depth16S ? FillSpanImpl<CT32, CT16S>(primitive, state, y, minX, maxX) : FillSpanImpl<CT32, CT16>(primitive, state, y, minX, maxX);
+		}
+		else
+		{
+			FillSpanImpl<CT32, CT32>(primitive, state, y, minX, maxX);
+		}
+		break;
+	}
+}
+
+template <typename ColorStorage, typename DepthStorage>
+void CGSH_Software::FillSpanImpl(const PRIMITIVE& primitive, const RENDERSTATE& state, int32 y, int32 minX, int32 maxX)
+{
+	typedef typename ColorStorage::Unit ColorUnit;
+	typedef typename DepthStorage::Unit DepthUnit;
+
+	CGsPixelFormats::CPixelIndexor<ColorStorage> colorIndexor(m_pRAM, state.frame.GetBasePtr(), state.frame.nWidth);
+	CGsPixelFormats::CPixelIndexor<DepthStorage> depthIndexor(m_pRAM, state.zbuf.GetBasePtr(), state.frame.nWidth);
+
+	bool readDepth = (state.depthMethod >= DEPTH_TEST_GEQUAL) || state.zWrite;
+	bool isZ24 = (state.zPsm == PSMZ24);
+	bool isColor24 = (state.frame.nPsm == PSMCT24);
+
+	ColorUnit* colorPtrs[4];
+	DepthUnit* depthPtrs[4];
+	PIXELQUAD quad;
+	for(int32 x = minX; x <= maxX; x += 4)
+	{
+		uint32 coverage = 0;
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			int32 pixelX = x + i;
+			if(pixelX > maxX)
+			{
+				quad.color[i] = quad.z[i] = quad.dstColor[i] = quad.dstZ[i] = 0;
+				continue;
+			}
+			coverage |= (1 << i);
+
+			quad.color[i] = ShadeColor(primitive, state, pixelX, y);
+			double z = primitive.z.Evaluate(pixelX, y);
+			quad.z[i] = static_cast<uint32>(std::min<double>(std::max<double>(z, 0), state.zMax));
+
+			colorPtrs[i] = colorIndexor.GetPixelAddress(pixelX, y);
+			if(sizeof(ColorUnit) == 2)
+			{
+				quad.dstColor[i] = Color16ToColor32(*colorPtrs[i]);
+			}
+			else
+			{
+				quad.dstColor[i] = isColor24 ? ((*colorPtrs[i] & 0x00FFFFFF) | 0x80000000) : *colorPtrs[i];
+			}
+
+			if(readDepth)
+			{
+				auto depthAddress = reinterpret_cast<uint8*>(depthIndexor.GetPixelAddress(pixelX, y));
+				depthPtrs[i] = reinterpret_cast<DepthUnit*>(m_pRAM + ((depthAddress - m_pRAM) ^ DEPTH_BLOCK_SWIZZLE));
+				quad.dstZ[i] = isZ24 ? (*depthPtrs[i] & 0x00FFFFFF) : *depthPtrs[i];
+			}
+			else
+			{
+				quad.dstZ[i] = 0;
+			}
+		}
+
+		uint32 writeMask = ShadeQuad(state, quad, coverage);
+
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			if(writeMask & (1 << i))
+			{
+				if(sizeof(ColorUnit) == 2)
+				{
+					*colorPtrs[i] = static_cast<ColorUnit>(Color32ToColor16(quad.color[i]));
+				}
+				else
+				{
+					*colorPtrs[i] = static_cast<ColorUnit>(quad.color[i]);
+				}
+			}
+			if(writeMask & (0x10 << i))
+			{
+				if(isZ24)
+				{
+					*depthPtrs[i] = static_cast<DepthUnit>((*depthPtrs[i] & 0xFF000000) | quad.z[i]);
+				}
+				else
+				{
+					*depthPtrs[i] = static_cast<DepthUnit>(quad.z[i]);
+				}
+			}
+		}
+	}
+}
+
+uint32 CGSH_Software::ShadeColor(const PRIMITIVE& primitive, const RENDERSTATE& state, int32 x, int32 y)
+{
+	uint32 r = ClampColor(primitive.color[0].Evaluate(x, y));
+	uint32 g = ClampColor(primitive.color[1].Evaluate(x, y));
+	uint32 b = ClampColor(primitive.color[2].Evaluate(x, y));
+	uint32 a = ClampColor(primitive.color[3].Evaluate(x, y));
+	if(!state.prim.nTexture)
+	{
+		return r | (g << 8) | (b << 16) | (a << 24);
+	}
+
+	float u = primitive.tex[0].Evaluate(x, y);
+	float v = primitive.tex[1].Evaluate(x, y);
+	if(!state.prim.nUseUV && (primitive.type != RASTER_SPRITE))
+	{
+		float q = primitive.tex[2].Evaluate(x, y);
+		if(q == 0) q = 1;
+		u = (u / q) * static_cast<float>(state.tex0.GetWidth());
+		v = (v / q) * static_cast<float>(state.tex0.GetHeight());
+	}
+
+	uint32 texel = FetchTexel(state, static_cast<int32>(floorf(u)), static_cast<int32>(floorf(v)));
+	uint32 tr = (texel >>  0) & 0xFF;
+	uint32 tg = (texel >>  8) & 0xFF;
+	uint32 tb = (texel >> 16) & 0xFF;
+	uint32 ta = (texel >> 24) & 0xFF;
+	bool useTexAlpha = (state.tex0.nColorComp != 0);
+
+	switch(state.tex0.nFunction)
+	{
+	case TEX0_FUNCTION_MODULATE:
+		r = std::min<uint32>((tr * r) >> 7, 0xFF);
+		g = std::min<uint32>((tg * g) >> 7, 0xFF);
+		b = std::min<uint32>((tb * b) >> 7, 0xFF);
+		if(useTexAlpha) a = std::min<uint32>((ta * a) >> 7, 0xFF);
+		break;
+	case TEX0_FUNCTION_DECAL:
+		r = tr; g = tg; b = tb;
+		if(useTexAlpha) a = ta;
+		break;
+	case TEX0_FUNCTION_HIGHLIGHT:
+	case TEX0_FUNCTION_HIGHLIGHT2:
+		r = std::min<uint32>(((tr * r) >> 7) + a, 0xFF);
+		g = std::min<uint32>(((tg * g) >> 7) + a, 0xFF);
+		b = std::min<uint32>(((tb * b) >> 7) + a, 0xFF);
+		if(useTexAlpha)
+		{
+			a = (state.tex0.nFunction == TEX0_FUNCTION_HIGHLIGHT) ? std::min<uint32>(ta + a, 0xFF) : ta;
+		}
+		break;
+	}
+
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+uint32 CGSH_Software::FetchTexel(const RENDERSTATE& state, int32 u, int32 v)
+{
+	const auto& tex0 = state.tex0;
+	auto clamp = state.clamp;
+	u = WrapTexCoord(u, tex0.GetWidth(), clamp.nWMS, clamp.GetMinU(), clamp.GetMaxU());
+	v = WrapTexCoord(v, tex0.GetHeight(), clamp.nWMT, clamp.GetMinV(), clamp.GetMaxV());
+
+	switch(tex0.nPsm)
+	{
+	case PSMCT32:
+		return CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, tex0.GetBufPtr(), tex0.nBufWidth).GetPixel(u, v);
+	case PSMCT24:
+		{
+			uint32 color = CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, tex0.GetBufPtr(), tex0.nBufWidth).GetPixel(u, v);
+			return ApplyTexa(color, false, state.texa);
+		}
+	case PSMCT16:
+		{
+			uint16 color = CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, tex0.GetBufPtr(), tex0.nBufWidth).GetPixel(u, v);
+			return ApplyTexa(Color16ToColor32(color), (color & 0x8000) != 0, state.texa);
+		}
+	case PSMCT16S:
+		{
+			uint16 color = CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, tex0.GetBufPtr(), tex0.nBufWidth).GetPixel(u, v);
+			return ApplyTexa(Color16ToColor32(color), (color & 0x8000) != 0, state.texa);
+		}
+	case PSMT8:
+		return state.clut[CGsPixelFormats::CPixelIndexorPSMT8(m_pRAM, tex0.GetBufPtr(), tex0.nBufWidth).GetPixel(u, v)];
+	case PSMT4:
+		return state.clut[CGsPixelFormats::CPixelIndexorPSMT4(m_pRAM, tex0.GetBufPtr(), tex0.nBufWidth).GetPixel(u, v)];
+	case PSMT8H:
+		return state.clut[CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, tex0.GetBufPtr(), tex0.nBufWidth).GetPixel(u, v) >> 24];
+	case PSMT4HL:
+		return state.clut[(CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, tex0.GetBufPtr(), tex0.nBufWidth).GetPixel(u, v) >> 24) & 0x0F];
+	case PSMT4HH:
+		return state.clut[CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, tex0.GetBufPtr(), tex0.nBufWidth).GetPixel(u, v) >> 28];
+	default:
+		return 0;
+	}
+}
+
+#ifdef GSH_SOFTWARE_SSE2
+
+static __m128i CompareGreaterUnsigned(__m128i a, __m128i b)
+{
+	auto bias = _mm_set1_epi32(0x80000000);
+	return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+//Color components are widened to 16 bits, two pixels at a time
+static __m128i BlendHalf(__m128i src, __m128i dst, const CGSHandler::ALPHA& alpha)
+{
+	auto zero = _mm_setzero_si128();
+	auto selectColor =
+		[&] (unsigned int select)
+		{
+			return (select == 0) ? src : ((select == 1) ? dst : zero);
+		};
+
+	__m128i factor;
+	switch(alpha.nC)
+	{
+	case 0:
+		factor = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, 0xFF), 0xFF);
+		break;
+	case 1:
+		factor = _mm_shufflehi_epi16(_mm_shufflelo_epi16(dst, 0xFF), 0xFF);
+		break;
+	default:
+		factor = _mm_set1_epi16(alpha.nFix);
+		break;
+	}
+
+	auto diff = _mm_sub_epi16(selectColor(alpha.nA), selectColor(alpha.nB));
+	auto productLo = _mm_madd_epi16(_mm_unpacklo_epi16(diff, zero), _mm_unpacklo_epi16(factor, zero));
+	auto productHi = _mm_madd_epi16(_mm_unpackhi_epi16(diff, zero), _mm_unpackhi_epi16(factor, zero));
+	auto result = _mm_packs_epi32(_mm_srai_epi32(productLo, 7), _mm_srai_epi32(productHi, 7));
+	return _mm_adds_epi16(result, selectColor(alpha.nD));
+}
+
+//Runs the depth test, alpha test, destination alpha test and blending on 4 pixels,
+//returns which pixels need to be written to the frame buffer (bits 0-3) and depth buffer (bits 4-7)
+uint32 CGSH_Software::ShadeQuad(const RENDERSTATE& state, PIXELQUAD& quad, uint32 coverage)
+{
+	auto ones = _mm_set1_epi32(-1);
+	auto zero = _mm_setzero_si128();
+	auto srcColor = _mm_loadu_si128(reinterpret_cast<const __m128i*>(quad.color));
+	auto dstColor = _mm_loadu_si128(reinterpret_cast<const __m128i*>(quad.dstColor));
+	auto srcZ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(quad.z));
+	auto dstZ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(quad.dstZ));
+	auto laneMask = _mm_setr_epi32(
+		-static_cast<int32>(coverage & 1), -static_cast<int32>((coverage >> 1) & 1),
+		-static_cast<int32>((coverage >> 2) & 1), -static_cast<int32>((coverage >> 3) & 1));
+
+	__m128i depthPass;
+	switch(state.depthMethod)
+	{
+	case DEPTH_TEST_NEVER:
+		depthPass = zero;
+		break;
+	case DEPTH_TEST_ALWAYS:
+		depthPass = ones;
+		break;
+	case DEPTH_TEST_GEQUAL:
+		depthPass = _mm_andnot_si128(CompareGreaterUnsigned(dstZ, srcZ), ones);
+		break;
+	default:
+		depthPass = CompareGreaterUnsigned(srcZ, dstZ);
+		break;
+	}
+
+	auto srcAlpha = _mm_srli_epi32(srcColor, 24);
+	auto alphaRef = _mm_set1_epi32(state.test.nAlphaRef);
+	__m128i alphaPass;
+	switch(state.test.nAlphaMethod)
+	{
+	case ALPHA_TEST_NEVER:
+		alphaPass = zero;
+		break;
+	case ALPHA_TEST_LESS:
+		alphaPass = _mm_cmplt_epi32(srcAlpha, alphaRef);
+		break;
+	case ALPHA_TEST_LEQUAL:
+		alphaPass = _mm_andnot_si128(_mm_cmpgt_epi32(srcAlpha, alphaRef), ones);
+		break;
+	case ALPHA_TEST_EQUAL:
+		alphaPass = _mm_cmpeq_epi32(srcAlpha, alphaRef);
+		break;
+	case ALPHA_TEST_GEQUAL:
+		alphaPass = _mm_andnot_si128(_mm_cmplt_epi32(srcAlpha, alphaRef), ones);
+		break;
+	case ALPHA_TEST_GREATER:
+		alphaPass = _mm_cmpgt_epi32(srcAlpha, alphaRef);
+		break;
+	case ALPHA_TEST_NOTEQUAL:
+		alphaPass = _mm_andnot_si128(_mm_cmpeq_epi32(srcAlpha, alphaRef), ones);
+		break;
+	default:
+		alphaPass = ones;
+		break;
+	}
+
+	auto pass = _mm_and_si128(laneMask, depthPass);
+	if(state.dateEnabled)
+	{
+		auto dstAlphaSet = _mm_srai_epi32(dstColor, 31);
+		pass = _mm_and_si128(pass, state.test.nDestAlphaMode ? dstAlphaSet : _mm_andnot_si128(dstAlphaSet, ones));
+	}
+
+	unsigned int alphaFail = state.test.nAlphaFail;
+	bool failWritesColor = (alphaFail == ALPHA_TEST_FAIL_FBONLY) || (alphaFail == ALPHA_TEST_FAIL_RGBONLY);
+	bool failWritesDepth = (alphaFail == ALPHA_TEST_FAIL_ZBONLY);
+	auto colorWrite = _mm_and_si128(pass, failWritesColor ? ones : alphaPass);
+	auto depthWrite = state.zWrite ? _mm_and_si128(pass, failWritesDepth ? ones : alphaPass) : zero;
+	auto keepDstAlpha = (alphaFail == ALPHA_TEST_FAIL_RGBONLY) ? _mm_andnot_si128(alphaPass, pass) : zero;
+
+	auto color = srcColor;
+	if(state.blendEnabled)
+	{
+		auto blendedLo = BlendHalf(_mm_unpacklo_epi8(srcColor, zero), _mm_unpacklo_epi8(dstColor, zero), state.alpha);
+		auto blendedHi = BlendHalf(_mm_unpackhi_epi8(srcColor, zero), _mm_unpackhi_epi8(dstColor, zero), state.alpha);
+		auto blended = _mm_packus_epi16(blendedLo, blendedHi);
+		auto alphaMask = _mm_set1_epi32(0xFF000000);
+		blended = _mm_or_si128(_mm_andnot_si128(alphaMask, blended), _mm_and_si128(alphaMask, srcColor));
+		if(state.pabeEnabled)
+		{
+			//Only pixels with their alpha MSB set get blended
+			auto blendSelect = _mm_srai_epi32(srcColor, 31);
+			blended = _mm_or_si128(_mm_and_si128(blendSelect, blended), _mm_andnot_si128(blendSelect, srcColor));
+		}
+		color = blended;
+	}
+	color = _mm_or_si128(color, _mm_set1_epi32(state.fbaMask));
+
+	auto preserveMask = _mm_or_si128(_mm_set1_epi32(state.colorMask), _mm_and_si128(keepDstAlpha, _mm_set1_epi32(0xFF000000)));
+	color = _mm_or_si128(_mm_andnot_si128(preserveMask, color), _mm_and_si128(preserveMask, dstColor));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(quad.color), color);
+
+	uint32 colorWriteMask = _mm_movemask_ps(_mm_castsi128_ps(colorWrite));
+	uint32 depthWriteMask = _mm_movemask_ps(_mm_castsi128_ps(depthWrite));
+	return colorWriteMask | (depthWriteMask << 4);
+}
+
+#else
+
+static uint32 BlendColor(uint32 src, uint32 dst, const CGSHandler::ALPHA& alpha)
+{
+	int32 srcAlpha = src >> 24;
+	int32 dstAlpha = dst >> 24;
+	int32 factor = (alpha.nC == 0) ? srcAlpha : ((alpha.nC == 1) ? dstAlpha : alpha.nFix);
+	uint32 result = src & 0xFF000000;
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		int32 srcValue = (src >> (i * 8)) & 0xFF;
+		int32 dstValue = (dst >> (i * 8)) & 0xFF;
+		auto selectColor =
+			[&] (unsigned int select)
+			{
+				return (select == 0) ? srcValue : ((select == 1) ? dstValue : 0);
+			};
+		int32 value = (((selectColor(alpha.nA) - selectColor(alpha.nB)) * factor) >> 7) + selectColor(alpha.nD);
+		result |= static_cast<uint32>(std::min<int32>(std::max<int32>(value, 0), 0xFF)) << (i * 8);
+	}
+	return result;
+}
+
+uint32 CGSH_Software::ShadeQuad(const RENDERSTATE& state, PIXELQUAD& quad, uint32 coverage)
+{
+	uint32 writeMask = 0;
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		if(!(coverage & (1 << i))) continue;
+
+		uint32 srcColor = quad.color[i];
+		uint32 dstColor = quad.dstColor[i];
+
+		bool depthPass = true;
+		switch(state.depthMethod)
+		{
+		case DEPTH_TEST_NEVER:
+			depthPass = false;
+			break;
+		case DEPTH_TEST_GEQUAL:
+			depthPass = quad.z[i] >= quad.dstZ[i];
+			break;
+		case DEPTH_TEST_GREATER:
+			depthPass = quad.z[i] > quad.dstZ[i];
+			break;
+		}
+
+		uint32 srcAlpha = srcColor >> 24;
+		uint32 alphaRef = state.test.nAlphaRef;
+		bool alphaPass = true;
+		switch(state.test.nAlphaMethod)
+		{
+		case ALPHA_TEST_NEVER:		alphaPass = false;					break;
+		case ALPHA_TEST_LESS:		alphaPass = srcAlpha < alphaRef;	break;
+		case ALPHA_TEST_LEQUAL:		alphaPass = srcAlpha <= alphaRef;	break;
+		case ALPHA_TEST_EQUAL:		alphaPass = srcAlpha == alphaRef;	break;
+		case ALPHA_TEST_GEQUAL:		alphaPass = srcAlpha >= alphaRef;	break;
+		case ALPHA_TEST_GREATER:	alphaPass = srcAlpha > alphaRef;	break;
+		case ALPHA_TEST_NOTEQUAL:	alphaPass = srcAlpha != alphaRef;	break;
+		}
+
+		bool pass = depthPass;
+		if(state.dateEnabled)
+		{
+			pass &= ((dstColor >> 31) == state.test.nDestAlphaMode);
+		}
+		if(!pass) continue;
+
+		unsigned int alphaFail = state.test.nAlphaFail;
+		bool colorWrite = alphaPass || (alphaFail == ALPHA_TEST_FAIL_FBONLY) || (alphaFail == ALPHA_TEST_FAIL_RGBONLY);
+		bool depthWrite = state.zWrite && (alphaPass || (alphaFail == ALPHA_TEST_FAIL_ZBONLY));
+		bool keepDstAlpha = !alphaPass && (alphaFail == ALPHA_TEST_FAIL_RGBONLY);
+
+		uint32 color = srcColor;
+		if(state.blendEnabled && (!state.pabeEnabled || (srcColor & 0x80000000)))
+		{
+			color = BlendColor(srcColor, dstColor, state.alpha);
+		}
+		color |= state.fbaMask;
+
+		uint32 preserveMask = state.colorMask | (keepDstAlpha ? 0xFF000000 : 0);
+		quad.color[i] = (color & ~preserveMask) | (dstColor & preserveMask);
+
+		if(colorWrite) writeMask |= (1 << i);
+		if(depthWrite) writeMask |= (0x10 << i);
+	}
+	return writeMask;
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////
+// Transfers & Presentation
+/////////////////////////////////////////////////////////////
+
+void CGSH_Software::ProcessHostToLocalTransfer()
+{
+	//Data has been written in GS RAM already and pending primitives were flushed when the transfer started
+}
+
+void CGSH_Software::ProcessLocalToHostTransfer()
+{
+	//Pending primitives were flushed when the transfer started, GS RAM is up to date
+}
+
+void CGSH_Software::ProcessLocalToLocalTransfer()
+{
+	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+	if(bltBuf.nSrcPsm != bltBuf.nDstPsm) return;
+
+	switch(bltBuf.nDstPsm)
+	{
+	case PSMCT32:
+		TransferLocalToLocal<CGsPixelFormats::STORAGEPSMCT32>(0xFFFFFFFF);
+		break;
+	case PSMCT24:
+		TransferLocalToLocal<CGsPixelFormats::STORAGEPSMCT32>(0x00FFFFFF);
+		break;
+	case PSMT8H:
+		TransferLocalToLocal<CGsPixelFormats::STORAGEPSMCT32>(0xFF000000);
+		break;
+	case PSMT4HL:
+		TransferLocalToLocal<CGsPixelFormats::STORAGEPSMCT32>(0x0F000000);
+		break;
+	case PSMT4HH:
+		TransferLocalToLocal<CGsPixelFormats::STORAGEPSMCT32>(0xF0000000);
+		break;
+	case PSMCT16:
+		TransferLocalToLocal<CGsPixelFormats::STORAGEPSMCT16>(0xFFFF);
+		break;
+	case PSMCT16S:
+		TransferLocalToLocal<CGsPixelFormats::STORAGEPSMCT16S>(0xFFFF);
+		break;
+	case PSMT8:
+		TransferLocalToLocal<CGsPixelFormats::STORAGEPSMT8>(0xFF);
+		break;
+	case PSMT4:
+		TransferLocalToLocal<CGsPixelFormats::STORAGEPSMT4>(0x0F);
+		break;
+	}
+}
+
+template <typename Storage>
+void CGSH_Software::TransferLocalToLocal(typename Storage::Unit mask)
+{
+	typedef typename Storage::Unit Unit;
+
+	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+
+	CGsPixelFormats::CPixelIndexor<Storage> srcIndexor(m_pRAM, bltBuf.GetSrcPtr(), bltBuf.nSrcWidth);
+	CGsPixelFormats::CPixelIndexor<Storage> dstIndexor(m_pRAM, bltBuf.GetDstPtr(), bltBuf.nDstWidth);
+
+	//Source is read completely before writing to handle overlapping areas
+	std::vector<Unit> pixels(trxReg.nRRW * trxReg.nRRH);
+	for(uint32 y = 0; y < trxReg.nRRH; y++)
+	{
+		for(uint32 x = 0; x < trxReg.nRRW; x++)
+		{
+			pixels[x + (y * trxReg.nRRW)] = srcIndexor.GetPixel((trxPos.nSSAX + x) % MAX_SURFACE_SIZE, (trxPos.nSSAY + y) % MAX_SURFACE_SIZE);
+		}
+	}
+
+	for(uint32 y = 0; y < trxReg.nRRH; y++)
+	{
+		for(uint32 x = 0; x < trxReg.nRRW; x++)
+		{
+			uint32 dstX = (trxPos.nDSAX + x) % MAX_SURFACE_SIZE;
+			uint32 dstY = (trxPos.nDSAY + y) % MAX_SURFACE_SIZE;
+			Unit pixel = pixels[x + (y * trxReg.nRRW)];
+			if(mask != static_cast<Unit>(~0))
+			{
+				pixel = (pixel & mask) | (dstIndexor.GetPixel(dstX, dstY) & ~mask);
+			}
+			dstIndexor.SetPixel(dstX, dstY, pixel);
+		}
+	}
+}
+
+void CGSH_Software::ProcessClutTransfer(uint32, uint32)
+{
+	//The CLUT buffer was loaded with different colors. Primitives already in the batch keep
+	//the colors they were submitted with, new ones will use a linear CLUT built again.
+	m_linearClutDirty = true;
+}
+
+void CGSH_Software::PresentFramebuffer()
+{
+
+}
+
+void CGSH_Software::ReadDisplayFramebuffer(FramebufferPixelArray& pixels, uint32& width, uint32& height)
+{
+	DISPLAY d;
+	DISPFB fb;
+	{
+		std::lock_guard<std::recursive_mutex> registerMutexLock(m_registerMutex);
+		unsigned int readCircuit = GetCurrentReadCircuit();
+		d <<= (readCircuit == 0) ? m_nDISPLAY1.value.q : m_nDISPLAY2.value.q;
+		fb <<= (readCircuit == 0) ? m_nDISPFB1.value.q : m_nDISPFB2.value.q;
+	}
+
+	width = (d.nW + 1) / (d.nMagX + 1);
+	height = (d.nH + 1);
+	if(GetCrtIsInterlaced() && GetCrtIsFrameMode()) height /= 2;
+	width = std::min<uint32>(std::max<uint32>(width, 1), MAX_SURFACE_SIZE);
+	height = std::min<uint32>(std::max<uint32>(height, 1), MAX_SURFACE_SIZE);
+
+	pixels.resize(width * height);
+	CGsPixelFormats::CPixelIndexorPSMCT32 indexor32(m_pRAM, fb.GetBufPtr(), fb.nBufWidth);
+	CGsPixelFormats::CPixelIndexorPSMCT16 indexor16(m_pRAM, fb.GetBufPtr(), fb.nBufWidth);
+	CGsPixelFormats::CPixelIndexorPSMCT16S indexor16S(m_pRAM, fb.GetBufPtr(), fb.nBufWidth);
+	for(uint32 y = 0; y < height; y++)
+	{
+		uint32* row = pixels.data() + (y * width);
+		uint32 srcY = (fb.nY + y) % MAX_SURFACE_SIZE;
+		for(uint32 x = 0; x < width; x++)
+		{
+			uint32 srcX = (fb.nX + x) % MAX_SURFACE_SIZE;
+			switch(fb.nPSM)
+			{
+			case PSMCT16:
+				row[x] = Color16ToColor32(indexor16.GetPixel(srcX, srcY));
+				break;
+			case PSMCT16S:
+				row[x] = Color16ToColor32(indexor16S.GetPixel(srcX, srcY));
+				break;
+			default:
+				row[x] = indexor32.GetPixel(srcX, srcY);
+				break;
+			}
+		}
+	}
+}
+
+CGSH_Software::PRESENTATION_RECT CGSH_Software::GetPresentationRect(uint32 sourceWidth, uint32 sourceHeight) const
+{
+	uint32 windowWidth = m_presentationParams.windowWidth;
+	uint32 windowHeight = m_presentationParams.windowHeight;
+	PRESENTATION_RECT rect;
+	switch(m_presentationParams.mode)
+	{
+	case PRESENTATION_MODE_FILL:
+		rect.width = windowWidth;
+		rect.height = windowHeight;
+		break;
+	case PRESENTATION_MODE_FIT:
+		rect.width = windowWidth;
+		rect.height = (sourceWidth != 0) ? (windowWidth * sourceHeight) / sourceWidth : 0;
+		if(rect.height > windowHeight)
+		{
+			rect.width = (sourceHeight != 0) ? (windowHeight * sourceWidth) / sourceHeight : 0;
+			rect.height = windowHeight;
+		}
+		break;
+	case PRESENTATION_MODE_ORIGINAL:
+		rect.width = sourceWidth;
+		rect.height = sourceHeight;
+		break;
+	}
+	rect.x = static_cast<int32>(windowWidth - rect.width) / 2;
+	rect.y = static_cast<int32>(windowHeight - rect.height) / 2;
+	return rect;
+}
+
+void CGSH_Software::ReadFramebuffer(uint32 width, uint32 height, void* buffer)
+{
+	//Output is 24-bit BGR with the bottom row first, same as what the OpenGL handler provides
+	SendGSCall(
+		[this, width, height, buffer] ()
+		{
+			FlushPrimitives();
+
+			uint32 dispWidth = 0;
+			uint32 dispHeight = 0;
+			ReadDisplayFramebuffer(m_readPixels, dispWidth, dispHeight);
+
+			//Rows are aligned on 4 bytes
+			uint32 rowPitch = ((width * 3) + 3) & ~3;
+			auto output = reinterpret_cast<uint8*>(buffer);
+			for(uint32 y = 0; y < height; y++)
+			{
+				uint32 srcY = ((height - y - 1) * dispHeight) / height;
+				uint8* row = output + (y * rowPitch);
+				for(uint32 x = 0; x < width; x++)
+				{
+					uint32 srcX = (x * dispWidth) / width;
+					uint32 color = m_readPixels[srcX + (srcY * dispWidth)];
+					row[(x * 3) + 0] = static_cast<uint8>(color >> 16);
+					row[(x * 3) + 1] = static_cast<uint8>(color >>  8);
+					row[(x * 3) + 2] = static_cast<uint8>(color >>  0);
+				}
+			}
+		},
+		true
+	);
+}
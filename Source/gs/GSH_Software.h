@@ -0,0 +1,221 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "GSHandler.h"
+
+#define PREF_CGSH_SOFTWARE_ENABLED "renderer.software.enabled"
+
+//Software rasterizer, draws directly in GS RAM and doesn't need any window or graphics API.
+//Primitives are accumulated in a batch that is binned in screen tiles, tiles are then
+//rasterized in parallel by a pool of worker threads (with the GS thread helping out).
+
+class CGSH_Software : public CGSHandler
+{
+public:
+								CGSH_Software();
+	virtual						~CGSH_Software();
+
+	virtual void				SaveState(Framework::CZipArchiveWriter&) override;
+	virtual void				LoadState(Framework::CZipArchiveReader&) override;
+
+	virtual void				ProcessHostToLocalTransfer() override;
+	virtual void				ProcessLocalToHostTransfer() override;
+	virtual void				ProcessLocalToLocalTransfer() override;
+	virtual void				ProcessClutTransfer(uint32, uint32) override;
+	virtual void				ReadFramebuffer(uint32, uint32, void*) override;
+
+	static FactoryFunction		GetFactoryFunction();
+	static void					RegisterPreferences();
+
+protected:
+	typedef std::vector<uint32> FramebufferPixelArray;
+
+	struct PRESENTATION_RECT
+	{
+		int32		x = 0;
+		int32		y = 0;
+		uint32		width = 0;
+		uint32		height = 0;
+	};
+
+	virtual void				InitializeImpl() override;
+	virtual void				ReleaseImpl() override;
+
+	//Called on the GS thread on flip, once everything was drawn in GS RAM. Frontends override this to show the frame.
+	virtual void				PresentFramebuffer();
+
+	//Copies the displayed frame buffer at its native size, pixels are 0xXXBBGGRR with the top row first
+	void						ReadDisplayFramebuffer(FramebufferPixelArray&, uint32&, uint32&);
+	//Where the frame goes in the output window according to the presentation mode, top row first
+	PRESENTATION_RECT			GetPresentationRect(uint32, uint32) const;
+
+private:
+	enum
+	{
+		TILE_SHIFT = 5,
+		TILE_SIZE = (1 << TILE_SHIFT),
+		MAX_SURFACE_SIZE = 2048,
+		TILE_COUNT_X = (MAX_SURFACE_SIZE / TILE_SIZE),
+		TILE_COUNT = (TILE_COUNT_X * TILE_COUNT_X),
+		MAX_PRIMITIVES = 0x4000,
+		MAX_WORKER_COUNT = 7,
+	};
+
+	enum RASTER_TYPE
+	{
+		RASTER_POINT,
+		RASTER_LINE,
+		RASTER_TRIANGLE,
+		RASTER_SPRITE,
+	};
+
+	struct VERTEX
+	{
+		uint64		position;
+		uint64		rgbaq;
+		uint64		uv;
+		uint64		st;
+	};
+
+	//Linear function of the screen position, value = c + dx * x + dy * y
+	template <typename ValueType>
+	struct GRADIENT
+	{
+		ValueType	c;
+		ValueType	dx;
+		ValueType	dy;
+
+		ValueType	Evaluate(int32 x, int32 y) const { return c + (dx * x) + (dy * y); }
+	};
+
+	typedef GRADIENT<float> GRADIENTF;
+	typedef GRADIENT<double> GRADIENTD;
+
+	struct RENDERSTATE
+	{
+		PRIM		prim;
+		FRAME		frame;
+		ZBUF		zbuf;
+		TEST		test;
+		ALPHA		alpha;
+		TEX0		tex0;
+		CLAMP		clamp;
+		TEXA		texa;
+		SCISSOR		scissor;
+		uint64		fba;
+		uint64		pabe;
+
+		//Derived from the registers above
+		uint32		zPsm;
+		uint32		zMax;
+		uint32		depthMethod;
+		bool		zWrite;
+		uint32		colorMask;
+		uint32		fbaMask;
+		bool		blendEnabled;
+		bool		pabeEnabled;
+		bool		dateEnabled;
+		std::array<uint32, 256> clut;
+	};
+
+	struct PRIMITIVE
+	{
+		uint32		type;
+		uint32		stateIndex;
+		int32		minX;
+		int32		minY;
+		int32		maxX;
+		int32		maxY;
+		int32		x[3];
+		int32		y[3];
+		GRADIENTF	color[4];
+		GRADIENTD	z;
+		GRADIENTF	tex[3];
+	};
+
+	//Four horizontally adjacent pixels going through the pixel pipeline
+	struct PIXELQUAD
+	{
+		uint32		color[4];
+		uint32		z[4];
+		uint32		dstColor[4];
+		uint32		dstZ[4];
+	};
+
+	typedef std::vector<uint32> PrimitiveIndexArray;
+
+	virtual void				ResetImpl() override;
+	virtual void				FlipImpl() override;
+	virtual void				WriteRegisterImpl(uint8, uint64) override;
+
+	void						VertexKick(uint8, uint64);
+	uint32						GetCurrentReadCircuit() const;
+
+	void						BuildRenderState(RENDERSTATE&);
+	void						Prim_Point();
+	void						Prim_Line();
+	void						Prim_Triangle();
+	void						Prim_Sprite();
+	void						AddPrimitive(PRIMITIVE&);
+
+	void						FlushPrimitives();
+	void						DiscardPrimitives();
+
+	void						StartWorkers();
+	void						StopWorkers();
+	void						WorkerThreadProc();
+	void						ProcessTiles();
+	void						RasterizeTile(uint32);
+	void						RasterizePrimitive(const PRIMITIVE&, int32, int32, int32, int32);
+	void						FillSpan(const PRIMITIVE&, const RENDERSTATE&, int32, int32, int32);
+	template <typename, typename> void FillSpanImpl(const PRIMITIVE&, const RENDERSTATE&, int32, int32, int32);
+	uint32						ShadeColor(const PRIMITIVE&, const RENDERSTATE&, int32, int32);
+	uint32						FetchTexel(const RENDERSTATE&, int32, int32);
+	static uint32				ShadeQuad(const RENDERSTATE&, PIXELQUAD&, uint32);
+
+	template <typename Storage> void TransferLocalToLocal(typename Storage::Unit);
+
+	VERTEX						m_vtxBuffer[3];
+	unsigned int				m_vtxCount = 0;
+	unsigned int				m_primitiveType = PRIM_INVALID;
+	PRIM						m_primitiveMode;
+
+	//Linear version of the CLUT buffer for the last indexed texture, built again after CLUT transfers
+	std::array<uint32, 256>		m_linearClut;
+	uint64						m_linearClutTex0 = 0;
+	uint64						m_linearClutTexa = 0;
+	bool						m_linearClutDirty = true;
+
+	FramebufferPixelArray		m_readPixels;
+
+	std::vector<RENDERSTATE>	m_renderStates;
+	std::vector<PRIMITIVE>		m_primitives;
+	uint64						m_batchFrame = 0;
+	uint64						m_batchZbuf = 0;
+	int32						m_batchMaxY = 0;
+	uint32						m_batchTexStart = 0;
+	uint32						m_batchTexEnd = 0;
+	bool						m_batchUsesDepth = false;
+	bool						m_batchSerial = false;
+
+	PrimitiveIndexArray			m_tileBins[TILE_COUNT];
+	std::vector<uint32>			m_activeTiles;
+	std::atomic<uint32>			m_nextTile;
+	std::atomic<uint32>			m_completedTiles;
+
+	std::vector<std::thread>	m_workers;
+	std::mutex					m_workerMutex;
+	std::condition_variable		m_workerCondition;
+	std::condition_variable		m_workDoneCondition;
+	uint32						m_workGeneration = 0;
+	uint32						m_busyWorkerCount = 0;
+	bool						m_workOpen = false;
+	bool						m_workersDone = false;
+
+	static CGSHandler*			GSHandlerFactory();
+};
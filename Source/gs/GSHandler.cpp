@@ -1,7 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <functional>
-#include <boost/scoped_array.hpp>
+#include <algorithm>
 #include "../AppConfig.h"
 #include "../Log.h"
 #include "../MemoryStateFile.h"
@@ -51,17 +51,14 @@
 
 #define LOG_NAME						("gs")
 
-struct MASSIVEWRITE_INFO
-{
-#ifdef DEBUGGER_INCLUDED
-	CGsPacketMetadata				metadata;
-#endif
-	unsigned int					count;
-	CGSHandler::RegisterWrite		writes[1];
-};
-
 CGSHandler::CGSHandler()
-: m_threadDone(false)
+: m_commands(new COMMAND[COMMAND_RING_SIZE])
+, m_commandReadPos(0)
+, m_commandWritePos(0)
+, m_payloadArena(new uint8[PAYLOAD_ARENA_SIZE])
+, m_payloadReadPos(0)
+, m_threadIdle(false)
+, m_threadDone(false)
 , m_drawCallCount(0)
 , m_pCLUT(nullptr)
 , m_pRAM(nullptr)
@@ -116,13 +113,13 @@ void CGSHandler::RegisterPreferences()
 
 void CGSHandler::NotifyPreferencesChanged()
 {
-	m_mailBox.SendCall([this] () { NotifyPreferencesChangedImpl(); });
+	SendGSCall([this] () { NotifyPreferencesChangedImpl(); });
 }
 
 void CGSHandler::Reset()
 {
 	ResetBase();
-	m_mailBox.SendCall(std::bind(&CGSHandler::ResetImpl, this), true);
+	SendGSCall(std::bind(&CGSHandler::ResetImpl, this), true);
 }
 
 void CGSHandler::ResetBase()
@@ -160,13 +157,30 @@ void CGSHandler::NotifyPreferencesChangedImpl()
 
 }
 
+void CGSHandler::SyncLocalToHostTransfers()
+{
+
+}
+
+void CGSHandler::SetShaderCachePathImpl(const boost::filesystem::path&)
+{
+
+}
+
 void CGSHandler::SetPresentationParams(const PRESENTATION_PARAMS& presentationParams)
 {
 	m_presentationParams = presentationParams;
 }
 
+void CGSHandler::SetShaderCachePath(const boost::filesystem::path& cachePath)
+{
+	SendGSCall([this, cachePath] () { SetShaderCachePathImpl(cachePath); }, true);
+}
+
 void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive)
 {
+	SendGSCall([this] () { SyncLocalToHostTransfers(); }, true);
+
 	archive.InsertFile(new CMemoryStateFile(STATE_RAM,		m_pRAM,		RAMSIZE));
 	archive.InsertFile(new CMemoryStateFile(STATE_REGS,		m_nReg,		sizeof(uint64) * CGSHandler::REGISTER_MAX));
 	archive.InsertFile(new CMemoryStateFile(STATE_TRXCTX,	&m_trxCtx,	sizeof(TRXCONTEXT)));
@@ -191,6 +205,9 @@ void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive)
 
 void CGSHandler::LoadState(Framework::CZipArchiveReader& archive)
 {
+	//Make sure no pending readback overwrites the RAM we're about to load
+	SendGSCall([this] () { SyncLocalToHostTransfers(); }, true);
+
 	archive.BeginReadFile(STATE_RAM		)->Read(m_pRAM,		RAMSIZE);
 	archive.BeginReadFile(STATE_REGS	)->Read(m_nReg,		sizeof(uint64) * 0x80);
 	archive.BeginReadFile(STATE_TRXCTX	)->Read(&m_trxCtx,	sizeof(TRXCONTEXT));
@@ -356,22 +373,22 @@ void CGSHandler::WritePrivRegister(uint32 nAddress, uint32 nData)
 
 void CGSHandler::Initialize()
 {
-	m_mailBox.SendCall(std::bind(&CGSHandler::InitializeImpl, this), true);
+	SendGSCall(std::bind(&CGSHandler::InitializeImpl, this), true);
 }
 
 void CGSHandler::Release()
 {
-	m_mailBox.SendCall(std::bind(&CGSHandler::ReleaseImpl, this), true);
+	SendGSCall(std::bind(&CGSHandler::ReleaseImpl, this), true);
 }
 
 void CGSHandler::Flip(bool showOnly)
 {
 	if(!showOnly)
 	{
-		m_mailBox.FlushCalls();
-		m_mailBox.SendCall(std::bind(&CGSHandler::MarkNewFrame, this));
+		SendGSCall([] () { }, true);
+		SendGSCall(std::bind(&CGSHandler::MarkNewFrame, this));
 	}
-	m_mailBox.SendCall(std::bind(&CGSHandler::FlipImpl, this), true);
+	SendGSCall(std::bind(&CGSHandler::FlipImpl, this), true);
 }
 
 void CGSHandler::FlipImpl()
@@ -410,24 +427,44 @@ void CGSHandler::SetSMODE2(uint64 value)
 
 void CGSHandler::WriteRegister(uint8 registerId, uint64 value)
 {
-	m_mailBox.SendCall(std::bind(&CGSHandler::WriteRegisterImpl, this, registerId, value));
+	COMMAND command = {};
+	command.type = COMMAND_WRITE_REGISTER;
+	command.param = registerId;
+	command.value = value;
+	PushCommand(command);
 }
 
 void CGSHandler::FeedImageData(const void* data, uint32 length)
 {
-	m_transferCount++;
+	//Big transfers are split in chunks that fit in the payload arena,
+	//chunk size is a multiple of every pixel size (ie.: PSMCT24)
+	static const uint32 maxChunkSize = 0xF0000;
+	static_assert((maxChunkSize + 0x10) <= MAX_PAYLOAD_SIZE, "Chunk size too big.");
 
-	//Allocate 0x10 more bytes to allow transfer handlers
-	//to read beyond the actual length of the buffer (ie.: PSMCT24)
-	
-	uint8* buffer = new uint8[length + 0x10];
-	memcpy(buffer, data, length);
-	m_mailBox.SendCall(std::bind(&CGSHandler::FeedImageDataImpl, this, buffer, length));
+	auto input = reinterpret_cast<const uint8*>(data);
+	while(length != 0)
+	{
+		uint32 chunkSize = std::min<uint32>(length, maxChunkSize);
+
+		m_transferCount++;
+
+		//Allocate 0x10 more bytes to allow transfer handlers
+		//to read beyond the actual length of the buffer (ie.: PSMCT24)
+		COMMAND command = {};
+		command.type = COMMAND_FEED_IMAGE_DATA;
+		command.param = chunkSize;
+		command.payload = AllocatePayload(chunkSize + 0x10, command.payloadEnd);
+		memcpy(command.payload, input, chunkSize);
+		PushCommand(command);
+
+		input += chunkSize;
+		length -= chunkSize;
+	}
 }
 
 void CGSHandler::ReadImageData(void* data, uint32 length)
 {
-	m_mailBox.SendCall([this, data, length] () { ReadImageDataImpl(data, length); }, true);
+	SendGSCall([this, data, length] () { ReadImageDataImpl(data, length); }, true);
 }
 
 void CGSHandler::WriteRegisterMassively(const RegisterWrite* writeList, unsigned int count, const CGsPacketMetadata* metadata)
@@ -463,23 +500,35 @@ void CGSHandler::WriteRegisterMassively(const RegisterWrite* writeList, unsigned
 		}
 	}
 
-	m_transferCount++;
+	//Big packets are split in chunks that fit in the payload arena
+	static const unsigned int maxChunkCount = (MAX_PAYLOAD_SIZE - sizeof(CGsPacketMetadata)) / sizeof(RegisterWrite);
 
-	auto massiveWrite = reinterpret_cast<MASSIVEWRITE_INFO*>(malloc(sizeof(MASSIVEWRITE_INFO) + (count * sizeof(RegisterWrite))));
-	memcpy(massiveWrite->writes, writeList, sizeof(CGSHandler::RegisterWrite) * count);
-	massiveWrite->count = count;
-#ifdef DEBUGGER_INCLUDED
-	if(metadata != nullptr)
-	{
-		memcpy(&massiveWrite->metadata, metadata, sizeof(CGsPacketMetadata));
-	}
-	else
+	while(count != 0)
 	{
-		massiveWrite->metadata = CGsPacketMetadata();
-	}
+		unsigned int chunkCount = std::min<unsigned int>(count, maxChunkCount);
+
+		m_transferCount++;
+
+		COMMAND command = {};
+		command.type = COMMAND_WRITE_REGISTER_MASSIVELY;
+		command.param = chunkCount;
+		command.payload = AllocatePayload(sizeof(CGsPacketMetadata) + (chunkCount * sizeof(RegisterWrite)), command.payloadEnd);
+#ifdef DEBUGGER_INCLUDED
+		if(metadata != nullptr)
+		{
+			memcpy(command.payload, metadata, sizeof(CGsPacketMetadata));
+		}
+		else
+		{
+			new (command.payload) CGsPacketMetadata();
+		}
 #endif
-	//Bind is used here because using a lambda seems to cause problems on Android/clang
-	m_mailBox.SendCall(std::bind(&CGSHandler::WriteRegisterMassivelyImpl, this, massiveWrite));
+		memcpy(command.payload + sizeof(CGsPacketMetadata), writeList, sizeof(RegisterWrite) * chunkCount);
+		PushCommand(command);
+
+		writeList += chunkCount;
+		count -= chunkCount;
+	}
 }
 
 void CGSHandler::WriteRegisterImpl(uint8 nRegister, uint64 nData)
@@ -530,8 +579,6 @@ void CGSHandler::WriteRegisterImpl(uint8 nRegister, uint64 nData)
 
 void CGSHandler::FeedImageDataImpl(const void* pData, uint32 nLength)
 {
-	boost::scoped_array<const uint8> dataPtr(reinterpret_cast<const uint8*>(pData));
-
 #ifdef DEBUGGER_INCLUDED
 	if(m_frameDump)
 	{
@@ -584,25 +631,27 @@ void CGSHandler::ReadImageDataImpl(void* ptr, uint32 size)
 	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
 
 	assert(trxPos.nDIR == 0);
+
+	//Data read back by the renderer needs to be in RAM before we hand it over
+	SyncLocalToHostTransfers();
 	((this)->*(m_transferReadHandlers[bltBuf.nSrcPsm]))(ptr, size);
 }
 
-void CGSHandler::WriteRegisterMassivelyImpl(MASSIVEWRITE_INFO* massiveWrite)
+void CGSHandler::WriteRegisterMassivelyImpl(const RegisterWrite* writeList, unsigned int count, const CGsPacketMetadata* metadata)
 {
 #ifdef DEBUGGER_INCLUDED
 	if(m_frameDump)
 	{
-		m_frameDump->AddRegisterPacket(massiveWrite->writes, massiveWrite->count, &massiveWrite->metadata);
+		m_frameDump->AddRegisterPacket(writeList, count, metadata);
 	}
 #endif
 
-	const RegisterWrite* writeIterator = massiveWrite->writes;
-	for(unsigned int i = 0; i < massiveWrite->count; i++)
+	const RegisterWrite* writeIterator = writeList;
+	for(unsigned int i = 0; i < count; i++)
 	{
 		WriteRegisterImpl(writeIterator->first, writeIterator->second);
 		writeIterator++;
 	}
-	free(massiveWrite);
 
 	assert(m_transferCount != 0);
 	m_transferCount--;
@@ -611,6 +660,11 @@ void CGSHandler::WriteRegisterMassivelyImpl(MASSIVEWRITE_INFO* massiveWrite)
 void CGSHandler::BeginTransfer()
 {
 	uint32 trxDir = m_nReg[GS_REG_TRXDIR] & 0x03;
+	if(trxDir != 1)
+	{
+		//Pending readbacks must land in RAM before it gets modified by another transfer
+		SyncLocalToHostTransfers();
+	}
 	if(trxDir == 0 || trxDir == 1)
 	{
 		//"Host to Local" or "Local to Host"
@@ -1648,14 +1702,116 @@ void CGSHandler::WriteToDelayedRegister(uint32 address, uint32 value, DELAYED_RE
 	}
 }
 
+//Sends a call to the GS thread. Commands pushed before the call are processed before it.
+void CGSHandler::SendGSCall(const CMailBox::FunctionType& function, bool waitForCompletion)
+{
+	uint32 fence = m_commandWritePos.load();
+	m_mailBox.SendCall(
+		[this, fence, function] ()
+		{
+			ProcessCommands(fence);
+			function();
+		},
+		waitForCompletion
+	);
+}
+
+//Only called from the thread sending data to the GS (ie.: EE thread)
+void CGSHandler::PushCommand(const COMMAND& command)
+{
+	uint32 writePos = m_commandWritePos.load(std::memory_order_relaxed);
+	while((writePos - m_commandReadPos.load()) == COMMAND_RING_SIZE)
+	{
+		//Ring is full, wait for the GS thread to catch up
+		std::this_thread::yield();
+	}
+	m_commands[writePos & (COMMAND_RING_SIZE - 1)] = command;
+	m_commandWritePos.store(writePos + 1);
+	if(m_threadIdle.load())
+	{
+		m_mailBox.WakeUp();
+	}
+}
+
+//Payloads are released in the same order as they are allocated, the arena is used as a ring
+uint8* CGSHandler::AllocatePayload(uint32 size, uint64& payloadEnd)
+{
+	assert(size <= MAX_PAYLOAD_SIZE);
+	uint64 payloadStart = m_payloadWritePos;
+	uint32 offset = static_cast<uint32>(payloadStart % PAYLOAD_ARENA_SIZE);
+	if((offset + size) > PAYLOAD_ARENA_SIZE)
+	{
+		//Not enough space before the end of the arena, skip to the beginning
+		payloadStart += PAYLOAD_ARENA_SIZE - offset;
+		offset = 0;
+	}
+	payloadEnd = payloadStart + size;
+	while((payloadEnd - m_payloadReadPos.load()) > PAYLOAD_ARENA_SIZE)
+	{
+		std::this_thread::yield();
+	}
+	m_payloadWritePos = payloadEnd;
+	return m_payloadArena.get() + offset;
+}
+
+void CGSHandler::ProcessCommands(uint32 fence)
+{
+	while(true)
+	{
+		uint32 readPos = m_commandReadPos.load(std::memory_order_relaxed);
+		//Calls sent from other threads might have a fence that was already passed
+		if(static_cast<int32>(fence - readPos) <= 0) break;
+		ProcessCommand(m_commands[readPos & (COMMAND_RING_SIZE - 1)]);
+		m_commandReadPos.store(readPos + 1);
+	}
+}
+
+void CGSHandler::ProcessCommand(const COMMAND& command)
+{
+	switch(command.type)
+	{
+	case COMMAND_WRITE_REGISTER:
+		WriteRegisterImpl(static_cast<uint8>(command.param), command.value);
+		break;
+	case COMMAND_WRITE_REGISTER_MASSIVELY:
+		WriteRegisterMassivelyImpl(reinterpret_cast<const RegisterWrite*>(command.payload + sizeof(CGsPacketMetadata)), command.param, 
+			reinterpret_cast<const CGsPacketMetadata*>(command.payload));
+		break;
+	case COMMAND_FEED_IMAGE_DATA:
+		FeedImageDataImpl(command.payload, command.param);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+	if(command.payload)
+	{
+		m_payloadReadPos.store(command.payloadEnd);
+	}
+}
+
 void CGSHandler::ThreadProc()
 {
 	while(!m_threadDone)
 	{
-		m_mailBox.WaitForCall(100);
-		while(m_mailBox.IsPending())
+		//Write position needs to be read before checking for calls to make sure
+		//we don't process commands that were pushed after a pending call
+		uint32 writePos = m_commandWritePos.load();
+		if(m_mailBox.IsPending())
 		{
 			m_mailBox.ReceiveCall();
+			continue;
+		}
+		if(writePos != m_commandReadPos.load(std::memory_order_relaxed))
+		{
+			ProcessCommands(writePos);
+			continue;
+		}
+		m_threadIdle = true;
+		if(m_commandWritePos.load() == m_commandReadPos.load(std::memory_order_relaxed))
+		{
+			m_mailBox.WaitForCall(100);
 		}
+		m_threadIdle = false;
 	}
 }
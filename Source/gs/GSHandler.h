@@ -5,7 +5,9 @@
 #include <functional>
 #include <atomic>
 #include <array>
+#include <memory>
 #include <boost/signals2.hpp>
+#include <boost/filesystem.hpp>
 
 #include "Types.h"
 #include "Convertible.h"
@@ -16,7 +18,6 @@
 
 class CFrameDump;
 class CGsPacketMetadata;
-struct MASSIVEWRITE_INFO;
 
 #define PREF_CGSHANDLER_PRESENTATION_MODE		"renderer.presentationmode"
 
@@ -580,6 +581,7 @@ public:
 
 	void									Reset();
 	void									SetPresentationParams(const PRESENTATION_PARAMS&);
+	void									SetShaderCachePath(const boost::filesystem::path&);
 
 	virtual void							SaveState(Framework::CZipArchiveWriter&);
 	virtual void							LoadState(Framework::CZipArchiveReader&);
@@ -762,18 +764,49 @@ protected:
 
 	void									WriteToDelayedRegister(uint32, uint32, DELAYED_REGISTER&);
 
+	enum
+	{
+		COMMAND_RING_SIZE = 0x10000,
+		PAYLOAD_ARENA_SIZE = 0x800000,
+		MAX_PAYLOAD_SIZE = 0x100000,
+	};
+
+	enum COMMAND_TYPE
+	{
+		COMMAND_WRITE_REGISTER,
+		COMMAND_WRITE_REGISTER_MASSIVELY,
+		COMMAND_FEED_IMAGE_DATA,
+	};
+
+	//Commands sent from the EE thread to the GS thread, variable sized data lives in the payload arena
+	struct COMMAND
+	{
+		uint32		type;
+		uint32		param;
+		uint64		value;
+		uint8*		payload;
+		uint64		payloadEnd;
+	};
+
 	void									ThreadProc();
+	void									SendGSCall(const CMailBox::FunctionType&, bool = false);
+	void									PushCommand(const COMMAND&);
+	uint8*									AllocatePayload(uint32, uint64&);
+	void									ProcessCommands(uint32);
+	void									ProcessCommand(const COMMAND&);
 	virtual void							InitializeImpl() = 0;
 	virtual void							ReleaseImpl() = 0;
 	void									ResetBase();
 	virtual void							ResetImpl();
 	virtual void							NotifyPreferencesChangedImpl();
+	virtual void							SetShaderCachePathImpl(const boost::filesystem::path&);
 	virtual void							FlipImpl();
 	void									MarkNewFrame();
 	virtual void							WriteRegisterImpl(uint8, uint64);
 	void									FeedImageDataImpl(const void*, uint32);
 	void									ReadImageDataImpl(void*, uint32);
-	virtual void							WriteRegisterMassivelyImpl(MASSIVEWRITE_INFO*);
+	virtual void							SyncLocalToHostTransfers();
+	virtual void							WriteRegisterMassivelyImpl(const RegisterWrite*, unsigned int, const CGsPacketMetadata*);
 
 	void									BeginTransfer();
 
@@ -827,6 +860,13 @@ protected:
 	std::recursive_mutex					m_registerMutex;
 	std::atomic<int>						m_transferCount;
 	CMailBox								m_mailBox;
+	std::unique_ptr<COMMAND[]>				m_commands;
+	std::atomic<uint32>						m_commandReadPos;
+	std::atomic<uint32>						m_commandWritePos;
+	std::unique_ptr<uint8[]>				m_payloadArena;
+	std::atomic<uint64>						m_payloadReadPos;
+	uint64									m_payloadWritePos = 0;
+	std::atomic<bool>						m_threadIdle;
 	bool									m_threadDone;
 	CFrameDump*								m_frameDump;
 	bool									m_drawEnabled = true;
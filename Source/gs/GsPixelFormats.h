@@ -134,6 +134,30 @@ public:
 			*GetPixelAddress(nX, nY) = nPixel;
 		}
 
+		//Stores a run of pixels on a single row, page offsets are looked up once per page crossed.
+		//Converter is called with the destination unit and source pixel.
+		template <typename SourceType, typename Converter>
+		void SetPixelRow(unsigned int nX, unsigned int nY, const SourceType* src, unsigned int count, unsigned int srcStride, Converter converter)
+		{
+			uint32 rowPageNum = (nY / Storage::PAGEHEIGHT) * (m_nWidth * 64) / Storage::PAGEWIDTH;
+			const uint32* rowOffsets = m_pageOffsets[nY % Storage::PAGEHEIGHT];
+			while(count != 0)
+			{
+				uint32 pageNum = (nX / Storage::PAGEWIDTH) + rowPageNum;
+				uint32 pageAddress = m_nPointer + (pageNum * PAGESIZE);
+				uint32 pageX = nX % Storage::PAGEWIDTH;
+				uint32 spanCount = std::min<uint32>(count, Storage::PAGEWIDTH - pageX);
+				for(uint32 i = 0; i < spanCount; i++)
+				{
+					auto pixelAddr = m_pMemory + ((pageAddress + rowOffsets[pageX + i]) & (CGSHandler::RAMSIZE - 1));
+					converter(*reinterpret_cast<typename Storage::Unit*>(pixelAddr), *src);
+					src += srcStride;
+				}
+				nX += spanCount;
+				count -= spanCount;
+			}
+		}
+
 		typename Storage::Unit* GetPixelAddress(unsigned int nX, unsigned int nY)
 		{
 			uint32 pageNum = (nX / Storage::PAGEWIDTH) + (nY / Storage::PAGEHEIGHT) * (m_nWidth * 64) / Storage::PAGEWIDTH;
@@ -1,8 +1,13 @@
 #pragma once
 
-#include <list>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <unordered_map>
 #include "GSHandler.h"
 #include "GsCachedArea.h"
+#include "GsPixelFormats.h"
 
 #define TEX0_CLUTINFO_MASK (~0xFFFFFFE000000000ULL)
 
@@ -17,6 +22,7 @@ public:
 		{
 			m_live = false;
 			m_textureHandle = TextureHandleType();
+			m_cachedArea.ClearDirtyPages();
 		}
 
 		uint64        m_tex0 = 0;
@@ -25,69 +31,197 @@ public:
 
 		//Platform specific
 		TextureHandleType m_textureHandle;
+
+	private:
+		friend class CGsTextureCache;
+
+		//LRU list links, most recently used texture is at the head
+		CTexture*     m_prev = nullptr;
+		CTexture*     m_next = nullptr;
+
+		//Range of GS RAM pages covered by this texture
+		uint32        m_pageStart = 0;
+		uint32        m_pageEnd = 0;
+		uint32        m_invalidationStamp = 0;
 	};
 
 	enum
 	{
-		MAX_TEXTURE_CACHE = 256,
+		DEFAULT_TEXTURE_CACHE_SIZE = 256,
 	};
 
-	CGsTextureCache()
+	CGsTextureCache(unsigned int size = DEFAULT_TEXTURE_CACHE_SIZE)
+	{
+		SetSize(size);
+	}
+
+	CGsTextureCache(const CGsTextureCache&) = delete;
+	CGsTextureCache& operator =(const CGsTextureCache&) = delete;
+
+	//Changes the amount of textures that can be cached, all cached textures are released
+	void SetSize(unsigned int size)
 	{
-		for(unsigned int i = 0; i < MAX_TEXTURE_CACHE; i++)
+		assert(size != 0);
+		Flush();
+		m_textures.clear();
+		m_head = nullptr;
+		m_tail = nullptr;
+		for(unsigned int i = 0; i < size; i++)
 		{
-			m_textureCache.push_back(std::make_shared<CTexture>());
+			auto texture = new CTexture();
+			m_textures.push_back(TexturePtr(texture));
+			LinkTail(texture);
 		}
+		m_textureMap.reserve(size);
+	}
+
+	unsigned int GetSize() const
+	{
+		return static_cast<unsigned int>(m_textures.size());
 	}
 
 	CTexture* Search(const CGSHandler::TEX0& tex0)
 	{
 		uint64 maskedTex0 = static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
 
-		for(auto textureIterator(m_textureCache.begin());
-			textureIterator != m_textureCache.end(); textureIterator++)
-		{
-			auto texture = *textureIterator;
-			if(!texture->m_live) continue;
-			if(maskedTex0 != texture->m_tex0) continue;
-			m_textureCache.erase(textureIterator);
-			m_textureCache.push_front(texture);
-			return texture.get();
-		}
+		auto textureIterator = m_textureMap.find(maskedTex0);
+		if(textureIterator == std::end(m_textureMap)) return nullptr;
 
-		return nullptr;
+		auto texture = textureIterator->second;
+		assert(texture->m_live);
+		Unlink(texture);
+		LinkHead(texture);
+		return texture;
 	}
 
-	void Insert(const CGSHandler::TEX0& tex0, TextureHandleType& textureHandle)
+	void Insert(const CGSHandler::TEX0& tex0, TextureHandleType textureHandle)
 	{
-		auto texture = *m_textureCache.rbegin();
-		texture->Reset();
+		auto texture = m_tail;
+		Evict(texture);
+
+		uint64 maskedTex0 = static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
+		auto prevTextureIterator = m_textureMap.find(maskedTex0);
+		if(prevTextureIterator != std::end(m_textureMap))
+		{
+			Evict(prevTextureIterator->second);
+		}
 
 		texture->m_cachedArea.SetArea(tex0.nPsm, tex0.GetBufPtr(), tex0.GetBufWidth(), tex0.GetHeight());
 
-		texture->m_tex0          = static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
-		texture->m_textureHandle = textureHandle;
+		texture->m_tex0          = maskedTex0;
+		texture->m_textureHandle = std::move(textureHandle);
 		texture->m_live          = true;
 
-		m_textureCache.pop_back();
-		m_textureCache.push_front(texture);
+		//Register texture in the pages it covers
+		uint32 areaStart = tex0.GetBufPtr();
+		uint32 areaSize = texture->m_cachedArea.GetSize();
+		texture->m_pageStart = std::min<uint32>(areaStart / CGsPixelFormats::PAGESIZE, PAGE_COUNT);
+		texture->m_pageEnd = std::min<uint32>((areaStart + areaSize + CGsPixelFormats::PAGESIZE - 1) / CGsPixelFormats::PAGESIZE, PAGE_COUNT);
+		for(uint32 page = texture->m_pageStart; page < texture->m_pageEnd; page++)
+		{
+			m_pageTextures[page].push_back(texture);
+		}
+
+		m_textureMap[maskedTex0] = texture;
+
+		Unlink(texture);
+		LinkHead(texture);
 	}
 
 	void InvalidateRange(uint32 start, uint32 size)
 	{
-		std::for_each(std::begin(m_textureCache), std::end(m_textureCache), 
-			[start, size] (TexturePtr& texture) { if(texture->m_live) { texture->m_cachedArea.Invalidate(start, size); } });
+		if(size == 0) return;
+
+		uint32 pageStart = std::min<uint32>(start / CGsPixelFormats::PAGESIZE, PAGE_COUNT);
+		uint32 pageEnd = std::min<uint32>((start + size + CGsPixelFormats::PAGESIZE - 1) / CGsPixelFormats::PAGESIZE, PAGE_COUNT);
+
+		//Textures spanning many pages only need to be visited once
+		m_invalidationStamp++;
+		for(uint32 page = pageStart; page < pageEnd; page++)
+		{
+			for(const auto& texture : m_pageTextures[page])
+			{
+				if(texture->m_invalidationStamp == m_invalidationStamp) continue;
+				texture->m_invalidationStamp = m_invalidationStamp;
+				texture->m_cachedArea.Invalidate(start, size);
+			}
+		}
 	}
 
 	void Flush()
 	{
-		std::for_each(std::begin(m_textureCache), std::end(m_textureCache), 
-			[] (TexturePtr& texture) { texture->Reset(); });
+		for(auto& texture : m_textures)
+		{
+			texture->Reset();
+		}
+		for(auto& pageTextures : m_pageTextures)
+		{
+			pageTextures.clear();
+		}
+		m_textureMap.clear();
 	}
 
 private:
-	typedef std::shared_ptr<CTexture> TexturePtr;
-	typedef std::list<TexturePtr> TextureList;
+	enum
+	{
+		PAGE_COUNT = CGSHandler::RAMSIZE / CGsPixelFormats::PAGESIZE,
+	};
+
+	typedef std::unique_ptr<CTexture> TexturePtr;
+	typedef std::vector<TexturePtr> TextureArray;
+	typedef std::unordered_map<uint64, CTexture*> TextureMap;
+	typedef std::vector<CTexture*> PageTextureArray;
+
+	void Evict(CTexture* texture)
+	{
+		if(!texture->m_live) return;
+
+		auto textureIterator = m_textureMap.find(texture->m_tex0);
+		if((textureIterator != std::end(m_textureMap)) && (textureIterator->second == texture))
+		{
+			m_textureMap.erase(textureIterator);
+		}
+
+		for(uint32 page = texture->m_pageStart; page < texture->m_pageEnd; page++)
+		{
+			auto& pageTextures = m_pageTextures[page];
+			auto pageTextureIterator = std::find(std::begin(pageTextures), std::end(pageTextures), texture);
+			assert(pageTextureIterator != std::end(pageTextures));
+			*pageTextureIterator = pageTextures.back();
+			pageTextures.pop_back();
+		}
+
+		texture->m_pageStart = 0;
+		texture->m_pageEnd = 0;
+		texture->Reset();
+	}
+
+	void Unlink(CTexture* texture)
+	{
+		if(texture->m_prev) texture->m_prev->m_next = texture->m_next; else m_head = texture->m_next;
+		if(texture->m_next) texture->m_next->m_prev = texture->m_prev; else m_tail = texture->m_prev;
+		texture->m_prev = nullptr;
+		texture->m_next = nullptr;
+	}
+
+	void LinkHead(CTexture* texture)
+	{
+		texture->m_next = m_head;
+		if(m_head) m_head->m_prev = texture; else m_tail = texture;
+		m_head = texture;
+	}
+
+	void LinkTail(CTexture* texture)
+	{
+		texture->m_prev = m_tail;
+		if(m_tail) m_tail->m_next = texture; else m_head = texture;
+		m_tail = texture;
+	}
 
-	TextureList    m_textureCache;
+	TextureArray        m_textures;
+	TextureMap          m_textureMap;
+	PageTextureArray    m_pageTextures[PAGE_COUNT];
+	CTexture*           m_head = nullptr;
+	CTexture*           m_tail = nullptr;
+	uint32              m_invalidationStamp = 0;
 };
@@ -280,13 +280,7 @@ uint32 CCdvdman::CdRead(uint32 startSector, uint32 sectorCount, uint32 bufferPtr
 	}
 	if(m_image != NULL && bufferPtr != 0)
 	{
-		uint8* buffer = &m_ram[bufferPtr];
-		uint32 sectorSize = 2048;
-		for(unsigned int i = 0; i < sectorCount; i++)
-		{
-			m_image->ReadBlock(startSector + i, buffer);
-			buffer += sectorSize;
-		}
+		m_image->ReadBlocks(startSector, sectorCount, m_ram + bufferPtr);
 	}
 	if(m_callbackPtr != 0)
 	{
@@ -444,11 +438,8 @@ uint32 CCdvdman::CdStRead(uint32 sectors, uint32 bufPtr, uint32 mode, uint32 err
 {
 	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSTREAD "(sectors = %d, bufPtr = 0x%0.8X, mode = %d, errPtr = 0x%0.8X);\r\n",
 		sectors, bufPtr, mode, errPtr);
-	for(unsigned int i = 0; i < sectors; i++)
-	{
-		m_image->ReadBlock(m_streamPos, m_ram + (bufPtr + (i * 0x800)));
-		m_streamPos++;
-	}
+	m_image->ReadBlocks(m_streamPos, sectors, m_ram + bufPtr);
+	m_streamPos += sectors;
 	if(errPtr != 0)
 	{
 		auto err = reinterpret_cast<uint32*>(m_ram + errPtr);
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <algorithm>
 #include "Iop_RootCounters.h"
 #include "Iop_Intc.h"
 #include "string_format.h"
@@ -120,50 +121,12 @@ void CRootCounters::Update(unsigned int ticks)
 		COUNTER& counter = m_counter[i];
 		if(i == 2 && counter.mode.en) continue;
 		//Compute count increment
-		unsigned int clockRatio = 1;
-		if(i == 0 && counter.mode.clc)
-		{
-			clockRatio = m_pixelClocks;
-		}
-		if(i == 1 && counter.mode.clc)
-		{
-			clockRatio = m_hsyncClocks;
-		}
-		if(i == 2 && (counter.mode.div != COUNTER_SCALE_1))
-		{
-			assert(counter.mode.div == COUNTER_SCALE_8);
-			clockRatio = 8;
-		}
-		if(
-			((i == 4) || (i == 5)) && 
-			(counter.mode.div != COUNTER_SCALE_1))
-		{
-			switch(counter.mode.div)
-			{
-			case COUNTER_SCALE_8:
-				clockRatio = 8;
-				break;
-			case COUNTER_SCALE_16:
-				clockRatio = 16;
-				break;
-			case COUNTER_SCALE_256:
-				clockRatio = 256;
-				break;
-			}
-		}
+		unsigned int clockRatio = GetCounterClockRatio(i);
 		unsigned int totalTicks = counter.clockRemain + ticks;
 		unsigned int countAdd = totalTicks / clockRatio;
 		counter.clockRemain = totalTicks % clockRatio;
 		//Update count
-		uint32 counterMax = 0;
-		if(g_counterSizes[i] == 16)
-		{
-			counterMax = counter.mode.tar ? static_cast<uint16>(counter.target) : 0xFFFF;
-		}
-		else
-		{
-			counterMax = counter.mode.tar ? counter.target : 0xFFFFFFFF;
-		}
+		uint32 counterMax = GetCounterMax(i);
 		uint32 counterTemp = counter.count + countAdd;
 		if(counterTemp >= counterMax)
 		{
@@ -184,6 +147,74 @@ void CRootCounters::Update(unsigned int ticks)
 	}
 }
 
+uint32 CRootCounters::GetTicksUntilNextInterrupt() const
+{
+	uint64 result = 0xFFFFFFFF;
+	for(unsigned int i = 0; i < MAX_COUNTERS; i++)
+	{
+		const COUNTER& counter = m_counter[i];
+		if(i == 2 && counter.mode.en) continue;
+		if(!(counter.mode.iq1 && counter.mode.iq2)) continue;
+		uint32 counterMax = GetCounterMax(i);
+		//Counter with a null target interrupts on every update, nothing to wait for
+		if(counterMax == 0) continue;
+		uint64 increments = (counter.count < counterMax) ? (counterMax - counter.count) : 1;
+		uint64 ticks = (increments * GetCounterClockRatio(i)) - counter.clockRemain;
+		result = std::min<uint64>(result, ticks);
+	}
+	return static_cast<uint32>(std::max<uint64>(result, 1));
+}
+
+unsigned int CRootCounters::GetCounterClockRatio(unsigned int i) const
+{
+	const COUNTER& counter = m_counter[i];
+	unsigned int clockRatio = 1;
+	if(i == 0 && counter.mode.clc)
+	{
+		clockRatio = m_pixelClocks;
+	}
+	if(i == 1 && counter.mode.clc)
+	{
+		clockRatio = m_hsyncClocks;
+	}
+	if(i == 2 && (counter.mode.div != COUNTER_SCALE_1))
+	{
+		assert(counter.mode.div == COUNTER_SCALE_8);
+		clockRatio = 8;
+	}
+	if(
+		((i == 4) || (i == 5)) && 
+		(counter.mode.div != COUNTER_SCALE_1))
+	{
+		switch(counter.mode.div)
+		{
+		case COUNTER_SCALE_8:
+			clockRatio = 8;
+			break;
+		case COUNTER_SCALE_16:
+			clockRatio = 16;
+			break;
+		case COUNTER_SCALE_256:
+			clockRatio = 256;
+			break;
+		}
+	}
+	return clockRatio;
+}
+
+uint32 CRootCounters::GetCounterMax(unsigned int i) const
+{
+	const COUNTER& counter = m_counter[i];
+	if(g_counterSizes[i] == 16)
+	{
+		return counter.mode.tar ? static_cast<uint16>(counter.target) : 0xFFFF;
+	}
+	else
+	{
+		return counter.mode.tar ? counter.target : 0xFFFFFFFF;
+	}
+}
+
 uint32 CRootCounters::ReadRegister(uint32 address)
 {
 #ifdef _DEBUG
@@ -37,6 +37,9 @@ namespace Iop
 
 		void		Update(unsigned int);
 
+		//Amount of ticks before a counter raises an interrupt, might be a bit early but never late
+		uint32		GetTicksUntilNextInterrupt() const;
+
 		uint32		ReadRegister(uint32);
 		uint32		WriteRegister(uint32, uint32);
 
@@ -108,6 +111,9 @@ namespace Iop
 
 		static unsigned int		GetCounterIdByAddress(uint32);
 
+		unsigned int			GetCounterClockRatio(unsigned int) const;
+		uint32					GetCounterMax(unsigned int) const;
+
 		COUNTER					m_counter[MAX_COUNTERS];
 		Iop::CIntc&				m_intc;
 		unsigned int			m_hsyncClocks;
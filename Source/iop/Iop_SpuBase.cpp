@@ -1,11 +1,20 @@
 #include <cassert>
 #include <cmath>
 #include <climits>
+#include <cstring>
 #include "string_format.h"
 #include "../Log.h"
 #include "../RegisterStateFile.h"
 #include "Iop_SpuBase.h"
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SPU_MIX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SPU_MIX_NEON
+#include <arm_neon.h>
+#endif
+
 using namespace Iop;
 
 #define INIT_SAMPLE_RATE (44100)
@@ -34,6 +43,110 @@ using namespace Iop;
 #define STATE_CHANNEL_REGS_REPEAT			("REPEAT")
 #define STATE_CHANNEL_REGS_CURRENT			("CURRENT")
 
+namespace
+{
+	//Adds a voice's samples scaled by its left and right volumes to an interleaved stereo mix
+	void MixVoice(const int16* voice, unsigned int tickCount, int16 volumeLeft, int16 volumeRight, int32* mix, int32* reverbMix)
+	{
+		unsigned int tick = 0;
+#if defined(SPU_MIX_SSE2)
+		__m128i volumes = _mm_set_epi16(volumeRight, volumeLeft, volumeRight, volumeLeft, volumeRight, volumeLeft, volumeRight, volumeLeft);
+		for(; (tick + 8) <= tickCount; tick += 8)
+		{
+			__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(voice + tick));
+			__m128i stereoSamples[2] =
+			{
+				_mm_unpacklo_epi16(samples, samples),
+				_mm_unpackhi_epi16(samples, samples)
+			};
+			for(unsigned int half = 0; half < 2; half++)
+			{
+				__m128i productsLo = _mm_mullo_epi16(stereoSamples[half], volumes);
+				__m128i productsHi = _mm_mulhi_epi16(stereoSamples[half], volumes);
+				__m128i products[2] =
+				{
+					_mm_srai_epi32(_mm_unpacklo_epi16(productsLo, productsHi), 15),
+					_mm_srai_epi32(_mm_unpackhi_epi16(productsLo, productsHi), 15)
+				};
+				for(unsigned int i = 0; i < 2; i++)
+				{
+					unsigned int offset = (tick * 2) + (half * 8) + (i * 4);
+					__m128i* mixPtr = reinterpret_cast<__m128i*>(mix + offset);
+					_mm_storeu_si128(mixPtr, _mm_add_epi32(_mm_loadu_si128(mixPtr), products[i]));
+					if(reverbMix)
+					{
+						__m128i* reverbMixPtr = reinterpret_cast<__m128i*>(reverbMix + offset);
+						_mm_storeu_si128(reverbMixPtr, _mm_add_epi32(_mm_loadu_si128(reverbMixPtr), products[i]));
+					}
+				}
+			}
+		}
+#elif defined(SPU_MIX_NEON)
+		const int16 volumeValues[4] = { volumeLeft, volumeRight, volumeLeft, volumeRight };
+		int16x4_t volumes = vld1_s16(volumeValues);
+		for(; (tick + 8) <= tickCount; tick += 8)
+		{
+			int16x8_t samples = vld1q_s16(voice + tick);
+			int16x8x2_t stereoSamples = vzipq_s16(samples, samples);
+			int16x4_t quarters[4] =
+			{
+				vget_low_s16(stereoSamples.val[0]), vget_high_s16(stereoSamples.val[0]),
+				vget_low_s16(stereoSamples.val[1]), vget_high_s16(stereoSamples.val[1])
+			};
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				unsigned int offset = (tick * 2) + (i * 4);
+				int32x4_t products = vshrq_n_s32(vmull_s16(quarters[i], volumes), 15);
+				vst1q_s32(mix + offset, vaddq_s32(vld1q_s32(mix + offset), products));
+				if(reverbMix)
+				{
+					vst1q_s32(reverbMix + offset, vaddq_s32(vld1q_s32(reverbMix + offset), products));
+				}
+			}
+		}
+#endif
+		for(; tick < tickCount; tick++)
+		{
+			int32 sampleLeft = (static_cast<int32>(voice[tick]) * volumeLeft) >> 15;
+			int32 sampleRight = (static_cast<int32>(voice[tick]) * volumeRight) >> 15;
+			mix[(tick * 2) + 0] += sampleLeft;
+			mix[(tick * 2) + 1] += sampleRight;
+			if(reverbMix)
+			{
+				reverbMix[(tick * 2) + 0] += sampleLeft;
+				reverbMix[(tick * 2) + 1] += sampleRight;
+			}
+		}
+	}
+
+	void SaturateMix(const int32* mix, int16* output, unsigned int sampleCount)
+	{
+		unsigned int sample = 0;
+#if defined(SPU_MIX_SSE2)
+		for(; (sample + 8) <= sampleCount; sample += 8)
+		{
+			__m128i mixLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mix + sample + 0));
+			__m128i mixHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mix + sample + 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + sample), _mm_packs_epi32(mixLo, mixHi));
+		}
+#elif defined(SPU_MIX_NEON)
+		for(; (sample + 8) <= sampleCount; sample += 8)
+		{
+			int16x4_t mixLo = vqmovn_s32(vld1q_s32(mix + sample + 0));
+			int16x4_t mixHi = vqmovn_s32(vld1q_s32(mix + sample + 4));
+			vst1q_s16(output + sample, vcombine_s16(mixLo, mixHi));
+		}
+#endif
+		for(; sample < sampleCount; sample++)
+		{
+			int32 resultSample = mix[sample];
+			resultSample = std::max<int32>(resultSample, SHRT_MIN);
+			resultSample = std::min<int32>(resultSample, SHRT_MAX);
+			output[sample] = static_cast<int16>(resultSample);
+		}
+	}
+}
+
 bool CSpuBase::g_reverbParamIsAddress[REVERB_PARAM_COUNT] =
 {
 	true,
@@ -559,84 +672,161 @@ void CSpuBase::MixSamples(int32 inputSample, int32 volumeLevel, int16* output)
 	*output = static_cast<int16>(resultSample);
 }
 
-void CSpuBase::Render(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+void CSpuBase::MixOutput(int16* output, const int16* input, unsigned int sampleCount)
 {
-	bool updateReverb = m_reverbEnabled && (m_ctrl & CONTROL_REVERB);
+	unsigned int sample = 0;
+#if defined(SPU_MIX_SSE2)
+	for(; (sample + 8) <= sampleCount; sample += 8)
+	{
+		__m128i outputSamples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(output + sample));
+		__m128i inputSamples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + sample));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output + sample), _mm_adds_epi16(outputSamples, inputSamples));
+	}
+#elif defined(SPU_MIX_NEON)
+	for(; (sample + 8) <= sampleCount; sample += 8)
+	{
+		vst1q_s16(output + sample, vqaddq_s16(vld1q_s16(output + sample), vld1q_s16(input + sample)));
+	}
+#endif
+	for(; sample < sampleCount; sample++)
+	{
+		int32 resultSample = static_cast<int32>(output[sample]) + static_cast<int32>(input[sample]);
+		resultSample = std::max<int32>(resultSample, SHRT_MIN);
+		resultSample = std::min<int32>(resultSample, SHRT_MAX);
+		output[sample] = static_cast<int16>(resultSample);
+	}
+}
 
+void CSpuBase::Render(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+{
 	assert((sampleCount & 0x01) == 0);
 	//ticks are 44100Hz ticks
 	unsigned int ticks = sampleCount / 2;
-	memset(samples, 0, sizeof(int16) * sampleCount);
+	while(ticks != 0)
+	{
+		unsigned int blockTicks = std::min<unsigned int>(ticks, RENDER_BLOCK_TICKS);
+		RenderBlock(samples, blockTicks, sampleRate);
+		samples += blockTicks * 2;
+		ticks -= blockTicks;
+	}
+}
 
-	for(unsigned int j = 0; j < ticks; j++)
+void CSpuBase::RenderBlock(int16* samples, unsigned int ticks, unsigned int sampleRate)
+{
+	bool updateReverb = m_reverbEnabled && (m_ctrl & CONTROL_REVERB);
+
+	//Voices are rendered one at a time for the whole block, channel registers
+	//can't change while rendering so this is equivalent to going tick by tick
+	int32 mix[RENDER_BLOCK_TICKS * 2];
+	int32 reverbMix[RENDER_BLOCK_TICKS * 2];
+	memset(mix, 0, sizeof(int32) * ticks * 2);
+	if(updateReverb)
 	{
-		int16 reverbSample[2] = { 0, 0 };
-		//Update channels
-		for(unsigned int i = 0; i < 24; i++)
+		memset(reverbMix, 0, sizeof(int32) * ticks * 2);
+	}
+
+	for(unsigned int i = 0; i < 24; i++)
+	{
+		CHANNEL& channel(m_channel[i]);
+		if(channel.status == STOPPED) continue;
+		CSampleReader& reader(m_reader[i]);
+		if(channel.status == KEY_ON)
 		{
-			CHANNEL& channel(m_channel[i]);
-			if(channel.status == STOPPED) continue;
-			CSampleReader& reader(m_reader[i]);
-			if(channel.status == KEY_ON)
+			reader.SetParams(channel.address, channel.repeat);
+			reader.ClearEndFlag();
+			channel.status = ATTACK;
+			channel.adsrVolume = 0;
+		}
+		else
+		{
+			if(reader.IsDone())
 			{
-				reader.SetParams(channel.address, channel.repeat);
-				reader.ClearEndFlag();
-				channel.status = ATTACK;
+				channel.status = STOPPED;
 				channel.adsrVolume = 0;
+				continue;
 			}
-			else
+			if(reader.DidChangeRepeat())
 			{
-				if(reader.IsDone())
-				{
-					channel.status = STOPPED;
-					channel.adsrVolume = 0;
-					continue;
-				}
-				if(reader.DidChangeRepeat())
-				{
-					channel.repeat = reader.GetRepeat();
-					reader.ClearDidChangeRepeat();
-				}
-				//Update repeat in case it has been changed externally (needed for FFX)
-				reader.SetRepeat(channel.repeat);
+				channel.repeat = reader.GetRepeat();
+				reader.ClearDidChangeRepeat();
 			}
+			//Update repeat in case it has been changed externally (needed for FFX)
+			reader.SetRepeat(channel.repeat);
+		}
 
-			reader.SetIrqAddress(m_irqAddr);
+		reader.SetIrqAddress(m_irqAddr);
 
-			int16 readSample = 0;
-			reader.SetPitch(m_baseSamplingRate, channel.pitch);
-			reader.GetSamples(&readSample, 1, sampleRate);
-			channel.current = reader.GetCurrent();
+		//Envelope doesn't depend on samples, it tells us how long the voice will last in this block
+		int32 adsrLevels[RENDER_BLOCK_TICKS];
+		unsigned int voiceTicks = UpdateAdsr(channel, adsrLevels, ticks);
 
-			if((m_ctrl & CONTROL_IRQ) && reader.GetIrqPending())
-			{
-				m_irqPending = true;
-			}
+		int16 voiceSamples[RENDER_BLOCK_TICKS];
+		reader.SetPitch(m_baseSamplingRate, channel.pitch);
+		unsigned int readTicks = reader.GetSamples(voiceSamples, voiceTicks, sampleRate);
+		channel.current = reader.GetCurrent();
 
-			reader.ClearIrqPending();
+		//IRQ address is checked by the reader on every block it decodes
+		if((m_ctrl & CONTROL_IRQ) && reader.GetIrqPending())
+		{
+			m_irqPending = true;
+		}
 
-			//Mix samples
-			UpdateAdsr(channel);
-			int32 inputSample = static_cast<int32>(readSample);
-			//Mix adsrVolume
-			{
-				inputSample = (inputSample * static_cast<int32>(channel.adsrVolume >> 16)) / static_cast<int32>(MAX_ADSR_VOLUME >> 16);
-			}
+		reader.ClearIrqPending();
+
+		if(readTicks != voiceTicks)
+		{
+			//Reader reached the end of the sample, voice would have been stopped on the following tick
+			channel.status = STOPPED;
+			channel.adsrVolume = 0;
+		}
 
+		//Mix adsrVolume
+		for(unsigned int tick = 0; tick < readTicks; tick++)
+		{
+			int32 inputSample = (static_cast<int32>(voiceSamples[tick]) * adsrLevels[tick]) / static_cast<int32>(MAX_ADSR_VOLUME >> 16);
+			inputSample = std::max<int32>(inputSample, SHRT_MIN);
+			inputSample = std::min<int32>(inputSample, SHRT_MAX);
+			voiceSamples[tick] = static_cast<int16>(inputSample);
+		}
+
+		//Mix in reverb if enabled for this channel
+		int32* voiceReverbMix = (updateReverb && (m_channelReverb.f & (1 << i))) ? reverbMix : nullptr;
+
+		if(!channel.volumeLeft.mode.mode && !channel.volumeRight.mode.mode)
+		{
+			//Volumes are constant for the whole block
 			channel.volumeLeftAbs  = ComputeChannelVolume(channel.volumeLeft, channel.volumeLeftAbs);
 			channel.volumeRightAbs = ComputeChannelVolume(channel.volumeRight, channel.volumeRightAbs);
 
 			int32 adjustedLeftVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeLeftAbs >> 16) * m_volumeAdjust));
 			int32 adjustedRightVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeRightAbs >> 16) * m_volumeAdjust));
-			MixSamples(inputSample, adjustedLeftVolume, samples + 0);
-			MixSamples(inputSample, adjustedRightVolume, samples + 1);
-			//Mix in reverb if enabled for this channel
-			if(updateReverb && (m_channelReverb.f & (1 << i)))
+			MixVoice(voiceSamples, readTicks, static_cast<int16>(adjustedLeftVolume), static_cast<int16>(adjustedRightVolume), mix, voiceReverbMix);
+		}
+		else
+		{
+			//Sweeping, volumes change on every tick
+			for(unsigned int tick = 0; tick < readTicks; tick++)
 			{
-				MixSamples(inputSample, adjustedLeftVolume, reverbSample + 0);
-				MixSamples(inputSample, adjustedRightVolume, reverbSample + 1);
+				channel.volumeLeftAbs  = ComputeChannelVolume(channel.volumeLeft, channel.volumeLeftAbs);
+				channel.volumeRightAbs = ComputeChannelVolume(channel.volumeRight, channel.volumeRightAbs);
+
+				int32 adjustedLeftVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeLeftAbs >> 16) * m_volumeAdjust));
+				int32 adjustedRightVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeRightAbs >> 16) * m_volumeAdjust));
+				MixVoice(voiceSamples + tick, 1, static_cast<int16>(adjustedLeftVolume), static_cast<int16>(adjustedRightVolume),
+					mix + (tick * 2), voiceReverbMix ? (voiceReverbMix + (tick * 2)) : nullptr);
 			}
 		}
+	}
+
+	SaturateMix(mix, samples, ticks * 2);
+
+	for(unsigned int j = 0; j < ticks; j++)
+	{
+		int16 reverbSample[2] = { 0, 0 };
+		if(updateReverb)
+		{
+			SaturateMix(reverbMix + (j * 2), reverbSample, 2);
+		}
 
 		if(!m_blockReader.CanReadSamples() && (m_blockWritePtr == SOUND_INPUT_DATA_SIZE))
 		{
@@ -825,111 +1015,137 @@ float CSpuBase::GetReverbCoef(unsigned int registerId) const
 	return static_cast<float>(value) / static_cast<float>(0x8000);
 }
 
-void CSpuBase::UpdateAdsr(CHANNEL& channel)
+unsigned int CSpuBase::UpdateAdsr(CHANNEL& channel, int32* levels, unsigned int tickCount)
 {
-	static unsigned int logIndex[8] = { 0, 4, 6, 8, 9, 10, 11, 12 };
+	//Rates only change when the envelope enters another phase, each phase is
+	//processed as a segment. Returns the number of ticks before the voice stops.
+	static const unsigned int logIndex[8] = { 0, 4, 6, 8, 9, 10, 11, 12 };
 	int32 currentAdsrLevel = channel.adsrVolume;
-	if(channel.status == ATTACK)
+	unsigned int tick = 0;
+	while(tick < tickCount)
 	{
-		if(channel.adsrLevel.attackMode == 0)
+		if(channel.status == ATTACK)
 		{
-			//Linear mode
-			currentAdsrLevel += GetAdsrDelta((channel.adsrLevel.attackRate ^ 0x7F) - 0x10);
-		}
-		else
-		{
-			if(currentAdsrLevel < 0x60000000)
+			uint32 delta = GetAdsrDelta((channel.adsrLevel.attackRate ^ 0x7F) - 0x10);
+			//Exponential mode increases slower when getting near the top
+			uint32 highDelta = (channel.adsrLevel.attackMode == 0) ? delta : GetAdsrDelta((channel.adsrLevel.attackRate ^ 0x7F) - 0x18);
+			for(; tick < tickCount; tick++)
 			{
-				currentAdsrLevel += GetAdsrDelta((channel.adsrLevel.attackRate ^ 0x7F) - 0x10);
-			}
-			else
-			{
-				currentAdsrLevel += GetAdsrDelta((channel.adsrLevel.attackRate ^ 0x7F) - 0x18);
+				currentAdsrLevel += (currentAdsrLevel < 0x60000000) ? delta : highDelta;
+				//Terminasion condition
+				if(currentAdsrLevel < 0)
+				{
+					currentAdsrLevel = MAX_ADSR_VOLUME;
+					channel.status = DECAY;
+					levels[tick++] = static_cast<uint32>(currentAdsrLevel) >> 16;
+					break;
+				}
+				levels[tick] = static_cast<uint32>(currentAdsrLevel) >> 16;
 			}
 		}
-		//Terminasion condition
-		if(currentAdsrLevel < 0)
+		else if(channel.status == DECAY)
 		{
-			currentAdsrLevel = MAX_ADSR_VOLUME;
-			channel.status = DECAY;
-		}
-	}
-	else if(channel.status == DECAY)
-	{
-		unsigned int decayType = (static_cast<uint32>(currentAdsrLevel) >> 28) & 0x7;
-		currentAdsrLevel -= GetAdsrDelta((4 * (channel.adsrLevel.decayRate ^ 0x1F)) - 0x18 + logIndex[decayType]);
-		//Terminasion condition
-		if(static_cast<unsigned int>((currentAdsrLevel >> 27) & 0xF) <= channel.adsrLevel.sustainLevel)
-		{
-			channel.status = SUSTAIN;
+			unsigned int deltaIndex = (4 * (channel.adsrLevel.decayRate ^ 0x1F)) - 0x18;
+			for(; tick < tickCount; tick++)
+			{
+				unsigned int decayType = (static_cast<uint32>(currentAdsrLevel) >> 28) & 0x7;
+				currentAdsrLevel -= GetAdsrDelta(deltaIndex + logIndex[decayType]);
+				levels[tick] = static_cast<uint32>(currentAdsrLevel) >> 16;
+				//Terminasion condition
+				if(static_cast<unsigned int>((currentAdsrLevel >> 27) & 0xF) <= channel.adsrLevel.sustainLevel)
+				{
+					channel.status = SUSTAIN;
+					tick++;
+					break;
+				}
+			}
 		}
-	}
-	else if(channel.status == SUSTAIN)
-	{
-		if(channel.adsrRate.sustainDirection == 0)
+		else if(channel.status == SUSTAIN)
 		{
-			//Increment
-			if(channel.adsrRate.sustainMode == 0)
+			if(channel.adsrRate.sustainDirection == 0)
 			{
-				currentAdsrLevel += GetAdsrDelta((channel.adsrRate.sustainRate ^ 0x7F) - 0x10);
+				//Increment
+				uint32 delta = GetAdsrDelta((channel.adsrRate.sustainRate ^ 0x7F) - 0x10);
+				uint32 highDelta = (channel.adsrRate.sustainMode == 0) ? delta : GetAdsrDelta((channel.adsrRate.sustainRate ^ 0x7F) - 0x18);
+				for(; (tick < tickCount) && (currentAdsrLevel != MAX_ADSR_VOLUME); tick++)
+				{
+					currentAdsrLevel += (currentAdsrLevel < 0x60000000) ? delta : highDelta;
+					if(currentAdsrLevel < 0)
+					{
+						currentAdsrLevel = MAX_ADSR_VOLUME;
+					}
+					levels[tick] = static_cast<uint32>(currentAdsrLevel) >> 16;
+				}
 			}
 			else
 			{
-				if(currentAdsrLevel < 0x60000000)
-				{
-					currentAdsrLevel += GetAdsrDelta((channel.adsrRate.sustainRate ^ 0x7F) - 0x10);
-				}
-				else
+				//Decrement
+				for(; (tick < tickCount) && (currentAdsrLevel != 0); tick++)
 				{
-					currentAdsrLevel += GetAdsrDelta((channel.adsrRate.sustainRate ^ 0x7F) - 0x18);
+					if(channel.adsrRate.sustainMode == 0)
+					{
+						//Linear
+						currentAdsrLevel -= GetAdsrDelta((channel.adsrRate.sustainRate ^ 0x7F) - 0x0F);
+					}
+					else
+					{
+						unsigned int sustainType = (static_cast<uint32>(currentAdsrLevel) >> 28) & 0x7;
+						currentAdsrLevel -= GetAdsrDelta((channel.adsrRate.sustainRate ^ 0x7F) - 0x1B + logIndex[sustainType]);
+					}
+
+					if(currentAdsrLevel < 0)
+					{
+						currentAdsrLevel = 0;
+					}
+					levels[tick] = static_cast<uint32>(currentAdsrLevel) >> 16;
 				}
 			}
 
-			if(currentAdsrLevel < 0)
+			//Level has reached its limit and will stay there until the voice is released
+			for(; tick < tickCount; tick++)
 			{
-				currentAdsrLevel = MAX_ADSR_VOLUME;
+				levels[tick] = static_cast<uint32>(currentAdsrLevel) >> 16;
 			}
 		}
-		else
+		else if(channel.status == RELEASE)
 		{
-			//Decrement
-			if(channel.adsrRate.sustainMode == 0)
-			{
-				//Linear
-				currentAdsrLevel -= GetAdsrDelta((channel.adsrRate.sustainRate ^ 0x7F) - 0x0F);
-			}
-			else
+			for(; tick < tickCount; tick++)
 			{
-				unsigned int sustainType = (static_cast<uint32>(currentAdsrLevel) >> 28) & 0x7;
-				currentAdsrLevel -= GetAdsrDelta((channel.adsrRate.sustainRate ^ 0x7F) - 0x1B + logIndex[sustainType]);
-			}
+				if(channel.adsrRate.releaseMode == 0)
+				{
+					//Linear
+					currentAdsrLevel -= GetAdsrDelta((4 * (channel.adsrRate.releaseRate ^ 0x1F)) - 0x0C);
+				}
+				else
+				{
+					unsigned int releaseType = (static_cast<uint32>(currentAdsrLevel) >> 28) & 0x7;
+					currentAdsrLevel -= GetAdsrDelta((4 * (channel.adsrRate.releaseRate ^ 0x1F)) - 0x18 + logIndex[releaseType]);
+				}
 
-			if(currentAdsrLevel < 0)
-			{
-				currentAdsrLevel = 0;
+				if(currentAdsrLevel < 0)
+				{
+					currentAdsrLevel = 0;
+					channel.status = STOPPED;
+					levels[tick++] = 0;
+					break;
+				}
+				levels[tick] = static_cast<uint32>(currentAdsrLevel) >> 16;
 			}
 		}
-	}
-	else if(channel.status == RELEASE)
-	{
-		if(channel.adsrRate.releaseMode == 0)
+		else if(channel.status == STOPPED)
 		{
-			//Linear
-			currentAdsrLevel -= GetAdsrDelta((4 * (channel.adsrRate.releaseRate ^ 0x1F)) - 0x0C);
+			break;
 		}
 		else
 		{
-			unsigned int releaseType = (static_cast<uint32>(currentAdsrLevel) >> 28) & 0x7;
-			currentAdsrLevel -= GetAdsrDelta((4 * (channel.adsrRate.releaseRate ^ 0x1F)) - 0x18 + logIndex[releaseType]);
-		}
-
-		if(currentAdsrLevel < 0)
-		{
-			currentAdsrLevel = 0;
-			channel.status = STOPPED;
+			for(; tick < tickCount; tick++)
+			{
+				levels[tick] = static_cast<uint32>(currentAdsrLevel) >> 16;
+			}
 		}
 	}
 	channel.adsrVolume = static_cast<uint32>(currentAdsrLevel);
+	return tick;
 }
 
 ///////////////////////////////////////////////////////
@@ -984,12 +1200,16 @@ void CSpuBase::CSampleReader::SetPitch(uint32 baseSamplingRate, uint16 pitch)
 	m_srcSamplingRate = baseSamplingRate * pitch / 4096;
 }
 
-void CSpuBase::CSampleReader::GetSamples(int16* samples, unsigned int sampleCount, unsigned int dstSamplingRate)
+unsigned int CSpuBase::CSampleReader::GetSamples(int16* samples, unsigned int sampleCount, unsigned int dstSamplingRate)
 {
+	//Stops after the end of the sample has been decoded, returns the number of samples read.
+	//First sample is always read, caller checks IsDone before starting a new block.
 	for(unsigned int i = 0; i < sampleCount; i++)
 	{
+		if((i != 0) && m_done) return i;
 		samples[i] = GetSample(dstSamplingRate);
 	}
+	return sampleCount;
 }
 
 int16 CSpuBase::CSampleReader::GetSample(unsigned int dstSamplingRate)
@@ -216,6 +216,9 @@ namespace Iop
 
 		void			Render(int16*, unsigned int, unsigned int);
 
+		//Adds another core's output to a rendered buffer, with saturation
+		static void		MixOutput(int16*, const int16*, unsigned int);
+
 		static bool		g_reverbParamIsAddress[REVERB_PARAM_COUNT];
 
 	private:
@@ -227,6 +230,11 @@ namespace Iop
 			SOUND_INPUT_DATA_SAMPLES    = (SOUND_INPUT_DATA_SIZE / 4),
 		};
 
+		enum
+		{
+			RENDER_BLOCK_TICKS = 64,
+		};
+
 		class CSampleReader
 		{
 		public:
@@ -238,7 +246,7 @@ namespace Iop
 
 			void			SetParams(uint32, uint32);
 			void			SetPitch(uint32, uint16);
-			void			GetSamples(int16*, unsigned int, unsigned int);
+			unsigned int	GetSamples(int16*, unsigned int, unsigned int);
 			uint32			GetRepeat() const;
 			void			SetRepeat(uint32);
 			uint32			GetCurrent() const;
@@ -305,7 +313,8 @@ namespace Iop
 			MAX_ADSR_VOLUME = 0x7FFFFFFF,
 		};
 
-		void				UpdateAdsr(CHANNEL&);
+		void				RenderBlock(int16*, unsigned int, unsigned int);
+		unsigned int		UpdateAdsr(CHANNEL&, int32*, unsigned int);
 		uint32				GetAdsrDelta(unsigned int) const;
 		float				GetReverbSample(uint32) const;
 		void				SetReverbSample(uint32, float);
@@ -31,7 +31,6 @@ CSubSystem::CSubSystem(bool ps2Mode)
 #endif
 , m_cpuArch(MIPS_REGSIZE_32)
 , m_copScu(MIPS_REGSIZE_32)
-, m_dmaUpdateTicks(0)
 {
 	//Read memory map
 	m_cpu.m_pMemoryMap->InsertReadMap((0 * IOP_RAM_SIZE),    (0 * IOP_RAM_SIZE) + IOP_RAM_SIZE - 1,      m_ram,                                                                  0x01);
@@ -59,6 +58,21 @@ CSubSystem::CSubSystem(bool ps2Mode)
 	m_cpu.m_pCOP[0] = &m_copScu;
 	m_cpu.m_pAddrTranslator = &CMIPS::TranslateAddress64;
 
+	//Only memory and status registers that can be read without side effects and that are
+	//modified through processed events can be waited on. Counters change on their own and
+	//reading some of the other registers consumes data (ie.: SIO2 FIFOs).
+	m_executor.SetBusyWaitAddressHandler(
+		[] (uint32 address)
+		{
+			return
+				(address < (IOP_RAM_SIZE * 4)) ||
+				((address >= IOP_SCRATCH_ADDR) && (address < (IOP_SCRATCH_ADDR + IOP_SCRATCH_SIZE))) ||
+				((address >= CDmac::DMAC_ZONE1_START) && (address <= CDmac::DMAC_ZONE1_END)) ||
+				((address >= CDmac::DMAC_ZONE2_START) && (address <= CDmac::DMAC_ZONE2_END)) ||
+				((address >= CIntc::ADDR_BEGIN) && (address <= CIntc::ADDR_END));
+		}
+	);
+
 	m_dmac.SetReceiveFunction(4, bind(&CSpuBase::ReceiveDma, &m_spuCore0, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3));
 	m_dmac.SetReceiveFunction(8, bind(&CSpuBase::ReceiveDma, &m_spuCore1, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3));
 }
@@ -76,6 +90,14 @@ void CSubSystem::SetBios(const BiosBasePtr& bios)
 	m_bios = bios;
 }
 
+void CSubSystem::SetFastMemoryEnabled(bool enabled)
+{
+	//RAM is mirrored 4 times at the beginning of the address space
+	m_cpu.m_fastMemory = enabled ? m_ram : nullptr;
+	m_cpu.m_fastMemorySize = IOP_RAM_SIZE * 4;
+	m_cpu.m_fastMemoryMask = IOP_RAM_SIZE - 1;
+}
+
 void CSubSystem::NotifyVBlankStart()
 {
 	m_bios->NotifyVBlankStart();
@@ -136,8 +158,6 @@ void CSubSystem::Reset()
 
 	m_cpu.m_Comments.RemoveTags();
 	m_cpu.m_Functions.RemoveTags();
-
-	m_dmaUpdateTicks = 0;
 }
 
 uint32 CSubSystem::ReadIoRegister(uint32 address)
@@ -235,7 +255,7 @@ uint32 CSubSystem::WriteIoRegister(uint32 address, uint32 value)
 
 bool CSubSystem::IsCpuIdle()
 {
-	if(m_bios->IsIdle())
+	if(m_bios->IsIdle() || m_executor.IsBusyWaiting())
 	{
 		return true;
 	}
@@ -254,16 +274,8 @@ bool CSubSystem::IsCpuIdle()
 
 void CSubSystem::CountTicks(int ticks)
 {
-	static int g_dmaUpdateDelay = 10000;
 	m_counters.Update(ticks);
 	m_bios->CountTicks(ticks);
-	m_dmaUpdateTicks += ticks;
-	if(m_dmaUpdateTicks >= g_dmaUpdateDelay)
-	{
-		m_dmac.ResumeDma(4);
-		m_dmac.ResumeDma(8);
-		m_dmaUpdateTicks -= g_dmaUpdateDelay;
-	}
 	{
 		bool irqPending = false;
 		irqPending |= m_spuCore0.GetIrqPending();
@@ -279,6 +291,12 @@ void CSubSystem::CountTicks(int ticks)
 	}
 }
 
+void CSubSystem::ResumeDma()
+{
+	m_dmac.ResumeDma(4);
+	m_dmac.ResumeDma(8);
+}
+
 int CSubSystem::ExecuteCpu(int quota)
 {
 	int executed = 0;
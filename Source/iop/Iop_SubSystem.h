@@ -20,6 +20,11 @@ namespace Iop
 	class CSubSystem
 	{
 	public:
+		enum
+		{
+			DMA_UPDATE_TICKS = 10000,
+		};
+
 							CSubSystem(bool ps2Mode);
 		virtual				~CSubSystem();
 
@@ -28,8 +33,14 @@ namespace Iop
 		bool				IsCpuIdle();
 		void				CountTicks(int);
 
+		//Lets stalled DMA channels proceed, expected to be called every DMA_UPDATE_TICKS
+		void				ResumeDma();
+
 		void				SetBios(const BiosBasePtr&);
 
+		//Only affects blocks compiled afterwards, should be set right after a reset
+		void				SetFastMemoryEnabled(bool);
+
 		void				NotifyVBlankStart();
 		void				NotifyVBlankEnd();
 
@@ -64,7 +75,5 @@ namespace Iop
 
 		uint32				ReadIoRegister(uint32);
 		uint32				WriteIoRegister(uint32, uint32);
-
-		int					m_dmaUpdateTicks;
 	};
 }
@@ -0,0 +1,89 @@
+#include <cassert>
+#include <cstring>
+#include "GSH_SoftwareAndroid.h"
+
+CGSH_SoftwareAndroid::CGSH_SoftwareAndroid(ANativeWindow* window)
+: m_window(window)
+{
+
+}
+
+CGSH_SoftwareAndroid::~CGSH_SoftwareAndroid()
+{
+	
+}
+
+CGSHandler::FactoryFunction CGSH_SoftwareAndroid::GetFactoryFunction(ANativeWindow* window)
+{
+	return [window]() { return new CGSH_SoftwareAndroid(window); };
+}
+
+void CGSH_SoftwareAndroid::InitializeImpl()
+{
+	SetupWindow();
+	CGSH_Software::InitializeImpl();
+}
+
+void CGSH_SoftwareAndroid::SetWindow(ANativeWindow* window)
+{
+	m_window = window;
+	SendGSCall(
+		[this] ()
+		{
+			SetupWindow();
+		},
+		true
+	);
+}
+
+void CGSH_SoftwareAndroid::SetupWindow()
+{
+	//Pixels are 0xXXBBGGRR, which is what RGBX_8888 windows take
+	auto result = ANativeWindow_setBuffersGeometry(m_window, 0, 0, WINDOW_FORMAT_RGBX_8888);
+	assert(result == 0);
+	
+	PRESENTATION_PARAMS presentationParams;
+	presentationParams.mode 			= PRESENTATION_MODE_FIT;
+	presentationParams.windowWidth 		= ANativeWindow_getWidth(m_window);
+	presentationParams.windowHeight 	= ANativeWindow_getHeight(m_window);
+	
+	SetPresentationParams(presentationParams);
+}
+
+void CGSH_SoftwareAndroid::PresentFramebuffer()
+{
+	uint32 width = 0;
+	uint32 height = 0;
+	ReadDisplayFramebuffer(m_pixels, width, height);
+	
+	ANativeWindow_Buffer buffer = {};
+	if(ANativeWindow_lock(m_window, &buffer, nullptr) != 0) return;
+	
+	auto dstPixels = reinterpret_cast<uint32*>(buffer.bits);
+	for(int32 y = 0; y < buffer.height; y++)
+	{
+		memset(dstPixels + (y * buffer.stride), 0, buffer.width * sizeof(uint32));
+	}
+	
+	//No scaler here, nearest neighbour sampling of the frame in the presentation rectangle
+	auto rect = GetPresentationRect(width, height);
+	if((width != 0) && (height != 0) && (rect.width != 0) && (rect.height != 0))
+	{
+		for(uint32 y = 0; y < rect.height; y++)
+		{
+			int32 dstY = rect.y + static_cast<int32>(y);
+			if((dstY < 0) || (dstY >= buffer.height)) continue;
+			uint32 srcY = (y * height) / rect.height;
+			auto srcRow = m_pixels.data() + (srcY * width);
+			auto dstRow = dstPixels + (dstY * buffer.stride);
+			for(uint32 x = 0; x < rect.width; x++)
+			{
+				int32 dstX = rect.x + static_cast<int32>(x);
+				if((dstX < 0) || (dstX >= buffer.width)) continue;
+				dstRow[dstX] = srcRow[(x * width) / rect.width];
+			}
+		}
+	}
+	
+	ANativeWindow_unlockAndPost(m_window);
+}
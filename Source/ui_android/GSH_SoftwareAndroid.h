@@ -0,0 +1,25 @@
+#pragma once
+
+#include <android/native_window.h>
+#include "../gs/GSH_Software.h"
+
+class CGSH_SoftwareAndroid : public CGSH_Software
+{
+public:
+							CGSH_SoftwareAndroid(ANativeWindow*);
+	virtual					~CGSH_SoftwareAndroid();
+	
+	void					SetWindow(ANativeWindow*);
+	
+	static FactoryFunction 	GetFactoryFunction(ANativeWindow*);
+	
+protected:
+	void					InitializeImpl() override;
+	void					PresentFramebuffer() override;
+	
+private:
+	void					SetupWindow();
+	
+	ANativeWindow*	 		m_window = nullptr;
+	FramebufferPixelArray	m_pixels;
+};
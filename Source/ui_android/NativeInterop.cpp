@@ -13,6 +13,7 @@
 #include "../gs/GSH_Null.h"
 #include "NativeShared.h"
 #include "GSH_OpenGLAndroid.h"
+#include "GSH_SoftwareAndroid.h"
 #include "SH_OpenSL.h"
 #include "StatsManager.h"
 
@@ -66,11 +67,13 @@ extern "C" JNIEXPORT void JNICALL Java_com_virtualapplications_play_NativeIntero
 	g_virtualMachine = new CPS2VM();
 	g_virtualMachine->Initialize();
 	g_virtualMachine->CreatePadHandler(CPH_Generic::GetFactoryFunction());
+	g_virtualMachine->AudioStatsUpdated.connect(boost::bind(&CStatsManager::OnAudioStatsUpdated, &CStatsManager::GetInstance(), _1));
 #ifdef PROFILE
-	g_virtualMachine->ProfileFrameDone.connect(boost::bind(&CStatsManager::OnProfileFrameDone, &CStatsManager::GetInstance(), _1));
+	g_virtualMachine->ProfileFrameDone.connect(boost::bind(&CStatsManager::OnProfileFrameDone, &CStatsManager::GetInstance(), boost::ref(*g_virtualMachine), _1));
 #endif
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_AUDIO_ENABLEOUTPUT, true);
 	CGSH_OpenGL::RegisterPreferences();
+	CGSH_Software::RegisterPreferences();
 }
 
 extern "C" JNIEXPORT jboolean JNICALL Java_com_virtualapplications_play_NativeInterop_isVirtualMachineCreated(JNIEnv* env, jobject obj)
@@ -117,7 +120,7 @@ extern "C" JNIEXPORT void JNICALL Java_com_virtualapplications_play_NativeIntero
 	if(g_virtualMachine == nullptr) return;
 	Framework::PathUtils::EnsurePathExists(GetStateDirectoryPath());
 	auto stateFilePath = GenerateStatePath(slot);
-	if(g_virtualMachine->SaveState(stateFilePath.string().c_str()) != 0)
+	if(!g_virtualMachine->SaveState(stateFilePath.string().c_str()).get())
 	{
 		jclass exceptionClass = env->FindClass("java/lang/Exception");
 		env->ThrowNew(exceptionClass, "SaveState failed.");
@@ -166,13 +169,27 @@ extern "C" JNIEXPORT void JNICALL Java_com_virtualapplications_play_NativeIntero
 	auto gsHandler = g_virtualMachine->GetGSHandler();
 	if(gsHandler == nullptr)
 	{
-		g_virtualMachine->CreateGSHandler(CGSH_OpenGLAndroid::GetFactoryFunction(nativeWindow));
+		if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_SOFTWARE_ENABLED))
+		{
+			g_virtualMachine->CreateGSHandler(CGSH_SoftwareAndroid::GetFactoryFunction(nativeWindow));
+		}
+		else
+		{
+			g_virtualMachine->CreateGSHandler(CGSH_OpenGLAndroid::GetFactoryFunction(nativeWindow));
+		}
 		g_virtualMachine->m_ee->m_gs->OnNewFrame.connect(
 			boost::bind(&CStatsManager::OnNewFrame, &CStatsManager::GetInstance(), _1));
 	}
 	else
 	{
-		static_cast<CGSH_OpenGLAndroid*>(gsHandler)->SetWindow(nativeWindow);
+		if(auto softwareGsHandler = dynamic_cast<CGSH_SoftwareAndroid*>(gsHandler))
+		{
+			softwareGsHandler->SetWindow(nativeWindow);
+		}
+		else
+		{
+			static_cast<CGSH_OpenGLAndroid*>(gsHandler)->SetWindow(nativeWindow);
+		}
 	}
 }
 
@@ -137,7 +137,7 @@ void CSH_OpenSL::Write(int16* buffer, unsigned int sampleCount, unsigned int)
 
 bool CSH_OpenSL::HasFreeBuffers()
 {
-	return false;
+	return m_bufferCount != 0;
 }
 
 void CSH_OpenSL::RecycleBuffers()
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include "../../tools/PsfPlayer/Source/SoundHandler.h"
 #include <SLES/OpenSLES.h>
 #include <SLES/OpenSLES_Android.h>
@@ -38,5 +39,5 @@ private:
 	SLPlayItf                        m_playerPlay = nullptr;
 	SLAndroidSimpleBufferQueueItf    m_playerQueue = nullptr;
 	
-	uint32    m_bufferCount = BUFFER_COUNT;
+	std::atomic<uint32>    m_bufferCount = { BUFFER_COUNT };
 };
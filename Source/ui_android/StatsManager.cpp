@@ -1,5 +1,6 @@
 #include <jni.h>
 #include "StatsManager.h"
+#include "../PS2VM.h"
 #include "string_format.h"
 
 void CStatsManager::OnNewFrame(uint32 drawCalls)
@@ -21,6 +22,18 @@ uint32 CStatsManager::GetDrawCalls()
 	return m_drawCalls;
 }
 
+uint32 CStatsManager::GetAudioLatency()
+{
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+	return m_audioLatency;
+}
+
+uint32 CStatsManager::GetAudioUnderruns()
+{
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+	return m_audioUnderruns;
+}
+
 #ifdef PROFILE
 
 std::string CStatsManager::GetProfilingInfo()
@@ -59,6 +72,17 @@ std::string CStatsManager::GetProfilingInfo()
 	return result;
 }
 
+std::string CStatsManager::GetFrameTimeInfo()
+{
+	std::lock_guard<std::mutex> profileZonesLock(m_profilerZonesMutex);
+
+	static const uint64 timeScale = 1000000;
+
+	float avgFrameTime = (m_frameTimeCount != 0) ? static_cast<double>(m_totalFrameTime) / static_cast<double>(m_frameTimeCount * timeScale) : 0;
+	float maxFrameTime = static_cast<double>(m_maxFrameTime) / static_cast<double>(timeScale);
+	return string_format("Frame Time: %6.2fms (max %6.2fms, VU1 thread %s)", avgFrameTime, maxFrameTime, m_vu1Threaded ? "on" : "off");
+}
+
 #endif
 
 void CStatsManager::ClearStats()
@@ -66,14 +90,33 @@ void CStatsManager::ClearStats()
 	std::lock_guard<std::mutex> statsLock(m_statsMutex);
 	m_frames = 0;
 	m_drawCalls = 0;
+	m_audioUnderruns = 0;
 #ifdef PROFILE
-	for(auto& zonePair : m_profilerZones) { zonePair.second.currentValue = 0; }
+	{
+		std::lock_guard<std::mutex> profileZonesLock(m_profilerZonesMutex);
+		for(auto& zonePair : m_profilerZones) { zonePair.second.currentValue = 0; }
+		m_frameTimeCount = 0;
+		m_totalFrameTime = 0;
+		m_maxFrameTime = 0;
+	}
 #endif
 }
 
+void CStatsManager::OnAudioStatsUpdated(const CAudioStream::STATS& stats)
+{
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+	m_audioLatency = stats.latency;
+	//Stream counts underruns since it was started, only keep new ones
+	if(stats.underrunCount >= m_audioUnderrunTotal)
+	{
+		m_audioUnderruns += stats.underrunCount - m_audioUnderrunTotal;
+	}
+	m_audioUnderrunTotal = stats.underrunCount;
+}
+
 #ifdef PROFILE
 
-void CStatsManager::OnProfileFrameDone(const CProfiler::ZoneArray& zones)
+void CStatsManager::OnProfileFrameDone(CPS2VM& virtualMachine, const CProfiler::ZoneArray& zones)
 {
 	std::lock_guard<std::mutex> profileZonesLock(m_profilerZonesMutex);
 
@@ -87,6 +130,12 @@ void CStatsManager::OnProfileFrameDone(const CProfiler::ZoneArray& zones)
 		}
 		zoneInfo.maxValue = std::max<uint64>(zoneInfo.maxValue, zone.totalTime);
 	}
+
+	auto cpuUtilisation = virtualMachine.GetCpuUtilisationInfo();
+	m_frameTimeCount += cpuUtilisation.frameCount;
+	m_totalFrameTime += cpuUtilisation.totalFrameTime;
+	m_maxFrameTime = std::max<uint64>(m_maxFrameTime, cpuUtilisation.maxFrameTime);
+	m_vu1Threaded = virtualMachine.m_ee->m_vpu1->IsThreaded();
 }
 
 #endif
@@ -101,6 +150,16 @@ extern "C" JNIEXPORT jint JNICALL Java_com_virtualapplications_play_StatsManager
 	return CStatsManager::GetInstance().GetDrawCalls();
 }
 
+extern "C" JNIEXPORT jint JNICALL Java_com_virtualapplications_play_StatsManager_getAudioLatency(JNIEnv* env, jobject obj)
+{
+	return CStatsManager::GetInstance().GetAudioLatency();
+}
+
+extern "C" JNIEXPORT jint JNICALL Java_com_virtualapplications_play_StatsManager_getAudioUnderruns(JNIEnv* env, jobject obj)
+{
+	return CStatsManager::GetInstance().GetAudioUnderruns();
+}
+
 extern "C" JNIEXPORT void JNICALL Java_com_virtualapplications_play_StatsManager_clearStats(JNIEnv* env, jobject obj)
 {
 	CStatsManager::GetInstance().ClearStats();
@@ -120,6 +179,7 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_virtualapplications_play_StatsMana
 	std::string info;
 #ifdef PROFILE
 	info = CStatsManager::GetInstance().GetProfilingInfo();
+	info += CStatsManager::GetInstance().GetFrameTimeInfo() + "\r\n";
 #endif
 	jstring result = env->NewStringUTF(info.c_str());
 	return result;
@@ -5,6 +5,9 @@
 #include "Types.h"
 #include "Singleton.h"
 #include "../Profiler.h"
+#include "../AudioStream.h"
+
+class CPS2VM;
 
 class CStatsManager : public CSingleton<CStatsManager>
 {
@@ -13,14 +16,19 @@ public:
 	
 	uint32			GetFrames();
 	uint32			GetDrawCalls();
+	uint32			GetAudioLatency();
+	uint32			GetAudioUnderruns();
 #ifdef PROFILE
 	std::string		GetProfilingInfo();
+	std::string		GetFrameTimeInfo();
 #endif
 
 	void			ClearStats();
 	
+	void			OnAudioStatsUpdated(const CAudioStream::STATS&);
+
 #ifdef PROFILE
-	void			OnProfileFrameDone(const CProfiler::ZoneArray&);
+	void			OnProfileFrameDone(CPS2VM&, const CProfiler::ZoneArray&);
 #endif
 	
 private:
@@ -28,6 +36,9 @@ private:
 	
 	uint32			m_frames = 0;
 	uint32			m_drawCalls = 0;
+	uint32			m_audioLatency = 0;
+	uint32			m_audioUnderruns = 0;
+	uint32			m_audioUnderrunTotal = 0;
 	
 #ifdef PROFILE
 	struct ZONEINFO
@@ -41,5 +52,11 @@ private:
 
 	std::mutex				m_profilerZonesMutex;
 	ZoneMap					m_profilerZones;
+
+	//Frame times reported by the VM since the last ClearStats
+	uint32					m_frameTimeCount = 0;
+	uint64					m_totalFrameTime = 0;
+	uint64					m_maxFrameTime = 0;
+	bool					m_vu1Threaded = false;
 #endif
 };
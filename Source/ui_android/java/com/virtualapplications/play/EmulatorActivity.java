@@ -251,7 +251,9 @@ public class EmulatorActivity extends Activity
 					int frames = StatsManager.getFrames();
 					int drawCalls = StatsManager.getDrawCalls();
 					int dcpf = (frames != 0) ? (drawCalls / frames) : 0;
-					_fpsTextView.setText(String.format("%d f/s, %d dc/f", frames, dcpf));
+					int audioLatency = StatsManager.getAudioLatency();
+					int audioUnderruns = StatsManager.getAudioUnderruns();
+					_fpsTextView.setText(String.format("%d f/s, %d dc/f, %d ms/%d ur", frames, dcpf, audioLatency, audioUnderruns));
 					if(StatsManager.isProfiling())
 					{
 						String profilingInfo = StatsManager.getProfilingInfo();
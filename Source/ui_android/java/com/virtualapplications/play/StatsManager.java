@@ -9,6 +9,8 @@ public class StatsManager
 
 	public static native int getFrames();
 	public static native int getDrawCalls();
+	public static native int getAudioLatency();
+	public static native int getAudioUnderruns();
 	public static native void clearStats();
 	
 	public static native boolean isProfiling();
@@ -1,6 +1,7 @@
 #import "AppDelegate.h"
 #import "EmulatorViewController.h"
 #include "GSH_OpenGL.h"
+#include "../gs/GSH_Software.h"
 
 @interface AppDelegate ()
 
@@ -12,6 +13,7 @@
 {
 	[EmulatorViewController registerPreferences];
 	CGSH_OpenGL::RegisterPreferences();
+	CGSH_Software::RegisterPreferences();
 	return YES;
 }
 
@@ -6,6 +6,7 @@
 #include "../AppConfig.h"
 #include "PreferenceDefs.h"
 #include "GSH_OpenGLiOS.h"
+#include "GSH_SoftwareiOS.h"
 #include "IosUtils.h"
 #include "PH_Generic.h"
 #include "../../tools/PsfPlayer/Source/SH_OpenAL.h"
@@ -58,7 +59,14 @@ CPS2VM* g_virtualMachine = nullptr;
 	assert(g_virtualMachine == nullptr);
 	g_virtualMachine = new CPS2VM();
 	g_virtualMachine->Initialize();
-	g_virtualMachine->CreateGSHandler(CGSH_OpenGLiOS::GetFactoryFunction((CAEAGLLayer*)self.view.layer));
+	if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_SOFTWARE_ENABLED))
+	{
+		g_virtualMachine->CreateGSHandler(CGSH_SoftwareiOS::GetFactoryFunction((CAEAGLLayer*)self.view.layer));
+	}
+	else
+	{
+		g_virtualMachine->CreateGSHandler(CGSH_OpenGLiOS::GetFactoryFunction((CAEAGLLayer*)self.view.layer));
+	}
 
 	g_virtualMachine->CreatePadHandler(CPH_Generic::GetFactoryFunction());
 	
@@ -0,0 +1,128 @@
+#include <cassert>
+#include "opengl/OpenGlDef.h"
+#include "GSH_SoftwareiOS.h"
+
+CGSH_SoftwareiOS::CGSH_SoftwareiOS(CAEAGLLayer* layer)
+: m_layer(layer)
+{
+
+}
+
+CGSH_SoftwareiOS::~CGSH_SoftwareiOS()
+{
+	
+}
+
+CGSHandler::FactoryFunction CGSH_SoftwareiOS::GetFactoryFunction(CAEAGLLayer* layer)
+{
+	return [layer]() { return new CGSH_SoftwareiOS(layer); };
+}
+
+void CGSH_SoftwareiOS::InitializeImpl()
+{
+	//GLES is only used to put the frames drawn by the rasterizer on the layer
+	m_context = [[EAGLContext alloc] initWithAPI: kEAGLRenderingAPIOpenGLES3];
+	
+	if(!m_context)
+	{
+		NSLog(@"Failed to create ES context");
+		return;
+	}
+	
+	if(![EAGLContext setCurrentContext: m_context])
+	{
+		NSLog(@"Failed to set ES context current");
+		return;
+	}
+	
+	CreateFramebuffer();
+	
+	m_frameTexture = Framework::OpenGl::CTexture::Create();
+	glGenFramebuffers(1, &m_frameFramebuffer);
+	
+	{
+		PRESENTATION_PARAMS presentationParams;
+		presentationParams.mode 			= PRESENTATION_MODE_FIT;
+		presentationParams.windowWidth 		= m_framebufferWidth;
+		presentationParams.windowHeight 	= m_framebufferHeight;
+		
+		SetPresentationParams(presentationParams);
+	}
+	
+	CGSH_Software::InitializeImpl();
+}
+
+void CGSH_SoftwareiOS::ReleaseImpl()
+{
+	CGSH_Software::ReleaseImpl();
+	
+	glDeleteFramebuffers(1, &m_frameFramebuffer);
+	m_frameFramebuffer = 0;
+	m_frameTexture.Reset();
+}
+
+void CGSH_SoftwareiOS::PresentFramebuffer()
+{
+	if(!m_context) return;
+	
+	uint32 width = 0;
+	uint32 height = 0;
+	ReadDisplayFramebuffer(m_pixels, width, height);
+	
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_defaultFramebuffer);
+	glViewport(0, 0, m_framebufferWidth, m_framebufferHeight);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+	
+	if((width != 0) && (height != 0))
+	{
+		glBindTexture(GL_TEXTURE_2D, m_frameTexture);
+		if((width != m_frameTextureWidth) || (height != m_frameTextureHeight))
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, m_frameFramebuffer);
+			glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_frameTexture, 0);
+			m_frameTextureWidth = width;
+			m_frameTextureHeight = height;
+		}
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, m_pixels.data());
+		
+		//Frame rows are top first while GL's are bottom first, flip the destination rectangle
+		auto rect = GetPresentationRect(width, height);
+		int32 dstBottom = static_cast<int32>(m_presentationParams.windowHeight) - rect.y;
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_frameFramebuffer);
+		glBlitFramebuffer(0, 0, width, height,
+			rect.x, dstBottom, rect.x + rect.width, dstBottom - static_cast<int32>(rect.height),
+			GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	}
+	CHECKGLERROR();
+	
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorRenderbuffer);
+	BOOL success = [m_context presentRenderbuffer: GL_RENDERBUFFER];
+	assert(success == YES);
+}
+
+void CGSH_SoftwareiOS::CreateFramebuffer()
+{
+	assert(m_defaultFramebuffer == 0);
+	
+	glGenFramebuffers(1, &m_defaultFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_defaultFramebuffer);
+	
+	glGenRenderbuffers(1, &m_colorRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorRenderbuffer);
+	[m_context renderbufferStorage: GL_RENDERBUFFER fromDrawable: m_layer];
+	glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_WIDTH, &m_framebufferWidth);
+	glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_HEIGHT, &m_framebufferHeight);
+	
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorRenderbuffer);
+	
+	CHECKGLERROR();
+	
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		NSLog(@"Failed to make complete framebuffer object %x", glCheckFramebufferStatus(GL_FRAMEBUFFER));
+		assert(false);
+	}
+}
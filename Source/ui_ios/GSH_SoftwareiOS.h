@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../gs/GSH_Software.h"
+#include "opengl/OpenGlDef.h"
+#include "opengl/Resource.h"
+
+class CGSH_SoftwareiOS : public CGSH_Software
+{
+public:
+							CGSH_SoftwareiOS(CAEAGLLayer*);
+	virtual					~CGSH_SoftwareiOS();
+	
+	static FactoryFunction 	GetFactoryFunction(CAEAGLLayer*);
+	
+protected:
+	void					InitializeImpl() override;
+	void					ReleaseImpl() override;
+	void					PresentFramebuffer() override;
+
+private:
+	void					CreateFramebuffer();
+	
+	CAEAGLLayer*			m_layer = nullptr;
+	EAGLContext*			m_context = nullptr;
+	GLuint					m_defaultFramebuffer = 0;
+	GLuint					m_colorRenderbuffer = 0;
+	
+	GLint					m_framebufferWidth = 0;
+	GLint					m_framebufferHeight = 0;
+
+	Framework::OpenGl::CTexture	m_frameTexture;
+	GLuint					m_frameFramebuffer = 0;
+	uint32					m_frameTextureWidth = 0;
+	uint32					m_frameTextureHeight = 0;
+	FramebufferPixelArray	m_pixels;
+};
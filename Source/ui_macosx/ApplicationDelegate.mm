@@ -1,6 +1,7 @@
 #import "ApplicationDelegate.h"
 #import "PreferencesWindowController.h"
 #import "GSH_OpenGLMacOSX.h"
+#import "GSH_SoftwareMacOSX.h"
 #import "PH_HidMacOSX.h"
 #import "../../tools/PsfPlayer/Source/SH_OpenAL.h"
 #import "Globals.h"
@@ -15,6 +16,7 @@
 -(void)applicationDidFinishLaunching: (NSNotification*)notification
 {
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREFERENCE_AUDIO_ENABLEOUTPUT, true);
+	CGSH_Software::RegisterPreferences();
 	
 	g_virtualMachine->Initialize();
 	
@@ -27,7 +29,14 @@
 	
 	NSOpenGLContext* context = [outputWindowController.openGlView openGLContext];
 	void* lowLevelContext = [context CGLContextObj];
-	g_virtualMachine->CreateGSHandler(CGSH_OpenGLMacOSX::GetFactoryFunction(reinterpret_cast<CGLContextObj>(lowLevelContext)));
+	if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_SOFTWARE_ENABLED))
+	{
+		g_virtualMachine->CreateGSHandler(CGSH_SoftwareMacOSX::GetFactoryFunction(reinterpret_cast<CGLContextObj>(lowLevelContext)));
+	}
+	else
+	{
+		g_virtualMachine->CreateGSHandler(CGSH_OpenGLMacOSX::GetFactoryFunction(reinterpret_cast<CGLContextObj>(lowLevelContext)));
+	}
 	g_virtualMachine->CreatePadHandler(CPH_HidMacOSX::GetFactoryFunction());
 	[self setupSoundHandler];
 #ifdef _DEBUG
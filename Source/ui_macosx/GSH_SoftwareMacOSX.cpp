@@ -0,0 +1,79 @@
+#include "GSH_SoftwareMacOSX.h"
+
+CGSH_SoftwareMacOSX::CGSH_SoftwareMacOSX(CGLContextObj context)
+: m_context(context)
+{
+
+}
+
+CGSH_SoftwareMacOSX::~CGSH_SoftwareMacOSX()
+{
+
+}
+
+CGSHandler::FactoryFunction CGSH_SoftwareMacOSX::GetFactoryFunction(CGLContextObj context)
+{
+	return std::bind(&CGSH_SoftwareMacOSX::GSHandlerFactory, context);
+}
+
+void CGSH_SoftwareMacOSX::InitializeImpl()
+{
+	CGLSetCurrentContext(m_context);
+
+	m_frameTexture = Framework::OpenGl::CTexture::Create();
+	glGenFramebuffers(1, &m_frameFramebuffer);
+
+	CGSH_Software::InitializeImpl();
+}
+
+void CGSH_SoftwareMacOSX::ReleaseImpl()
+{
+	CGSH_Software::ReleaseImpl();
+
+	glDeleteFramebuffers(1, &m_frameFramebuffer);
+	m_frameFramebuffer = 0;
+	m_frameTexture.Reset();
+}
+
+void CGSH_SoftwareMacOSX::PresentFramebuffer()
+{
+	uint32 width = 0;
+	uint32 height = 0;
+	ReadDisplayFramebuffer(m_pixels, width, height);
+
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glViewport(0, 0, m_presentationParams.windowWidth, m_presentationParams.windowHeight);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	if((width != 0) && (height != 0))
+	{
+		glBindTexture(GL_TEXTURE_2D, m_frameTexture);
+		if((width != m_frameTextureWidth) || (height != m_frameTextureHeight))
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, m_frameFramebuffer);
+			glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_frameTexture, 0);
+			m_frameTextureWidth = width;
+			m_frameTextureHeight = height;
+		}
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, m_pixels.data());
+
+		//Frame rows are top first while GL's are bottom first, flip the destination rectangle
+		auto rect = GetPresentationRect(width, height);
+		int32 dstBottom = static_cast<int32>(m_presentationParams.windowHeight) - rect.y;
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_frameFramebuffer);
+		glBlitFramebuffer(0, 0, width, height, 
+			rect.x, dstBottom, rect.x + rect.width, dstBottom - static_cast<int32>(rect.height), 
+			GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	}
+
+	CHECKGLERROR();
+	CGLFlushDrawable(m_context);
+}
+
+CGSHandler* CGSH_SoftwareMacOSX::GSHandlerFactory(CGLContextObj context)
+{
+	return new CGSH_SoftwareMacOSX(context);
+}
@@ -0,0 +1,32 @@
+#ifndef _GSH_SOFTWAREMACOSX_H_
+#define _GSH_SOFTWAREMACOSX_H_
+
+#include "../gs/GSH_Software.h"
+#include "opengl/OpenGlDef.h"
+#include "opengl/Resource.h"
+
+class CGSH_SoftwareMacOSX : public CGSH_Software
+{
+public:
+							CGSH_SoftwareMacOSX(CGLContextObj);
+	virtual					~CGSH_SoftwareMacOSX();
+
+	static FactoryFunction	GetFactoryFunction(CGLContextObj);
+
+protected:
+	virtual void			InitializeImpl() override;
+	virtual void			ReleaseImpl() override;
+	virtual void			PresentFramebuffer() override;
+
+private:
+	static CGSHandler*		GSHandlerFactory(CGLContextObj);
+
+	CGLContextObj						m_context;
+	Framework::OpenGl::CTexture			m_frameTexture;
+	GLuint								m_frameFramebuffer = 0;
+	uint32								m_frameTextureWidth = 0;
+	uint32								m_frameTextureHeight = 0;
+	FramebufferPixelArray				m_pixels;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#include "GSH_SoftwareQt.h"
+#include <QWindow>
+#include <QOpenGLContext>
+#include <QOpenGLPaintDevice>
+#include <QPainter>
+#include <QImage>
+
+CGSH_SoftwareQt::CGSH_SoftwareQt(QWindow* renderWindow)
+: m_renderWindow(renderWindow)
+{
+
+}
+
+CGSH_SoftwareQt::~CGSH_SoftwareQt()
+{
+
+}
+
+CGSHandler::FactoryFunction CGSH_SoftwareQt::GetFactoryFunction(QWindow* renderWindow)
+{
+	return [renderWindow] () { return new CGSH_SoftwareQt(renderWindow); };
+}
+
+void CGSH_SoftwareQt::InitializeImpl()
+{
+	//The output window has an OpenGL surface, frames are only blitted to it through QPainter
+	m_context = new QOpenGLContext();
+	m_context->setFormat(m_renderWindow->requestedFormat());
+
+	bool succeeded = m_context->create();
+	Q_ASSERT(succeeded);
+
+	CGSH_Software::InitializeImpl();
+}
+
+void CGSH_SoftwareQt::ReleaseImpl()
+{
+	CGSH_Software::ReleaseImpl();
+
+	delete m_context;
+	m_context = nullptr;
+}
+
+void CGSH_SoftwareQt::PresentFramebuffer()
+{
+	if(!m_renderWindow->isExposed()) return;
+	if(!m_context->makeCurrent(m_renderWindow)) return;
+
+	uint32 width = 0;
+	uint32 height = 0;
+	ReadDisplayFramebuffer(m_pixels, width, height);
+
+	auto rect = GetPresentationRect(width, height);
+	{
+		QOpenGLPaintDevice device(m_presentationParams.windowWidth, m_presentationParams.windowHeight);
+		QPainter painter(&device);
+		painter.fillRect(0, 0, m_presentationParams.windowWidth, m_presentationParams.windowHeight, Qt::black);
+		if(width != 0 && height != 0)
+		{
+			//Pixels are 0xXXBBGGRR, which is RGBX in memory
+			QImage image(reinterpret_cast<const uchar*>(m_pixels.data()), width, height, width * sizeof(uint32), QImage::Format_RGBX8888);
+			painter.drawImage(QRect(rect.x, rect.y, rect.width, rect.height), image);
+		}
+	}
+
+	m_context->swapBuffers(m_renderWindow);
+}
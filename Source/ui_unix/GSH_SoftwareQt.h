@@ -0,0 +1,26 @@
+#pragma once
+
+#include "gs/GSH_Software.h"
+
+class QWindow;
+class QOpenGLContext;
+
+class CGSH_SoftwareQt : public CGSH_Software
+{
+public:
+	CGSH_SoftwareQt(QWindow*);
+	virtual ~CGSH_SoftwareQt();
+
+	static FactoryFunction GetFactoryFunction(QWindow*);
+
+	void InitializeImpl() override;
+	void ReleaseImpl() override;
+
+protected:
+	void PresentFramebuffer() override;
+
+private:
+	QWindow* m_renderWindow = nullptr;
+	QOpenGLContext* m_context = nullptr;
+	FramebufferPixelArray m_pixels;
+};
@@ -12,6 +12,7 @@
 #include <QStorageInfo>
 
 #include "GSH_OpenGLQt.h"
+#include "GSH_SoftwareQt.h"
 #include "tools/PsfPlayer/Source/SH_OpenAL.h"
 #include "DiskUtils.h"
 #include "PathUtils.h"
@@ -79,7 +80,14 @@ void MainWindow::InitEmu()
     g_virtualMachine = new CPS2VM();
     g_virtualMachine->Initialize();
 
-    g_virtualMachine->CreateGSHandler(CGSH_OpenGLQt::GetFactoryFunction(m_openglpanel));
+    if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_SOFTWARE_ENABLED))
+    {
+        g_virtualMachine->CreateGSHandler(CGSH_SoftwareQt::GetFactoryFunction(m_openglpanel));
+    }
+    else
+    {
+        g_virtualMachine->CreateGSHandler(CGSH_OpenGLQt::GetFactoryFunction(m_openglpanel));
+    }
     SetupSoundHandler();
 
     g_virtualMachine->CreatePadHandler(CPH_HidUnix::GetFactoryFunction());
@@ -90,6 +98,10 @@ void MainWindow::InitEmu()
 
     StatsManager = new CStatsManager();
     g_virtualMachine->m_ee->m_gs->OnNewFrame.connect(std::bind(&CStatsManager::OnNewFrame, StatsManager, std::placeholders::_1));
+    g_virtualMachine->AudioStatsUpdated.connect(std::bind(&CStatsManager::OnAudioStatsUpdated, StatsManager, std::placeholders::_1));
+#ifdef PROFILE
+    g_virtualMachine->ProfileFrameDone.connect(std::bind(&CStatsManager::OnProfileFrameDone, StatsManager, std::ref(*g_virtualMachine), std::placeholders::_1));
+#endif
 
     g_virtualMachine->OnRunningStateChange.connect(std::bind(&MainWindow::OnRunningStateChange, this));
     g_virtualMachine->m_ee->m_os->OnExecutableChange.connect(std::bind(&MainWindow::OnExecutableChange, this));
@@ -223,15 +235,26 @@ void MainWindow::CreateStatusBar()
     m_dcLabel->setAlignment(Qt::AlignHCenter);
     m_dcLabel->setMinimumSize(m_dcLabel->sizeHint());
 
+    m_audioLabel = new QLabel(" audio: 000ms/000 ");
+    m_audioLabel->setAlignment(Qt::AlignHCenter);
+    m_audioLabel->setMinimumSize(m_audioLabel->sizeHint());
 
     m_stateLabel = new QLabel(" Paused ");
     m_stateLabel->setAlignment(Qt::AlignHCenter);
     m_stateLabel->setMinimumSize(m_dcLabel->sizeHint());
 
+#ifdef PROFILE
+    m_frameTimeLabel = new QLabel("");
+    m_frameTimeLabel->setAlignment(Qt::AlignHCenter);
+#endif
 
     statusBar()->addWidget(m_stateLabel);
     statusBar()->addWidget(fpsLabel);
     statusBar()->addWidget(m_dcLabel);
+    statusBar()->addWidget(m_audioLabel);
+#ifdef PROFILE
+    statusBar()->addWidget(m_frameTimeLabel);
+#endif
 
 
     m_fpstimer = new QTimer(this);
@@ -244,10 +267,16 @@ void MainWindow::setFPS()
     int frames = StatsManager->GetFrames();
     int drawCalls = StatsManager->GetDrawCalls();
     int dcpf = (frames != 0) ? (drawCalls / frames) : 0;
+    int audioLatency = StatsManager->GetAudioLatency();
+    int audioUnderruns = StatsManager->GetAudioUnderruns();
     //fprintf(stderr, "%d f/s, %d dc/f\n", frames, dcpf);
+#ifdef PROFILE
+    m_frameTimeLabel->setText(QString(" %1 ").arg(QString::fromStdString(StatsManager->GetFrameTimeInfo())));
+#endif
     StatsManager->ClearStats();
     fpsLabel->setText(QString(" fps: %1 ").arg(frames));
     m_dcLabel->setText(QString(" dc: %1 ").arg(dcpf));
+    m_audioLabel->setText(QString(" audio: %1ms/%2 ").arg(audioLatency).arg(audioUnderruns));
 }
 
 void MainWindow::OnRunningStateChange()
@@ -385,6 +414,7 @@ void MainWindow::RegisterPreferences()
 {
     CAppConfig::GetInstance().RegisterPreferenceBoolean(PREFERENCE_AUDIO_ENABLEOUTPUT, true);
     CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_UI_PAUSEWHENFOCUSLOST, true);
+    CGSH_Software::RegisterPreferences();
 }
 
 void MainWindow::focusOutEvent(QFocusEvent * event)
@@ -47,7 +47,11 @@ private:
     QWindow* m_openglpanel;
     QLabel* fpsLabel;
     QLabel* m_dcLabel;
+    QLabel* m_audioLabel;
     QLabel* m_stateLabel;
+#ifdef PROFILE
+    QLabel* m_frameTimeLabel;
+#endif
     CStatsManager* StatsManager;
     CPH_HidUnix* m_padhandler = nullptr;
     QTimer *m_fpstimer = nullptr;
@@ -19,6 +19,14 @@ PIXELFORMATDESCRIPTOR CGSH_OpenGLWin32::m_pfd =
 	0, 0, 0
 };
 
+static const int g_contextAttributes[] =
+{
+	WGL_CONTEXT_MAJOR_VERSION_ARB, 3,
+	WGL_CONTEXT_MINOR_VERSION_ARB, 2,
+	WGL_CONTEXT_PROFILE_MASK_ARB, WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
+	0
+};
+
 CGSH_OpenGLWin32::CGSH_OpenGLWin32(Framework::Win32::CWindow* outputWindow)
 : m_outputWnd(outputWindow)
 {
@@ -46,15 +54,7 @@ void CGSH_OpenGLWin32::InitializeImpl()
 	auto createContextAttribsARB = reinterpret_cast<PFNWGLCREATECONTEXTATTRIBSARBPROC>(wglGetProcAddress("wglCreateContextAttribsARB"));
 	if(createContextAttribsARB != nullptr)
 	{
-		static const int attributes[] = 
-		{
-			WGL_CONTEXT_MAJOR_VERSION_ARB, 3,
-			WGL_CONTEXT_MINOR_VERSION_ARB, 2,
-			WGL_CONTEXT_PROFILE_MASK_ARB, WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
-			0
-		};
-
-		auto newContext = createContextAttribsARB(m_dc, nullptr, attributes);
+		auto newContext = createContextAttribsARB(m_dc, nullptr, g_contextAttributes);
 		assert(newContext != nullptr);
 
 		if(newContext != nullptr)
@@ -94,6 +94,35 @@ void CGSH_OpenGLWin32::PresentBackbuffer()
 	SwapBuffers(m_dc);
 }
 
+bool CGSH_OpenGLWin32::CreateSharedContext()
+{
+	auto createContextAttribsARB = reinterpret_cast<PFNWGLCREATECONTEXTATTRIBSARBPROC>(wglGetProcAddress("wglCreateContextAttribsARB"));
+	if(createContextAttribsARB == nullptr) return false;
+
+	assert(m_sharedContext == nullptr);
+	m_sharedContext = createContextAttribsARB(m_dc, m_context, g_contextAttributes);
+	return (m_sharedContext != nullptr);
+}
+
+void CGSH_OpenGLWin32::DestroySharedContext()
+{
+	if(m_sharedContext == nullptr) return;
+
+	auto deleteResult = wglDeleteContext(m_sharedContext);
+	assert(deleteResult == TRUE);
+	m_sharedContext = nullptr;
+}
+
+void CGSH_OpenGLWin32::MakeSharedContextCurrent()
+{
+	wglMakeCurrent(m_dc, m_sharedContext);
+}
+
+void CGSH_OpenGLWin32::ReleaseSharedContext()
+{
+	wglMakeCurrent(NULL, NULL);
+}
+
 Framework::Win32::CWindow* CGSH_OpenGLWin32::CreateSettingsDialog(HWND parentWnd)
 {
 	return new CGSH_OpenGL_SettingsWnd(parentWnd);
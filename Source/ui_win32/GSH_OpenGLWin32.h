@@ -21,12 +21,18 @@ public:
 protected:
 	void							PresentBackbuffer() override;
 
+	bool							CreateSharedContext() override;
+	void							DestroySharedContext() override;
+	void							MakeSharedContextCurrent() override;
+	void							ReleaseSharedContext() override;
+
 private:
 	static CGSHandler*				GSHandlerFactory(Framework::Win32::CWindow*);
 
 	Framework::Win32::CWindow*		m_outputWnd = nullptr;
 
 	HGLRC							m_context = nullptr;
+	HGLRC							m_sharedContext = nullptr;
 	HDC								m_dc = nullptr;
 	static PIXELFORMATDESCRIPTOR	m_pfd;
 };
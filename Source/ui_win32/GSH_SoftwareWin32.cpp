@@ -0,0 +1,52 @@
+#include "GSH_SoftwareWin32.h"
+
+CGSH_SoftwareWin32::CGSH_SoftwareWin32(Framework::Win32::CWindow* outputWindow)
+: m_outputWnd(outputWindow)
+{
+
+}
+
+CGSH_SoftwareWin32::~CGSH_SoftwareWin32()
+{
+
+}
+
+CGSHandler::FactoryFunction CGSH_SoftwareWin32::GetFactoryFunction(Framework::Win32::CWindow* outputWindow)
+{
+	return std::bind(&CGSH_SoftwareWin32::GSHandlerFactory, outputWindow);
+}
+
+void CGSH_SoftwareWin32::PresentFramebuffer()
+{
+	uint32 width = 0;
+	uint32 height = 0;
+	ReadDisplayFramebuffer(m_pixels, width, height);
+
+	//GDI wants BGRX pixels
+	for(auto& pixel : m_pixels)
+	{
+		pixel = (pixel & 0x0000FF00) | ((pixel & 0xFF) << 16) | ((pixel >> 16) & 0xFF);
+	}
+
+	BITMAPINFO bitmapInfo = {};
+	bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bitmapInfo.bmiHeader.biWidth = width;
+	//Negative height makes the bitmap top-down
+	bitmapInfo.bmiHeader.biHeight = -static_cast<LONG>(height);
+	bitmapInfo.bmiHeader.biPlanes = 1;
+	bitmapInfo.bmiHeader.biBitCount = 32;
+	bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+	auto rect = GetPresentationRect(width, height);
+	HDC dc = GetDC(m_outputWnd->m_hWnd);
+	PatBlt(dc, 0, 0, m_presentationParams.windowWidth, m_presentationParams.windowHeight, BLACKNESS);
+	SetStretchBltMode(dc, COLORONCOLOR);
+	StretchDIBits(dc, rect.x, rect.y, rect.width, rect.height, 0, 0, width, height, 
+		m_pixels.data(), &bitmapInfo, DIB_RGB_COLORS, SRCCOPY);
+	ReleaseDC(m_outputWnd->m_hWnd, dc);
+}
+
+CGSHandler* CGSH_SoftwareWin32::GSHandlerFactory(Framework::Win32::CWindow* outputWindow)
+{
+	return new CGSH_SoftwareWin32(outputWindow);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../gs/GSH_Software.h"
+#include "win32/Window.h"
+
+class CGSH_SoftwareWin32 : public CGSH_Software
+{
+public:
+									CGSH_SoftwareWin32(Framework::Win32::CWindow*);
+	virtual							~CGSH_SoftwareWin32();
+
+	static FactoryFunction			GetFactoryFunction(Framework::Win32::CWindow*);
+
+protected:
+	void							PresentFramebuffer() override;
+
+private:
+	static CGSHandler*				GSHandlerFactory(Framework::Win32::CWindow*);
+
+	Framework::Win32::CWindow*		m_outputWnd = nullptr;
+	FramebufferPixelArray			m_pixels;
+};
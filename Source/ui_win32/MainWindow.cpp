@@ -18,6 +18,7 @@
 #include "../ee/PS2OS.h"
 #include "../gs/GSH_Null.h"
 #include "GSH_OpenGLWin32.h"
+#include "GSH_SoftwareWin32.h"
 #include "../PH_Generic.h"
 #include "PH_DirectInput.h"
 #include "VFSManagerWnd.h"
@@ -79,6 +80,7 @@ CMainWindow::CMainWindow(CPS2VM& virtualMachine)
 
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_UI_PAUSEWHENFOCUSLOST, true);
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_UI_SOUNDENABLED, true);
+	CGSH_Software::RegisterPreferences();
 
 	if(!DoesWindowClassExist(CLSNAME))
 	{
@@ -128,7 +130,14 @@ CMainWindow::CMainWindow(CPS2VM& virtualMachine)
 	m_statusBar.SetText(FPSPANEL,		_T(""));
 
 	//m_virtualMachine.CreateGSHandler(CGSH_Null::GetFactoryFunction());
-	m_virtualMachine.CreateGSHandler(CGSH_OpenGLWin32::GetFactoryFunction(m_outputWnd));
+	if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_SOFTWARE_ENABLED))
+	{
+		m_virtualMachine.CreateGSHandler(CGSH_SoftwareWin32::GetFactoryFunction(m_outputWnd));
+	}
+	else
+	{
+		m_virtualMachine.CreateGSHandler(CGSH_OpenGLWin32::GetFactoryFunction(m_outputWnd));
+	}
 
 #ifdef USE_VIRTUALPAD
 	m_virtualMachine.CreatePadHandler(CPH_Generic::GetFactoryFunction());
@@ -435,7 +444,7 @@ void CMainWindow::SaveState()
 	if(m_virtualMachine.m_ee->m_os->GetELF() == nullptr) return;
 
 	Framework::PathUtils::EnsurePathExists(GetStateDirectoryPath());
-	if(m_virtualMachine.SaveState(GenerateStatePath().string().c_str()) == 0)
+	if(m_virtualMachine.SaveState(GenerateStatePath().string().c_str()).get())
 	{
 		PrintStatusTextA("Saved state to slot %i.", m_stateSlot);
 	}
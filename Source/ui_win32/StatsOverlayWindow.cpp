@@ -111,6 +111,14 @@ void CStatsOverlayWindow::Update(unsigned int frames)
 			y += m_renderMetrics.fontSizeY + m_renderMetrics.spaceY;
 		}
 
+		{
+			//Allows comparing frame times with VU1 running on its worker thread or not
+			float avgFrameTime = (m_cpuUtilisation.frameCount != 0) ? static_cast<double>(m_cpuUtilisation.totalFrameTime) / static_cast<double>(m_cpuUtilisation.frameCount * timeScale) : 0;
+			float maxFrameTime = static_cast<double>(m_cpuUtilisation.maxFrameTime) / static_cast<double>(timeScale);
+			memDc.TextOut(x, y, string_format(_T("Frame Time: %6.2fms (max %6.2fms, VU1 thread %s)"), avgFrameTime, maxFrameTime, m_vu1Threaded ? _T("on") : _T("off")).c_str());
+			y += m_renderMetrics.fontSizeY + m_renderMetrics.spaceY;
+		}
+
 		for(auto& zonePair : m_profilerZones) { zonePair.second.currentValue = 0; }
 		m_cpuUtilisation = CPS2VM::CPU_UTILISATION_INFO();
 	}
@@ -149,4 +157,8 @@ void CStatsOverlayWindow::OnProfileFrameDone(CPS2VM& virtualMachine, const CProf
 	m_cpuUtilisation.eeIdleTicks   += cpuUtilisation.eeIdleTicks;
 	m_cpuUtilisation.iopTotalTicks += cpuUtilisation.iopTotalTicks;
 	m_cpuUtilisation.iopIdleTicks  += cpuUtilisation.iopIdleTicks;
+	m_cpuUtilisation.frameCount     += cpuUtilisation.frameCount;
+	m_cpuUtilisation.totalFrameTime += cpuUtilisation.totalFrameTime;
+	m_cpuUtilisation.maxFrameTime   = std::max<uint64>(m_cpuUtilisation.maxFrameTime, cpuUtilisation.maxFrameTime);
+	m_vu1Threaded = virtualMachine.m_ee->m_vpu1->IsThreaded();
 }
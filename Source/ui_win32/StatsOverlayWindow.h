@@ -43,6 +43,7 @@ private:
 	ZoneMap					m_profilerZones;
 
 	CPS2VM::CPU_UTILISATION_INFO m_cpuUtilisation;
+	bool					m_vu1Threaded = false;
 	RENDERMETRICS			m_renderMetrics;
 	Framework::Win32::CFont	m_font;
 };
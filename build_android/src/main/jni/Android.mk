@@ -40,6 +40,9 @@ include $(CLEAR_VARS)
 LOCAL_MODULE			:= libPlay
 LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/BasicBlock.cpp \
+							$(PROJECT_PATH)/Source/BlockCache.cpp \
+							$(PROJECT_PATH)/Source/BlockCompileQueue.cpp \
+							$(PROJECT_PATH)/Source/CodeArena.cpp \
 							$(PROJECT_PATH)/Source/ControllerInfo.cpp \
 							$(PROJECT_PATH)/Source/COP_FPU.cpp \
 							$(PROJECT_PATH)/Source/COP_FPU_Reflection.cpp \
@@ -59,7 +62,9 @@ LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/ee/GIF.cpp \
 							$(PROJECT_PATH)/Source/ee/INTC.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU.cpp \
+							$(PROJECT_PATH)/Source/ee/IPU_Csc.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU_DmVectorTable.cpp \
+							$(PROJECT_PATH)/Source/ee/IPU_Idct.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU_MacroblockAddressIncrementTable.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU_MacroblockTypeBTable.cpp \
 							$(PROJECT_PATH)/Source/ee/IPU_MacroblockTypeITable.cpp \
@@ -85,12 +90,18 @@ LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/ee/VUShared_Reflection.cpp \
 							$(PROJECT_PATH)/Source/ELF.cpp \
 							$(PROJECT_PATH)/Source/ElfFile.cpp \
+							$(PROJECT_PATH)/Source/EventScheduler.cpp \
+							$(PROJECT_PATH)/Source/AudioStream.cpp \
+							$(PROJECT_PATH)/Source/SampleFifo.cpp \
+							$(PROJECT_PATH)/Source/TimeStretcher.cpp \
 							$(PROJECT_PATH)/Source/FrameDump.cpp \
 							$(PROJECT_PATH)/Source/gs/GsCachedArea.cpp \
 							$(PROJECT_PATH)/Source/gs/GSH_Null.cpp \
+							$(PROJECT_PATH)/Source/gs/GSH_Software.cpp \
 							$(PROJECT_PATH)/Source/gs/GSHandler.cpp \
 							$(PROJECT_PATH)/Source/gs/GSH_OpenGL/GSH_OpenGL.cpp \
 							$(PROJECT_PATH)/Source/gs/GSH_OpenGL/GSH_OpenGL_Shader.cpp \
+							$(PROJECT_PATH)/Source/gs/GSH_OpenGL/GSH_OpenGL_ProgramCache.cpp \
 							$(PROJECT_PATH)/Source/gs/GSH_OpenGL/GSH_OpenGL_Texture.cpp \
 							$(PROJECT_PATH)/Source/gs/GsPixelFormats.cpp \
 							$(PROJECT_PATH)/Source/iop/ArgumentIterator.cpp \
@@ -146,11 +157,13 @@ LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/ISO9660/PathTableRecord.cpp \
 							$(PROJECT_PATH)/Source/ISO9660/VolumeDescriptor.cpp \
 							$(PROJECT_PATH)/Source/IszImageStream.cpp \
+							$(PROJECT_PATH)/Source/ImageBlockCache.cpp \
 							$(PROJECT_PATH)/Source/Log.cpp \
 							$(PROJECT_PATH)/Source/MA_MIPSIV.cpp \
 							$(PROJECT_PATH)/Source/MA_MIPSIV_Reflection.cpp \
 							$(PROJECT_PATH)/Source/MA_MIPSIV_Templates.cpp \
 							$(PROJECT_PATH)/Source/MailBox.cpp \
+							$(PROJECT_PATH)/Source/MappedFile.cpp \
 							$(PROJECT_PATH)/Source/MemoryMap.cpp \
 							$(PROJECT_PATH)/Source/MemoryStateFile.cpp \
 							$(PROJECT_PATH)/Source/MemoryUtils.cpp \
@@ -172,8 +185,10 @@ LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 							$(PROJECT_PATH)/Source/RegisterStateFile.cpp \
 							$(PROJECT_PATH)/Source/StructCollectionStateFile.cpp \
 							$(PROJECT_PATH)/Source/StructFile.cpp \
+							$(PROJECT_PATH)/Source/StateSnapshot.cpp \
 							$(PROJECT_PATH)/Source/VirtualPad.cpp \
 							$(PROJECT_PATH)/Source/ui_android/GSH_OpenGLAndroid.cpp \
+							$(PROJECT_PATH)/Source/ui_android/GSH_SoftwareAndroid.cpp \
 							$(PROJECT_PATH)/Source/ui_android/InputManager.cpp \
 							$(PROJECT_PATH)/Source/ui_android/NativeInterop.cpp \
 							$(PROJECT_PATH)/Source/ui_android/NativeShared.cpp \
@@ -184,7 +199,7 @@ LOCAL_SRC_FILES			:=	$(PROJECT_PATH)/Source/AppConfig.cpp \
 LOCAL_CFLAGS			:= -Wno-extern-c-compat -D_IOP_EMULATE_MODULES -DDISABLE_LOGGING -DGLES_COMPATIBILITY
 LOCAL_C_INCLUDES		:= $(BOOST_PATH) $(DEPENDENCIES_PATH)/bzip2-1.0.6 $(FRAMEWORK_PATH)/include $(CODEGEN_PATH)/include $(PROJECT_PATH)/include
 LOCAL_CPP_FEATURES		:= exceptions rtti
-LOCAL_LDLIBS 			:= -landroid -llog -lOpenSLES -lGLESv3 -lEGL -lz
+LOCAL_LDLIBS 			:= -landroid -llog -lOpenSLES -lGLESv3 -lEGL -lz -ldl
 LOCAL_STATIC_LIBRARIES	:= libCodeGen libFramework libbzip2 libboost cpufeatures
 
 ifeq ($(APP_OPTIM),debug)
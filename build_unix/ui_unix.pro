@@ -23,6 +23,7 @@ INCLUDEPATH +=. \
 SOURCES += ../Source/ui_unix/main.cpp\
     ../Source/ui_unix/mainwindow.cpp \
     ../Source/ui_unix/GSH_OpenGLQt.cpp \
+    ../Source/ui_unix/GSH_SoftwareQt.cpp \
     ../Source/ui_unix/StatsManager.cpp \
     ../Source/ui_unix/PH_HidUnix.cpp \
     ../Source/ui_unix/settingsdialog.cpp \
@@ -39,6 +40,7 @@ SOURCES += ../Source/ui_unix/main.cpp\
 
 HEADERS  += ../Source/ui_unix/mainwindow.h \
     ../Source/ui_unix/GSH_OpenGLQt.h \
+    ../Source/ui_unix/GSH_SoftwareQt.h \
     ../Source/ui_unix/StatsManager.h \
     ../Source/ui_unix/PH_HidUnix.h \
     ../Source/ui_unix/settingsdialog.h \
@@ -81,6 +83,6 @@ DEPENDPATH += $$PWD/../../CodeGen/include
 
 unix:!macx: PRE_TARGETDEPS += $$PWD/../../CodeGen/build_unix/build/libCodeGen.a
 
-LIBS += -lboost_system -lboost_filesystem -lboost_chrono -lGLEW -lz -lbz2 -lopenal -licuuc
+LIBS += -lboost_system -lboost_filesystem -lboost_chrono -lGLEW -lz -lbz2 -lopenal -licuuc -ldl
 
 QMAKE_CXXFLAGS += -std=c++11
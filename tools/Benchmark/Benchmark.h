@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdio.h>
+#include <chrono>
+#include <functional>
+#include "Types.h"
+
+class CBenchmark
+{
+public:
+	virtual			~CBenchmark() {}
+	virtual void	Execute() = 0;
+
+	bool			HasFailed() const { return m_failed; }
+
+protected:
+	//Runs 'function' and reports the time it took per unit of work
+	static double	Measure(const char* name, uint64 units, const std::function<void ()>& function)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		function();
+		auto endTime = std::chrono::high_resolution_clock::now();
+		auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+		double unitTime = static_cast<double>(duration) / static_cast<double>(units);
+		printf("%-40s %12.3f ns/unit (%llu units, %.3f ms)\n", name, unitTime,
+			static_cast<unsigned long long>(units), static_cast<double>(duration) / 1000000.0);
+		return unitTime;
+	}
+
+	//Results that differ from the reference make the tool exit with an error
+	void			Verify(bool matches, const char* name)
+	{
+		if(matches) return;
+		printf("  %s: MISMATCH\n", name);
+		m_failed = true;
+	}
+
+private:
+	bool			m_failed = false;
+};
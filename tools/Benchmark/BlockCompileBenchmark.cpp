@@ -0,0 +1,128 @@
+#include <vector>
+#include <algorithm>
+#include "BlockCompileBenchmark.h"
+#include "MIPS.h"
+#include "MA_MIPSIV.h"
+#include "MIPSAssembler.h"
+#include "MipsExecutor.h"
+
+static const uint32 g_ramSize = 0x400000;
+static const uint32 g_functionBase = 0x10000;
+static const uint32 g_functionCount = 256;
+static const uint32 g_functionStride = 0x400;
+static const uint32 g_loopsPerFunction = 8;
+static const uint32 g_loopIterations = 64;
+static const int g_sliceCycles = 5000;
+
+//Looks like what happens on boot or when a level loads: the CPU keeps on reaching code it never ran
+//before. Each function contains a few small loops, giving the worker time to compile the blocks ahead.
+static uint32 AssembleProgram(uint8* ram)
+{
+	for(uint32 i = 0; i < g_functionCount; i++)
+	{
+		CMIPSAssembler assembler(reinterpret_cast<uint32*>(ram + g_functionBase + (i * g_functionStride)));
+		for(uint32 j = 0; j < g_loopsPerFunction; j++)
+		{
+			auto loopLabel = assembler.CreateLabel();
+			assembler.ADDIU(CMIPS::T0, CMIPS::R0, g_loopIterations);
+			assembler.MarkLabel(loopLabel);
+			assembler.ADDU(CMIPS::T1, CMIPS::T1, CMIPS::T0);
+			assembler.OR(CMIPS::T2, CMIPS::T2, CMIPS::T1);
+			assembler.ADDIU(CMIPS::T3, CMIPS::T3, static_cast<uint16>(i + j));
+			assembler.ADDIU(CMIPS::T0, CMIPS::T0, 0xFFFF);
+			assembler.BNE(CMIPS::T0, CMIPS::R0, loopLabel);
+			assembler.NOP();
+		}
+		assembler.JR(CMIPS::RA);
+		assembler.NOP();
+	}
+
+	//Driver calls every function once and ends in an infinite loop
+	uint32 driverAddress = 0;
+	CMIPSAssembler assembler(reinterpret_cast<uint32*>(ram + driverAddress));
+	for(uint32 i = 0; i < g_functionCount; i++)
+	{
+		assembler.JAL(g_functionBase + (i * g_functionStride));
+		assembler.NOP();
+	}
+	uint32 endAddress = driverAddress + assembler.GetProgramSize();
+	auto endLabel = assembler.CreateLabel();
+	assembler.MarkLabel(endLabel);
+	assembler.BEQ(CMIPS::R0, CMIPS::R0, endLabel);
+	assembler.NOP();
+	assembler.JR(CMIPS::RA);
+	assembler.NOP();
+	return endAddress;
+}
+
+struct PROGRAM_RESULT
+{
+	uint32 t1;
+	uint32 t2;
+	uint32 t3;
+};
+
+static PROGRAM_RESULT RunProgram(const char* name, bool backgroundCompileEnabled)
+{
+	std::vector<uint8> ram(g_ramSize);
+	uint32 endAddress = AssembleProgram(ram.data());
+
+	CMIPS cpu(MEMORYMAP_ENDIAN_LSBF);
+	CMA_MIPSIV cpuArch(MIPS_REGSIZE_32);
+	cpu.m_pMemoryMap->InsertReadMap(0, g_ramSize - 1, ram.data(), 0x01);
+	cpu.m_pMemoryMap->InsertWriteMap(0, g_ramSize - 1, ram.data(), 0x01);
+	cpu.m_pMemoryMap->InsertInstructionMap(0, g_ramSize - 1, ram.data(), 0x01);
+	cpu.m_pArch = &cpuArch;
+	cpu.m_pAddrTranslator = &CMIPS::TranslateAddress64;
+
+	CMipsExecutor executor(cpu, g_ramSize);
+	executor.SetBackgroundCompileEnabled(backgroundCompileEnabled);
+	cpu.m_State.nPC = 0;
+
+	std::vector<double> sliceTimes;
+	auto totalStartTime = std::chrono::high_resolution_clock::now();
+	while(cpu.m_State.nPC != endAddress)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		executor.Execute(g_sliceCycles);
+		auto endTime = std::chrono::high_resolution_clock::now();
+		sliceTimes.push_back(std::chrono::duration<double, std::micro>(endTime - startTime).count());
+	}
+	auto totalEndTime = std::chrono::high_resolution_clock::now();
+	double totalTime = std::chrono::duration<double, std::milli>(totalEndTime - totalStartTime).count();
+
+	//What matters for stutter is how long the worst slices take, not the average
+	std::sort(sliceTimes.begin(), sliceTimes.end());
+	double p99Time = sliceTimes[(sliceTimes.size() * 99) / 100];
+	double maxTime = sliceTimes.back();
+	printf("  %-38s %8.3f ms total, %4u slices, p99 %9.3f us, max %9.3f us\n", name, totalTime,
+		static_cast<unsigned int>(sliceTimes.size()), p99Time, maxTime);
+
+	PROGRAM_RESULT result = {};
+	result.t1 = cpu.m_State.nGPR[CMIPS::T1].nV0;
+	result.t2 = cpu.m_State.nGPR[CMIPS::T2].nV0;
+	result.t3 = cpu.m_State.nGPR[CMIPS::T3].nV0;
+	return result;
+}
+
+void CBlockCompileBenchmark::Execute()
+{
+	printf("Block Compile:\n");
+	auto cpuThreadResult = RunProgram("Compile on CPU thread", false);
+	auto workerThreadResult = RunProgram("Compile on worker thread", true);
+
+	//Every loop adds 64 + 63 + ... + 1 to T1 and (function + loop) 64 times to T3
+	uint32 expectedT1 = 0;
+	uint32 expectedT3 = 0;
+	for(uint32 i = 0; i < g_functionCount; i++)
+	{
+		for(uint32 j = 0; j < g_loopsPerFunction; j++)
+		{
+			expectedT1 += (g_loopIterations * (g_loopIterations + 1)) / 2;
+			expectedT3 += (i + j) * g_loopIterations;
+		}
+	}
+	Verify((cpuThreadResult.t1 == expectedT1) && (cpuThreadResult.t3 == expectedT3), "Compile on CPU thread");
+	Verify((workerThreadResult.t1 == expectedT1) && (workerThreadResult.t3 == expectedT3) &&
+		(workerThreadResult.t2 == cpuThreadResult.t2), "Compile on worker thread");
+}
@@ -0,0 +1,88 @@
+#include <random>
+#include <vector>
+#include <cstring>
+#include "CodeArenaBenchmark.h"
+#include "CodeArena.h"
+#include "MemoryFunction.h"
+
+static const uint32 g_blockCount = 0x4000;
+static const uint32 g_overlayCount = 8;
+
+//Blocks of various sizes spread over a few guest pages, like a code overlay loaded by a game
+static std::vector<uint32> GenerateBlockSizes()
+{
+	std::mt19937 generator(0);
+	std::vector<uint32> blockSizes(g_blockCount);
+	for(auto& blockSize : blockSizes)
+	{
+		blockSize = 0x40 + (generator() % 0x400);
+	}
+	return blockSizes;
+}
+
+void CCodeArenaBenchmark::Execute()
+{
+	auto blockSizes = GenerateBlockSizes();
+	std::vector<uint8> code(0x440);
+	for(uint32 i = 0; i < code.size(); i++)
+	{
+		code[i] = static_cast<uint8>(i * 13);
+	}
+	uint64 totalBlocks = static_cast<uint64>(g_blockCount) * g_overlayCount;
+
+	printf("Code Arena:\n");
+
+	{
+		std::vector<CMemoryFunction> functions(g_blockCount);
+		Measure("  Load/invalidate (one mapping per block)", totalBlocks,
+			[&] ()
+			{
+				for(uint32 overlay = 0; overlay < g_overlayCount; overlay++)
+				{
+					for(uint32 i = 0; i < g_blockCount; i++)
+					{
+						functions[i] = CMemoryFunction(code.data(), blockSizes[i]);
+					}
+					functions.clear();
+					functions.resize(g_blockCount);
+				}
+			}
+		);
+	}
+
+	{
+		CCodeArena arena;
+		std::vector<CCodeArena::ALLOCATION> allocations(g_blockCount);
+		Measure("  Load/invalidate (arena)", totalBlocks,
+			[&] ()
+			{
+				for(uint32 overlay = 0; overlay < g_overlayCount; overlay++)
+				{
+					for(uint32 i = 0; i < g_blockCount; i++)
+					{
+						allocations[i] = arena.Allocate(i * 0x40, code.data(), blockSizes[i]);
+					}
+					for(auto& allocation : allocations)
+					{
+						arena.Free(allocation);
+					}
+				}
+			}
+		);
+
+		bool matches = true;
+		for(uint32 i = 0; i < g_blockCount; i++)
+		{
+			allocations[i] = arena.Allocate(i * 0x40, code.data(), blockSizes[i]);
+			matches &= (memcmp(allocations[i].code, code.data(), blockSizes[i]) == 0);
+		}
+		for(auto& allocation : allocations)
+		{
+			arena.Free(allocation);
+		}
+		matches &= (arena.GetUsedSize() == 0);
+		Verify(matches, "Arena blocks");
+
+		printf("  %-40s %12.3f MB mapped\n", "Arena memory", static_cast<double>(arena.GetMappedSize()) / (1024.0 * 1024.0));
+	}
+}
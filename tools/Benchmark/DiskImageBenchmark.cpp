@@ -0,0 +1,155 @@
+#include <random>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include "DiskImageBenchmark.h"
+#include "../UnitTest/DiskImageGenerator.h"
+#include "StdStream.h"
+#include "CsoImageStream.h"
+#include "IszImageStream.h"
+#include "ImageBlockCache.h"
+#include "ISO9660/BlockProvider.h"
+
+static const uint32 g_sectorSize = DiskImageGenerator::SECTOR_SIZE;
+static const uint32 g_sectorCount = 0x2000;
+static const uint32 g_iszBlockSize = 0x10000;
+
+struct TRACE_READ
+{
+	uint32 sector;
+	uint32 count;
+};
+typedef std::vector<TRACE_READ> Trace;
+
+static Trace GenerateTrace()
+{
+	//Mimics what was recorded from CdRead: a movie streamed in 16 sector chunks
+	//while small files are loaded from another area of the disk
+	Trace trace;
+	std::mt19937 generator(1);
+	uint32 streamSector = 0;
+	uint32 streamEnd = g_sectorCount / 2;
+	for(uint32 i = 0; i < 0x800; i++)
+	{
+		if((generator() % 3) != 0)
+		{
+			TRACE_READ read = { streamSector, 16 };
+			trace.push_back(read);
+			streamSector += 16;
+			if(streamSector >= streamEnd) streamSector = 0;
+		}
+		else
+		{
+			uint32 fileSector = streamEnd + static_cast<uint32>(generator() % (g_sectorCount - streamEnd - 8));
+			TRACE_READ read = { fileSector, 1 + static_cast<uint32>(generator() % 8) };
+			trace.push_back(read);
+		}
+	}
+	return trace;
+}
+
+void CDiskImageBenchmark::Execute()
+{
+	auto image = DiskImageGenerator::GenerateImage(g_sectorCount);
+	auto trace = GenerateTrace();
+
+	uint64 sectorCount = 0;
+	for(const auto& read : trace)
+	{
+		sectorCount += read.count;
+	}
+
+	auto replayTrace =
+		[&] (const char* name, Framework::CStream& stream)
+		{
+			std::vector<uint8> buffer(16 * g_sectorSize);
+			bool matches = true;
+			Measure(name, sectorCount,
+				[&] ()
+				{
+					for(const auto& read : trace)
+					{
+						uint32 size = read.count * g_sectorSize;
+						stream.Seek(static_cast<int64>(read.sector) * g_sectorSize, Framework::STREAM_SEEK_SET);
+						stream.Read(buffer.data(), size);
+						matches &= (memcmp(buffer.data(), image.data() + (read.sector * g_sectorSize), size) == 0);
+					}
+				}
+			);
+			Verify(matches, name);
+		};
+
+	auto replayBlockTrace =
+		[&] (const char* name, ISO9660::CBlockProvider& blockProvider)
+		{
+			std::vector<uint8> buffer(16 * g_sectorSize);
+			bool matches = true;
+			Measure(name, sectorCount,
+				[&] ()
+				{
+					for(const auto& read : trace)
+					{
+						blockProvider.ReadBlocks(read.sector, read.count, buffer.data());
+						matches &= (memcmp(buffer.data(), image.data() + (read.sector * g_sectorSize), read.count * g_sectorSize) == 0);
+					}
+				}
+			);
+			Verify(matches, name);
+		};
+
+	printf("Disk Image:\n");
+
+	{
+		Framework::CMemStream rawStream;
+		rawStream.Write(image.data(), image.size());
+		replayTrace("  Trace (raw ISO)", rawStream);
+	}
+
+	{
+		auto isoPath = DiskImageGenerator::WriteImageFile(image, 0x800, 0);
+		{
+			auto stream = std::make_shared<Framework::CStdStream>(isoPath.string().c_str(), "rb");
+			ISO9660::CBlockProvider2048 streamBlockProvider(stream);
+			replayBlockTrace("  Trace (ISO file, stream)", streamBlockProvider);
+
+			ISO9660::CBlockProviderMapped2048 mappedBlockProvider(std::make_shared<CMappedFile>(isoPath));
+			replayBlockTrace("  Trace (ISO file, mapped)", mappedBlockProvider);
+		}
+		boost::filesystem::remove(isoPath);
+
+		auto xaPath = DiskImageGenerator::WriteImageFile(image, 0x930, 0x18);
+		{
+			auto stream = std::make_shared<Framework::CStdStream>(xaPath.string().c_str(), "rb");
+			ISO9660::CBlockProviderCDROMXA streamBlockProvider(stream);
+			replayBlockTrace("  Trace (CD-ROM XA file, stream)", streamBlockProvider);
+
+			ISO9660::CBlockProviderMappedCDROMXA mappedBlockProvider(std::make_shared<CMappedFile>(xaPath));
+			replayBlockTrace("  Trace (CD-ROM XA file, mapped)", mappedBlockProvider);
+		}
+		boost::filesystem::remove(xaPath);
+	}
+
+	auto& blockCache = CImageBlockCache::GetInstance();
+	size_t memoryBudget = blockCache.GetMemoryBudget();
+
+	//A budget of 0 only keeps the last block around, like the streams used to do
+	for(auto budget : { static_cast<size_t>(0), memoryBudget })
+	{
+		blockCache.SetMemoryBudget(budget);
+		bool cacheEnabled = (budget != 0);
+
+		{
+			std::unique_ptr<Framework::CMemStream> csoBaseStream(DiskImageGenerator::CreateCsoImage(image));
+			CCsoImageStream csoStream(csoBaseStream.get());
+			replayTrace(cacheEnabled ? "  Trace (CSO, block cache)" : "  Trace (CSO, single block)", csoStream);
+		}
+
+		{
+			//ISZ stream takes ownership of its base stream
+			CIszImageStream iszStream(DiskImageGenerator::CreateIszImage(image, g_iszBlockSize));
+			replayTrace(cacheEnabled ? "  Trace (ISZ, block cache)" : "  Trace (ISZ, single block)", iszStream);
+		}
+	}
+
+	blockCache.SetMemoryBudget(memoryBudget);
+}
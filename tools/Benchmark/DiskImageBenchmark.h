@@ -0,0 +1,10 @@
+#pragma once
+
+#include "Types.h"
+#include "Benchmark.h"
+
+class CDiskImageBenchmark : public CBenchmark
+{
+public:
+	void	Execute() override;
+};
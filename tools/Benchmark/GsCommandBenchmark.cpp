@@ -0,0 +1,108 @@
+#include <cstring>
+#include <vector>
+#include "GsCommandBenchmark.h"
+#include "gs/GSH_Null.h"
+
+//Sends packets to the GS thread the way it was done before the command ring was introduced:
+//one heap allocation and one std::function per packet, queued in the mailbox
+class CMailBoxGsHandler : public CGSH_Null
+{
+public:
+	void WriteRegisterMassivelyMailBox(const RegisterWrite* writeList, unsigned int count)
+	{
+		m_transferCount++;
+		auto writes = reinterpret_cast<RegisterWrite*>(malloc(count * sizeof(RegisterWrite)));
+		memcpy(writes, writeList, count * sizeof(RegisterWrite));
+		m_mailBox.SendCall(
+			[this, writes, count] ()
+			{
+				WriteRegisterMassivelyImpl(writes, count, nullptr);
+				free(writes);
+			}
+		);
+	}
+
+	void FeedImageDataMailBox(const void* data, uint32 length)
+	{
+		m_transferCount++;
+		uint8* buffer = new uint8[length + 0x10];
+		memcpy(buffer, data, length);
+		m_mailBox.SendCall(
+			[this, buffer, length] ()
+			{
+				FeedImageDataImpl(buffer, length);
+				delete [] buffer;
+			}
+		);
+	}
+
+	void Synchronize()
+	{
+		SendGSCall([] () { }, true);
+	}
+
+	//Only safe to read after Synchronize
+	uint64 m_processedWriteCount = 0;
+
+protected:
+	void WriteRegisterMassivelyImpl(const RegisterWrite* writeList, unsigned int count, const CGsPacketMetadata* metadata) override
+	{
+		m_processedWriteCount += count;
+		CGSH_Null::WriteRegisterMassivelyImpl(writeList, count, metadata);
+	}
+};
+
+void CGsCommandBenchmark::Execute()
+{
+	static const uint32 g_packetCount = 0x40000;
+	//Every 8th packet carries image data
+	static const uint32 g_imagePacketInterval = 8;
+	static const uint32 g_imageDataSize = 0x400;
+
+	//Packet drawing a strip of 10 gouraud shaded triangles
+	CGSHandler::RegisterWriteList writeList;
+	writeList.push_back(CGSHandler::RegisterWrite(GS_REG_PRIM, 0x04));
+	for(unsigned int i = 0; i < 12; i++)
+	{
+		writeList.push_back(CGSHandler::RegisterWrite(GS_REG_RGBAQ, 0x3F80000080808080ULL));
+		writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZ2, (static_cast<uint64>(i) << 36) | (i << 4)));
+	}
+	std::vector<uint8> imageData(g_imageDataSize);
+
+	CMailBoxGsHandler gs;
+
+	printf("GsCommand:\n");
+	double mailBoxTime = Measure("  GIF packets (mailbox)", g_packetCount,
+		[&] ()
+		{
+			for(uint32 i = 0; i < g_packetCount; i++)
+			{
+				gs.WriteRegisterMassivelyMailBox(writeList.data(), static_cast<unsigned int>(writeList.size()));
+				if((i % g_imagePacketInterval) == 0)
+				{
+					gs.FeedImageDataMailBox(imageData.data(), g_imageDataSize);
+				}
+			}
+			gs.Synchronize();
+		}
+	);
+	uint64 mailBoxWriteCount = gs.m_processedWriteCount;
+	gs.m_processedWriteCount = 0;
+	double ringTime = Measure("  GIF packets (command ring)", g_packetCount,
+		[&] ()
+		{
+			for(uint32 i = 0; i < g_packetCount; i++)
+			{
+				gs.WriteRegisterMassively(writeList.data(), static_cast<unsigned int>(writeList.size()), nullptr);
+				if((i % g_imagePacketInterval) == 0)
+				{
+					gs.FeedImageData(imageData.data(), g_imageDataSize);
+				}
+			}
+			gs.Synchronize();
+		}
+	);
+	printf("  Packets per second: %.0f (mailbox), %.0f (command ring)\n", 1000000000.0 / mailBoxTime, 1000000000.0 / ringTime);
+	printf("  Speedup: %.2fx\n", mailBoxTime / ringTime);
+	Verify(gs.m_processedWriteCount == mailBoxWriteCount, "GIF packets (command ring)");
+}
@@ -0,0 +1,79 @@
+#include <memory>
+#include <vector>
+#include "GsRasterBenchmark.h"
+#include "gs/GSH_Software.h"
+
+void CGsRasterBenchmark::Execute()
+{
+	static const uint32 g_frameCount = 32;
+	static const uint32 g_screenWidth = 640;
+	static const uint32 g_screenHeight = 448;
+	static const uint32 g_stripCount = 14;
+	static const uint32 g_stripLength = 40;
+
+	std::vector<uint8> presentBuffer(g_screenWidth * g_screenHeight * 3);
+
+	auto gs = std::unique_ptr<CGSHandler>(CGSH_Software::GetFactoryFunction()());
+	gs->Initialize();
+
+	auto setupContext =
+		[&] (uint32 framePsm, bool blend)
+		{
+			CGSHandler::RegisterWriteList writeList;
+			writeList.push_back(CGSHandler::RegisterWrite(GS_REG_FRAME_1, (static_cast<uint64>(framePsm) << 24) | ((g_screenWidth / 64) << 16)));
+			writeList.push_back(CGSHandler::RegisterWrite(GS_REG_ZBUF_1, 0x100 | (static_cast<uint64>(CGSHandler::PSMZ24 & 0x0F) << 24)));
+			writeList.push_back(CGSHandler::RegisterWrite(GS_REG_SCISSOR_1, (static_cast<uint64>(g_screenWidth - 1) << 16) | (static_cast<uint64>(g_screenHeight - 1) << 48)));
+			//ZTE = 1, ZTST = GEQUAL
+			writeList.push_back(CGSHandler::RegisterWrite(GS_REG_TEST_1, (1 << 16) | (2 << 17)));
+			//(Cs - Cd) * As + Cd
+			writeList.push_back(CGSHandler::RegisterWrite(GS_REG_ALPHA_1, 0x44));
+			writeList.push_back(CGSHandler::RegisterWrite(GS_REG_PRIM, CGSHandler::PRIM_TRIANGLESTRIP | (1 << 3) | (blend ? (1 << 6) : 0)));
+			gs->WriteRegisterMassively(writeList.data(), static_cast<unsigned int>(writeList.size()), nullptr);
+		};
+
+	//Strips of gouraud shaded triangles covering the screen
+	CGSHandler::RegisterWriteList stripList;
+	uint32 stripHeight = g_screenHeight / g_stripCount;
+	uint32 stepWidth = g_screenWidth / (g_stripLength / 2);
+	for(uint32 strip = 0; strip < g_stripCount; strip++)
+	{
+		stripList.push_back(CGSHandler::RegisterWrite(GS_REG_PRIM, CGSHandler::PRIM_TRIANGLESTRIP | (1 << 3)));
+		for(uint32 i = 0; i < g_stripLength + 2; i++)
+		{
+			uint64 x = (i / 2) * stepWidth;
+			uint64 y = (strip + (i & 1)) * stripHeight;
+			uint64 z = 0x1000 + i;
+			stripList.push_back(CGSHandler::RegisterWrite(GS_REG_RGBAQ, 0x3F80000040000000ULL | ((i * 0x10) & 0xFF) | (((strip * 0x20) & 0xFF) << 8)));
+			stripList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZ2, (x << 4) | (y << 20) | (z << 32)));
+		}
+	}
+	uint64 pixelCount = static_cast<uint64>(g_frameCount) * g_screenWidth * (stripHeight * g_stripCount);
+
+	auto drawFrames =
+		[&] ()
+		{
+			for(uint32 frame = 0; frame < g_frameCount; frame++)
+			{
+				gs->WriteRegisterMassively(stripList.data(), static_cast<unsigned int>(stripList.size()), nullptr);
+			}
+			gs->ReadFramebuffer(g_screenWidth, g_screenHeight, presentBuffer.data());
+		};
+
+	printf("GsRaster:\n");
+	setupContext(CGSHandler::PSMCT32, false);
+
+	//Without blending, every frame overwrites the previous one with the same pixels,
+	//so the result of a single frame is the reference for the whole run
+	gs->WriteRegisterMassively(stripList.data(), static_cast<unsigned int>(stripList.size()), nullptr);
+	gs->ReadFramebuffer(g_screenWidth, g_screenHeight, presentBuffer.data());
+	auto referenceBuffer = presentBuffer;
+
+	Measure("  PSMCT32 + Z24 (pixels)", pixelCount, drawFrames);
+	Verify(presentBuffer == referenceBuffer, "PSMCT32 + Z24 (repeated frames)");
+	setupContext(CGSHandler::PSMCT32, true);
+	Measure("  PSMCT32 + Z24 + blend (pixels)", pixelCount, drawFrames);
+	setupContext(CGSHandler::PSMCT16, true);
+	Measure("  PSMCT16 + Z24 + blend (pixels)", pixelCount, drawFrames);
+
+	gs->Release();
+}
@@ -0,0 +1,56 @@
+#include <random>
+#include <vector>
+#include "IpuBenchmark.h"
+#include "ee/IPU_Idct.h"
+#include "idct/IEEE1180.h"
+
+void CIpuBenchmark::Execute()
+{
+	static const uint32 g_blockCount = 0x40000;
+	static const uint32 g_blockSize = 0x40;
+
+	//Sparse coefficient blocks, like what comes out of the VLC decoder
+	std::vector<int16> input(g_blockCount * g_blockSize);
+	{
+		std::mt19937 generator(0);
+		for(uint32 i = 0; i < input.size(); i++)
+		{
+			uint32 value = generator();
+			bool isDc = (i % g_blockSize) == 0;
+			input[i] = (isDc || ((value % 8) == 0)) ? static_cast<int16>((value >> 8) % 512) - 256 : 0;
+		}
+	}
+
+	std::vector<int16> referenceOutput(input.size());
+	std::vector<int16> output(input.size());
+
+	printf("IPU:\n");
+	double referenceTime = Measure("  IDCT (IEEE1180 reference)", g_blockCount,
+		[&] ()
+		{
+			for(uint32 i = 0; i < g_blockCount; i++)
+			{
+				IDCT::CIEEE1180::GetInstance()->Transform(input.data() + (i * g_blockSize), referenceOutput.data() + (i * g_blockSize));
+			}
+		}
+	);
+	double simdTime = Measure("  IDCT (separable SIMD)", g_blockCount,
+		[&] ()
+		{
+			for(uint32 i = 0; i < g_blockCount; i++)
+			{
+				IPU::CIdct::Transform(input.data() + (i * g_blockSize), output.data() + (i * g_blockSize));
+			}
+		}
+	);
+
+	//Both must stay within IEEE 1180 accuracy, allow an off by one difference
+	uint32 mismatchCount = 0;
+	for(uint32 i = 0; i < output.size(); i++)
+	{
+		int32 difference = static_cast<int32>(output[i]) - static_cast<int32>(referenceOutput[i]);
+		if((difference > 1) || (difference < -1)) mismatchCount++;
+	}
+	printf("  Speedup: %.2fx\n", referenceTime / simdTime);
+	Verify(mismatchCount == 0, "IDCT (separable SIMD)");
+}
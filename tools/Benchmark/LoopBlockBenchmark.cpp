@@ -0,0 +1,80 @@
+#include <vector>
+#include "LoopBlockBenchmark.h"
+#include "MIPS.h"
+#include "MA_MIPSIV.h"
+#include "MIPSAssembler.h"
+#include "MipsExecutor.h"
+
+static const uint32 g_ramSize = 0x100000;
+static const uint32 g_outerIterations = 0x400;
+static const uint32 g_innerIterations = 0x100;
+static const int g_sliceCycles = 5000;
+
+//Nested loops with a condition in the inner one, like a copy or a checksum loop found in game code
+static uint32 AssembleProgram(uint8* ram)
+{
+	CMIPSAssembler assembler(reinterpret_cast<uint32*>(ram));
+	auto outerLabel = assembler.CreateLabel();
+	auto innerLabel = assembler.CreateLabel();
+	auto skipLabel = assembler.CreateLabel();
+	auto endLabel = assembler.CreateLabel();
+
+	assembler.ADDIU(CMIPS::T1, CMIPS::R0, g_outerIterations);
+	assembler.MarkLabel(outerLabel);
+	assembler.ADDIU(CMIPS::T0, CMIPS::R0, g_innerIterations);
+	assembler.MarkLabel(innerLabel);
+	assembler.ANDI(CMIPS::T2, CMIPS::T0, 1);
+	assembler.BEQ(CMIPS::T2, CMIPS::R0, skipLabel);
+	assembler.ADDU(CMIPS::T3, CMIPS::T3, CMIPS::T0);
+	assembler.ADDIU(CMIPS::T4, CMIPS::T4, 1);
+	assembler.MarkLabel(skipLabel);
+	assembler.ADDIU(CMIPS::T0, CMIPS::T0, 0xFFFF);
+	assembler.BNE(CMIPS::T0, CMIPS::R0, innerLabel);
+	assembler.NOP();
+	assembler.ADDIU(CMIPS::T1, CMIPS::T1, 0xFFFF);
+	assembler.BNE(CMIPS::T1, CMIPS::R0, outerLabel);
+	assembler.NOP();
+
+	uint32 endAddress = assembler.GetProgramSize();
+	assembler.MarkLabel(endLabel);
+	assembler.BEQ(CMIPS::R0, CMIPS::R0, endLabel);
+	assembler.NOP();
+	assembler.JR(CMIPS::RA);
+	assembler.NOP();
+	return endAddress;
+}
+
+//Returns a value computed by the program, both modes must end with the same
+static uint32 RunProgram(bool loopBlocksEnabled)
+{
+	std::vector<uint8> ram(g_ramSize);
+	uint32 endAddress = AssembleProgram(ram.data());
+
+	CMIPS cpu(MEMORYMAP_ENDIAN_LSBF);
+	CMA_MIPSIV cpuArch(MIPS_REGSIZE_32);
+	cpu.m_pMemoryMap->InsertReadMap(0, g_ramSize - 1, ram.data(), 0x01);
+	cpu.m_pMemoryMap->InsertWriteMap(0, g_ramSize - 1, ram.data(), 0x01);
+	cpu.m_pMemoryMap->InsertInstructionMap(0, g_ramSize - 1, ram.data(), 0x01);
+	cpu.m_pArch = &cpuArch;
+	cpu.m_pAddrTranslator = &CMIPS::TranslateAddress64;
+
+	CMipsExecutor executor(cpu, g_ramSize);
+	executor.SetLoopBlocksEnabled(loopBlocksEnabled);
+	cpu.m_State.nPC = 0;
+	while(cpu.m_State.nPC != endAddress)
+	{
+		executor.Execute(g_sliceCycles);
+	}
+	return cpu.m_State.nGPR[CMIPS::T3].nV[0];
+}
+
+void CLoopBlockBenchmark::Execute()
+{
+	uint64 iterationCount = static_cast<uint64>(g_outerIterations) * g_innerIterations;
+	uint32 results[2] = {};
+
+	printf("Loop Block:\n");
+	Measure("  Inner loop iteration (basic blocks)", iterationCount, [&] () { results[0] = RunProgram(false); });
+	Measure("  Inner loop iteration (loop blocks)", iterationCount, [&] () { results[1] = RunProgram(true); });
+	Verify(results[0] == results[1], "Inner loop iteration (loop blocks)");
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "Types.h"
+#include "Benchmark.h"
+
+class CLoopBlockBenchmark : public CBenchmark
+{
+public:
+	void	Execute() override;
+};
@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <memory>
+#include "BlockCompileBenchmark.h"
+#include "CodeArenaBenchmark.h"
+#include "DiskImageBenchmark.h"
+#include "GsCommandBenchmark.h"
+#include "GsRasterBenchmark.h"
+#include "IpuBenchmark.h"
+#include "LoopBlockBenchmark.h"
+#include "MemoryMapBenchmark.h"
+#include "StateSnapshotBenchmark.h"
+#include "VifUnpackBenchmark.h"
+
+typedef std::function<CBenchmark* ()> BenchmarkFactoryFunction;
+
+static const BenchmarkFactoryFunction s_factories[] =
+{
+	[] () { return new CMemoryMapBenchmark(); },
+	[] () { return new CVifUnpackBenchmark(); },
+	[] () { return new CGsCommandBenchmark(); },
+	[] () { return new CGsRasterBenchmark(); },
+	[] () { return new CIpuBenchmark(); },
+	[] () { return new CDiskImageBenchmark(); },
+	[] () { return new CStateSnapshotBenchmark(); },
+	[] () { return new CBlockCompileBenchmark(); },
+	[] () { return new CCodeArenaBenchmark(); },
+	[] () { return new CLoopBlockBenchmark(); },
+};
+
+int main(int argc, const char** argv)
+{
+	int result = 0;
+	for(const auto& factory : s_factories)
+	{
+		auto benchmark = std::unique_ptr<CBenchmark>(factory());
+		benchmark->Execute();
+		if(benchmark->HasFailed())
+		{
+			result = 1;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,92 @@
+#include <random>
+#include <vector>
+#include "MemoryMapBenchmark.h"
+#include "MemoryMap.h"
+#include "Ps2Const.h"
+
+//Exposes the list scan that was used before the page table was introduced
+class CLinearMemoryMap : public CMemoryMap_LSBF
+{
+public:
+	uint32 GetWordLinear(uint32 address)
+	{
+		auto e = GetMap(m_readMap, address);
+		if(e == nullptr) return 0xCCCCCCCC;
+		switch(e->nType)
+		{
+		case MEMORYMAP_TYPE_MEMORY:
+			return *reinterpret_cast<uint32*>(reinterpret_cast<uint8*>(e->pPointer) + (address - e->nStart));
+		default:
+			return e->handler(address, 0);
+		}
+	}
+};
+
+void CMemoryMapBenchmark::Execute()
+{
+	static const uint32 g_accessCount = 0x1000000;
+	static const uint32 g_ioPortAddress = 0x10000000;
+	//Keep the working set small enough to measure the lookup rather than cache misses
+	static const uint32 g_ramWorkingSetSize = 0x40000;
+
+	std::vector<uint8> ram(PS2::EE_RAM_SIZE);
+	std::vector<uint8> spr(PS2::EE_SPR_SIZE);
+	std::vector<uint8> vuMem1(PS2::VUMEM1SIZE);
+	std::vector<uint8> bios(PS2::EE_BIOS_SIZE);
+
+	//Same layout as the EE's read map
+	CLinearMemoryMap memoryMap;
+	auto ioHandler = [] (uint32 address, uint32) { return address; };
+	memoryMap.InsertReadMap(0x00000000,            0x01FFFFFF,                                   ram.data(),    0x00);
+	memoryMap.InsertReadMap(PS2::EE_SPR_ADDR,      PS2::EE_SPR_ADDR + PS2::EE_SPR_SIZE - 1,      spr.data(),    0x01);
+	memoryMap.InsertReadMap(g_ioPortAddress,       0x10FFFFFF,                                   ioHandler,     0x02);
+	memoryMap.InsertReadMap(PS2::VUMEM1ADDR,       PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1,        vuMem1.data(), 0x03);
+	memoryMap.InsertReadMap(0x12000000,            0x12FFFFFF,                                   ioHandler,     0x04);
+	memoryMap.InsertReadMap(0x1FC00000,            0x1FFFFFFF,                                   bios.data(),   0x05);
+
+	//Mostly RAM accesses with a sprinkle of accesses to other regions, like a typical game
+	std::vector<uint32> addresses(g_accessCount);
+	{
+		std::mt19937 generator(0);
+		for(auto& address : addresses)
+		{
+			uint32 value = generator();
+			switch(value % 16)
+			{
+			default:
+				address = (value & (g_ramWorkingSetSize - 1));
+				break;
+			case 0:
+			case 1:
+				address = PS2::EE_SPR_ADDR + (value & (PS2::EE_SPR_SIZE - 1));
+				break;
+			case 2:
+				address = PS2::VUMEM1ADDR + (value & (PS2::VUMEM1SIZE - 1));
+				break;
+			case 3:
+				address = g_ioPortAddress + (value & 0xFFFF);
+				break;
+			}
+			address &= ~0x03;
+		}
+	}
+
+	uint32 linearSum = 0;
+	uint32 pageSum = 0;
+
+	printf("MemoryMap:\n");
+	double linearTime = Measure("  GetWord (linear scan)", g_accessCount,
+		[&] ()
+		{
+			for(auto address : addresses) linearSum += memoryMap.GetWordLinear(address);
+		}
+	);
+	double pageTime = Measure("  GetWord (page table)", g_accessCount,
+		[&] ()
+		{
+			for(auto address : addresses) pageSum += memoryMap.GetWord(address);
+		}
+	);
+	printf("  Speedup: %.2fx\n", linearTime / pageTime);
+	Verify(linearSum == pageSum, "GetWord (page table)");
+}
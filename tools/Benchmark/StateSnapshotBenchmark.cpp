@@ -0,0 +1,88 @@
+#include <random>
+#include <vector>
+#include <cstring>
+#include <zlib.h>
+#include "StateSnapshotBenchmark.h"
+#include "StateSnapshot.h"
+
+static const uint32 g_memorySize = 0x2000000;
+static const uint32 g_pageSize = 0x1000;
+static const uint32 g_saveCount = 16;
+
+static void TouchMemory(std::vector<uint8>& memory, std::mt19937& generator)
+{
+	//Games usually modify a few percent of the RAM between two saves
+	uint32 pageCount = g_memorySize / g_pageSize;
+	for(uint32 i = 0; i < (pageCount / 32); i++)
+	{
+		uint32 page = generator() % pageCount;
+		memory[(page * g_pageSize) + (generator() % g_pageSize)] = static_cast<uint8>(generator());
+	}
+}
+
+void CStateSnapshotBenchmark::Execute()
+{
+	std::vector<uint8> memory(g_memorySize);
+	std::mt19937 generator(0);
+	for(auto& value : memory)
+	{
+		value = static_cast<uint8>(generator() & 0x0F);
+	}
+
+	uint64 totalSize = static_cast<uint64>(g_memorySize) * g_saveCount;
+
+	printf("State Snapshot:\n");
+
+	{
+		std::vector<uint8> copy(g_memorySize);
+		std::mt19937 touchGenerator(1);
+		Measure("  Capture (full copy)", totalSize,
+			[&] ()
+			{
+				for(uint32 i = 0; i < g_saveCount; i++)
+				{
+					TouchMemory(memory, touchGenerator);
+					memcpy(copy.data(), memory.data(), g_memorySize);
+				}
+			}
+		);
+	}
+
+	{
+		CStateSnapshot snapshot;
+		{
+			CStateSnapshot::CCaptureScope captureScope(snapshot);
+			snapshot.CaptureRegion("ram", memory.data(), g_memorySize);
+		}
+		std::mt19937 touchGenerator(1);
+		const void* captured = nullptr;
+		uint64 copiedSize = 0;
+		Measure("  Capture (dirty pages)", totalSize,
+			[&] ()
+			{
+				for(uint32 i = 0; i < g_saveCount; i++)
+				{
+					TouchMemory(memory, touchGenerator);
+					CStateSnapshot::CCaptureScope captureScope(snapshot);
+					captured = snapshot.CaptureRegion("ram", memory.data(), g_memorySize);
+					copiedSize += snapshot.GetCopiedSize();
+				}
+			}
+		);
+		printf("  Copied: %llu of %llu bytes (%.1f%%)\n", static_cast<unsigned long long>(copiedSize),
+			static_cast<unsigned long long>(totalSize), static_cast<double>(copiedSize) * 100.0 / static_cast<double>(totalSize));
+		Verify(memcmp(captured, memory.data(), g_memorySize) == 0, "Capture (dirty pages)");
+	}
+
+	{
+		//What the emulation thread used to wait on before the archive was written on another thread
+		std::vector<uint8> compressed(compressBound(g_memorySize));
+		Measure("  Compress (zlib default level)", g_memorySize,
+			[&] ()
+			{
+				uLongf compressedSize = static_cast<uLongf>(compressed.size());
+				compress2(compressed.data(), &compressedSize, memory.data(), g_memorySize, Z_DEFAULT_COMPRESSION);
+			}
+		);
+	}
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "Types.h"
+#include "Benchmark.h"
+
+class CStateSnapshotBenchmark : public CBenchmark
+{
+public:
+	void	Execute() override;
+};
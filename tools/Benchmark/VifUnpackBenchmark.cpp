@@ -0,0 +1,158 @@
+#include <random>
+#include <vector>
+#include <cstring>
+#include "VifUnpackBenchmark.h"
+#include "ee/VifUnpack.h"
+#include "Ps2Const.h"
+
+//Same decoding as the generic path of CVif::Cmd_UNPACK: one element at a time, with runtime checks
+static uint32 UnpackGeneric(VifUnpack::STATE& state, uint8* vuMem, uint32 vuMemSize, uint32 dstAddr,
+	const uint8* src, uint32 count, uint32 format, bool usn, bool useMask, uint32 mode)
+{
+	for(uint32 element = 0; element < count; element++)
+	{
+		uint32 value[4] = {};
+		if(format == VifUnpack::FORMAT_V4_5)
+		{
+			uint16 color = 0;
+			memcpy(&color, src, 2);
+			value[0] = ((color >>  0) & 0x1F) << 3;
+			value[1] = ((color >>  5) & 0x1F) << 3;
+			value[2] = ((color >> 10) & 0x1F) << 3;
+			value[3] = ((color >> 15) & 0x01) << 7;
+		}
+		else
+		{
+			uint32 fieldCount = ((format >> 2) & 0x03) + 1;
+			uint32 fieldSize = 4 >> (format & 0x03);
+			for(unsigned int i = 0; i < fieldCount; i++)
+			{
+				uint32 temp = 0;
+				memcpy(&temp, src + (i * fieldSize), fieldSize);
+				if(!usn && (fieldSize == 2)) temp = static_cast<int16>(temp);
+				if(!usn && (fieldSize == 1)) temp = static_cast<int8>(temp);
+				value[i] = temp;
+			}
+			if(fieldCount == 1)
+			{
+				value[1] = value[2] = value[3] = value[0];
+			}
+		}
+		src += VifUnpack::GetElementSize(format);
+
+		auto dst = reinterpret_cast<uint32*>(vuMem + dstAddr);
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			uint32 col = std::min<uint32>(state.writeTick, 3);
+			uint32 maskOp = useMask ? ((state.mask >> (((col * 4) + i) * 2)) & 0x03) : VifUnpack::MASKOP_DATA;
+			switch(maskOp)
+			{
+			case VifUnpack::MASKOP_DATA:
+				if(mode != VifUnpack::MODE_NORMAL) value[i] += state.row[i];
+				if(mode == VifUnpack::MODE_DIFFERENCE) state.row[i] = value[i];
+				dst[i] = value[i];
+				break;
+			case VifUnpack::MASKOP_ROW:
+				dst[i] = state.row[i];
+				break;
+			case VifUnpack::MASKOP_COL:
+				dst[i] = state.col[col];
+				break;
+			}
+		}
+
+		state.writeTick++;
+		if(state.writeTick == state.cycleLength) state.writeTick = 0;
+		dstAddr = (dstAddr + 0x10) & (vuMemSize - 1);
+	}
+	return dstAddr;
+}
+
+void CVifUnpackBenchmark::Execute()
+{
+	struct UNPACK
+	{
+		const char*	name;
+		uint32		format;
+		bool		usn;
+		bool		useMask;
+		uint32		mode;
+	};
+
+	//Formats commonly used by games to upload geometry to VU1
+	static const UNPACK g_unpacks[] =
+	{
+		{ "  V4-32 (positions)",             VifUnpack::FORMAT_V4_32, false, false, VifUnpack::MODE_NORMAL },
+		{ "  V3-32 (normals)",               VifUnpack::FORMAT_V3_32, false, false, VifUnpack::MODE_NORMAL },
+		{ "  V2-32 (texture coordinates)",   VifUnpack::FORMAT_V2_32, false, false, VifUnpack::MODE_NORMAL },
+		{ "  V4-16 (signed, offset)",        VifUnpack::FORMAT_V4_16, false, false, VifUnpack::MODE_OFFSET },
+		{ "  V3-16 (signed, masked)",        VifUnpack::FORMAT_V3_16, false, true,  VifUnpack::MODE_NORMAL },
+		{ "  V2-16 (texture coordinates)",   VifUnpack::FORMAT_V2_16, false, false, VifUnpack::MODE_NORMAL },
+		{ "  V4-8 (colors)",                 VifUnpack::FORMAT_V4_8,  true,  false, VifUnpack::MODE_NORMAL },
+		{ "  V4-5 (colors)",                 VifUnpack::FORMAT_V4_5,  true,  false, VifUnpack::MODE_NORMAL },
+		{ "  S32 (masked, difference)",      VifUnpack::FORMAT_S32,   false, true,  VifUnpack::MODE_DIFFERENCE },
+	};
+
+	static const uint32 g_elementCount = 256;
+	static const uint32 g_iterationCount = 0x4000;
+	static const uint32 g_cycleLength = 4;
+
+	std::vector<uint8> source(g_elementCount * 16);
+	{
+		std::mt19937 generator(0);
+		for(auto& value : source) value = static_cast<uint8>(generator());
+	}
+
+	std::vector<uint8> genericVuMem(PS2::VUMEM1SIZE);
+	std::vector<uint8> fastVuMem(PS2::VUMEM1SIZE);
+
+	VifUnpack::STATE initState = {};
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		initState.row[i] = 0x1000 * (i + 1);
+		initState.col[i] = 0x2000 * (i + 1);
+	}
+	initState.mask = 0xE4E4E4E4;
+	initState.cycleLength = g_cycleLength;
+
+	printf("VifUnpack:\n");
+	auto fastFunctionAvailable = VifUnpack::GetFunction(VifUnpack::FORMAT_V4_32, false, false, VifUnpack::MODE_NORMAL) != nullptr;
+	if(!fastFunctionAvailable)
+	{
+		printf("  Specialised kernels not available on this platform.\n");
+		return;
+	}
+
+	for(const auto& unpack : g_unpacks)
+	{
+		auto genericState = initState;
+		auto fastState = initState;
+		auto unpackFunction = VifUnpack::GetFunction(unpack.format, unpack.usn, unpack.useMask, unpack.mode);
+		uint64 units = static_cast<uint64>(g_elementCount) * g_iterationCount;
+
+		printf("%s\n", unpack.name);
+		double genericTime = Measure("    Generic", units,
+			[&] ()
+			{
+				for(uint32 i = 0; i < g_iterationCount; i++)
+				{
+					UnpackGeneric(genericState, genericVuMem.data(), PS2::VUMEM1SIZE, 0, source.data(), g_elementCount,
+						unpack.format, unpack.usn, unpack.useMask, unpack.mode);
+				}
+			}
+		);
+		double fastTime = Measure("    Specialised", units,
+			[&] ()
+			{
+				for(uint32 i = 0; i < g_iterationCount; i++)
+				{
+					unpackFunction(fastState, fastVuMem.data(), PS2::VUMEM1SIZE, 0, source.data(), g_elementCount);
+				}
+			}
+		);
+		bool match = (memcmp(genericVuMem.data(), fastVuMem.data(), PS2::VUMEM1SIZE) == 0) &&
+			(memcmp(genericState.row, fastState.row, sizeof(genericState.row)) == 0);
+		printf("    Speedup: %.2fx\n", genericTime / fastTime);
+		Verify(match, unpack.name);
+	}
+}
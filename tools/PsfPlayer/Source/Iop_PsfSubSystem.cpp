@@ -12,6 +12,7 @@ CPsfSubSystem::CPsfSubSystem(bool ps2Mode)
 , m_spuUpdateTicks(0)
 , m_spuUpdateCounter(0)
 , m_frameCounter(0)
+, m_dmaUpdateCounter(0)
 , m_currentBlock(0)
 {
 	uint32 cpuFreq = ps2Mode ? PS2::IOP_CLOCK_OVER_FREQ : PS2::IOP_CLOCK_BASE_FREQ;
@@ -32,6 +33,7 @@ void CPsfSubSystem::Reset()
 	m_currentBlock = 0;
 	m_frameCounter = m_frameTicks;
 	m_spuUpdateCounter = m_spuUpdateTicks;
+	m_dmaUpdateCounter = CSubSystem::DMA_UPDATE_TICKS;
 }
 
 CMIPS& CPsfSubSystem::GetCpu()
@@ -88,6 +90,13 @@ void CPsfSubSystem::Update(bool singleStep, CSoundHandler* soundHandler)
 			m_iop.CountTicks(ticks);
 			m_spuUpdateCounter -= ticks;
 			m_frameCounter -= ticks;
+			m_dmaUpdateCounter -= ticks;
+		}
+
+		if(m_dmaUpdateCounter < 0)
+		{
+			m_dmaUpdateCounter += CSubSystem::DMA_UPDATE_TICKS;
+			m_iop.ResumeDma();
 		}
 
 		if(m_spuUpdateCounter < 0)
@@ -103,13 +112,7 @@ void CPsfSubSystem::Update(bool singleStep, CSoundHandler* soundHandler)
 				int16 samplesSpu1[BLOCK_SIZE];
 				m_iop.m_spuCore1.Render(samplesSpu1, BLOCK_SIZE, 44100);
 
-				for(unsigned int i = 0; i < BLOCK_SIZE; i++)
-				{
-					int32 resultSample = static_cast<int32>(samplesSpu0[i]) + static_cast<int32>(samplesSpu1[i]);
-					resultSample = std::max<int32>(resultSample, SHRT_MIN);
-					resultSample = std::min<int32>(resultSample, SHRT_MAX);
-					samplesSpu0[i] = static_cast<int16>(resultSample);
-				}
+				Iop::CSpuBase::MixOutput(samplesSpu0, samplesSpu1, BLOCK_SIZE);
 			}
 
 			m_currentBlock++;
@@ -36,6 +36,7 @@ namespace Iop
 		uint32								m_spuUpdateTicks;
 		int									m_frameCounter;
 		int									m_spuUpdateCounter;
+		int									m_dmaUpdateCounter;
 
 		enum
 		{
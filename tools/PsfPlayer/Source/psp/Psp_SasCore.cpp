@@ -196,13 +196,7 @@ uint32 CSasCore::Core(uint32 contextAddr, uint32 bufferAddr)
 	m_spu[0]->Render(samplesSpu0, sampleCount, 44100);
 	m_spu[1]->Render(samplesSpu1, sampleCount, 44100);
 
-	for(unsigned int i = 0; i < sampleCount; i++)
-	{
-		int32 resultSample = static_cast<int32>(samplesSpu0[i]) + static_cast<int32>(samplesSpu1[i]);
-		resultSample = std::max<int32>(resultSample, SHRT_MIN);
-		resultSample = std::min<int32>(resultSample, SHRT_MAX);
-		samplesSpu0[i] = static_cast<int16>(resultSample);
-	}
+	Iop::CSpuBase::MixOutput(samplesSpu0, samplesSpu1, sampleCount);
 
 	return 0;
 }
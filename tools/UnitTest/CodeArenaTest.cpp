@@ -0,0 +1,83 @@
+#include <vector>
+#include <cstring>
+#include "CodeArenaTest.h"
+#include "CodeArena.h"
+
+void CCodeArenaTest::Execute()
+{
+	TestAllocation();
+	TestExecution();
+}
+
+void CCodeArenaTest::TestAllocation()
+{
+	std::vector<uint8> code(0x8000);
+	for(uint32 i = 0; i < code.size(); i++)
+	{
+		code[i] = static_cast<uint8>(i * 13);
+	}
+
+	CCodeArena arena;
+
+	//Blocks of a same guest page are laid out next to each other, aligned on 16 bytes
+	auto allocation0 = arena.Allocate(0x1000, code.data(), 0x31);
+	auto allocation1 = arena.Allocate(0x1040, code.data() + 0x100, 0x20);
+	TEST_VERIFY(allocation1.code == reinterpret_cast<uint8*>(allocation0.code) + 0x40);
+	TEST_VERIFY(memcmp(allocation0.code, code.data(), 0x31) == 0);
+	TEST_VERIFY(memcmp(allocation1.code, code.data() + 0x100, 0x20) == 0);
+
+	//Another guest page gets its own span
+	auto allocation2 = arena.Allocate(0x2000, code.data() + 0x200, 0x40);
+	TEST_VERIFY(allocation2.spanIndex != allocation0.spanIndex);
+	TEST_VERIFY(memcmp(allocation2.code, code.data() + 0x200, 0x40) == 0);
+	TEST_VERIFY(arena.GetUsedSize() == (0x31 + 0x20 + 0x40));
+
+	//Blocks bigger than a span get a mapping of their own
+	size_t mappedSize = arena.GetMappedSize();
+	auto largeAllocation = arena.Allocate(0x3000, code.data(), code.size());
+	TEST_VERIFY(memcmp(largeAllocation.code, code.data(), code.size()) == 0);
+	TEST_VERIFY(arena.GetMappedSize() >= (mappedSize + code.size()));
+	arena.Free(largeAllocation);
+	TEST_VERIFY(largeAllocation.code == nullptr);
+	TEST_VERIFY(arena.GetMappedSize() == mappedSize);
+
+	//Span is reused once all of its blocks are gone
+	void* firstCode = allocation0.code;
+	arena.Free(allocation0);
+	arena.Free(allocation1);
+	auto allocation3 = arena.Allocate(0x5000, code.data() + 0x300, 0x10);
+	TEST_VERIFY(allocation3.code == firstCode);
+	TEST_VERIFY(memcmp(allocation3.code, code.data() + 0x300, 0x10) == 0);
+	TEST_VERIFY(memcmp(allocation2.code, code.data() + 0x200, 0x40) == 0);
+
+	arena.Free(allocation2);
+	arena.Free(allocation3);
+	TEST_VERIFY(arena.GetUsedSize() == 0);
+}
+
+void CCodeArenaTest::TestExecution()
+{
+	//Returns 0x1234
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	static const uint8 code[] = { 0xB8, 0x34, 0x12, 0x00, 0x00, 0xC3 };
+#elif defined(_M_ARM64) || defined(__aarch64__)
+	static const uint32 code[] = { 0x52800000 | (0x1234 << 5), 0xD65F03C0 };
+#else
+	//No code to try on this architecture
+	return;
+#endif
+
+	CCodeArena arena;
+	auto allocation = arena.Allocate(0, code, sizeof(code));
+	auto function = reinterpret_cast<uint32 (*)()>(allocation.code);
+	TEST_VERIFY(function() == 0x1234);
+
+	//New code written next to the one being executed is visible through the executable mapping
+	auto otherAllocation = arena.Allocate(0x10, code, sizeof(code));
+	auto otherFunction = reinterpret_cast<uint32 (*)()>(otherAllocation.code);
+	TEST_VERIFY(otherFunction() == 0x1234);
+	TEST_VERIFY(function() == 0x1234);
+
+	arena.Free(otherAllocation);
+	arena.Free(allocation);
+}
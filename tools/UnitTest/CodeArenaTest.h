@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Test.h"
+
+class CCodeArenaTest : public CTest
+{
+public:
+	void	Execute() override;
+
+private:
+	void	TestAllocation();
+	void	TestExecution();
+};
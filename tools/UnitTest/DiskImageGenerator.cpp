@@ -0,0 +1,158 @@
+#include <random>
+#include <cstring>
+#include <zlib.h>
+#include "DiskImageGenerator.h"
+#include "StdStream.h"
+
+using namespace DiskImageGenerator;
+
+#pragma pack(push, 1)
+//Same layout as CIszImageStream's header
+struct ISZ_HEADER
+{
+	char		signature[4];
+	uint8		headerSize;
+	int8		version;
+	uint32		volumeSerialNumber;
+	uint16		sectorSize;
+	uint32		totalSectors;
+	int8		hasPassword;
+	int64		segmentSize;
+	uint32		blockNumber;
+	uint32		blockSize;
+	uint8		blockPtrLength;
+	int8		segmentNumber;
+	uint32		blockPtrOffset;
+	uint32		segmentPtrOffset;
+	uint32		dataOffset;
+	int8		reserved;
+};
+#pragma pack(pop)
+
+std::vector<uint8> DiskImageGenerator::GenerateImage(uint32 sectorCount)
+{
+	//Mix of repeated patterns and noise, compresses about as well as typical game data
+	std::vector<uint8> image(sectorCount * SECTOR_SIZE);
+	std::mt19937 generator(0);
+	for(uint32 i = 0; i < image.size();)
+	{
+		uint32 runLength = 16 + (generator() % 256);
+		bool noise = (generator() % 4) == 0;
+		uint8 value = static_cast<uint8>(generator());
+		for(uint32 j = 0; (j < runLength) && (i < image.size()); j++, i++)
+		{
+			image[i] = noise ? static_cast<uint8>(generator()) : static_cast<uint8>(value + (j & 3));
+		}
+	}
+	return image;
+}
+
+Framework::CMemStream* DiskImageGenerator::CreateCsoImage(const std::vector<uint8>& image)
+{
+	static const uint32 frameSize = SECTOR_SIZE;
+	uint32 frameCount = static_cast<uint32>(image.size() / frameSize);
+
+	std::vector<uint32> index(frameCount + 1);
+	std::vector<uint8> frames;
+	uint32 dataOffset = 0x18 + static_cast<uint32>(index.size() * sizeof(uint32));
+	for(uint32 i = 0; i < frameCount; i++)
+	{
+		index[i] = dataOffset + static_cast<uint32>(frames.size());
+
+		std::vector<uint8> compressed(compressBound(frameSize));
+		z_stream z = {};
+		deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+		z.next_in = const_cast<Bytef*>(image.data() + (i * frameSize));
+		z.avail_in = frameSize;
+		z.next_out = compressed.data();
+		z.avail_out = static_cast<uInt>(compressed.size());
+		deflate(&z, Z_FINISH);
+		deflateEnd(&z);
+
+		if(z.total_out < frameSize)
+		{
+			frames.insert(frames.end(), compressed.begin(), compressed.begin() + z.total_out);
+		}
+		else
+		{
+			index[i] |= 0x80000000;
+			frames.insert(frames.end(), image.begin() + (i * frameSize), image.begin() + ((i + 1) * frameSize));
+		}
+	}
+	index[frameCount] = dataOffset + static_cast<uint32>(frames.size());
+
+	uint8 header[0x18] = { 'C', 'I', 'S', 'O' };
+	uint32 headerSize = sizeof(header);
+	uint64 totalBytes = image.size();
+	memcpy(header + 0x04, &headerSize, sizeof(uint32));
+	memcpy(header + 0x08, &totalBytes, sizeof(uint64));
+	memcpy(header + 0x10, &frameSize, sizeof(uint32));
+
+	auto stream = new Framework::CMemStream();
+	stream->Write(header, sizeof(header));
+	stream->Write(index.data(), index.size() * sizeof(uint32));
+	stream->Write(frames.data(), frames.size());
+	stream->Seek(0, Framework::STREAM_SEEK_SET);
+	return stream;
+}
+
+Framework::CMemStream* DiskImageGenerator::CreateIszImage(const std::vector<uint8>& image, uint32 blockSize)
+{
+	static const char* key = "IsZ!";
+	uint32 blockCount = static_cast<uint32>(image.size() / blockSize);
+
+	std::vector<uint8> table(blockCount * 3);
+	std::vector<uint8> blocks;
+	for(uint32 i = 0; i < blockCount; i++)
+	{
+		uLongf compressedSize = compressBound(blockSize);
+		std::vector<uint8> compressed(compressedSize);
+		compress(compressed.data(), &compressedSize, image.data() + (i * blockSize), blockSize);
+		blocks.insert(blocks.end(), compressed.begin(), compressed.begin() + compressedSize);
+
+		uint32 value = static_cast<uint32>(compressedSize) | (2 << 22);
+		for(uint32 j = 0; j < 3; j++)
+		{
+			table[(i * 3) + j] = static_cast<uint8>(value >> (j * 8));
+		}
+	}
+	for(uint32 i = 0; i < table.size(); i++)
+	{
+		table[i] ^= ~key[i & 3];
+	}
+
+	ISZ_HEADER header = {};
+	memcpy(header.signature, key, 4);
+	header.headerSize		= sizeof(ISZ_HEADER);
+	header.sectorSize		= SECTOR_SIZE;
+	header.totalSectors		= static_cast<uint32>(image.size() / SECTOR_SIZE);
+	header.blockNumber		= blockCount;
+	header.blockSize		= blockSize;
+	header.blockPtrLength	= 3;
+	header.blockPtrOffset	= sizeof(ISZ_HEADER);
+	//Leave room after the table, the table reader might read one byte past it
+	header.dataOffset		= static_cast<uint32>(sizeof(ISZ_HEADER) + table.size() + 1);
+
+	auto stream = new Framework::CMemStream();
+	stream->Write(&header, sizeof(ISZ_HEADER));
+	stream->Write(table.data(), table.size());
+	uint8 padding = 0;
+	stream->Write(&padding, 1);
+	stream->Write(blocks.data(), blocks.size());
+	stream->Seek(0, Framework::STREAM_SEEK_SET);
+	return stream;
+}
+
+boost::filesystem::path DiskImageGenerator::WriteImageFile(const std::vector<uint8>& image, uint32 internalSectorSize, uint32 headerSize)
+{
+	auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+	Framework::CStdStream stream(path.string().c_str(), "wb");
+	std::vector<uint8> sector(internalSectorSize);
+	uint32 sectorCount = static_cast<uint32>(image.size() / SECTOR_SIZE);
+	for(uint32 i = 0; i < sectorCount; i++)
+	{
+		memcpy(sector.data() + headerSize, image.data() + (i * SECTOR_SIZE), SECTOR_SIZE);
+		stream.Write(sector.data(), sector.size());
+	}
+	return path;
+}
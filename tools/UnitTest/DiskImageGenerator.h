@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "Types.h"
+#include "MemStream.h"
+
+//Builds disk images in the various formats supported by the disk providers, shared by tests and benchmarks
+namespace DiskImageGenerator
+{
+	enum
+	{
+		SECTOR_SIZE = 0x800,
+	};
+
+	std::vector<uint8>			GenerateImage(uint32 sectorCount);
+
+	Framework::CMemStream*		CreateCsoImage(const std::vector<uint8>&);
+	Framework::CMemStream*		CreateIszImage(const std::vector<uint8>&, uint32 blockSize);
+
+	//Writes an uncompressed image to a temporary file, 'headerSize' bytes are left before each sector
+	boost::filesystem::path		WriteImageFile(const std::vector<uint8>&, uint32 internalSectorSize, uint32 headerSize);
+}
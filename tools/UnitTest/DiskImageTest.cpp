@@ -0,0 +1,231 @@
+#include <random>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include "DiskImageTest.h"
+#include "DiskImageGenerator.h"
+#include "StdStream.h"
+#include "CsoImageStream.h"
+#include "IszImageStream.h"
+#include "ImageBlockCache.h"
+#include "ISO9660/BlockProvider.h"
+
+static const uint32 g_sectorSize = DiskImageGenerator::SECTOR_SIZE;
+static const uint32 g_sectorCount = 0x400;
+static const uint32 g_cacheBlockSize = 0x1000;
+static const uint32 g_cacheBlockCount = 16;
+
+//Counts how many times each block was decoded and fills blocks with their block number
+class CCountingSource
+{
+public:
+	CCountingSource()
+	{
+		for(auto& count : m_decodeCounts) count = 0;
+	}
+
+	CImageBlockCache::DecodeFunction GetDecodeFunction()
+	{
+		return
+			[this] (uint32 blockNumber, CImageBlockCache::Block& block)
+			{
+				block.assign(g_cacheBlockSize, static_cast<uint8>(blockNumber));
+				m_decodeCounts[blockNumber]++;
+			};
+	}
+
+	uint32 GetDecodeCount(uint32 blockNumber) const
+	{
+		return m_decodeCounts[blockNumber];
+	}
+
+private:
+	std::atomic<uint32> m_decodeCounts[g_cacheBlockCount];
+};
+
+static bool IsBlockValid(const CImageBlockCache::BlockPtr& block, uint32 blockNumber)
+{
+	return (block->size() == g_cacheBlockSize) &&
+		std::all_of(block->begin(), block->end(), [blockNumber] (uint8 value) { return value == static_cast<uint8>(blockNumber); });
+}
+
+void CDiskImageTest::Execute()
+{
+	TestBlockCacheEviction();
+	TestBlockCacheReadAhead();
+	TestBlockProviders();
+	TestCompressedStreams();
+}
+
+void CDiskImageTest::TestBlockCacheEviction()
+{
+	CImageBlockCache cache;
+	cache.SetMemoryBudget(3 * g_cacheBlockSize);
+
+	CCountingSource source;
+	auto sourceId = cache.RegisterSource(source.GetDecodeFunction(), g_cacheBlockCount, g_cacheBlockSize);
+
+	//None of these accesses are sequential, read-ahead never kicks in
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 0), 0));
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 5), 5));
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 10), 10));
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 0), 0));
+	TEST_VERIFY(source.GetDecodeCount(0) == 1);
+
+	//Block 5 is now the least recently used one and makes room for block 15
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 15), 15));
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 0), 0));
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 10), 10));
+	TEST_VERIFY(source.GetDecodeCount(0) == 1);
+	TEST_VERIFY(source.GetDecodeCount(10) == 1);
+	TEST_VERIFY(source.GetDecodeCount(15) == 1);
+
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 5), 5));
+	TEST_VERIFY(source.GetDecodeCount(5) == 2);
+
+	//Blocks handed out stay valid after being evicted
+	auto block = cache.GetBlock(sourceId, 3);
+	cache.SetMemoryBudget(0);
+	TEST_VERIFY(IsBlockValid(block, 3));
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 3), 3));
+	TEST_VERIFY(source.GetDecodeCount(3) == 1);
+	TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, 0), 0));
+	TEST_VERIFY(source.GetDecodeCount(0) == 2);
+
+	cache.UnregisterSource(sourceId);
+}
+
+void CDiskImageTest::TestBlockCacheReadAhead()
+{
+	CImageBlockCache cache;
+	cache.SetMemoryBudget(g_cacheBlockCount * g_cacheBlockSize * 4);
+
+	CCountingSource source;
+	auto sourceId = cache.RegisterSource(source.GetDecodeFunction(), g_cacheBlockCount, g_cacheBlockSize);
+
+	//Sequential accesses make the workers decode the rest of the source ahead of time
+	for(uint32 i = 0; i < 3; i++)
+	{
+		TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, i), i));
+	}
+
+	auto isReadAheadDone =
+		[&] ()
+		{
+			for(uint32 i = 3; i < g_cacheBlockCount; i++)
+			{
+				if(source.GetDecodeCount(i) == 0) return false;
+			}
+			return true;
+		};
+	auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while(!isReadAheadDone() && (std::chrono::steady_clock::now() < timeout))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	TEST_VERIFY(isReadAheadDone());
+
+	//Blocks read ahead are served from the cache, nothing gets decoded twice
+	for(uint32 i = 3; i < g_cacheBlockCount; i++)
+	{
+		TEST_VERIFY(IsBlockValid(cache.GetBlock(sourceId, i), i));
+	}
+	for(uint32 i = 0; i < g_cacheBlockCount; i++)
+	{
+		TEST_VERIFY(source.GetDecodeCount(i) == 1);
+	}
+
+	cache.UnregisterSource(sourceId);
+}
+
+void CDiskImageTest::TestBlockProviders()
+{
+	auto image = DiskImageGenerator::GenerateImage(g_sectorCount);
+	std::vector<uint8> buffer(16 * g_sectorSize);
+
+	auto verifyProvider =
+		[&] (ISO9660::CBlockProvider& blockProvider)
+		{
+			std::mt19937 generator(0);
+			for(uint32 i = 0; i < 0x100; i++)
+			{
+				uint32 count = 1 + (generator() % 16);
+				uint32 sector = generator() % (g_sectorCount - count + 1);
+				blockProvider.ReadBlocks(sector, count, buffer.data());
+				TEST_VERIFY(memcmp(buffer.data(), image.data() + (sector * g_sectorSize), count * g_sectorSize) == 0);
+			}
+		};
+
+	auto isoPath = DiskImageGenerator::WriteImageFile(image, 0x800, 0);
+	auto xaPath = DiskImageGenerator::WriteImageFile(image, 0x930, 0x18);
+	try
+	{
+		{
+			ISO9660::CBlockProvider2048 streamBlockProvider(std::make_shared<Framework::CStdStream>(isoPath.string().c_str(), "rb"));
+			verifyProvider(streamBlockProvider);
+			ISO9660::CBlockProviderMapped2048 mappedBlockProvider(std::make_shared<CMappedFile>(isoPath));
+			verifyProvider(mappedBlockProvider);
+		}
+		{
+			ISO9660::CBlockProviderCDROMXA streamBlockProvider(std::make_shared<Framework::CStdStream>(xaPath.string().c_str(), "rb"));
+			verifyProvider(streamBlockProvider);
+			ISO9660::CBlockProviderMappedCDROMXA mappedBlockProvider(std::make_shared<CMappedFile>(xaPath));
+			verifyProvider(mappedBlockProvider);
+		}
+	}
+	catch(...)
+	{
+		boost::filesystem::remove(isoPath);
+		boost::filesystem::remove(xaPath);
+		throw;
+	}
+	boost::filesystem::remove(isoPath);
+	boost::filesystem::remove(xaPath);
+}
+
+void CDiskImageTest::TestCompressedStreams()
+{
+	auto image = DiskImageGenerator::GenerateImage(g_sectorCount);
+	std::vector<uint8> buffer(0x10000);
+
+	//Reads of any size and alignment, some of them crossing block boundaries
+	auto verifyStream =
+		[&] (Framework::CStream& stream)
+		{
+			std::mt19937 generator(0);
+			for(uint32 i = 0; i < 0x200; i++)
+			{
+				uint32 size = 1 + (generator() % buffer.size());
+				uint32 position = generator() % (image.size() - size + 1);
+				stream.Seek(position, Framework::STREAM_SEEK_SET);
+				TEST_VERIFY(stream.Read(buffer.data(), size) == size);
+				TEST_VERIFY(memcmp(buffer.data(), image.data() + position, size) == 0);
+			}
+		};
+
+	auto& blockCache = CImageBlockCache::GetInstance();
+	size_t memoryBudget = blockCache.GetMemoryBudget();
+
+	//Also covers the cache keeping a single block around
+	for(auto budget : { static_cast<size_t>(0), memoryBudget })
+	{
+		blockCache.SetMemoryBudget(budget);
+
+		{
+			std::unique_ptr<Framework::CMemStream> csoBaseStream(DiskImageGenerator::CreateCsoImage(image));
+			CCsoImageStream csoStream(csoBaseStream.get());
+			verifyStream(csoStream);
+		}
+
+		{
+			//ISZ stream takes ownership of its base stream
+			CIszImageStream iszStream(DiskImageGenerator::CreateIszImage(image, 0x8000));
+			verifyStream(iszStream);
+		}
+	}
+
+	blockCache.SetMemoryBudget(memoryBudget);
+}
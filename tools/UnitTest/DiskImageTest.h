@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Test.h"
+
+class CDiskImageTest : public CTest
+{
+public:
+	void	Execute() override;
+
+private:
+	void	TestBlockCacheEviction();
+	void	TestBlockCacheReadAhead();
+	void	TestBlockProviders();
+	void	TestCompressedStreams();
+};
@@ -0,0 +1,117 @@
+#include <random>
+#include <vector>
+#include "GsCommandTest.h"
+#include "gs/GSH_Null.h"
+#include "gs/GsPixelFormats.h"
+
+//Records what reaches the GS thread, in order. Calls sent through the mailbox leave a marker.
+class CRecordingGsHandler : public CGSH_Null
+{
+public:
+	enum
+	{
+		MARKER_REGISTER = 0xFF,
+	};
+
+	void SendMarker(uint32 marker)
+	{
+		SendGSCall([this, marker] () { m_received.push_back(RegisterWrite(MARKER_REGISTER, marker)); });
+	}
+
+	void Synchronize()
+	{
+		SendGSCall([] () { }, true);
+	}
+
+	//Only safe to read after Synchronize
+	RegisterWriteList m_received;
+
+protected:
+	void WriteRegisterMassivelyImpl(const RegisterWrite* writeList, unsigned int count, const CGsPacketMetadata* metadata) override
+	{
+		m_received.insert(m_received.end(), writeList, writeList + count);
+		CGSH_Null::WriteRegisterMassivelyImpl(writeList, count, metadata);
+	}
+};
+
+void CGsCommandTest::Execute()
+{
+	//More commands than the ring holds, more payload than the arena holds
+	static const uint32 g_packetCount = 0x18000;
+	static const uint32 g_markerInterval = 0x100;
+	static const uint32 g_transferCount = 40;
+	static const uint32 g_transferWidth = 256;
+	static const uint32 g_transferHeight = 256;
+
+	CRecordingGsHandler gs;
+	std::mt19937 generator(0);
+
+	//Register writes and calls must reach the GS thread in submission order, with their content intact
+	{
+		CGSHandler::RegisterWriteList expected;
+		CGSHandler::RegisterWriteList packet;
+		for(uint32 i = 0; i < g_packetCount; i++)
+		{
+			packet.clear();
+			uint32 writeCount = (generator() % 32) + 1;
+			for(uint32 j = 0; j < writeCount; j++)
+			{
+				uint64 value = (static_cast<uint64>(generator()) << 32) | generator();
+				packet.push_back(CGSHandler::RegisterWrite(GS_REG_RGBAQ, value));
+			}
+			gs.WriteRegisterMassively(packet.data(), static_cast<unsigned int>(packet.size()), nullptr);
+			expected.insert(expected.end(), packet.begin(), packet.end());
+			if((i % g_markerInterval) == 0)
+			{
+				gs.SendMarker(i);
+				expected.push_back(CGSHandler::RegisterWrite(CRecordingGsHandler::MARKER_REGISTER, i));
+			}
+		}
+		gs.Synchronize();
+		TEST_VERIFY(gs.m_received == expected);
+	}
+
+	//Image data goes through the payload arena too, split in uneven chunks
+	{
+		std::vector<uint32> image(g_transferWidth * g_transferHeight);
+		for(uint32 transfer = 0; transfer < g_transferCount; transfer++)
+		{
+			for(auto& pixel : image) pixel = generator();
+
+			auto bltBuf = make_convertible<CGSHandler::BITBLTBUF>(0);
+			bltBuf.nDstPtr = 0;
+			bltBuf.nDstWidth = g_transferWidth / 64;
+			bltBuf.nDstPsm = CGSHandler::PSMCT32;
+			auto trxReg = make_convertible<CGSHandler::TRXREG>(0);
+			trxReg.nRRW = g_transferWidth;
+			trxReg.nRRH = g_transferHeight;
+
+			CGSHandler::RegisterWriteList setup;
+			setup.push_back(CGSHandler::RegisterWrite(GS_REG_BITBLTBUF, bltBuf));
+			setup.push_back(CGSHandler::RegisterWrite(GS_REG_TRXPOS, 0));
+			setup.push_back(CGSHandler::RegisterWrite(GS_REG_TRXREG, trxReg));
+			setup.push_back(CGSHandler::RegisterWrite(GS_REG_TRXDIR, 0));
+			gs.WriteRegisterMassively(setup.data(), static_cast<unsigned int>(setup.size()), nullptr);
+
+			auto data = reinterpret_cast<const uint8*>(image.data());
+			uint32 remaining = static_cast<uint32>(image.size() * sizeof(uint32));
+			while(remaining != 0)
+			{
+				uint32 chunkSize = std::min<uint32>(remaining, ((generator() % 0x800) + 1) * 0x10);
+				gs.FeedImageData(data, chunkSize);
+				data += chunkSize;
+				remaining -= chunkSize;
+			}
+			gs.Synchronize();
+
+			CGsPixelFormats::CPixelIndexorPSMCT32 indexor(gs.GetRam(), bltBuf.GetDstPtr(), bltBuf.nDstWidth);
+			for(uint32 y = 0; y < g_transferHeight; y++)
+			{
+				for(uint32 x = 0; x < g_transferWidth; x++)
+				{
+					TEST_VERIFY(indexor.GetPixel(x, y) == image[x + (y * g_transferWidth)]);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Test.h"
+
+class CGsCommandTest : public CTest
+{
+public:
+	void	Execute() override;
+};
@@ -0,0 +1,164 @@
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "IpuTest.h"
+#include "ee/IPU_Idct.h"
+#include "ee/IPU_Csc.h"
+#include "idct/IEEE1180.h"
+
+//Straightforward per pixel version of the CSC command, used as reference for IPU::CCsc
+static void ConvertReference(const uint8* block, void* output, bool ofm, bool dte, uint16 TH0, uint16 TH1)
+{
+	static const int32 ditherMatrix[4][4] =
+	{
+		{ -4,  0, -3,  1 },
+		{  2, -2,  3, -1 },
+		{ -3,  1, -4,  0 },
+		{  3, -1,  2, -2 },
+	};
+
+	auto pixels32 = reinterpret_cast<uint32*>(output);
+	auto pixels16 = reinterpret_cast<uint16*>(output);
+
+	for(unsigned int y = 0; y < 16; y++)
+	{
+		for(unsigned int x = 0; x < 16; x++)
+		{
+			unsigned int chromaIndex = ((y / 2) * 8) + (x / 2);
+			float nY = block[(y * 0x10) + x];
+			float nCb = static_cast<float>(block[0x100 + chromaIndex]) - 128;
+			float nCr = static_cast<float>(block[0x140 + chromaIndex]) - 128;
+
+			float components[3] =
+			{
+				nY + (1.402f * nCr),
+				(nY - (0.34414f * nCb)) - (0.71414f * nCr),
+				nY + (1.772f * nCb),
+			};
+			uint32 rgb[3] = {};
+			for(unsigned int i = 0; i < 3; i++)
+			{
+				rgb[i] = static_cast<uint32>(std::min<float>(std::max<float>(components[i], 0), 255));
+			}
+
+			//Alpha comes from comparing the whole color against the thresholds
+			uint32 color = rgb[0] | (rgb[1] << 8) | (rgb[2] << 16);
+			uint32 th0 = (TH0 & 0xFF) * 0x10101;
+			uint32 th1 = (TH1 & 0xFF) * 0x10101;
+			uint32 alpha = (color < th0) ? 0 : ((color < th1) ? 0x40 : 0x80);
+
+			unsigned int pixelIndex = (y * 0x10) + x;
+			if(!ofm)
+			{
+				pixels32[pixelIndex] = color | (alpha << 24);
+			}
+			else
+			{
+				int32 dither = dte ? ditherMatrix[y & 3][x & 3] : 0;
+				uint32 pixel = (alpha == 0x40) ? 0x8000 : 0;
+				for(unsigned int i = 0; i < 3; i++)
+				{
+					int32 value = std::min<int32>(std::max<int32>(static_cast<int32>(rgb[i]) + dither, 0), 255);
+					pixel |= (value >> 3) << (i * 5);
+				}
+				pixels16[pixelIndex] = static_cast<uint16>(pixel);
+			}
+		}
+	}
+}
+
+void CIpuTest::Execute()
+{
+	TestIdct();
+	TestCsc();
+}
+
+void CIpuTest::TestIdct()
+{
+	static const uint32 g_blockCount = 0x1000;
+	static const uint32 g_blockSize = 0x40;
+
+	//A DC only block spreads DC / 8 over every sample, results are clamped to [-256, 255]
+	{
+		static const int16 dcValues[] = { 80, -2048, 4000, -4000 };
+		static const int16 dcResults[] = { 10, -256, 255, -256 };
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			int16 input[g_blockSize] = {};
+			int16 output[g_blockSize] = {};
+			input[0] = dcValues[i];
+			IPU::CIdct::Transform(input, output);
+			TEST_VERIFY(std::all_of(std::begin(output), std::end(output), [&] (int16 value) { return value == dcResults[i]; }));
+		}
+	}
+
+	//Sparse blocks like the VLC decoder produces and dense ones with the full coefficient range
+	std::mt19937 generator(0);
+	std::vector<int16> input(g_blockCount * g_blockSize);
+	for(uint32 i = 0; i < input.size(); i++)
+	{
+		uint32 value = generator();
+		bool isDc = (i % g_blockSize) == 0;
+		bool isDense = ((i / g_blockSize) & 1) != 0;
+		if(isDense)
+		{
+			input[i] = static_cast<int16>((value >> 8) % 4096) - 2048;
+		}
+		else
+		{
+			input[i] = (isDc || ((value % 8) == 0)) ? static_cast<int16>((value >> 8) % 512) - 256 : 0;
+		}
+	}
+
+	//IEEE 1180 accuracy allows results to be off by one from the double precision transform
+	for(uint32 block = 0; block < g_blockCount; block++)
+	{
+		int16 referenceOutput[g_blockSize];
+		int16 output[g_blockSize];
+		IDCT::CIEEE1180::GetInstance()->Transform(input.data() + (block * g_blockSize), referenceOutput);
+		IPU::CIdct::Transform(input.data() + (block * g_blockSize), output);
+		for(uint32 i = 0; i < g_blockSize; i++)
+		{
+			int32 difference = static_cast<int32>(output[i]) - static_cast<int32>(referenceOutput[i]);
+			TEST_VERIFY((difference >= -1) && (difference <= 1));
+		}
+	}
+}
+
+void CIpuTest::TestCsc()
+{
+	static const uint32 g_blockCount = 0x40;
+
+	//Mid gray, between both alpha thresholds
+	{
+		uint8 block[IPU::CCsc::BLOCK_SIZE];
+		std::fill(std::begin(block), std::end(block), 0x80);
+		uint32 pixels[IPU::CCsc::RGB32_SIZE / 4];
+		IPU::CCsc::ConvertBlock(block, pixels, false, false, 0x10, 0x90);
+		TEST_VERIFY(std::all_of(std::begin(pixels), std::end(pixels), [] (uint32 pixel) { return pixel == 0x40808080; }));
+	}
+
+	std::mt19937 generator(0);
+	for(uint32 blockIndex = 0; blockIndex < g_blockCount; blockIndex++)
+	{
+		uint8 block[IPU::CCsc::BLOCK_SIZE];
+		for(auto& value : block) value = static_cast<uint8>(generator());
+
+		//Keeps TH0 <= TH1 on half of the blocks so that all three alpha values show up
+		uint16 TH0 = static_cast<uint16>(generator() & 0x1FF);
+		uint16 TH1 = static_cast<uint16>(generator() & 0x1FF);
+		if((blockIndex & 1) && (TH0 > TH1)) std::swap(TH0, TH1);
+
+		for(unsigned int variant = 0; variant < 4; variant++)
+		{
+			bool ofm = (variant & 1) != 0;
+			bool dte = (variant & 2) != 0;
+
+			uint8 referenceOutput[IPU::CCsc::RGB32_SIZE] = {};
+			uint8 output[IPU::CCsc::RGB32_SIZE] = {};
+			ConvertReference(block, referenceOutput, ofm, dte, TH0, TH1);
+			IPU::CCsc::ConvertBlock(block, output, ofm, dte, TH0, TH1);
+			TEST_VERIFY(std::equal(std::begin(output), std::end(output), std::begin(referenceOutput)));
+		}
+	}
+}
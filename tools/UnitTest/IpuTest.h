@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Test.h"
+
+class CIpuTest : public CTest
+{
+public:
+	void	Execute() override;
+
+private:
+	void	TestIdct();
+	void	TestCsc();
+};
@@ -0,0 +1,91 @@
+#include <vector>
+#include "LoopBlockTest.h"
+#include "MIPS.h"
+#include "MA_MIPSIV.h"
+#include "MIPSAssembler.h"
+#include "MipsExecutor.h"
+
+static const uint32 g_ramSize = 0x10000;
+static const uint32 g_outerIterations = 4;
+static const uint32 g_innerIterations = 0x10;
+
+//Inner loop has a forward branch skipping an instruction on even iterations, program stops on the SYSCALL
+static void AssembleProgram(uint8* ram)
+{
+	CMIPSAssembler assembler(reinterpret_cast<uint32*>(ram));
+	auto outerLabel = assembler.CreateLabel();
+	auto innerLabel = assembler.CreateLabel();
+	auto skipLabel = assembler.CreateLabel();
+
+	assembler.ADDIU(CMIPS::T1, CMIPS::R0, g_outerIterations);
+	assembler.MarkLabel(outerLabel);
+	assembler.ADDIU(CMIPS::T0, CMIPS::R0, g_innerIterations);
+	assembler.MarkLabel(innerLabel);
+	assembler.ANDI(CMIPS::T2, CMIPS::T0, 1);
+	assembler.BEQ(CMIPS::T2, CMIPS::R0, skipLabel);
+	assembler.ADDU(CMIPS::T3, CMIPS::T3, CMIPS::T0);
+	assembler.ADDIU(CMIPS::T4, CMIPS::T4, 1);
+	assembler.MarkLabel(skipLabel);
+	assembler.ADDIU(CMIPS::T0, CMIPS::T0, 0xFFFF);
+	assembler.BNE(CMIPS::T0, CMIPS::R0, innerLabel);
+	assembler.NOP();
+	assembler.ADDIU(CMIPS::T1, CMIPS::T1, 0xFFFF);
+	assembler.BNE(CMIPS::T1, CMIPS::R0, outerLabel);
+	assembler.NOP();
+	assembler.SYSCALL();
+	assembler.JR(CMIPS::RA);
+	assembler.NOP();
+}
+
+void CLoopBlockTest::Execute()
+{
+	//Instructions executed up to and including the SYSCALL
+	//Inner loop runs 7 instructions on odd iterations and 6 on even ones, outer loop adds 4
+	uint64 expectedExecutedCount = 2 + (g_outerIterations * (4 + ((g_innerIterations * 13) / 2)));
+	uint32 expectedOddCount = g_outerIterations * (g_innerIterations / 2);
+	uint32 expectedSum = g_outerIterations * ((g_innerIterations * (g_innerIterations + 1)) / 2);
+
+	//Small time slices make loop blocks exit on their iteration limit, big ones let them run to the end
+	static const int sliceCycles[] = { 0x10, 0x100, 0x10000 };
+	for(auto slice : sliceCycles)
+	{
+		for(auto loopBlocksEnabled : { false, true })
+		{
+			auto result = RunProgram(loopBlocksEnabled, slice);
+			TEST_VERIFY(result.executedCount == expectedExecutedCount);
+			TEST_VERIFY(result.oddCount == expectedOddCount);
+			TEST_VERIFY(result.sum == expectedSum);
+		}
+	}
+}
+
+CLoopBlockTest::RESULT CLoopBlockTest::RunProgram(bool loopBlocksEnabled, int sliceCycles)
+{
+	std::vector<uint8> ram(g_ramSize);
+	AssembleProgram(ram.data());
+
+	CMIPS cpu(MEMORYMAP_ENDIAN_LSBF);
+	CMA_MIPSIV cpuArch(MIPS_REGSIZE_32);
+	cpu.m_pMemoryMap->InsertReadMap(0, g_ramSize - 1, ram.data(), 0x01);
+	cpu.m_pMemoryMap->InsertWriteMap(0, g_ramSize - 1, ram.data(), 0x01);
+	cpu.m_pMemoryMap->InsertInstructionMap(0, g_ramSize - 1, ram.data(), 0x01);
+	cpu.m_pArch = &cpuArch;
+	cpu.m_pAddrTranslator = &CMIPS::TranslateAddress64;
+
+	CMipsExecutor executor(cpu, g_ramSize);
+	executor.SetLoopBlocksEnabled(loopBlocksEnabled);
+	cpu.m_State.nPC = 0;
+
+	//Time used by every slice is what the blocks report as executed
+	RESULT result;
+	while(cpu.m_State.nHasException == MIPS_EXCEPTION_NONE)
+	{
+		int remainingCycles = executor.Execute(sliceCycles);
+		result.executedCount += static_cast<int64>(sliceCycles) - remainingCycles;
+		TEST_VERIFY(result.executedCount <= 0x10000);
+	}
+	TEST_VERIFY(cpu.m_State.nHasException == MIPS_EXCEPTION_SYSCALL);
+	result.oddCount = cpu.m_State.nGPR[CMIPS::T4].nV[0];
+	result.sum = cpu.m_State.nGPR[CMIPS::T3].nV[0];
+	return result;
+}
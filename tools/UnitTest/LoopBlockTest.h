@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Test.h"
+
+class CLoopBlockTest : public CTest
+{
+public:
+	void	Execute() override;
+
+private:
+	struct RESULT
+	{
+		uint64	executedCount = 0;
+		uint32	oddCount = 0;
+		uint32	sum = 0;
+	};
+
+	RESULT	RunProgram(bool, int);
+};
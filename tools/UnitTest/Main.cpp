@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <memory>
+#include <functional>
+#include "CodeArenaTest.h"
+#include "DiskImageTest.h"
+#include "GsCommandTest.h"
+#include "IpuTest.h"
+#include "LoopBlockTest.h"
+#include "MemoryMapTest.h"
+#include "StateSnapshotTest.h"
+#include "VifUnpackTest.h"
+
+typedef std::function<CTest* ()> TestFactoryFunction;
+
+static const TestFactoryFunction s_factories[] =
+{
+	[] () { return new CMemoryMapTest(); },
+	[] () { return new CVifUnpackTest(); },
+	[] () { return new CGsCommandTest(); },
+	[] () { return new CIpuTest(); },
+	[] () { return new CDiskImageTest(); },
+	[] () { return new CStateSnapshotTest(); },
+	[] () { return new CCodeArenaTest(); },
+	[] () { return new CLoopBlockTest(); },
+};
+
+int main(int argc, const char** argv)
+{
+	int result = 0;
+	for(const auto& factory : s_factories)
+	{
+		auto test = std::unique_ptr<CTest>(factory());
+		try
+		{
+			test->Execute();
+		}
+		catch(const std::exception& exception)
+		{
+			printf("Test failed: %s\n", exception.what());
+			result = 1;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,93 @@
+#include <vector>
+#include "MemoryMapTest.h"
+#include "MemoryMap.h"
+
+void CMemoryMapTest::Execute()
+{
+	static const uint32 g_ramSize = 0x40000;
+	static const uint32 g_ioAddress = 0x10000000;
+	static const uint32 g_sharedPageAddress = 0x11000000;
+	static const uint32 g_watchedAddress = 0x12000000;
+	static const uint32 g_watchedSize = 0x2000;
+
+	std::vector<uint8> ram(g_ramSize);
+	std::vector<uint8> halfPage(CMemoryMap::PAGE_SIZE / 2);
+	std::vector<uint8> watched(g_watchedSize);
+	for(uint32 i = 0; i < g_ramSize; i++)
+	{
+		ram[i] = static_cast<uint8>(i * 7);
+	}
+
+	uint32 ioReadCount = 0;
+	uint32 watchedAccessCount = 0;
+	uint32 lastIoWrite = 0;
+
+	//Memory and handlers sharing a page can't be resolved by the page table alone
+	CMemoryMap_LSBF memoryMap;
+	memoryMap.InsertReadMap(0, g_ramSize - 1, ram.data(), 0x00);
+	memoryMap.InsertReadMap(g_ioAddress, g_ioAddress + 0xFFFF,
+		[&] (uint32 address, uint32) { ioReadCount++; return address ^ 0xA5A5A5A5; }, 0x01);
+	memoryMap.InsertReadMap(g_sharedPageAddress, g_sharedPageAddress + (CMemoryMap::PAGE_SIZE / 2) - 1, halfPage.data(), 0x02);
+	memoryMap.InsertReadMap(g_sharedPageAddress + (CMemoryMap::PAGE_SIZE / 2), g_sharedPageAddress + CMemoryMap::PAGE_SIZE - 1,
+		[] (uint32 address, uint32) { return ~address; }, 0x03);
+	memoryMap.InsertReadMap(g_watchedAddress, g_watchedAddress + g_watchedSize - 1, watched.data(),
+		[&] (uint32, uint32) { watchedAccessCount++; return 0; }, 0x04);
+
+	memoryMap.InsertWriteMap(0, g_ramSize - 1, ram.data(), 0x00);
+	memoryMap.InsertWriteMap(g_ioAddress, g_ioAddress + 0xFFFF,
+		[&] (uint32, uint32 value) { lastIoWrite = value; return 0; }, 0x01);
+	memoryMap.InsertWriteMap(g_watchedAddress, g_watchedAddress + g_watchedSize - 1, watched.data(),
+		[&] (uint32, uint32) { watchedAccessCount++; return 0; }, 0x04);
+
+	//Pages entirely backed by memory without an access handler are the only ones with a direct pointer
+	TEST_VERIFY(memoryMap.GetReadPointer(0x1234) == ram.data() + 0x1234);
+	TEST_VERIFY(memoryMap.GetWritePointer(g_ramSize - 4) == ram.data() + g_ramSize - 4);
+	TEST_VERIFY(memoryMap.GetReadPointer(g_ramSize) == nullptr);
+	TEST_VERIFY(memoryMap.GetReadPointer(g_ioAddress) == nullptr);
+	TEST_VERIFY(memoryMap.GetReadPointer(g_sharedPageAddress) == nullptr);
+	TEST_VERIFY(memoryMap.GetReadPointer(g_watchedAddress) == nullptr);
+	TEST_VERIFY(memoryMap.GetWritePointer(g_watchedAddress) == nullptr);
+
+	//Reads across every kind of page
+	for(uint32 address = 0; address < g_ramSize; address += 0x104)
+	{
+		TEST_VERIFY(memoryMap.GetWord(address) == *reinterpret_cast<const uint32*>(ram.data() + address));
+	}
+	TEST_VERIFY(memoryMap.GetByte(0x3003) == ram[0x3003]);
+	TEST_VERIFY(memoryMap.GetHalf(0x3006) == *reinterpret_cast<const uint16*>(ram.data() + 0x3006));
+	TEST_VERIFY(memoryMap.GetWord(g_ramSize) == 0xCCCCCCCC);
+
+	TEST_VERIFY(memoryMap.GetWord(g_ioAddress + 0x1230) == ((g_ioAddress + 0x1230) ^ 0xA5A5A5A5));
+	TEST_VERIFY(ioReadCount == 1);
+
+	halfPage[0x10] = 0x5A;
+	TEST_VERIFY(memoryMap.GetByte(g_sharedPageAddress + 0x10) == 0x5A);
+	TEST_VERIFY(memoryMap.GetWord(g_sharedPageAddress + 0x800) == ~(g_sharedPageAddress + 0x800));
+	TEST_VERIFY(memoryMap.GetWord(g_sharedPageAddress + 0xFFC) == ~(g_sharedPageAddress + 0xFFC));
+
+	watched[0x1004] = 0x42;
+	TEST_VERIFY(memoryMap.GetByte(g_watchedAddress + 0x1004) == 0x42);
+	TEST_VERIFY(watchedAccessCount == 1);
+
+	//Writes
+	memoryMap.SetWord(0x2000, 0x11223344);
+	TEST_VERIFY(*reinterpret_cast<const uint32*>(ram.data() + 0x2000) == 0x11223344);
+	memoryMap.SetHalf(0x2002, 0x5566);
+	TEST_VERIFY(*reinterpret_cast<const uint32*>(ram.data() + 0x2000) == 0x55663344);
+	memoryMap.SetByte(0x2001, 0x77);
+	TEST_VERIFY(*reinterpret_cast<const uint32*>(ram.data() + 0x2000) == 0x55667744);
+
+	memoryMap.SetWord(g_ioAddress + 0x10, 0xDEADBEEF);
+	TEST_VERIFY(lastIoWrite == 0xDEADBEEF);
+
+	memoryMap.SetWord(g_watchedAddress + 0x8, 0xCAFEBABE);
+	TEST_VERIFY(*reinterpret_cast<const uint32*>(watched.data() + 0x8) == 0xCAFEBABE);
+	TEST_VERIFY(watchedAccessCount == 2);
+
+	//Elements inserted later must show up in the page table
+	std::vector<uint8> lateMemory(CMemoryMap::PAGE_SIZE);
+	TEST_VERIFY(memoryMap.GetReadPointer(0x20000000) == nullptr);
+	memoryMap.InsertReadMap(0x20000000, 0x20000000 + CMemoryMap::PAGE_SIZE - 1, lateMemory.data(), 0x05);
+	TEST_VERIFY(memoryMap.GetReadPointer(0x20000010) == lateMemory.data() + 0x10);
+	TEST_VERIFY(memoryMap.GetWord(0x1234 & ~3) == *reinterpret_cast<const uint32*>(ram.data() + (0x1234 & ~3)));
+}
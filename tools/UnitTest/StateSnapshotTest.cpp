@@ -0,0 +1,79 @@
+#include <vector>
+#include <cstring>
+#include "StateSnapshotTest.h"
+#include "StateSnapshot.h"
+
+void CStateSnapshotTest::Execute()
+{
+	static const uint32 g_pageSize = 0x1000;
+	//Not a multiple of the page size, to cover the last partial page
+	static const uint32 g_memorySize = (g_pageSize * 8) + 0x100;
+
+	std::vector<uint8> memory(g_memorySize);
+	for(uint32 i = 0; i < g_memorySize; i++)
+	{
+		memory[i] = static_cast<uint8>(i * 7);
+	}
+	std::vector<uint8> otherMemory(g_pageSize, 0xAA);
+
+	CStateSnapshot snapshot;
+	TEST_VERIFY(CStateSnapshot::GetCurrent() == nullptr);
+
+	//First capture copies everything
+	{
+		CStateSnapshot::CCaptureScope captureScope(snapshot);
+		TEST_VERIFY(CStateSnapshot::GetCurrent() == &snapshot);
+		auto captured = snapshot.CaptureRegion("ram", memory.data(), g_memorySize);
+		TEST_VERIFY(memcmp(captured, memory.data(), g_memorySize) == 0);
+		snapshot.CaptureRegion("other", otherMemory.data(), otherMemory.size());
+		TEST_VERIFY(snapshot.GetCapturedSize() == (g_memorySize + otherMemory.size()));
+		TEST_VERIFY(snapshot.GetCopiedSize() == (g_memorySize + otherMemory.size()));
+	}
+	TEST_VERIFY(CStateSnapshot::GetCurrent() == nullptr);
+
+	//Nothing changed, nothing to copy
+	{
+		CStateSnapshot::CCaptureScope captureScope(snapshot);
+		auto captured = snapshot.CaptureRegion("ram", memory.data(), g_memorySize);
+		TEST_VERIFY(memcmp(captured, memory.data(), g_memorySize) == 0);
+		TEST_VERIFY(snapshot.GetCapturedSize() == g_memorySize);
+		TEST_VERIFY(snapshot.GetCopiedSize() == 0);
+	}
+
+	//Only the modified pages are copied, including the partial one at the end
+	memory[(g_pageSize * 3) + 0x10]++;
+	memory[(g_pageSize * 3) + 0xF00]++;
+	memory[g_memorySize - 1]++;
+	{
+		CStateSnapshot::CCaptureScope captureScope(snapshot);
+		auto captured = snapshot.CaptureRegion("ram", memory.data(), g_memorySize);
+		TEST_VERIFY(memcmp(captured, memory.data(), g_memorySize) == 0);
+		TEST_VERIFY(snapshot.GetCopiedSize() == (g_pageSize + 0x100));
+	}
+
+	//Regions are tracked separately
+	otherMemory[0]++;
+	{
+		CStateSnapshot::CCaptureScope captureScope(snapshot);
+		snapshot.CaptureRegion("ram", memory.data(), g_memorySize);
+		auto captured = snapshot.CaptureRegion("other", otherMemory.data(), otherMemory.size());
+		TEST_VERIFY(memcmp(captured, otherMemory.data(), otherMemory.size()) == 0);
+		TEST_VERIFY(snapshot.GetCopiedSize() == g_pageSize);
+	}
+
+	//A region that changed size is copied again as a whole
+	{
+		CStateSnapshot::CCaptureScope captureScope(snapshot);
+		auto captured = snapshot.CaptureRegion("ram", memory.data(), g_pageSize * 2);
+		TEST_VERIFY(memcmp(captured, memory.data(), g_pageSize * 2) == 0);
+		TEST_VERIFY(snapshot.GetCopiedSize() == (g_pageSize * 2));
+	}
+
+	//Clearing drops the previous copies
+	snapshot.Clear();
+	{
+		CStateSnapshot::CCaptureScope captureScope(snapshot);
+		snapshot.CaptureRegion("ram", memory.data(), g_memorySize);
+		TEST_VERIFY(snapshot.GetCopiedSize() == g_memorySize);
+	}
+}
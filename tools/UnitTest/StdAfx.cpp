@@ -0,0 +1 @@
+#include "StdAfx.h"
@@ -0,0 +1,19 @@
+#ifndef _STDAFX_H_
+#define _STDAFX_H_
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <functional>
+#include <memory>
+
+#include <boost/signals2.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "Types.h"
+#include "Stream.h"
+#include "xml/Node.h"
+
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdexcept>
+#include "Types.h"
+
+#define TEST_STRINGIFY_(a) #a
+#define TEST_STRINGIFY(a) TEST_STRINGIFY_(a)
+#define TEST_VERIFY(a) if(!(a)) { throw std::runtime_error(__FILE__ "(" TEST_STRINGIFY(__LINE__) "): " #a); }
+
+class CTest
+{
+public:
+	virtual			~CTest() {}
+	virtual void	Execute() = 0;
+};
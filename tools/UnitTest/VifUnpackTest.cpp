@@ -0,0 +1,131 @@
+#include <random>
+#include <vector>
+#include <cstring>
+#include "VifUnpackTest.h"
+#include "ee/VifUnpack.h"
+#include "Ps2Const.h"
+
+//Decodes elements one at a time like the generic path of CVif::Cmd_UNPACK when CL == WL
+static uint32 UnpackReference(VifUnpack::STATE& state, uint8* vuMem, uint32 vuMemSize, uint32 dstAddr,
+	const uint8* src, uint32 count, uint32 format, bool usn, bool useMask, uint32 mode)
+{
+	for(uint32 element = 0; element < count; element++)
+	{
+		uint32 value[4] = {};
+		if(format == VifUnpack::FORMAT_V4_5)
+		{
+			uint16 color = 0;
+			memcpy(&color, src, 2);
+			value[0] = ((color >>  0) & 0x1F) << 3;
+			value[1] = ((color >>  5) & 0x1F) << 3;
+			value[2] = ((color >> 10) & 0x1F) << 3;
+			value[3] = ((color >> 15) & 0x01) << 7;
+		}
+		else
+		{
+			uint32 fieldCount = ((format >> 2) & 0x03) + 1;
+			uint32 fieldSize = 4 >> (format & 0x03);
+			for(unsigned int i = 0; i < fieldCount; i++)
+			{
+				uint32 temp = 0;
+				memcpy(&temp, src + (i * fieldSize), fieldSize);
+				if(!usn && (fieldSize == 2)) temp = static_cast<int16>(temp);
+				if(!usn && (fieldSize == 1)) temp = static_cast<int8>(temp);
+				value[i] = temp;
+			}
+			if(fieldCount == 1)
+			{
+				value[1] = value[2] = value[3] = value[0];
+			}
+		}
+		src += VifUnpack::GetElementSize(format);
+
+		auto dst = reinterpret_cast<uint32*>(vuMem + dstAddr);
+		uint32 col = std::min<uint32>(state.writeTick, 3);
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			uint32 maskOp = useMask ? ((state.mask >> (((col * 4) + i) * 2)) & 0x03) : VifUnpack::MASKOP_DATA;
+			switch(maskOp)
+			{
+			case VifUnpack::MASKOP_DATA:
+				if(mode != VifUnpack::MODE_NORMAL) value[i] += state.row[i];
+				if(mode == VifUnpack::MODE_DIFFERENCE) state.row[i] = value[i];
+				dst[i] = value[i];
+				break;
+			case VifUnpack::MASKOP_ROW:
+				dst[i] = state.row[i];
+				break;
+			case VifUnpack::MASKOP_COL:
+				dst[i] = state.col[col];
+				break;
+			}
+		}
+
+		state.writeTick++;
+		if(state.writeTick == state.cycleLength) state.writeTick = 0;
+		dstAddr = (dstAddr + 0x10) & (vuMemSize - 1);
+	}
+	return dstAddr;
+}
+
+void CVifUnpackTest::Execute()
+{
+	static const uint32 g_formats[] =
+	{
+		VifUnpack::FORMAT_S32, VifUnpack::FORMAT_S16, VifUnpack::FORMAT_S8,
+		VifUnpack::FORMAT_V2_32, VifUnpack::FORMAT_V2_16, VifUnpack::FORMAT_V2_8,
+		VifUnpack::FORMAT_V3_32, VifUnpack::FORMAT_V3_16, VifUnpack::FORMAT_V3_8,
+		VifUnpack::FORMAT_V4_32, VifUnpack::FORMAT_V4_16, VifUnpack::FORMAT_V4_8,
+		VifUnpack::FORMAT_V4_5,
+	};
+	static const uint32 g_elementCount = 37;
+
+	//Nothing to compare against on platforms without specialised kernels
+	if(VifUnpack::GetFunction(VifUnpack::FORMAT_V4_32, false, false, VifUnpack::MODE_NORMAL) == nullptr) return;
+
+	std::mt19937 generator(0);
+	std::vector<uint8> source(g_elementCount * 16);
+	std::vector<uint8> referenceVuMem(PS2::VUMEM1SIZE);
+	std::vector<uint8> fastVuMem(PS2::VUMEM1SIZE);
+
+	for(auto format : g_formats)
+	{
+		for(unsigned int variant = 0; variant < 12; variant++)
+		{
+			bool usn = (variant & 1) != 0;
+			bool useMask = (variant & 2) != 0;
+			uint32 mode = variant >> 2;
+
+			auto unpackFunction = VifUnpack::GetFunction(format, usn, useMask, mode);
+			TEST_VERIFY(unpackFunction != nullptr);
+
+			for(auto& value : source) value = static_cast<uint8>(generator());
+			for(auto& value : referenceVuMem) value = static_cast<uint8>(generator());
+			fastVuMem = referenceVuMem;
+
+			VifUnpack::STATE referenceState = {};
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				referenceState.row[i] = generator();
+				referenceState.col[i] = generator();
+			}
+			//Covers every mask operation, including the one that leaves the destination untouched
+			referenceState.mask = generator();
+			referenceState.cycleLength = (generator() % 4) + 1;
+			referenceState.writeTick = generator() % referenceState.cycleLength;
+			auto fastState = referenceState;
+
+			//Starts close to the end of VU memory to check the destination address wrapping around
+			uint32 dstAddr = PS2::VUMEM1SIZE - 0x100;
+			uint32 referenceDstAddr = UnpackReference(referenceState, referenceVuMem.data(), PS2::VUMEM1SIZE, dstAddr,
+				source.data(), g_elementCount, format, usn, useMask, mode);
+			uint32 fastDstAddr = unpackFunction(fastState, fastVuMem.data(), PS2::VUMEM1SIZE, dstAddr,
+				source.data(), g_elementCount);
+
+			TEST_VERIFY(fastDstAddr == referenceDstAddr);
+			TEST_VERIFY(fastState.writeTick == referenceState.writeTick);
+			TEST_VERIFY(memcmp(fastState.row, referenceState.row, sizeof(referenceState.row)) == 0);
+			TEST_VERIFY(fastVuMem == referenceVuMem);
+		}
+	}
+}
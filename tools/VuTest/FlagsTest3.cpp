@@ -0,0 +1,95 @@
+#include "FlagsTest3.h"
+#include "VuAssembler.h"
+
+void CFlagsTest3::Execute(CTestVm& virtualMachine)
+{
+	virtualMachine.Reset();
+
+	auto microMem = reinterpret_cast<uint32*>(virtualMachine.m_microMem);
+
+	//Consecutive FMAC operations where some MAC flag results are overwritten before being read.
+	//Flags observed by FMAND/FSAND and sticky flags must not be affected by the removal of those updates.
+
+	CVuAssembler assembler(microMem);
+
+	//pipe = 0		//macTime = 4, read by FMAND at pipe 4
+	assembler.Write(
+		CVuAssembler::Upper::SUBbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF3, CVuAssembler::VF1, CVuAssembler::VF1, CVuAssembler::BC_X),
+		CVuAssembler::Lower::NOP()
+	);
+
+	//pipe = 1		//macTime = 5, never read, only contributes to sticky flags
+	assembler.Write(
+		CVuAssembler::Upper::SUBbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF4, CVuAssembler::VF2, CVuAssembler::VF1, CVuAssembler::BC_X),
+		CVuAssembler::Lower::NOP()
+	);
+
+	//pipe = 2		//macTime = 6, read by FMAND at pipe 6
+	assembler.Write(
+		CVuAssembler::Upper::SUBbc(CVuAssembler::DEST_XY, CVuAssembler::VF5, CVuAssembler::VF1, CVuAssembler::VF1, CVuAssembler::BC_X),
+		CVuAssembler::Lower::NOP()
+	);
+
+	//pipe = 3		//macTime = 7, never read, only contributes to sticky flags
+	assembler.Write(
+		CVuAssembler::Upper::SUBbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF6, CVuAssembler::VF2, CVuAssembler::VF1, CVuAssembler::BC_X),
+		CVuAssembler::Lower::NOP()
+	);
+
+	//pipe = 4		//macTime = 8, read by FSAND at pipe 8
+	assembler.Write(
+		CVuAssembler::Upper::SUBbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF7, CVuAssembler::VF1, CVuAssembler::VF1, CVuAssembler::BC_X),
+		CVuAssembler::Lower::FMAND(CVuAssembler::VI1, CVuAssembler::VI15)
+	);
+
+	//pipe = 5
+	assembler.Write(
+		CVuAssembler::Upper::NOP(),
+		CVuAssembler::Lower::NOP()
+	);
+
+	//pipe = 6
+	assembler.Write(
+		CVuAssembler::Upper::NOP(),
+		CVuAssembler::Lower::FMAND(CVuAssembler::VI2, CVuAssembler::VI15)
+	);
+
+	//pipe = 7
+	assembler.Write(
+		CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT,
+		CVuAssembler::Lower::NOP()
+	);
+
+	//pipe = 8
+	assembler.Write(
+		CVuAssembler::Upper::NOP(),
+		CVuAssembler::Lower::FSAND(CVuAssembler::VI3, 0xFFF)
+	);
+
+	virtualMachine.m_cpu.m_State.nCOP2[1].nV0 = 0x3F800000;		//VF1 = (1, 1, 1, 1)
+	virtualMachine.m_cpu.m_State.nCOP2[1].nV1 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2[1].nV2 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2[1].nV3 = 0x3F800000;
+
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV0 = 0xBF800000;		//VF2 = (-1, -1, -1, -1)
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV1 = 0xBF800000;
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV2 = 0xBF800000;
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV3 = 0xBF800000;
+
+	virtualMachine.m_cpu.m_State.nCOP2VI[15] = 0xFFFF;
+
+	virtualMachine.ExecuteTest(0);
+
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[6].nV0 == 0xC0000000);	//VF6 = VF2 - VF1x
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[6].nV3 == 0xC0000000);
+
+	//Z flags of every component (pipe 0 result)
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2VI[1] == 0x000F);
+
+	//Z flags of X and Y (pipe 2 result)
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2VI[2] == 0x000C);
+
+	//Z flag from pipe 4 result, S sticky flag only set by pipe 1 and 3 results
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2VI[3] == 0x00C1);
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2SF == 0x00FF);
+}